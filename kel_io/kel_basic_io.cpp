@@ -7,6 +7,10 @@
 #include "kel_basic_io.h"
 #include "kel_file_io.h"
 #include "kel_bzip_workflow.h"
+#include "kel_gzip_workflow.h"
+#include "kel_bz2_workflow.h"
+
+#include <cstring>
 
 
 // Implementation file classes need to be defined within namespaces.
@@ -30,10 +34,238 @@ std::pair<size_t, std::string> IOLineRecord::getLineData() {
   size_t out_line = line_count_;
   line_count_ = 0;
   empty_ = true;
+  if (mapped_) {
+
+    // Copy the viewed text, the mapped memory is owned by the stream.
+    return {out_line, std::string(line_view_)};
+
+  }
   return {out_line, std::move(line_data_)};
 
 }
 
+
+// The pools are never destroyed, records may be released by threads during static destruction.
+StringBufferPool& IOLineRecord::linePool() {
+
+  static StringBufferPool& line_pool = *(new StringBufferPool(LINE_POOL_SLOTS_, LINE_POOL_MAX_CAPACITY_));
+  return line_pool;
+
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// A block of line records.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+IOLineBlock::IOLineBlock(size_t first_line_count, std::string&& block_data) : first_line_count_(first_line_count)
+                                                                            , block_data_(std::move(block_data))
+                                                                            , line_ends_(offsetPool().acquire()) {
+
+  indexLines();
+
+}
+
+
+IOLineBlock::IOLineBlock(size_t first_line_count, std::string_view block_view) : first_line_count_(first_line_count)
+                                                                               , line_ends_(offsetPool().acquire())
+                                                                               , block_view_(block_view)
+                                                                               , mapped_(true) {
+
+  indexLines();
+
+}
+
+
+void IOLineBlock::indexLines() {
+
+  line_ends_.clear();
+  std::string_view block_text = blockText();
+  const char* data_ptr = block_text.data();
+  const size_t data_size = block_text.size();
+  size_t line_begin{0};
+  while (line_begin < data_size) {
+
+    const void* line_end_ptr = std::memchr(data_ptr + line_begin, EOL_MARKER_, data_size - line_begin);
+    if (line_end_ptr == nullptr) {
+
+      // Unterminated final line.
+      line_ends_.push_back(data_size);
+      break;
+
+    }
+
+    size_t line_end = static_cast<const char*>(line_end_ptr) - data_ptr;
+    line_ends_.push_back(line_end);
+    line_begin = line_end + 1;
+
+  }
+
+}
+
+
+void IOLineBlock::appendLine(std::string_view line) {
+
+  if (mapped_) {
+
+    block_data_.assign(block_view_);
+    block_view_ = {};
+    mapped_ = false;
+
+  }
+
+  // Terminate an unterminated final line.
+  if (not line_ends_.empty() and line_ends_.back() == block_data_.size()) {
+
+    block_data_.push_back(EOL_MARKER_);
+
+  }
+
+  block_data_.append(line);
+  line_ends_.push_back(block_data_.size());
+  block_data_.push_back(EOL_MARKER_);
+
+}
+
+
+IOLineBlock& IOLineBlock::operator=(IOLineBlock&& line_block) noexcept {
+
+  if (this != &line_block) {
+
+    releaseBuffers();
+    first_line_count_ = line_block.first_line_count_;
+    block_data_ = std::move(line_block.block_data_);
+    line_ends_ = std::move(line_block.line_ends_);
+    block_view_ = line_block.block_view_;
+    EOF_ = line_block.EOF_;
+    mapped_ = line_block.mapped_;
+
+  }
+
+  return *this;
+
+}
+
+
+void IOLineBlock::releaseBuffers() {
+
+  blockPool().release(std::move(block_data_));
+  offsetPool().release(std::move(line_ends_));
+  block_data_.clear();
+  line_ends_.clear();
+
+}
+
+
+IOLineRecord IOLineBlock::lineRecord(size_t index) const {
+
+  std::string line_data = IOLineRecord::linePool().acquire();
+  line_data.assign(lineView(index));
+  return { lineCount(index), std::move(line_data) };
+
+}
+
+
+StringBufferPool& IOLineBlock::blockPool() {
+
+  static StringBufferPool& block_pool = *(new StringBufferPool(BLOCK_POOL_SLOTS_, BLOCK_POOL_MAX_CAPACITY_));
+  return block_pool;
+
+}
+
+
+OffsetBufferPool& IOLineBlock::offsetPool() {
+
+  static OffsetBufferPool& offset_pool = *(new OffsetBufferPool(BLOCK_POOL_SLOTS_, OFFSET_POOL_MAX_CAPACITY_));
+  return offset_pool;
+
+}
+
+
+std::string_view IOLineBlock::lineView(size_t index) const {
+
+  size_t line_begin = index == 0 ? 0 : line_ends_[index - 1] + 1;
+  return blockText().substr(line_begin, line_ends_[index] - line_begin);
+
+}
+
+
+IOLineBlock IOLineBlockAssembler::assemble(std::string_view text) {
+
+  size_t last_eol = text.rfind(EOL_MARKER_);
+  if (last_eol == std::string_view::npos) {
+
+    // No complete lines.
+    partial_line_.append(text);
+    return IOLineBlock(line_count_ + 1);
+
+  }
+
+  // The partial line from the previous text is completed by the first line of this text.
+  std::string block_data = IOLineBlock::blockPool().acquire();
+  block_data.clear();
+  block_data.reserve(partial_line_.size() + last_eol + 1);
+  block_data.append(partial_line_);
+  block_data.append(text.substr(0, last_eol + 1));
+  partial_line_.assign(text.substr(last_eol + 1));
+
+  IOLineBlock line_block(line_count_ + 1, std::move(block_data));
+  line_count_ += line_block.size();
+
+  return line_block;
+
+}
+
+
+IOLineBlock IOLineBlockAssembler::flush() {
+
+  if (partial_line_.empty()) {
+
+    return IOLineBlock(line_count_ + 1);
+
+  }
+
+  IOLineBlock line_block(line_count_ + 1, std::move(partial_line_));
+  line_count_ += line_block.size();
+  partial_line_.clear();
+
+  return line_block;
+
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Batch line records into a line block. Streams do not block after EOF, so a block is returned on EOF and the
+// EOF marker is returned by the next call.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+IOLineBlock BaseStreamIO::readBlock() {
+
+  IOLineRecord line_record = readLine();
+  if (line_record.EOFRecord()) {
+
+    return IOLineBlock::createEOFMarker();
+
+  }
+
+  IOLineBlock line_block(line_record.lineCount());
+  line_block.appendLine(line_record.getView());
+  while (line_block.dataSize() < LINE_BLOCK_SIZE_) {
+
+    IOLineRecord next_record = readLine();
+    if (next_record.EOFRecord()) {
+
+      break;
+
+    }
+    line_block.appendLine(next_record.getView());
+
+  }
+
+  return line_block;
+
+}
+
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Returns an IO stream that is either a normal stream or a compressed stream based on the file name extension.
@@ -42,6 +274,7 @@ std::pair<size_t, std::string> IOLineRecord::getLineData() {
 // If not in '.bgz' format then a standard (boost) single thread decompression algorithm is used.
 // If '.bz2' then Burrows-Wheeler compression is assumed.
 // If the file is not one of the above types, it is assumed to be an uncompressed record based text file.
+// Uncompressed text files are memory mapped (zero-copy), falling back to a std::ifstream if the file cannot be mapped.
 // Note the stream is returned open and ready for processing, std::nullopt is returned if there is a problem.
 // The threads argument is only valid for '.bgz' file types. The argument is ignored for other stream types.
 //
@@ -63,7 +296,15 @@ std::optional<std::unique_ptr<BaseStreamIO>> BaseStreamIO::getStreamIO(const std
 
     } else {
 
-      ExecEnv::log().info("File structure is not in bgz format, parser uses a general purpose gzip reader.");
+      ExecEnv::log().info("File structure is not in bgz format, parser uses a checkpoint indexed gzip reader.");
+      gz_stream_opt = GZParallelStreamIO::getStreamIO(file_name, decompression_threads);
+      if (gz_stream_opt) {
+
+        return gz_stream_opt;
+
+      }
+
+      ExecEnv::log().info("File: {} could not be opened by the checkpoint indexed gzip reader, parser uses a general purpose gzip reader.", file_name);
       return GZStreamIO::getStreamIO(file_name);
 
     }
@@ -72,13 +313,29 @@ std::optional<std::unique_ptr<BaseStreamIO>> BaseStreamIO::getStreamIO(const std
 
     return BGZStreamIO::getStreamIO(file_name, decompression_threads);
 
-  } else if (file_ext == BZ2_FILE_EXTENSTION_) { // If .bz2 then use Burrows Wheeler decompression.
+  } else if (file_ext == BZ2_FILE_EXTENSTION_) { // If .bz2 then use multi-threaded Burrows Wheeler block decompression.
 
+    auto bz2_stream_opt = BZ2ParallelStreamIO::getStreamIO(file_name, decompression_threads);
+    if (bz2_stream_opt) {
+
+      return bz2_stream_opt;
+
+    }
+
+    ExecEnv::log().info("File: {} could not be opened by the multi-threaded bzip2 reader, parser uses a single threaded bzip2 reader.", file_name);
     return BZ2StreamIO::getStreamIO(file_name);
 
   }
 
-  // Otherwise assume a text file.
+  // Otherwise assume a text file, memory mapped if possible.
+  auto mapped_stream_opt = MMapStreamIO::getStreamIO(file_name);
+  if (mapped_stream_opt) {
+
+    return mapped_stream_opt;
+
+  }
+
+  ExecEnv::log().info("File: {} could not be memory mapped, parser uses a std::ifstream text reader.", file_name);
   return TextStreamIO::getStreamIO(file_name);
 
 }
@@ -5,6 +5,8 @@
 #ifndef KEL_BASIC_IO_H
 #define KEL_BASIC_IO_H
 
+#include "kel_buffer_pool.h"
+
 #include <string>
 #include <memory>
 #include <string_view>
@@ -24,45 +26,175 @@ namespace kellerberrin {   //  organization::project level namespace
 // A static function createEOFMarker() creates an object to serve as EOF, this can also be pushed onto a queue.
 // Since the stored std::string data can be large, for optimal performance the object cannot be copied.
 // The object is designed to be pushed and popped from thread safe queues without incurring significant processing overhead.
+// A record can also be created as a std::string_view into memory owned by the stream (memory mapped files).
+// These 'mapped' records are zero-copy, the view is only valid while the originating stream remains open.
+// Calling getLineData() on a mapped record copies the viewed text into the returned std::string.
+// The line text buffers are recycled, a record destroyed with its line text still in place returns the buffer
+// to linePool() and the stream readers acquire line buffers from the pool.
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+using StringBufferPool = BufferPool<std::string>;
+
 class IOLineRecord {
 
 public:
 
   IOLineRecord(size_t line_count, std::string&& line_data) noexcept : line_count_(line_count), line_data_(std::move(line_data)) {}
+  // Zero-copy record, the viewed memory is owned by the stream and must outlive the record.
+  IOLineRecord(size_t line_count, std::string_view line_view) noexcept : line_count_(line_count), line_view_(line_view), mapped_(true) {}
   IOLineRecord(IOLineRecord&& line_record) noexcept : line_count_(line_record.line_count_)
                                                     , line_data_(std::move(line_record.line_data_))
+                                                    , line_view_(line_record.line_view_)
                                                     , EOF_(line_record.EOF_)
-                                                    , empty_(line_record.empty_) {}
+                                                    , empty_(line_record.empty_)
+                                                    , mapped_(line_record.mapped_) {}
   IOLineRecord(const IOLineRecord& line_record) = delete;
-  ~IOLineRecord() = default;
+  ~IOLineRecord() { linePool().release(std::move(line_data_)); }
 
   IOLineRecord& operator=(const IOLineRecord&) = delete;
 
   // After moving data out of the object, it is empty() but not EOF().
   [[nodiscard]] std::pair<size_t, std::string> getLineData();
   [[nodiscard]] size_t lineCount() const { return line_count_; }
-  [[nodiscard]] std::string_view getView() const { return {line_data_}; }
+  [[nodiscard]] std::string_view getView() const { return mapped_ ? line_view_ : std::string_view(line_data_); }
   [[nodiscard]] bool EOFRecord() const { return EOF_; }
   [[nodiscard]] bool empty() const { return empty_; }
+  // True if the record is a view into stream owned memory.
+  [[nodiscard]] bool mapped() const { return mapped_; }
 
 
   // ReturnType the EOF marker.
   [[nodiscard]] static IOLineRecord createEOFMarker() { return {}; }
 
+  // Recycled line text buffers, shared by all streams.
+  [[nodiscard]] static StringBufferPool& linePool();
+
 private:
 
   IOLineRecord() : EOF_{true} {} // Only create as an EOF marker.
 
   size_t line_count_{0}; // Actual line counts begin at 1.
   std::string line_data_; // This string is NOT '\n' terminated.
+  std::string_view line_view_; // Only valid if mapped_ is set, NOT '\n' terminated.
   bool EOF_{false};
   bool empty_{false};
+  bool mapped_{false};
+
+  // Line buffers are only retained up to peak usage.
+  constexpr static const size_t LINE_POOL_SLOTS_{32768};
+  constexpr static const size_t LINE_POOL_MAX_CAPACITY_{1 << 20};
 
 };
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// A block of consecutive line records held in a single buffer with an index of line end offsets.
+// Streams queue lines as blocks (typically the lines of a single decompressed block) so that queue synchronization
+// and memory allocation occur once per block rather than once per line.
+// Lines are accessed as std::string_view and are NOT '\n' terminated, the views are valid for the lifetime of the block.
+// A block can also be created as a std::string_view into memory owned by the stream (memory mapped files).
+// These 'mapped' blocks are zero-copy, the line views are only valid while the originating stream remains open.
+// A static function createEOFMarker() creates an object to serve as EOF, this can also be pushed onto a queue.
+// The object cannot be copied. The block data and line offset buffers are recycled using blockPool() and offsetPool().
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+using OffsetBufferPool = BufferPool<std::vector<size_t>>;
+
+class IOLineBlock {
+
+public:
+
+  explicit IOLineBlock(size_t first_line_count) noexcept : first_line_count_(first_line_count) {}
+  // The block data must be complete lines, each line is '\n' terminated except (optionally) the final line.
+  IOLineBlock(size_t first_line_count, std::string&& block_data);
+  // Zero-copy block, the viewed memory is owned by the stream and must outlive the block.
+  IOLineBlock(size_t first_line_count, std::string_view block_view);
+  IOLineBlock(IOLineBlock&& line_block) noexcept = default;
+  IOLineBlock(const IOLineBlock& line_block) = delete;
+  ~IOLineBlock() { releaseBuffers(); }
+
+  // The buffers of the assigned block are recycled.
+  IOLineBlock& operator=(IOLineBlock&& line_block) noexcept;
+  IOLineBlock& operator=(const IOLineBlock&) = delete;
+
+  // Copies the line into the block, a mapped block first copies the viewed text.
+  void appendLine(std::string_view line);
+
+  [[nodiscard]] size_t size() const { return line_ends_.size(); }
+  [[nodiscard]] bool empty() const { return line_ends_.empty(); }
+  [[nodiscard]] size_t dataSize() const { return blockText().size(); }
+  [[nodiscard]] std::string_view lineView(size_t index) const;
+  // The file line count of a line in the block.
+  [[nodiscard]] size_t lineCount(size_t index) const { return first_line_count_ + index; }
+  // Copies the line into a line record, the line buffer is acquired from IOLineRecord::linePool().
+  [[nodiscard]] IOLineRecord lineRecord(size_t index) const;
+  [[nodiscard]] bool EOFBlock() const { return EOF_; }
+  // True if the block is a view into stream owned memory.
+  [[nodiscard]] bool mapped() const { return mapped_; }
+
+  // ReturnType the EOF marker.
+  [[nodiscard]] static IOLineBlock createEOFMarker() { IOLineBlock eof_block(0); eof_block.EOF_ = true; return eof_block; }
+
+  // Recycled block data and line offset buffers, shared by all streams.
+  [[nodiscard]] static StringBufferPool& blockPool();
+  [[nodiscard]] static OffsetBufferPool& offsetPool();
+
+private:
+
+  size_t first_line_count_{0}; // Actual line counts begin at 1.
+  std::string block_data_;
+  std::vector<size_t> line_ends_; // The offset of each line end, the next line begins at the following offset.
+  std::string_view block_view_; // Only valid if mapped_ is set.
+  bool EOF_{false};
+  bool mapped_{false};
+
+  constexpr static const char EOL_MARKER_{'\n'};
+  // Blocks are queued in hundreds, the largest blocks are the gzip checkpoint spans (4MB).
+  constexpr static const size_t BLOCK_POOL_SLOTS_{1024};
+  constexpr static const size_t BLOCK_POOL_MAX_CAPACITY_{1 << 23};
+  constexpr static const size_t OFFSET_POOL_MAX_CAPACITY_{1 << 20};
+
+  [[nodiscard]] std::string_view blockText() const { return mapped_ ? block_view_ : std::string_view(block_data_); }
+  void indexLines();
+  void releaseBuffers();
+
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Assembles sequential decompressed text buffers into line blocks.
+// Lines split across consecutive buffers are joined and assigned to the block containing the line end.
+// The final (unterminated) line of the stream is returned by flush().
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class IOLineBlockAssembler {
+
+public:
+
+  IOLineBlockAssembler() = default;
+  ~IOLineBlockAssembler() = default;
+
+  // Returns the complete lines, the block may be empty.
+  [[nodiscard]] IOLineBlock assemble(std::string_view text);
+  // Returns any final unterminated line.
+  [[nodiscard]] IOLineBlock flush();
+
+  [[nodiscard]] size_t lineCount() const { return line_count_; }
+
+private:
+
+  std::string partial_line_;
+  size_t line_count_{0};
+
+  constexpr static const char EOL_MARKER_{'\n'};
+
+};
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Plug one of the superclasses (defined in the implementation file) to read text or gzipped files.
@@ -82,6 +214,10 @@ public:
   virtual bool open(const std::string &file_name) = 0;
   virtual void close() = 0;
   virtual IOLineRecord readLine() = 0;
+  // Returns the next block of lines, the default implementation batches readLine() records.
+  // Multi-threaded streams override this function to return lines as they are queued.
+  // Line blocks and line records should not be read in parallel from the same stream.
+  virtual IOLineBlock readBlock();
 
   // Returns an IO stream that is either a normal stream or a compressed stream based on the file name extension.
   // If '.bgz' then it uses a multi-threaded and memory efficient algorithm to decompress as it reads.
@@ -89,6 +225,7 @@ public:
   // If not in '.bgz' format then a standard (boost) single thread decompression algorithm is used.
   // If '.bz2' then Burrows-Wheeler compression is assumed.
   // If the file is not one of the above types, it is assumed to be an uncompressed record based text file.
+  // Uncompressed files are memory mapped and read without copying, if the file cannot be mapped a std::ifstream is used.
   // Note the stream is returned open and ready for processing, std::nullopt is returned if there is a problem.
   // The default decompression threads are only used by the bgz decompression stream
   [[nodiscard]] static std::optional<std::unique_ptr<BaseStreamIO>> getStreamIO( const std::string& file_name
@@ -100,6 +237,9 @@ protected:
   // Number of threads used in the decompression pipeline.
   constexpr static const size_t BGZ_DEFAULT_THREADS{15};
 
+  // The approximate data size of a line block batched from line records.
+  constexpr static const size_t LINE_BLOCK_SIZE_{65536};
+
   constexpr static const char* GZ_FILE_EXTENSTION_ = ".GZ"; // gzipped file assumed (checked for '.bgz' format).
   constexpr static const char* BGZ_FILE_EXTENSTION_ = ".BGZ"; // gzipped file assumed.
   constexpr static const char* BZ2_FILE_EXTENSTION_ = ".BZ2"; // Burrows-Wheeler compression assumed.
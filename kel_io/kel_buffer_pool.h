@@ -0,0 +1,141 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_BUFFER_POOL_H
+#define KEL_BUFFER_POOL_H
+
+
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <cstdint>
+
+
+namespace kellerberrin {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// A lock-free pool of recycled buffers (std::string, std::vector) shared by all threads.
+//
+// Records are created and destroyed by different threads at high rates (the stream reader threads create line
+// buffers and the VCF consumer threads destroy them). Recycling the buffers removes most malloc/free calls and
+// the associated allocator contention between threads.
+//
+// The pool is a fixed array of slots, each slot holds at most one buffer. A slot is claimed using compare and
+// exchange on the slot state, a thread never waits for a slot, if a claim fails then the next slot is tried.
+// acquire() returns a recycled buffer or, if none is found, an empty buffer. release() stores the buffer or,
+// if the pool is full or the buffer capacity is above the retained maximum, frees it.
+// The contents of an acquired buffer are unspecified, the caller must assign or clear the buffer.
+// Moving a buffer in and out of a slot does not allocate.
+//
+// Since buffers are only retained when released, the pool size is bounded by the peak number of buffers in use.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template<typename BufferType>
+class BufferPool {
+
+public:
+
+  BufferPool(size_t slot_count, size_t max_capacity) : slot_count_(std::max<size_t>(1, slot_count))
+                                                     , max_capacity_(max_capacity)
+                                                     , slots_(std::make_unique<Slot[]>(slot_count_)) {}
+  BufferPool(const BufferPool&) = delete;
+  ~BufferPool() = default;
+
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  [[nodiscard]] BufferType acquire() {
+
+    if (available_.load(std::memory_order_relaxed) == 0) {
+
+      return BufferType{};
+
+    }
+
+    size_t slot_index = acquire_index_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t count = 0; count < SCAN_LIMIT_; ++count, ++slot_index) {
+
+      Slot& slot = slots_[slot_index % slot_count_];
+      SlotState expected{SlotState::FULL};
+      if (slot.state_.compare_exchange_strong(expected, SlotState::BUSY, std::memory_order_acquire, std::memory_order_relaxed)) {
+
+        BufferType buffer(std::move(slot.buffer_));
+        slot.state_.store(SlotState::EMPTY, std::memory_order_release);
+        available_.fetch_sub(1, std::memory_order_relaxed);
+        return buffer;
+
+      }
+
+    }
+
+    return BufferType{};
+
+  }
+
+  void release(BufferType&& buffer) {
+
+    // Unallocated (moved from or small string) and oversize buffers are not retained.
+    if (buffer.capacity() <= empty_capacity_ or buffer.capacity() > max_capacity_) {
+
+      return;
+
+    }
+
+    size_t slot_index = release_index_.fetch_add(1, std::memory_order_relaxed);
+    for (size_t count = 0; count < SCAN_LIMIT_; ++count, ++slot_index) {
+
+      Slot& slot = slots_[slot_index % slot_count_];
+      SlotState expected{SlotState::EMPTY};
+      if (slot.state_.compare_exchange_strong(expected, SlotState::BUSY, std::memory_order_acquire, std::memory_order_relaxed)) {
+
+        slot.buffer_ = std::move(buffer);
+        slot.state_.store(SlotState::FULL, std::memory_order_release);
+        available_.fetch_add(1, std::memory_order_relaxed);
+        return;
+
+      }
+
+    }
+
+    // The pool is full, the buffer is freed.
+
+  }
+
+  // The approximate number of buffers held by the pool.
+  [[nodiscard]] size_t available() const { return available_.load(std::memory_order_relaxed); }
+  [[nodiscard]] size_t slotCount() const { return slot_count_; }
+
+private:
+
+  enum class SlotState : uint8_t { EMPTY, BUSY, FULL };
+
+  // Slots are cache line aligned to avoid false sharing between threads.
+  struct alignas(64) Slot {
+
+    std::atomic<SlotState> state_{SlotState::EMPTY};
+    BufferType buffer_;
+
+  };
+
+  const size_t slot_count_;
+  const size_t max_capacity_;
+  // The capacity of a default constructed buffer, the std::string small buffer does not allocate.
+  const size_t empty_capacity_{BufferType{}.capacity()};
+  std::unique_ptr<Slot[]> slots_;
+  // Acquire and release scan from separate positions, in steady state these advance in step around the slots.
+  alignas(64) std::atomic<size_t> acquire_index_{0};
+  alignas(64) std::atomic<size_t> release_index_{0};
+  alignas(64) std::atomic<size_t> available_{0};
+
+  // The maximum slots examined by acquire() and release().
+  constexpr static const size_t SCAN_LIMIT_{64};
+
+};
+
+
+} // namespace
+
+
+#endif //KEL_BUFFER_POOL_H
@@ -0,0 +1,574 @@
+// Copyright 2023 Kellerberrin
+//
+
+#include "kel_bz2_workflow.h"
+#include "kel_file_io.h"
+
+#include "kel_exec_env.h"
+#include "kel_utility.h"
+
+#include <bzlib.h>
+
+
+namespace kel = kellerberrin;
+
+
+std::optional<std::unique_ptr<kel::BaseStreamIO>> kel::BZ2ParallelStreamIO::getStreamIO( const std::string& file_name
+                                                                                       , size_t decompression_threads) {
+
+  auto stream_ptr = std::make_unique<BZ2ParallelStreamIO>(decompression_threads);
+  if (stream_ptr->open(file_name)) {
+
+    return stream_ptr;
+
+  }
+
+  ExecEnv::log().error("BZ2ParallelStreamIO::getStreamIO; error opening file: {}", file_name);
+  return std::nullopt;
+
+}
+
+
+bool kel::BZ2ParallelStreamIO::open(const std::string &file_name) {
+
+  if (stream_active_) {
+
+    ExecEnv::log().error("BZ2ParallelStreamIO::open; stream is already active; call close().");
+    return false;
+
+  }
+
+  file_name_ = file_name;
+  close_stream_ = false;
+  serial_fallback_ = false;
+  decompression_error_ = false;
+
+  bz2_file_.open(file_name_, std::ios::binary | std::ios::in);
+  if (not bz2_file_.good()) {
+
+    ExecEnv::log().error("BZ2ParallelStreamIO::open; I/O error; could not open file: {}", file_name_);
+    return false;
+
+  }
+
+  // Check the stream header 'BZh1' to 'BZh9'.
+  std::array<char, STREAM_HEADER_SIZE_> header{};
+  bz2_file_.read(header.data(), STREAM_HEADER_SIZE_);
+  if (not bz2_file_.good() or header[0] != 'B' or header[1] != 'Z' or header[2] != 'h' or header[3] < '1' or header[3] > '9') {
+
+    ExecEnv::log().error("BZ2ParallelStreamIO::open; file: {} is not in bzip2 format", file_name_);
+    bz2_file_.close();
+    return false;
+
+  }
+  bz2_file_.seekg(0);
+
+  decompression_pipeline_.activatePipeline(decompression_threads_, &BZ2ParallelStreamIO::decompressBlock);
+  reader_thread_.queueThreads(1);
+  reader_thread_.enqueueVoid(&BZ2ParallelStreamIO::readBlocks, this);
+  assemble_records_thread_.queueThreads(1);
+  assemble_future_ = assemble_records_thread_.enqueueFuture(&BZ2ParallelStreamIO::assembleRecords, this);
+  stream_active_ = true;
+
+  return true;
+
+}
+
+
+void kel::BZ2ParallelStreamIO::close() {
+
+  close_stream_ = true;
+  // The assembler may be blocked on a full line queue, it then discards the remaining pipeline blocks.
+  while (assemble_future_.valid() and assemble_future_.wait_for(CLOSE_WAIT_) != std::future_status::ready) {
+
+    line_queue_.drain();
+
+  }
+  reader_thread_.joinThreads();
+  assemble_records_thread_.joinThreads();
+  decompression_pipeline_.clear();
+  line_queue_.clear();
+  assemble_future_ = {};
+  bz2_file_.close();
+  stream_active_ = false;
+
+}
+
+
+// All byte pairs that lie wholly within either magic number at each of the 8 possible bit alignments.
+const kel::BZ2ParallelStreamIO::MagicPrefilter& kel::BZ2ParallelStreamIO::magicPrefilter() {
+
+  static const MagicPrefilter prefilter = []() {
+
+    MagicPrefilter byte_pairs;
+    for (uint64_t magic : { BLOCK_MAGIC_, STREAM_END_MAGIC_ }) {
+
+      // The magic number begins at bit 'alignment' of a 7 byte window.
+      for (size_t alignment = 0; alignment < 8; ++alignment) {
+
+        uint64_t window = magic << (8 - alignment);
+        for (size_t byte = 0; byte + 1 < 7; ++byte) {
+
+          bool pair_inside = (8 * byte) >= alignment and (8 * (byte + 2)) <= (alignment + MAGIC_BITS_);
+          if (pair_inside) {
+
+            size_t byte_pair = (window >> (8 * (7 - byte - 2))) & 0xFFFF;
+            byte_pairs.set(byte_pair);
+
+          }
+
+        }
+
+      }
+
+    }
+
+    return byte_pairs;
+
+  }();
+
+  return prefilter;
+
+}
+
+
+void kel::BZ2ParallelStreamIO::readBlocks() {
+
+  const MagicPrefilter& prefilter = magicPrefilter();
+  std::vector<char> read_buffer(READ_BUFFER_SIZE_);
+  // File data from the beginning of the current block, begins at file offset data_offset.
+  std::string file_data;
+  uint64_t data_offset{0};
+  uint64_t byte_count{0};
+  uint64_t shift_register{0};
+  size_t byte_pair{0};
+  size_t check_count{0};
+  // Every magic number (including any false match) begins a block, so no file data is discarded.
+  std::optional<uint64_t> block_begin;
+  bool block_stream_end{false};
+  size_t block_count{0};
+
+  while (not close_stream_ and not serial_fallback_) {
+
+    bz2_file_.read(read_buffer.data(), READ_BUFFER_SIZE_);
+    size_t read_size = bz2_file_.gcount();
+    if (read_size == 0) {
+
+      break;
+
+    }
+    file_data.append(read_buffer.data(), read_size);
+
+    for (size_t index = 0; index < read_size; ++index) {
+
+      auto byte = static_cast<uint8_t>(read_buffer[index]);
+      shift_register = (shift_register << 8) | byte;
+      byte_pair = ((byte_pair << 8) | byte) & 0xFFFF;
+      ++byte_count;
+
+      // Only check for magic numbers near a prefilter byte pair.
+      if (prefilter.test(byte_pair)) {
+
+        check_count = PREFILTER_WINDOW_;
+
+      }
+
+      if (check_count == 0) continue;
+      --check_count;
+
+      // Check the magic number ending at each bit of this byte, earliest first.
+      for (size_t shift = 8; shift > 0; --shift) {
+
+        uint64_t candidate = (shift_register >> (shift - 1)) & MAGIC_MASK_;
+        if ((candidate != BLOCK_MAGIC_ and candidate != STREAM_END_MAGIC_) or (byte_count * 8) < (MAGIC_BITS_ + shift - 1)) {
+
+          continue;
+
+        }
+
+        uint64_t magic_begin = (byte_count * 8) - (shift - 1) - MAGIC_BITS_;
+        if (block_begin) {
+
+          ++block_count;
+          queueBlock(file_data, data_offset, block_begin.value(), magic_begin, block_count, block_stream_end);
+
+        }
+        block_begin = magic_begin;
+        block_stream_end = candidate == STREAM_END_MAGIC_;
+
+      }
+
+    }
+
+    // Discard file data before the current block.
+    uint64_t keep_offset = block_begin ? block_begin.value() / 8 : byte_count;
+    file_data.erase(0, keep_offset - data_offset);
+    data_offset = keep_offset;
+
+  }
+
+  // Queue the final block, normally the stream end. A truncated final block fails to decompress.
+  if (not close_stream_ and not serial_fallback_ and block_begin) {
+
+    ++block_count;
+    queueBlock(file_data, data_offset, block_begin.value(), byte_count * 8, block_count, block_stream_end);
+
+  }
+
+  ExecEnv::log().info("BZ2ParallelStreamIO::readBlocks; file: {}, queued bzip2 blocks: {}", file_name_, block_count);
+
+  // Push the workflow stop token.
+  decompression_pipeline_.push(nullptr);
+
+}
+
+
+void kel::BZ2ParallelStreamIO::queueBlock( const std::string& file_data
+                                         , uint64_t data_offset
+                                         , uint64_t block_begin
+                                         , uint64_t block_end
+                                         , size_t block_id
+                                         , bool stream_end) {
+
+  auto block_ptr = std::make_unique<CompressedBlock>();
+  uint64_t begin_byte = block_begin / 8;
+  uint64_t end_byte = (block_end + 7) / 8;
+  block_ptr->block_id_ = block_id;
+  block_ptr->block_data_ = file_data.substr(begin_byte - data_offset, end_byte - begin_byte);
+  block_ptr->bit_offset_ = block_begin % 8;
+  block_ptr->bit_length_ = block_end - block_begin;
+  block_ptr->stream_end_ = stream_end;
+
+  decompression_pipeline_.push(std::move(block_ptr));
+
+}
+
+
+void kel::BZ2ParallelStreamIO::joinBlock(CompressedBlock& compressed_block, const CompressedBlock& following_block) {
+
+  // If the block does not end on a byte boundary, the final byte is also the first byte of the following block.
+  uint64_t block_end = compressed_block.bit_offset_ + compressed_block.bit_length_;
+  size_t shared_bytes = (block_end % 8) == 0 ? 0 : 1;
+  compressed_block.block_data_.append(following_block.block_data_, shared_bytes);
+  compressed_block.bit_length_ += following_block.bit_length_;
+
+}
+
+
+std::string kel::BZ2ParallelStreamIO::blockStream(const CompressedBlock& compressed_block) {
+
+  const auto* block_data = reinterpret_cast<const uint8_t*>(compressed_block.block_data_.data());
+  const size_t bit_offset = compressed_block.bit_offset_;
+
+  auto readBit = [&](uint64_t bit_position) -> uint64_t {
+
+    uint64_t position = bit_offset + bit_position;
+    return (block_data[position / 8] >> (7 - (position % 8))) & 1;
+
+  };
+
+  std::string stream_data(STREAM_HEADER_);
+  stream_data.reserve(STREAM_HEADER_SIZE_ + compressed_block.block_data_.size() + MAGIC_BITS_ + CRC_BITS_);
+
+  // Copy the whole bytes of the block, shifted to byte alignment.
+  uint64_t whole_bytes = compressed_block.bit_length_ / 8;
+  for (uint64_t index = 0; index < whole_bytes; ++index) {
+
+    uint8_t byte = bit_offset == 0 ? block_data[index]
+                                   : static_cast<uint8_t>((block_data[index] << bit_offset) | (block_data[index + 1] >> (8 - bit_offset)));
+    stream_data.push_back(static_cast<char>(byte));
+
+  }
+
+  uint64_t accumulator{0};
+  size_t accumulator_bits{0};
+  auto writeBits = [&](uint64_t value, size_t bit_count) {
+
+    for (size_t bit = bit_count; bit > 0; --bit) {
+
+      accumulator = (accumulator << 1) | ((value >> (bit - 1)) & 1);
+      if (++accumulator_bits == 8) {
+
+        stream_data.push_back(static_cast<char>(accumulator));
+        accumulator = 0;
+        accumulator_bits = 0;
+
+      }
+
+    }
+
+  };
+
+  // The remaining block bits.
+  for (uint64_t bit = whole_bytes * 8; bit < compressed_block.bit_length_; ++bit) {
+
+    writeBits(readBit(bit), 1);
+
+  }
+
+  // The block crc follows the block magic number. For a single block stream the combined stream crc is the block crc.
+  uint64_t block_crc{0};
+  for (uint64_t bit = MAGIC_BITS_; bit < MAGIC_BITS_ + CRC_BITS_; ++bit) {
+
+    block_crc = (block_crc << 1) | readBit(bit);
+
+  }
+  writeBits(STREAM_END_MAGIC_, MAGIC_BITS_);
+  writeBits(block_crc, CRC_BITS_);
+  // Pad to a byte boundary.
+  if (accumulator_bits > 0) {
+
+    writeBits(0, 8 - accumulator_bits);
+
+  }
+
+  return stream_data;
+
+}
+
+
+kel::BZ2ParallelStreamIO::DecompressedType kel::BZ2ParallelStreamIO::decompressBlock(CompressedType compressed_ptr) {
+
+  // Check if a stop token.
+  if (not compressed_ptr) {
+
+    // just return the nullptr;
+    return nullptr;
+
+  }
+
+  auto decompressed_ptr = std::make_unique<DecompressedBlock>();
+  decompressed_ptr->block_id_ = compressed_ptr->block_id_;
+
+  if (not compressed_ptr->stream_end_) {
+
+    std::optional<std::string> block_text = decompressStream(*compressed_ptr);
+    if (block_text) {
+
+      decompressed_ptr->block_text_ = std::move(block_text.value());
+      decompressed_ptr->decompress_success_ = true;
+      return decompressed_ptr;
+
+    }
+
+  }
+
+  // Returned to the assembler, the block may have been split by a false magic number.
+  decompressed_ptr->compressed_ptr_ = std::move(compressed_ptr);
+  decompressed_ptr->decompress_success_ = false;
+
+  return decompressed_ptr;
+
+}
+
+
+// Decompression failures are expected for blocks split by a false magic number and are not logged.
+std::optional<std::string> kel::BZ2ParallelStreamIO::decompressStream(const CompressedBlock& compressed_block) {
+
+  if (compressed_block.bit_length_ < MAGIC_BITS_ + CRC_BITS_) {
+
+    return std::nullopt;
+
+  }
+
+  std::string stream_data = blockStream(compressed_block);
+
+  bz_stream bz2_params{};
+  int return_code = ::BZ2_bzDecompressInit(&bz2_params, 0, 0);
+  if (return_code != BZ_OK) {
+
+    ExecEnv::log().error("BZ2ParallelStreamIO::decompressStream; ::BZ2_bzDecompressInit() fail, return code: {}", return_code);
+    return std::nullopt;
+
+  }
+
+  // A block decompresses to at most 900k bytes before the initial run length encoding is reversed, so the buffer may grow.
+  std::string block_text(INITIAL_OUTPUT_SIZE_, '\0');
+  size_t text_size{0};
+  bz2_params.next_in = stream_data.data();
+  bz2_params.avail_in = static_cast<unsigned int>(stream_data.size());
+  while (true) {
+
+    if (text_size == block_text.size()) {
+
+      block_text.resize(block_text.size() * 2);
+
+    }
+
+    bz2_params.next_out = block_text.data() + text_size;
+    bz2_params.avail_out = static_cast<unsigned int>(block_text.size() - text_size);
+    return_code = ::BZ2_bzDecompress(&bz2_params);
+    text_size = block_text.size() - bz2_params.avail_out;
+
+    // The block crc has been verified.
+    if (return_code == BZ_STREAM_END) break;
+
+    if (return_code != BZ_OK or (bz2_params.avail_in == 0 and bz2_params.avail_out > 0)) {
+
+      ::BZ2_bzDecompressEnd(&bz2_params);
+      return std::nullopt;
+
+    }
+
+  }
+  ::BZ2_bzDecompressEnd(&bz2_params);
+
+  block_text.resize(text_size);
+
+  return block_text;
+
+}
+
+
+void kel::BZ2ParallelStreamIO::assembleRecords() {
+
+  // Joins lines split across decompressed blocks.
+  IOLineBlockAssembler block_assembler;
+  // A block that failed to decompress, joined with the following blocks until it decompresses.
+  CompressedType pending_ptr;
+
+  while(true) {
+
+    DecompressedType block_ptr = decompression_pipeline_.waitAndPop();
+    // Check for eof.
+    if (not block_ptr) {
+
+      break;
+
+    }
+
+    // Discard the remaining blocks if the stream is closing or the serial decompressor is reading the file.
+    if (close_stream_ or serial_fallback_) continue;
+
+    std::string block_text;
+    if (pending_ptr) {
+
+      // A block split by a false magic number can only be joined to a following block that also failed.
+      if (block_ptr->decompress_success_) {
+
+        ExecEnv::log().warn("BZ2ParallelStreamIO::assembleRecords; file: {}, cannot decompress block: {}, using serial decompression",
+                            file_name_, pending_ptr->block_id_);
+        serial_fallback_ = true;
+        continue;
+
+      }
+
+      joinBlock(*pending_ptr, *block_ptr->compressed_ptr_);
+      if (pending_ptr->block_data_.size() > MAXIMUM_JOIN_SIZE_) {
+
+        ExecEnv::log().warn("BZ2ParallelStreamIO::assembleRecords; file: {}, joined block: {} size: {} exceeds maximum, using serial decompression",
+                            file_name_, pending_ptr->block_id_, pending_ptr->block_data_.size());
+        serial_fallback_ = true;
+        continue;
+
+      }
+
+      std::optional<std::string> joined_text = decompressStream(*pending_ptr);
+      if (not joined_text) continue;
+
+      block_text = std::move(joined_text.value());
+      pending_ptr.reset();
+
+    } else if (block_ptr->decompress_success_) {
+
+      block_text = std::move(block_ptr->block_text_);
+
+    } else if (block_ptr->compressed_ptr_->stream_end_) {
+
+      // The preceding block passed the crc check, so this is a genuine stream end.
+      continue;
+
+    } else {
+
+      pending_ptr = std::move(block_ptr->compressed_ptr_);
+      continue;
+
+    }
+
+    IOLineBlock line_block = block_assembler.assemble(block_text);
+    if (not line_block.empty()) {
+
+      line_queue_.push(std::move(line_block));
+
+    }
+
+  } // while.
+
+  if (pending_ptr and not close_stream_ and not serial_fallback_) {
+
+    ExecEnv::log().warn("BZ2ParallelStreamIO::assembleRecords; file: {}, cannot decompress final block: {}, using serial decompression",
+                        file_name_, pending_ptr->block_id_);
+    serial_fallback_ = true;
+
+  }
+
+  if (serial_fallback_ and not close_stream_) {
+
+    // Any partial line is discarded, the serial decompressor reads from the following line.
+    serialRecords(block_assembler.lineCount());
+
+  } else {
+
+    // Queue the final record if non-empty.
+    IOLineBlock final_block = block_assembler.flush();
+    if (not close_stream_ and not final_block.empty()) {
+
+      line_queue_.push(std::move(final_block));
+
+    }
+
+  }
+
+  // Push the eof marker.
+  line_queue_.pushEOF();
+
+}
+
+
+void kel::BZ2ParallelStreamIO::serialRecords(size_t line_count) {
+
+  BZ2StreamIO serial_stream;
+  if (not serial_stream.open(file_name_)) {
+
+    ExecEnv::log().error("BZ2ParallelStreamIO::serialRecords; serial decompressor could not open file: {}", file_name_);
+    decompression_error_ = true;
+    return;
+
+  }
+
+  try {
+
+    // Skip the lines already queued.
+    for (size_t count = 0; count < line_count; ++count) {
+
+      if (serial_stream.readLine().EOFRecord()) {
+
+        ExecEnv::log().error("BZ2ParallelStreamIO::serialRecords; file: {} ends before line: {}", file_name_, line_count);
+        decompression_error_ = true;
+        return;
+
+      }
+
+    }
+
+    while (not close_stream_) {
+
+      IOLineBlock line_block = serial_stream.readBlock();
+      if (line_block.EOFBlock()) {
+
+        break;
+
+      }
+      line_queue_.push(std::move(line_block));
+
+    }
+
+  }
+  catch (std::exception const &e) {
+
+    ExecEnv::log().error("BZ2ParallelStreamIO::serialRecords; file: {}, unexpected decompression exception: {}", file_name_, e.what());
+    decompression_error_ = true;
+
+  }
+
+}
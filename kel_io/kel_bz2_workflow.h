@@ -0,0 +1,167 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_BZ2_WORKFLOW_H
+#define KEL_BZ2_WORKFLOW_H
+
+
+#include "kel_queue_tidal.h"
+#include "kel_workflow_threads.h"
+#include "kel_workflow_pipeline.h"
+
+#include "kel_basic_io.h"
+#include "kel_line_block_queue.h"
+
+#include <string>
+#include <memory>
+#include <fstream>
+#include <bitset>
+
+
+namespace kellerberrin {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Multi-threaded decompression of '.bz2' files.
+// A bzip2 stream is a sequence of independently compressed blocks (up to 900k bytes of uncompressed data).
+// Each block begins with the 48 bit magic number 0x314159265359 (BCD pi) and the stream ends with the
+// 48 bit magic number 0x177245385090 (BCD sqrt(pi)). Blocks are not byte aligned.
+//
+// A reader thread scans the file for the block magic numbers and queues the bits of each block to a pipeline.
+// The pipeline threads wrap each block as a single block bzip2 stream and decompress it using libbz2.
+// An assembler thread joins lines split across blocks and queues the complete lines of each block as a line block.
+// The magic numbers can also occur by chance within the compressed data. A block that fails to decompress (or fails
+// the block crc check) is joined to the following block and decompressed again. A stream end is only accepted after
+// the preceding block has passed the crc check. If a joined block still cannot be decompressed, the remaining lines
+// are read using the serial boost decompressor (BZ2StreamIO).
+// Concatenated multi-stream files (for example, written by pbzip2) are supported.
+// The object presents the same sequential readLine() interface as the other stream objects.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+class BZ2ParallelStreamIO : public BaseStreamIO {
+
+  // The bits between consecutive magic numbers, the block begins at bit_offset_ of the first byte.
+  struct CompressedBlock {
+
+    size_t block_id_{0};
+    std::string block_data_;
+    size_t bit_offset_{0};
+    uint64_t bit_length_{0};
+    bool stream_end_{false}; // Begins with the stream end magic number.
+
+  };
+  using CompressedType = std::unique_ptr<CompressedBlock>;
+
+  // Returned from the data decompression threads.
+  struct DecompressedBlock {
+
+    size_t block_id_{0};
+    std::string block_text_;
+    bool decompress_success_{false};
+    // A stream end or a block that failed to decompress is returned so that it can be joined to the following block.
+    CompressedType compressed_ptr_;
+
+  };
+
+  // Convenience typedefs.
+  using DecompressedType = std::unique_ptr<DecompressedBlock>;
+  using DecompressionPipeline = WorkflowPipeline<CompressedType, DecompressedType>;
+
+  // Byte pairs that can occur within a block or stream end magic number, at any bit alignment.
+  using MagicPrefilter = std::bitset<65536>;
+
+public:
+
+  explicit BZ2ParallelStreamIO(size_t thread_count = BGZ_DEFAULT_THREADS) : decompression_threads_(thread_count) {}
+  BZ2ParallelStreamIO(const BZ2ParallelStreamIO &) = delete;
+  ~BZ2ParallelStreamIO() override { close(); }
+
+  [[nodiscard]] static std::optional<std::unique_ptr<BaseStreamIO>> getStreamIO( const std::string& file_name
+                                                                               , size_t decompression_threads = BGZ_DEFAULT_THREADS);
+
+  // Guaranteed sequential line reader. Does not block on eof.
+  [[nodiscard]] IOLineRecord readLine() override { return line_queue_.readLine(); }
+  // Guaranteed sequential line block reader. Does not block on eof.
+  [[nodiscard]] IOLineBlock readBlock() override { return line_queue_.readBlock(); }
+  // Verifies the bzip2 stream header and begins decompression.
+  [[nodiscard]] bool open(const std::string &file_name) override;
+  // Close the file and reset the internal queues and threads.
+  void close() override;
+
+  [[nodiscard]] bool good() const { return not decompression_error_; }
+  // Access queue stats.
+  [[nodiscard]] const QueueTidal<IOLineBlock>& lineQueue() const { return line_queue_.blockQueue(); }
+
+private:
+
+  std::string file_name_;
+  std::ifstream bz2_file_;
+  size_t decompression_threads_;
+  WorkflowThreads reader_thread_;
+  WorkflowThreads assemble_records_thread_;
+  std::future<void> assemble_future_;
+  DecompressionPipeline decompression_pipeline_{PIPELINE_HIGH_TIDE_, PIPELINE_LOW_TIDE_, PIPELINE_NAME_};
+  IOLineBlockQueue line_queue_{LINE_HIGH_TIDE_, LINE_LOW_TIDE_, LINE_QUEUE_NAME_, LINE_SAMPLE_FREQ_};
+  std::atomic<bool> decompression_error_{false};
+  std::atomic<bool> close_stream_{false};
+  std::atomic<bool> stream_active_{false};
+  std::atomic<bool> serial_fallback_{false};
+
+  constexpr static const uint64_t BLOCK_MAGIC_{0x314159265359};
+  constexpr static const uint64_t STREAM_END_MAGIC_{0x177245385090};
+  constexpr static const uint64_t MAGIC_MASK_{0xFFFFFFFFFFFF};
+  constexpr static const size_t MAGIC_BITS_{48};
+  constexpr static const size_t CRC_BITS_{32};
+  // After a prefilter byte pair match, the magic number must end within this many bytes.
+  constexpr static const size_t PREFILTER_WINDOW_{6};
+  // Each block is wrapped as a maximum block size ('9') bzip2 stream.
+  constexpr static const char* STREAM_HEADER_{"BZh9"};
+  constexpr static const size_t STREAM_HEADER_SIZE_{4};
+  constexpr static const size_t READ_BUFFER_SIZE_{1 << 20};
+  constexpr static const size_t INITIAL_OUTPUT_SIZE_{1 << 21};
+  // A compressed block is less than 1MB, joined blocks larger than this are not decompressed.
+  constexpr static const size_t MAXIMUM_JOIN_SIZE_{1 << 22};
+  // Each queued block decompresses to approximately 900k bytes, so the pipeline is kept short.
+  constexpr static const size_t PIPELINE_HIGH_TIDE_{64};
+  constexpr static const size_t PIPELINE_LOW_TIDE_{32};
+  constexpr static const char* PIPELINE_NAME_{"BZ2ParallelStreamIO Decompress Pipeline"};
+  constexpr static const size_t LINE_HIGH_TIDE_{32};
+  constexpr static const size_t LINE_LOW_TIDE_{16};
+  constexpr static const char* LINE_QUEUE_NAME_{"BZ2ParallelStreamIO Line Block Queue"};
+  constexpr static const size_t LINE_SAMPLE_FREQ_{100};
+  constexpr static const std::chrono::milliseconds CLOSE_WAIT_{10};
+
+  // Scan the file for block boundaries and queue the compressed blocks.
+  void readBlocks();
+  void queueBlock( const std::string& file_data
+                 , uint64_t data_offset
+                 , uint64_t block_begin
+                 , uint64_t block_end
+                 , size_t block_id
+                 , bool stream_end);
+  // Pipeline function, decompress the block.
+  [[nodiscard]] static DecompressedType decompressBlock(CompressedType compressed_ptr);
+  // Decompress a single block, returns std::nullopt on a decompression or crc error.
+  [[nodiscard]] static std::optional<std::string> decompressStream(const CompressedBlock& compressed_block);
+  // Wrap the block bits as a single block bzip2 stream.
+  [[nodiscard]] static std::string blockStream(const CompressedBlock& compressed_block);
+  // Append the bits of the following block.
+  static void joinBlock(CompressedBlock& compressed_block, const CompressedBlock& following_block);
+  // Assemble line blocks and queue as complete records.
+  void assembleRecords();
+  // Read the lines following the line count using the serial decompressor.
+  void serialRecords(size_t line_count);
+
+  [[nodiscard]] static const MagicPrefilter& magicPrefilter();
+
+};
+
+
+
+} // Namespace.
+
+
+#endif //KEL_BZ2_WORKFLOW_H
@@ -0,0 +1,681 @@
+// Copyright 2023 Kellerberrin
+//
+
+#include "kel_bzip_index.h"
+
+#include "kel_exec_env.h"
+#include "kel_utility.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <charconv>
+#include <zlib.h>
+
+
+namespace kel = kellerberrin;
+
+
+namespace {
+
+// The TBI and CSI index integers are little endian on all platforms.
+template<typename T> requires std::is_integral_v<T>
+T littleEndian(T value) {
+
+  if constexpr (std::endian::native == std::endian::big and sizeof(T) > 1) {
+
+    return std::byteswap(value);
+
+  } else {
+
+    return value;
+
+  }
+
+}
+
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Region text parsing.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::optional<kel::BGZRegion> kel::BGZRegion::parseRegion(const std::string& region_text) {
+
+  // Allow the '1,000,000' number format.
+  std::string region_str = Utility::trimAllChar(Utility::trimEndWhiteSpace(region_text), ',');
+  if (region_str.empty()) {
+
+    ExecEnv::log().error("BGZRegion::parseRegion; empty region text");
+    return std::nullopt;
+
+  }
+
+  auto parseCoordinate = [](std::string_view text) -> std::optional<int64_t> {
+
+    int64_t value{0};
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() or ptr != text.data() + text.size()) {
+
+      return std::nullopt;
+
+    }
+    return value;
+
+  };
+
+  BGZRegion region;
+  // Contig names can contain ':' so only the last ':' followed by a coordinate is significant.
+  size_t colon_pos = region_str.rfind(':');
+  if (colon_pos == std::string::npos or colon_pos + 1 == region_str.size()) {
+
+    region.contig = region_str.substr(0, colon_pos);
+    return region;
+
+  }
+
+  std::string_view interval_view(region_str);
+  interval_view.remove_prefix(colon_pos + 1);
+  size_t dash_pos = interval_view.find('-');
+  auto start_opt = parseCoordinate(interval_view.substr(0, dash_pos));
+  if (not start_opt) {
+
+    // Not a coordinate, so the entire text is a contig name.
+    region.contig = region_str;
+    return region;
+
+  }
+
+  region.contig = region_str.substr(0, colon_pos);
+  region.begin = std::max<int64_t>(start_opt.value() - 1, 0);
+
+  if (dash_pos != std::string_view::npos and dash_pos + 1 < interval_view.size()) {
+
+    auto end_opt = parseCoordinate(interval_view.substr(dash_pos + 1));
+    if (not end_opt or end_opt.value() <= region.begin) {
+
+      ExecEnv::log().error("BGZRegion::parseRegion; invalid region: {}", region_text);
+      return std::nullopt;
+
+    }
+    region.end = end_opt.value();
+
+  }
+
+  return region;
+
+}
+
+
+std::string kel::BGZRegion::toString() const {
+
+  if (end == REGION_END_) {
+
+    return std::format("{}:{}-", contig, begin + 1);
+
+  }
+
+  return std::format("{}:{}-{}", contig, begin + 1, end);
+
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Index file parsing.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::optional<kel::BGZIndex> kel::BGZIndex::readIndex(const std::string& bgz_file_name) {
+
+  for (auto const& extension : { TBI_EXTENSION_, CSI_EXTENSION_ }) {
+
+    std::string index_file_name = bgz_file_name + extension;
+    if (Utility::fileExists(index_file_name)) {
+
+      return readIndexFile(index_file_name);
+
+    }
+
+  }
+
+  ExecEnv::log().error("BGZIndex::readIndex; no '{}' or '{}' index found for file: {}", TBI_EXTENSION_, CSI_EXTENSION_, bgz_file_name);
+  return std::nullopt;
+
+}
+
+
+std::optional<kel::BGZIndex> kel::BGZIndex::readIndexFile(const std::string& index_file_name) {
+
+  // Index files are themselves block gzipped, zlib transparently decompresses concatenated gzip members.
+  gzFile index_file = ::gzopen(index_file_name.c_str(), "rb");
+  if (index_file == nullptr) {
+
+    ExecEnv::log().error("BGZIndex::readIndexFile; could not open index file: {}", index_file_name);
+    return std::nullopt;
+
+  }
+
+  std::string index_data;
+  constexpr const size_t READ_BUFFER_SIZE{1 << 16};
+  std::vector<char> read_buffer(READ_BUFFER_SIZE);
+  int read_size{0};
+  while ((read_size = ::gzread(index_file, read_buffer.data(), READ_BUFFER_SIZE)) > 0) {
+
+    index_data.append(read_buffer.data(), read_size);
+
+  }
+  ::gzclose(index_file);
+
+  if (read_size < 0) {
+
+    ExecEnv::log().error("BGZIndex::readIndexFile; error decompressing index file: {}", index_file_name);
+    return std::nullopt;
+
+  }
+
+  BGZIndex index;
+  if (not index.parseIndex(index_data)) {
+
+    ExecEnv::log().error("BGZIndex::readIndexFile; invalid index file: {}", index_file_name);
+    return std::nullopt;
+
+  }
+
+  ExecEnv::log().info("BGZIndex::readIndexFile; read {} index: {}, contigs: {}",
+                      (index.isCSI() ? "CSI" : "TBI"), index_file_name, index.contigNames().size());
+
+  return index;
+
+}
+
+
+bool kel::BGZIndex::parseIndex(const std::string& index_data) {
+
+  // All index integers are little endian.
+  size_t read_offset{0};
+  bool read_error{false};
+  auto readValue = [&]<typename T>(T& value) {
+
+    if (read_offset + sizeof(T) > index_data.size()) {
+
+      read_error = true;
+      value = T{};
+      return;
+
+    }
+    std::memcpy(&value, index_data.data() + read_offset, sizeof(T));
+    value = littleEndian(value);
+    read_offset += sizeof(T);
+
+  };
+
+  if (index_data.size() < 4) {
+
+    return false;
+
+  }
+
+  std::string_view magic(index_data.data(), 4);
+  read_offset = 4;
+  int32_t contig_count{0};
+
+  if (magic == TBI_MAGIC_) {
+
+    csi_index_ = false;
+    min_shift_ = TBI_MIN_SHIFT_;
+    depth_ = TBI_DEPTH_;
+    readValue(contig_count);
+    // The tabix configuration immediately follows the contig count.
+    int32_t names_length{0};
+    size_t config_offset = read_offset;
+    read_offset += 6 * sizeof(int32_t);
+    readValue(names_length);
+    if (read_error or read_offset + names_length > index_data.size()) {
+
+      return false;
+
+    }
+    read_offset += names_length;
+    if (not parseTabixConfig(std::string_view(index_data).substr(config_offset, read_offset - config_offset))) {
+
+      return false;
+
+    }
+
+  } else if (magic == CSI_MAGIC_) {
+
+    csi_index_ = true;
+    int32_t aux_length{0};
+    readValue(min_shift_);
+    readValue(depth_);
+    readValue(aux_length);
+    if (read_error or aux_length < 0 or read_offset + aux_length > index_data.size()) {
+
+      return false;
+
+    }
+    // A CSI index of a text file holds the tabix configuration in the auxiliary data.
+    if (not parseTabixConfig(std::string_view(index_data).substr(read_offset, aux_length))) {
+
+      ExecEnv::log().error("BGZIndex::parseIndex; CSI index does not contain tabix contig names");
+      return false;
+
+    }
+    read_offset += aux_length;
+    readValue(contig_count);
+
+  } else {
+
+    ExecEnv::log().error("BGZIndex::parseIndex; unknown index magic number");
+    return false;
+
+  }
+
+  if (read_error or contig_count < 0 or static_cast<size_t>(contig_count) != contig_names_.size()) {
+
+    ExecEnv::log().error("BGZIndex::parseIndex; contig count: {} does not match contig names: {}", contig_count, contig_names_.size());
+    return false;
+
+  }
+
+  contig_indexes_.resize(contig_count);
+  for (auto& contig_index : contig_indexes_) {
+
+    int32_t bin_count{0};
+    readValue(bin_count);
+    for (int32_t bin_idx = 0; bin_idx < bin_count and not read_error; ++bin_idx) {
+
+      uint32_t bin_id{0};
+      IndexBin index_bin;
+      int32_t chunk_count{0};
+      readValue(bin_id);
+      if (csi_index_) {
+
+        readValue(index_bin.loffset);
+
+      }
+      readValue(chunk_count);
+      if (read_error or chunk_count < 0) {
+
+        return false;
+
+      }
+      index_bin.chunks.resize(chunk_count);
+      for (auto& chunk : index_bin.chunks) {
+
+        readValue(chunk.begin);
+        readValue(chunk.end);
+
+      }
+      contig_index.bins.emplace(bin_id, std::move(index_bin));
+
+    }
+
+    if (not csi_index_) {
+
+      int32_t interval_count{0};
+      readValue(interval_count);
+      if (read_error or interval_count < 0) {
+
+        return false;
+
+      }
+      contig_index.linear_index.resize(interval_count);
+      for (auto& interval_offset : contig_index.linear_index) {
+
+        readValue(interval_offset);
+
+      }
+
+    }
+
+    if (read_error) {
+
+      return false;
+
+    }
+
+  }
+
+  // The optional trailing unplaced record count is not used.
+  return true;
+
+}
+
+
+bool kel::BGZIndex::parseTabixConfig(std::string_view config_data) {
+
+  constexpr const size_t CONFIG_FIELDS{7};
+  if (config_data.size() < CONFIG_FIELDS * sizeof(int32_t)) {
+
+    return false;
+
+  }
+
+  std::array<int32_t, CONFIG_FIELDS> config{};
+  std::memcpy(config.data(), config_data.data(), CONFIG_FIELDS * sizeof(int32_t));
+  std::ranges::transform(config, config.begin(), littleEndian<int32_t>);
+  format_ = config[0];
+  column_contig_ = config[1];
+  column_begin_ = config[2];
+  column_end_ = config[3];
+  meta_char_ = static_cast<char>(config[4]);
+  // config[5] is the tabix 'skip lines' count, header lines are identified by the meta char.
+  int32_t names_length = config[6];
+
+  config_data.remove_prefix(CONFIG_FIELDS * sizeof(int32_t));
+  if (names_length < 0 or static_cast<size_t>(names_length) > config_data.size()) {
+
+    return false;
+
+  }
+
+  // Contig names are concatenated null terminated strings.
+  contig_names_.clear();
+  contig_map_.clear();
+  std::string_view names_view = config_data.substr(0, names_length);
+  while (not names_view.empty()) {
+
+    size_t null_pos = names_view.find('\0');
+    std::string contig_name(names_view.substr(0, null_pos));
+    contig_map_.emplace(contig_name, contig_names_.size());
+    contig_names_.push_back(std::move(contig_name));
+    if (null_pos == std::string_view::npos) break;
+    names_view.remove_prefix(null_pos + 1);
+
+  }
+
+  return column_contig_ > 0 and column_begin_ > 0;
+
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Index queries.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The bins overlapping the zero-based half-open interval [begin, end), the standard SAM specification algorithm.
+std::vector<uint32_t> kel::BGZIndex::regionBins(int64_t begin, int64_t end) const {
+
+  std::vector<uint32_t> bins;
+  int32_t shift = min_shift_ + (depth_ * 3);
+  int64_t max_position = int64_t{1} << shift;
+  end = std::min(end, max_position);
+  if (begin >= end) {
+
+    return bins;
+
+  }
+
+  --end;
+  uint32_t level_first{0};
+  for (int32_t level = 0; level <= depth_; ++level) {
+
+    int64_t bin_begin = level_first + (begin >> shift);
+    int64_t bin_end = level_first + (end >> shift);
+    for (int64_t bin = bin_begin; bin <= bin_end; ++bin) {
+
+      bins.push_back(static_cast<uint32_t>(bin));
+
+    }
+    level_first += 1U << (3 * level);
+    shift -= 3;
+
+  }
+
+  return bins;
+
+}
+
+
+// Chunks ending before this offset cannot contain records overlapping the region begin.
+uint64_t kel::BGZIndex::minimumOffset(const ContigIndex& contig_index, int64_t begin) const {
+
+  if (not csi_index_) {
+
+    if (contig_index.linear_index.empty()) {
+
+      return 0;
+
+    }
+    size_t interval = std::min<size_t>(begin >> min_shift_, contig_index.linear_index.size() - 1);
+    return contig_index.linear_index[interval];
+
+  }
+
+  // The CSI index stores the linear offset in the bins, search the finest level bin and then its parents.
+  uint32_t bin = binFirst(depth_) + static_cast<uint32_t>(begin >> min_shift_);
+  while (true) {
+
+    auto find_iter = contig_index.bins.find(bin);
+    if (find_iter != contig_index.bins.end()) {
+
+      return find_iter->second.loffset;
+
+    }
+    if (bin == 0) {
+
+      return 0;
+
+    }
+    bin = (bin - 1) >> 3;
+
+  }
+
+}
+
+
+uint64_t kel::BGZIndex::firstRecordOffset() const {
+
+  uint64_t first_offset = std::numeric_limits<uint64_t>::max();
+  for (auto const& contig_index : contig_indexes_) {
+
+    for (auto const& [bin_id, index_bin] : contig_index.bins) {
+
+      // The meta bin does not hold record offsets.
+      if (bin_id == metaBin()) continue;
+
+      for (auto const& chunk : index_bin.chunks) {
+
+        first_offset = std::min(first_offset, chunk.begin);
+
+      }
+
+    }
+
+  }
+
+  return first_offset == std::numeric_limits<uint64_t>::max() ? 0 : first_offset;
+
+}
+
+
+kel::BGZChunkVector kel::BGZIndex::queryChunks(const BGZRegionVector& regions) const {
+
+  BGZChunkVector query_chunks;
+
+  // The file header precedes the first indexed record.
+  uint64_t header_end = firstRecordOffset();
+  if (header_end > 0) {
+
+    query_chunks.push_back({0, header_end});
+
+  }
+
+  for (auto const& region : regions) {
+
+    auto contig_iter = contig_map_.find(region.contig);
+    if (contig_iter == contig_map_.end()) {
+
+      ExecEnv::log().warn("BGZIndex::queryChunks; region contig: {} not found in index", region.contig);
+      continue;
+
+    }
+
+    const ContigIndex& contig_index = contig_indexes_[contig_iter->second];
+    uint64_t minimum_offset = minimumOffset(contig_index, region.begin);
+    for (auto bin : regionBins(region.begin, region.end)) {
+
+      auto bin_iter = contig_index.bins.find(bin);
+      if (bin_iter == contig_index.bins.end()) continue;
+
+      for (auto const& chunk : bin_iter->second.chunks) {
+
+        if (chunk.end > minimum_offset) {
+
+          query_chunks.push_back(chunk);
+
+        }
+
+      }
+
+    }
+
+  }
+
+  // Sort and merge overlapping chunks, or chunks that end and begin in the same compressed block.
+  std::ranges::sort(query_chunks, [](const BGZChunk& lhs, const BGZChunk& rhs) { return lhs.begin < rhs.begin; });
+  BGZChunkVector merged_chunks;
+  for (auto const& chunk : query_chunks) {
+
+    if (not merged_chunks.empty()
+        and (chunk.begin <= merged_chunks.back().end
+             or BGZChunk::blockOffset(chunk.begin) == BGZChunk::blockOffset(merged_chunks.back().end))) {
+
+      merged_chunks.back().end = std::max(merged_chunks.back().end, chunk.end);
+
+    } else {
+
+      merged_chunks.push_back(chunk);
+
+    }
+
+  }
+
+  return merged_chunks;
+
+}
+
+
+std::optional<std::tuple<std::string_view, int64_t, int64_t>> kel::BGZIndex::recordInterval(std::string_view line) const {
+
+  std::string_view contig;
+  int64_t begin{-1};
+  int64_t end{-1};
+  size_t ref_length{0};
+  std::string_view info;
+
+  size_t column{1};
+  size_t field_begin{0};
+  size_t max_column = std::max<size_t>({ static_cast<size_t>(column_contig_)
+                                       , static_cast<size_t>(column_begin_)
+                                       , static_cast<size_t>(column_end_)
+                                       , (format_ & 0xFFFF) == FORMAT_VCF_ ? VCF_INFO_COLUMN_ : 0 });
+
+  while (column <= max_column and field_begin <= line.size()) {
+
+    size_t field_end = line.find(FIELD_DELIMITER_, field_begin);
+    if (field_end == std::string_view::npos) field_end = line.size();
+    std::string_view field = line.substr(field_begin, field_end - field_begin);
+
+    auto parseField = [](std::string_view text) -> int64_t {
+
+      int64_t value{-1};
+      std::from_chars(text.data(), text.data() + text.size(), value);
+      return value;
+
+    };
+
+    if (column == static_cast<size_t>(column_contig_)) {
+
+      contig = field;
+
+    } else if (column == static_cast<size_t>(column_begin_)) {
+
+      begin = parseField(field);
+      if ((format_ & FORMAT_ZERO_BASED_) == 0) --begin;
+
+    } else if (column_end_ > 0 and column == static_cast<size_t>(column_end_) and (format_ & 0xFFFF) != FORMAT_VCF_) {
+
+      end = parseField(field);
+
+    }
+
+    if ((format_ & 0xFFFF) == FORMAT_VCF_) {
+
+      if (column == VCF_REF_COLUMN_) ref_length = field.size();
+      if (column == VCF_INFO_COLUMN_) info = field;
+
+    }
+
+    field_begin = field_end + 1;
+    ++column;
+
+  }
+
+  if (contig.empty() or begin < 0) {
+
+    return std::nullopt;
+
+  }
+
+  if ((format_ & 0xFFFF) == FORMAT_VCF_) {
+
+    end = begin + static_cast<int64_t>(std::max<size_t>(ref_length, 1));
+    // Symbolic structural variants specify the end position in the INFO field.
+    size_t end_pos = info.find(VCF_END_KEY_);
+    if (end_pos != std::string_view::npos and (end_pos == 0 or info[end_pos - 1] == ';')) {
+
+      std::string_view end_view = info.substr(end_pos + std::strlen(VCF_END_KEY_));
+      int64_t info_end{-1};
+      std::from_chars(end_view.data(), end_view.data() + end_view.size(), info_end);
+      if (info_end > begin) end = info_end;
+
+    }
+
+  } else if (end <= begin) {
+
+    end = begin + 1;
+
+  }
+
+  return std::tuple{contig, begin, end};
+
+}
+
+
+bool kel::BGZIndex::lineInRegions(std::string_view line, const BGZRegionVector& regions) const {
+
+  if (line.empty()) {
+
+    return false;
+
+  }
+
+  if (line.front() == meta_char_) {
+
+    return true;
+
+  }
+
+  auto interval_opt = recordInterval(line);
+  if (not interval_opt) {
+
+    return false;
+
+  }
+
+  auto const& [contig, begin, end] = interval_opt.value();
+  for (auto const& region : regions) {
+
+    if (region.contig == contig and begin < region.end and end > region.begin) {
+
+      return true;
+
+    }
+
+  }
+
+  return false;
+
+}
@@ -0,0 +1,154 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_BZIP_INDEX_H
+#define KEL_BZIP_INDEX_H
+
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <optional>
+#include <cstdint>
+
+
+namespace kellerberrin {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// A genomic region requested from an indexed '.bgz' file.
+// Regions are specified in the familiar tabix/samtools text format 'contig:start-end', 'contig:start' or 'contig'.
+// Text coordinates are 1-based and inclusive, internally the region is held as a zero-based half-open interval.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct BGZRegion {
+
+  std::string contig;
+  int64_t begin{0};                       // Zero-based, inclusive.
+  int64_t end{REGION_END_};               // Zero-based, exclusive.
+
+  // Parse the 'contig:start-end' format, returns std::nullopt on a malformed region.
+  [[nodiscard]] static std::optional<BGZRegion> parseRegion(const std::string& region_text);
+  [[nodiscard]] std::string toString() const;
+
+  constexpr static const int64_t REGION_END_{int64_t{1} << 62};
+
+};
+
+using BGZRegionVector = std::vector<BGZRegion>;
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Reads the tabix (.tbi) or coordinate sorted (.csi) index of a '.bgz' file.
+// The index is queried with a vector of regions and returns the BGZF virtual offset chunks that must be decompressed
+// to recover all the records overlapping the regions. A BGZF virtual offset is the file offset of the compressed
+// block in the upper 48 bits and the offset into the uncompressed block in the lower 16 bits.
+// Because index chunks are coarse, the returned chunks will contain records outside the requested regions.
+// The lineInRegions() function uses the tabix column configuration held in the index to filter these records.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A virtual offset interval [begin, end) within a '.bgz' file.
+struct BGZChunk {
+
+  uint64_t begin{0};
+  uint64_t end{0};
+
+  [[nodiscard]] static uint64_t blockOffset(uint64_t virtual_offset) { return virtual_offset >> 16; }
+  [[nodiscard]] static uint64_t dataOffset(uint64_t virtual_offset) { return virtual_offset & 0xFFFF; }
+
+};
+
+using BGZChunkVector = std::vector<BGZChunk>;
+
+
+class BGZIndex {
+
+public:
+
+  BGZIndex() = default;
+  ~BGZIndex() = default;
+
+  // Looks for 'file_name.tbi' and then 'file_name.csi', returns std::nullopt if no valid index is found.
+  [[nodiscard]] static std::optional<BGZIndex> readIndex(const std::string& bgz_file_name);
+  // Reads an explicitly named '.tbi' or '.csi' index.
+  [[nodiscard]] static std::optional<BGZIndex> readIndexFile(const std::string& index_file_name);
+
+  // Sorted and merged chunks covering all the regions.
+  // The first chunk covers the file header (all lines before the first indexed record).
+  [[nodiscard]] BGZChunkVector queryChunks(const BGZRegionVector& regions) const;
+
+  // Returns true if the line is a header (meta) line or the record overlaps any of the regions.
+  [[nodiscard]] bool lineInRegions(std::string_view line, const BGZRegionVector& regions) const;
+
+  [[nodiscard]] const std::vector<std::string>& contigNames() const { return contig_names_; }
+  [[nodiscard]] bool isCSI() const { return csi_index_; }
+
+private:
+
+  // Index bins are a map of bin number to chunks, the loffset is only used by '.csi' indexes.
+  struct IndexBin {
+
+    uint64_t loffset{0};
+    BGZChunkVector chunks;
+
+  };
+
+  struct ContigIndex {
+
+    std::map<uint32_t, IndexBin> bins;
+    std::vector<uint64_t> linear_index;     // Only used by '.tbi' indexes.
+
+  };
+
+  bool csi_index_{false};
+  int32_t min_shift_{TBI_MIN_SHIFT_};
+  int32_t depth_{TBI_DEPTH_};
+  // Tabix column configuration.
+  int32_t format_{0};
+  int32_t column_contig_{1};
+  int32_t column_begin_{4};
+  int32_t column_end_{5};
+  char meta_char_{'#'};
+  std::vector<std::string> contig_names_;
+  std::map<std::string, size_t, std::less<>> contig_map_;
+  std::vector<ContigIndex> contig_indexes_;
+
+  // Index constants specified by the SAM/tabix specifications.
+  constexpr static const int32_t TBI_MIN_SHIFT_{14};
+  constexpr static const int32_t TBI_DEPTH_{5};
+  constexpr static const int32_t FORMAT_GENERIC_{0};
+  constexpr static const int32_t FORMAT_SAM_{1};
+  constexpr static const int32_t FORMAT_VCF_{2};
+  constexpr static const int32_t FORMAT_ZERO_BASED_{0x10000};
+  constexpr static const char* TBI_MAGIC_{"TBI\1"};
+  constexpr static const char* CSI_MAGIC_{"CSI\1"};
+  constexpr static const char* TBI_EXTENSION_{".tbi"};
+  constexpr static const char* CSI_EXTENSION_{".csi"};
+  constexpr static const char* VCF_END_KEY_{"END="};
+  constexpr static const size_t VCF_REF_COLUMN_{4};
+  constexpr static const size_t VCF_INFO_COLUMN_{8};
+  constexpr static const char FIELD_DELIMITER_{'\t'};
+
+  [[nodiscard]] bool parseIndex(const std::string& index_data);
+  [[nodiscard]] bool parseTabixConfig(std::string_view config_data);
+  [[nodiscard]] uint32_t metaBin() const { return binCount() + 1; }
+  [[nodiscard]] uint32_t binCount() const { return ((1U << (3 * depth_ + 3)) - 1) / 7; }
+  [[nodiscard]] uint32_t binFirst(int32_t level) const { return ((1U << (3 * level)) - 1) / 7; }
+  [[nodiscard]] std::vector<uint32_t> regionBins(int64_t begin, int64_t end) const;
+  [[nodiscard]] uint64_t minimumOffset(const ContigIndex& contig_index, int64_t begin) const;
+  [[nodiscard]] uint64_t firstRecordOffset() const;
+  // Returns the zero-based half-open record interval and contig, std::nullopt if the line cannot be parsed.
+  [[nodiscard]] std::optional<std::tuple<std::string_view, int64_t, int64_t>> recordInterval(std::string_view line) const;
+
+};
+
+
+} // Namespace.
+
+
+#endif //KEL_BZIP_INDEX_H
@@ -7,7 +7,6 @@
 #include "kel_utility.h"
 
 #include <fstream>
-#include <zlib.h>
 
 
 namespace kel = kellerberrin;
@@ -30,6 +29,22 @@ std::optional<std::unique_ptr<kel::BaseStreamIO>> kel::BGZStreamIO::getStreamIO(
 
 }
 
+std::optional<std::unique_ptr<kel::BaseStreamIO>> kel::BGZStreamIO::getStreamIO( const std::string& file_name
+                                                                                , const BGZRegionVector& regions
+                                                                                , size_t decompression_threads) {
+
+  auto stream_ptr = std::make_unique<BGZStreamIO>(decompression_threads);
+  if (stream_ptr->open(file_name, regions)) {
+
+    return stream_ptr;
+
+  }
+
+  ExecEnv::log().error("BGZStreamIO::getStreamIO; error opening indexed regions of file: {}", file_name);
+  return std::nullopt;
+
+}
+
 void kel::BGZStreamIO::close() {
 
   record_counter_ = 0;
@@ -54,10 +69,54 @@ bool kel::BGZStreamIO::open(const std::string &file_name) {
 
   }
 
+  index_ = std::nullopt;
+  regions_.clear();
+  region_chunks_.clear();
+
+  return activateStream(file_name);
+
+}
+
+
+bool kel::BGZStreamIO::open(const std::string &file_name, const BGZRegionVector& regions) {
+
+  // Cannot re-open the object.
+  if (stream_state_ == BGZStreamState::ACTIVE) {
+
+    ExecEnv::log().error("BGZStreamIO::open; stream is already active; call close().");
+    return false;
+
+  }
+
+  index_ = BGZIndex::readIndex(file_name);
+  if (not index_) {
+
+    ExecEnv::log().error("BGZStreamIO::open; region queries require a '.tbi' or '.csi' index for file: {}", file_name);
+    return false;
+
+  }
+
+  regions_ = regions;
+  region_chunks_ = index_->queryChunks(regions_);
+  size_t compressed_bytes{0};
+  for (auto const& chunk : region_chunks_) {
+
+    compressed_bytes += BGZChunk::blockOffset(chunk.end) - BGZChunk::blockOffset(chunk.begin);
+
+  }
+  ExecEnv::log().info("BGZStreamIO::open; file: {}, regions: {}, index chunks: {}, compressed bytes: {}",
+                      file_name, regions_.size(), region_chunks_.size(), compressed_bytes);
+
+  return activateStream(file_name);
+
+}
+
+
+bool kel::BGZStreamIO::activateStream(const std::string &file_name) {
+
   record_counter_ = 0;
   file_name_ = file_name;
   close_stream_ = false;
-  line_eof_ = false;
 
   try {
 
@@ -79,13 +138,20 @@ bool kel::BGZStreamIO::open(const std::string &file_name) {
 
   // File is open so start processing.
   // Activate the decompression pipeline.
-  decompression_pipeline_.activatePipeline(decompression_threads_, &BGZStreamIO::decompressBlock);
+  decompression_pipeline_.activatePipeline(decompression_threads_, &BGZStreamIO::decompressBlock, this);
   // Enable queue stats for the pipeline.
   decompression_pipeline_.inputQueue().monitor().launchStats(PIPELINE_SAMPLE_FREQ_, std::string(PIPELINE_NAME_) + "_InputQueue");
-  decompression_pipeline_.outputQueue().monitor().launchStats(PIPELINE_SAMPLE_FREQ_, std::string(PIPELINE_NAME_) + "_OutputQueue");
   // Begin enqueueing compressed blocks of data onto the pipeline, 1 thread.
   reader_thread_.queueThreads(1);
-  reader_thread_.enqueueVoid(&BGZStreamIO::readDecompressFile, this);
+  if (index_) {
+
+    reader_thread_.enqueueVoid(&BGZStreamIO::readRegionChunks, this);
+
+  } else {
+
+    reader_thread_.enqueueVoid(&BGZStreamIO::readDecompressFile, this);
+
+  }
   // Begin dequeueing decompressed text records from the pipeline, 1 thread.
   assemble_records_thread_.queueThreads(1);
   assemble_records_thread_.enqueueVoid(&BGZStreamIO::assembleRecords, this);
@@ -97,16 +163,6 @@ bool kel::BGZStreamIO::open(const std::string &file_name) {
 }
 
 
-kel::IOLineRecord kel::BGZStreamIO::readLine() {
-
-  // Don't block if eof reached.
-  if (line_eof_ and line_queue_.empty()) return IOLineRecord::createEOFMarker();
-  // ReturnType next available sequential line record.
-  return line_queue_.waitAndPop();
-
-}
-
-
 void kel::BGZStreamIO::readDecompressFile() {
 
   if (not bgz_file_.good()) {
@@ -162,6 +218,64 @@ void kel::BGZStreamIO::readDecompressFile() {
 }
 
 
+void kel::BGZStreamIO::readRegionChunks() {
+
+  if (not bgz_file_.good()) {
+
+    ExecEnv::log().error("BGZStreamIO::readRegionChunks; failed to open bgz file: {}", file_name_);
+    decompression_pipeline_.push(nullptr);
+    return;
+
+  }
+
+  size_t block_count{0};
+  for (auto const& chunk : region_chunks_) {
+
+    // Chunks are specified as BGZF virtual offsets.
+    uint64_t block_offset = BGZChunk::blockOffset(chunk.begin);
+    const uint64_t end_block_offset = BGZChunk::blockOffset(chunk.end);
+    const size_t end_data_offset = BGZChunk::dataOffset(chunk.end);
+    bool first_block{true};
+
+    bgz_file_.seekg(static_cast<std::streamoff>(block_offset));
+    while (block_offset < end_block_offset or (block_offset == end_block_offset and end_data_offset > 0)) {
+
+      // Close down the stream gracefully.
+      if (close_stream_) {
+
+        decompression_pipeline_.push(nullptr);
+        return;
+
+      }
+
+      ++block_count;
+      auto compressed_ptr = readCompressedBlock(block_count);
+      if (not compressed_ptr->io_success_) {
+
+        ExecEnv::log().error("BGZStreamIO::readRegionChunks; Encountered I/O error reading compressed block at offset: {}", block_offset);
+        decompression_pipeline_.push(nullptr);
+        return;
+
+      }
+
+      // Restrict the decompressed data to the chunk.
+      compressed_ptr->data_begin_ = first_block ? BGZChunk::dataOffset(chunk.begin) : 0;
+      compressed_ptr->data_end_ = block_offset == end_block_offset ? end_data_offset : MAX_UNCOMPRESSED_SIZE_;
+      first_block = false;
+
+      block_offset += compressed_ptr->data_size_;
+      decompression_pipeline_.push(std::move(compressed_ptr));
+
+    }
+
+  }
+
+  // Push the workflow stop token.
+  decompression_pipeline_.push(nullptr);
+
+}
+
+
 bool kel::BGZStreamIO::checkEOFMarker(size_t remaining_chars) {
 
   // Not terminated so verify the EOF block.
@@ -198,6 +312,8 @@ bool kel::BGZStreamIO::checkEOFMarker(size_t remaining_chars) {
 
 kel::BGZStreamIO::CompressedType kel::BGZStreamIO::readCompressedBlock(size_t block_count) {
 
+  MetricTimer read_timer(read_latency_);
+
   // First read the header.
   //  Must be created for each iteration
   std::unique_ptr<CompressedBlock> read_vector_ptr(std::make_unique<CompressedBlock>());
@@ -229,12 +345,36 @@ kel::BGZStreamIO::CompressedType kel::BGZStreamIO::readCompressedBlock(size_t bl
 
   read_vector_ptr->data_size_ = total_block_size;
   read_vector_ptr->io_success_ = true;
+  compressed_blocks_.add();
+  compressed_bytes_.add(total_block_size);
 
   return read_vector_ptr;
 
 }
 
 
+bool kel::BGZStreamIO::setInflateBackend(InflateBackendType backend_type) {
+
+  if (stream_state_ == BGZStreamState::ACTIVE) {
+
+    ExecEnv::log().error("BGZStreamIO::setInflateBackend; stream is active; call close().");
+    return false;
+
+  }
+
+  if (not InflateBackend::available(backend_type)) {
+
+    ExecEnv::log().error("BGZStreamIO::setInflateBackend; inflate backend: {} is not available", InflateBackend::backendName(backend_type));
+    return false;
+
+  }
+
+  inflate_backend_ = backend_type;
+  return true;
+
+}
+
+
 kel::BGZStreamIO::DecompressedType kel::BGZStreamIO::decompressBlock(CompressedType compressed_ptr) {
 
   // Check if a stop token.
@@ -246,65 +386,46 @@ kel::BGZStreamIO::DecompressedType kel::BGZStreamIO::decompressBlock(CompressedT
   }
 
   auto decompressed_ptr = std::make_unique<DecompressedBlock>();
-  z_stream_s zlib_params;
 
-  // Inflate the compressed data.
-  zlib_params.next_in = reinterpret_cast<unsigned char*>(&(compressed_ptr->compressed_block_[0]));
-  zlib_params.avail_in = compressed_ptr->data_size_;
-  zlib_params.next_out = reinterpret_cast<unsigned char*>(&(decompressed_ptr->decompressed_data_[0]));
-  zlib_params.avail_out = MAX_UNCOMPRESSED_SIZE_;
-  zlib_params.data_type = Z_TEXT;
-  zlib_params.total_out = 0;
-  zlib_params.total_in = 0;
-  zlib_params.zalloc = Z_NULL;
-  zlib_params.zfree = Z_NULL;
-  zlib_params.opaque = nullptr;
-
-  int return_code = ::inflateInit2(&zlib_params, INFLATE_WINDOW_FLAG_);
-  if (return_code < Z_OK) {
-
-    std::string zlib_msg = zlib_params.msg != nullptr ? zlib_params.msg : "no msg";
-    ExecEnv::log().error("BGZStreamIO::decompressBlock; ::inflateInit2() fail, return code: {}, msg: {}, Uncompressed: {}, Consumed: {}",
-                         return_code, zlib_msg, MAX_UNCOMPRESSED_SIZE_ - zlib_params.avail_out, zlib_params.total_in);
-    decompressed_ptr->decompress_success_ = false;
-    return decompressed_ptr;
+  // Each pipeline thread holds the state of its own inflate backend.
+  thread_local std::unique_ptr<InflateBackend> backend_ptr;
+  if (not backend_ptr or backend_ptr->backendType() != inflate_backend_) {
 
-  }
+    auto backend_opt = InflateBackend::createBackend(inflate_backend_);
+    if (not backend_opt) {
 
-  return_code = ::inflate(&zlib_params, Z_FINISH);
-  if (return_code != Z_STREAM_END) {
+      decompressed_ptr->decompress_success_ = false;
+      return decompressed_ptr;
 
-    std::string zlib_msg = zlib_params.msg != nullptr ? zlib_params.msg : "no msg";
-    ExecEnv::log().error("BGZStreamIO::decompressBlock; ::inflate() fail, return code: {}, msg: {}, Uncompressed: {}, Consumed: {}",
-                         return_code, zlib_msg, MAX_UNCOMPRESSED_SIZE_ - zlib_params.avail_out, zlib_params.total_in);
-    decompressed_ptr->decompress_success_ = false;
-    return decompressed_ptr;
+    }
+    backend_ptr = std::move(backend_opt.value());
 
   }
 
-  return_code = ::inflateEnd(&zlib_params);
-  if (return_code < Z_OK) {
-
-    std::string zlib_msg = zlib_params.msg != nullptr ? zlib_params.msg : "no msg";
-    ExecEnv::log().error("BGZStreamIO::decompressBlock; ::inflateEnd() fail, return code: {}, msg: {}, Uncompressed: {}, Consumed: {}",
-                         return_code, zlib_msg, MAX_UNCOMPRESSED_SIZE_ - zlib_params.avail_out, zlib_params.total_in);
+  // Inflate the compressed data.
+  auto inflate_start = std::chrono::steady_clock::now();
+  auto inflate_size = backend_ptr->inflateMember( &(compressed_ptr->compressed_block_[0])
+                                                , compressed_ptr->data_size_
+                                                , &(decompressed_ptr->decompressed_data_[0])
+                                                , MAX_UNCOMPRESSED_SIZE_);
+  inflate_latency_.observe(std::chrono::steady_clock::now() - inflate_start);
+  if (not inflate_size) {
+
+    decompress_errors_.add();
+    ExecEnv::log().error("BGZStreamIO::decompressBlock; {} inflate fail, block: {}", backend_ptr->backendName(), compressed_ptr->block_id_);
     decompressed_ptr->decompress_success_ = false;
     return decompressed_ptr;
 
   }
 
-  decompressed_ptr->data_size_ = MAX_UNCOMPRESSED_SIZE_ - zlib_params.avail_out;
+  decompressed_ptr->data_size_ = inflate_size.value();
+  decompressed_bytes_.add(decompressed_ptr->data_size_);
   decompressed_ptr->block_id_ = compressed_ptr->block_id_;
   decompressed_ptr->decompress_success_ = true;
 
-  std::string_view block_view(&(decompressed_ptr->decompressed_data_[0]), decompressed_ptr->data_size_);
-  // Important note; if a final '\n' then the view parser allocates an empty string view.
-  std::vector<std::string_view> view_vector = Utility::viewTokenizer(block_view, EOL_MARKER_);
-  for (auto const& view : view_vector) {
-
-    decompressed_ptr->parsed_lines_.push_back(std::make_unique<std::string>(view));
-
-  }
+  // Apply the decompressed data window (only restricted for indexed region chunks).
+  decompressed_ptr->data_end_ = std::min(compressed_ptr->data_end_, decompressed_ptr->data_size_);
+  decompressed_ptr->data_begin_ = std::min(compressed_ptr->data_begin_, decompressed_ptr->data_end_);
 
   return decompressed_ptr;
 
@@ -315,7 +436,10 @@ void kel::BGZStreamIO::assembleRecords() {
 
   record_counter_ = 0;
   size_t block_count{0};
-  std::unique_ptr<std::string> previous_line_record;
+  // Joins lines split across decompressed blocks.
+  IOLineBlockAssembler block_assembler;
+  // Line blocks staged for a batch push to the line queue.
+  std::vector<IOLineBlock> staged_blocks;
 
   while(true) {
 
@@ -323,7 +447,6 @@ void kel::BGZStreamIO::assembleRecords() {
     // Check for eof.
     if (not block_ptr) {
 
-      line_eof_ = true;
       break;
 
     }
@@ -342,61 +465,54 @@ void kel::BGZStreamIO::assembleRecords() {
 
     }
 
-    // If the previous line record is defined, then concatenate with the first line record and queue.
-    if (previous_line_record and not block_ptr->parsed_lines_.empty()) {
+    std::string_view block_view(&(block_ptr->decompressed_data_[block_ptr->data_begin_]), block_ptr->data_end_ - block_ptr->data_begin_);
+    queueBlock(block_assembler.assemble(block_view), staged_blocks);
 
-      previous_line_record->append(*(block_ptr->parsed_lines_.front()));
+  } // while.
 
-      if ( block_ptr->parsed_lines_.size() >= 2) {
+  // Queue the final record if found and non-empty
+  queueBlock(block_assembler.flush(), staged_blocks);
 
-        ++record_counter_;
-        line_queue_.push(IOLineRecord(record_counter_, std::move(*previous_line_record)));
-        previous_line_record = nullptr;
+  // Push any staged blocks and the eof marker.
+  line_queue_.pushBatch(staged_blocks);
+  line_queue_.pushEOF();
 
-      }
+}
 
-    } else if (not block_ptr->parsed_lines_.empty()) {
 
-      ++record_counter_;
-      line_queue_.push(IOLineRecord(record_counter_, std::move(*(block_ptr->parsed_lines_.front()))));
-      previous_line_record = nullptr;
+void kel::BGZStreamIO::queueBlock(IOLineBlock&& line_block, std::vector<IOLineBlock>& staged_blocks) {
 
-    }
+  if (line_block.empty()) {
 
-    // Queue the 2nd to 2nd last last records.
-    size_t line_count = block_ptr->parsed_lines_.size();
-    for (size_t index = 1; index < line_count-1; ++index) {
+    return;
 
-      ++record_counter_;
-      line_queue_.push(IOLineRecord(record_counter_, std::move(*(block_ptr->parsed_lines_[index]))));
+  }
 
-    }
+  // Discard records that do not overlap the requested regions.
+  if (index_) {
 
-    if (not previous_line_record and not block_ptr->parsed_lines_.empty()) {
+    IOLineBlock region_block(record_counter_ + 1);
+    for (size_t index = 0; index < line_block.size(); ++index) {
 
-      // If this block is complete then queue the line and clear the previous_line_record.
-      // Store the last record in the previous_line_record.
-      previous_line_record = std::move(block_ptr->parsed_lines_.back());
+      if (index_->lineInRegions(line_block.lineView(index), regions_)) {
 
-    }
+        region_block.appendLine(line_block.lineView(index));
 
-  } // while.
+      }
 
-  // Queue the final record if found and non-empty
-  if (previous_line_record) {
+    }
 
-    if (not previous_line_record->empty()) {
+    if (region_block.empty()) {
 
-      ++record_counter_;
-      line_queue_.push(IOLineRecord(record_counter_, std::move(*previous_line_record)));
+      return;
 
     }
+    line_block = std::move(region_block);
 
   }
 
-  // Push the eof marker.
-  line_queue_.push(IOLineRecord::createEOFMarker());
+  record_counter_ += line_block.size();
+  lines_queued_.add(line_block.size());
+  line_queue_.stageBlock(std::move(line_block), staged_blocks);
 
 }
-
-
@@ -9,11 +9,17 @@
 #include "kel_queue_tidal.h"
 #include "kel_workflow_threads.h"
 #include "kel_workflow_pipeline.h"
+#include "kel_workflow_ordered.h"
 
 #include "kel_basic_io.h"
+#include "kel_bzip_index.h"
+#include "kel_line_block_queue.h"
+#include "kel_inflate_backend.h"
+#include "kel_metrics.h"
 
 #include <string>
 #include <memory>
+#include <vector>
 
 
 namespace kellerberrin {   //  organization::project level namespace
@@ -32,6 +38,11 @@ namespace kellerberrin {   //  organization::project level namespace
 // The object presents a stream-like readLine() interface to the data consumer.
 // Data ReadLine() records are guaranteed to be read sequentially and will block
 // until the next logical sequential line record is available (except on eof).
+// If the file has a tabix (.tbi) or CSI (.csi) index then the stream can be opened with a vector of regions.
+// Only the compressed blocks covering the regions (and the file header) are then read and decompressed,
+// and only header lines and records overlapping the regions are returned by readLine().
+// The stream registers a MetricSet (type "bgz_stream") with the MetricsRegistry, the block and byte counts and the
+// block read and inflate latencies are exported. The decompression pipeline and line queue export their own metrics.
 //
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -83,6 +94,9 @@ class BGZStreamIO : public BaseStreamIO {
     };
     size_t block_id_{0};
     size_t data_size_{0};
+    // The window of decompressed data to be used, only restricted when reading indexed regions.
+    size_t data_begin_{0};
+    size_t data_end_{MAX_UNCOMPRESSED_SIZE_};
     bool io_success_{false};
 
   };
@@ -92,9 +106,11 @@ class BGZStreamIO : public BaseStreamIO {
   struct DecompressedBlock {
 
     BGZDecompressedData decompressed_data_;
-    std::vector<std::unique_ptr<std::string>> parsed_lines_;
     size_t block_id_{0};
     size_t data_size_{0};
+    // The window of decompressed data to be queued as lines.
+    size_t data_begin_{0};
+    size_t data_end_{0};
     bool decompress_success_{false};
 
   };
@@ -102,7 +118,8 @@ class BGZStreamIO : public BaseStreamIO {
   // Convenience typedefs.
   using CompressedType = std::unique_ptr<CompressedBlock>;
   using DecompressedType = std::unique_ptr<DecompressedBlock>;
-  using DecompressionPipeline = WorkflowPipeline<CompressedType, DecompressedType>;
+  // Decompressed blocks are returned in file order by the reorder buffer of the ordered pipeline.
+  using DecompressionPipeline = WorkflowOrdered<CompressedType, DecompressedType>;
 
 public:
 
@@ -111,12 +128,21 @@ public:
 
   [[nodiscard]] static std::optional<std::unique_ptr<BaseStreamIO>> getStreamIO( const std::string& file_name
                                                                                , size_t decompression_threads = BGZ_DEFAULT_THREADS);
+  // Returns a stream restricted to the regions using the '.tbi' or '.csi' index of the file.
+  [[nodiscard]] static std::optional<std::unique_ptr<BaseStreamIO>> getStreamIO( const std::string& file_name
+                                                                               , const BGZRegionVector& regions
+                                                                               , size_t decompression_threads = BGZ_DEFAULT_THREADS);
 
   // Guaranteed sequential line reader. Does not block on eof.
-  [[nodiscard]] IOLineRecord readLine() override;
+  [[nodiscard]] IOLineRecord readLine() override { return line_queue_.readLine(); }
+  // Guaranteed sequential line block reader, each block holds the lines of a decompressed block. Does not block on eof.
+  [[nodiscard]] IOLineBlock readBlock() override { return line_queue_.readBlock(); }
 
   // Opens the '.bgz' file and begins decompressing the file, the object is now 'ACTIVE'.
   [[nodiscard]] bool open(const std::string &file_name) override;
+  // Opens the '.bgz' file and only decompresses the blocks indexed as covering the regions.
+  // Returns false if the file has no '.tbi' or '.csi' index.
+  [[nodiscard]] bool open(const std::string &file_name, const BGZRegionVector& regions);
 
   // Close the physical file and reset the internal queues and threads, the object is now 'STOPPED'.
   void close() override;
@@ -128,12 +154,20 @@ public:
   [[nodiscard]] static bool verify(const std::string &file_name, bool silent = true);
 
   [[nodiscard]] bool good() const { return not decompression_error_; }
+  // The inflate backend used to decompress blocks, set before open().
+  [[nodiscard]] InflateBackendType inflateBackend() const { return inflate_backend_; }
+  [[nodiscard]] bool setInflateBackend(InflateBackendType backend_type);
   // Stream state, of the object, active or stopped.
   [[nodiscard]] BGZStreamState streamState() const { return stream_state_; }
 
+  // Limit the active decompression threads, set after open(). Used to rebalance threads between pipeline stages.
+  void setActiveThreads(size_t active_threads) { decompression_pipeline_.setActiveThreads(active_threads); }
+  // The fraction of the decompression pipeline holding blocks waiting to be decompressed.
+  [[nodiscard]] double decompressionOccupancy() const { return decompression_pipeline_.inputOccupancy(); }
+
   // Access the underlying queues for diagnostics.
   [[nodiscard]] const DecompressionPipeline& workFlow() const { return decompression_pipeline_; }
-  [[nodiscard]] const QueueTidal<IOLineRecord>& lineQueue() const { return line_queue_; }
+  [[nodiscard]] const QueueTidal<IOLineBlock>& lineQueue() const { return line_queue_.blockQueue(); }
 
 private:
 
@@ -144,19 +178,32 @@ private:
   std::future<bool> reader_return_;
   WorkflowThreads assemble_records_thread_;
   // The synchronous decompression pipeline.
-  DecompressionPipeline decompression_pipeline_;
-  // Queue of parsed line records.
-  QueueTidal<IOLineRecord> line_queue_{LINE_HIGH_TIDE_, LINE_LOW_TIDE_, LINE_QUEUE_NAME_, LINE_SAMPLE_FREQ_};
+  DecompressionPipeline decompression_pipeline_{PIPELINE_NAME_};
+  // Optional region restriction using the file index.
+  std::optional<BGZIndex> index_;
+  BGZRegionVector regions_;
+  BGZChunkVector region_chunks_;
+  // Queue of line blocks.
+  IOLineBlockQueue line_queue_{LINE_HIGH_TIDE_, LINE_LOW_TIDE_, LINE_QUEUE_NAME_, LINE_SAMPLE_FREQ_};
 
   size_t decompression_threads_;
+  // The library used to decompress blocks, initially the process default.
+  InflateBackendType inflate_backend_{InflateBackend::defaultBackend()};
   // Flag set if problems decompressing a gzip block.
   bool decompression_error_{false};
-  // Flag set if EOF marker received on the line queue.
-  bool line_eof_{false};
   // If set, then shutdown the decompression pipeline gracefully.
   std::atomic<bool> close_stream_{false};
   // Object state.
   std::atomic<BGZStreamState> stream_state_{BGZStreamState::STOPPED};
+  // Runtime metrics exported by the MetricsRegistry.
+  std::shared_ptr<MetricSet> metrics_ptr_{MetricsRegistry::registerSource(METRICS_TYPE_, METRICS_NAME_)};
+  MetricCounter& compressed_blocks_{metrics_ptr_->counter("compressed_blocks_total")};
+  MetricCounter& compressed_bytes_{metrics_ptr_->counter("compressed_bytes_total")};
+  MetricCounter& decompressed_bytes_{metrics_ptr_->counter("decompressed_bytes_total")};
+  MetricCounter& decompress_errors_{metrics_ptr_->counter("decompress_errors_total")};
+  MetricCounter& lines_queued_{metrics_ptr_->counter("lines_total")};
+  MetricHistogram& read_latency_{metrics_ptr_->histogram("block_read_latency_seconds")};
+  MetricHistogram& inflate_latency_{metrics_ptr_->histogram("block_inflate_latency_seconds")};
 
 
   // Queue and workflow parameters.
@@ -166,11 +213,15 @@ private:
   constexpr static const char* PIPELINE_NAME_{"BGZWorkflow Decompress Pipeline"};
   constexpr static const size_t PIPELINE_SAMPLE_FREQ_{100};
 
-  constexpr static const size_t LINE_LOW_TIDE_{10000};
-  constexpr static const size_t LINE_HIGH_TIDE_{20000};
-  constexpr static const char* LINE_QUEUE_NAME_{"BGZWorkflow Line Record Queue"};
+  // Each line block holds the lines of a 64k decompressed block.
+  constexpr static const size_t LINE_LOW_TIDE_{100};
+  constexpr static const size_t LINE_HIGH_TIDE_{200};
+  constexpr static const char* LINE_QUEUE_NAME_{"BGZWorkflow Line Block Queue"};
   constexpr static const size_t LINE_SAMPLE_FREQ_{100};
 
+  constexpr static const char* METRICS_TYPE_{"bgz_stream"};
+  constexpr static const char* METRICS_NAME_{"BGZStreamIO"};
+
 
   // These constants are used to verify the structure of the .bgz file and specified by standard RFC1952.
   // Don't change these constants
@@ -190,17 +241,21 @@ private:
   constexpr static const int32_t HEADER_SIZE_{sizeof(BGZHeaderblock)};
   constexpr static const int32_t TRAILER_SIZE_{sizeof(BGZTrailerBlock)};
   constexpr static const size_t BLOCK_SIZE_ADJUST_{HEADER_SIZE_ + TRAILER_SIZE_ - 1};
-  constexpr static const size_t INFLATE_WINDOW_FLAG_ = 15 + 32;
-  constexpr static const char EOL_MARKER_ = '\n';
 
+  // Start the reader, decompression and assembly threads.
+  [[nodiscard]] bool activateStream(const std::string &file_name);
   // Read and decompress the entire bgz file.
   void readDecompressFile();
+  // Read and decompress the indexed region chunks.
+  void readRegionChunks();
   // Read a bgz block.
   [[nodiscard]] CompressedType readCompressedBlock(size_t block_count);
-  // Decompress a bgz block.
-  [[nodiscard]] static DecompressedType decompressBlock(CompressedType compressed_ptr);
-  // Assemble line records and queue as complete records.
+  // Decompress a bgz block using the selected inflate backend.
+  [[nodiscard]] DecompressedType decompressBlock(CompressedType compressed_ptr);
+  // Assemble line blocks and queue as complete records.
   void assembleRecords();
+  // Stage a block of complete line records for the line queue, records outside any requested regions are discarded.
+  void queueBlock(IOLineBlock&& line_block, std::vector<IOLineBlock>& staged_blocks);
   // Check the trailing EOF_MARKER_
   [[nodiscard]] bool checkEOFMarker(size_t remaining_chars);
 
@@ -0,0 +1,354 @@
+// Copyright 2023 Kellerberrin
+//
+
+#include "kel_bzip_writer.h"
+
+#include "kel_exec_env.h"
+#include "kel_utility.h"
+
+#include <zlib.h>
+
+
+namespace kel = kellerberrin;
+
+
+kel::BGZStreamWriter::BGZStreamWriter(size_t thread_count, int compression_level)
+  : std::ostream(nullptr), compression_threads_(thread_count), compression_level_(compression_level) {
+
+  rdbuf(&block_buffer_);
+  // The stream is not writable until opened.
+  setstate(std::ios_base::badbit);
+
+}
+
+
+std::optional<std::unique_ptr<std::ostream>> kel::BGZStreamWriter::getOutputStream( const std::string& file_name
+                                                                                   , std::ios_base::openmode mode
+                                                                                   , size_t compression_threads) {
+
+  std::string output_file_name = outputFileName(file_name);
+  std::string file_ext = Utility::toupper(Utility::fileExtension(output_file_name));
+
+  if (file_ext == BGZ_FILE_EXTENSTION_ or file_ext == GZ_FILE_EXTENSTION_) {
+
+    auto writer_ptr = std::make_unique<BGZStreamWriter>(compression_threads);
+    if (writer_ptr->open(output_file_name, (mode & std::ios_base::app) != 0)) {
+
+      return writer_ptr;
+
+    }
+
+  } else {
+
+    auto file_ptr = std::make_unique<std::ofstream>(output_file_name, mode);
+    if (file_ptr->good()) {
+
+      return file_ptr;
+
+    }
+
+  }
+
+  ExecEnv::log().error("BGZStreamWriter::getOutputStream; error opening output file: {}", output_file_name);
+  return std::nullopt;
+
+}
+
+
+std::string kel::BGZStreamWriter::outputFileName(const std::string& file_name) {
+
+  std::string file_ext = Utility::toupper(Utility::fileExtension(file_name));
+  if (compress_reports_ and file_ext != BGZ_FILE_EXTENSTION_ and file_ext != GZ_FILE_EXTENSTION_) {
+
+    return file_name + REPORT_FILE_EXTENSION_;
+
+  }
+
+  return file_name;
+
+}
+
+
+bool kel::BGZStreamWriter::open(const std::string &file_name, bool append) {
+
+  if (stream_active_) {
+
+    ExecEnv::log().error("BGZStreamWriter::open; stream is already active; call close().");
+    return false;
+
+  }
+
+  file_name_ = file_name;
+  compression_error_ = false;
+  block_count_ = 0;
+
+  auto open_mode = std::ios::binary | std::ios::out | (append ? std::ios::app : std::ios::trunc);
+  bgz_file_.open(file_name_, open_mode);
+  if (not bgz_file_.good()) {
+
+    ExecEnv::log().error("BGZStreamWriter::open; I/O error; could not open file: {}", file_name_);
+    return false;
+
+  }
+
+  block_buffer_.resetBlock();
+  clear();
+
+  compression_pipeline_.activatePipeline(compression_threads_, &BGZStreamWriter::compressPipeline, this);
+  writer_thread_.queueThreads(1);
+  writer_future_ = writer_thread_.enqueueFuture(&BGZStreamWriter::writeBlocks, this);
+  stream_active_ = true;
+
+  return true;
+
+}
+
+
+void kel::BGZStreamWriter::close() {
+
+  if (not stream_active_) {
+
+    return;
+
+  }
+
+  // Queue the final partial block and then the stop token.
+  block_buffer_.queueBlock();
+  compression_pipeline_.push(nullptr);
+  writer_future_.wait();
+  writer_thread_.joinThreads();
+  compression_pipeline_.clear();
+  writer_future_ = {};
+
+  auto eof_block = compressBlock(std::string(), compression_level_);
+  if (eof_block) {
+
+    bgz_file_.write(eof_block.value().data(), static_cast<std::streamsize>(eof_block.value().size()));
+
+  }
+
+  if (not bgz_file_.good() or compression_error_) {
+
+    ExecEnv::log().error("BGZStreamWriter::close; error writing file: {}, blocks written: {}", file_name_, block_count_);
+
+  }
+
+  bgz_file_.close();
+  stream_active_ = false;
+  setstate(std::ios_base::badbit);
+
+}
+
+
+void kel::BGZStreamWriter::queueBlock(std::string&& block_data) {
+
+  auto block_ptr = std::make_unique<WriteBlock>();
+  block_ptr->block_id_ = block_count_;
+  block_ptr->block_data_ = std::move(block_data);
+  ++block_count_;
+
+  compression_pipeline_.push(std::move(block_ptr));
+
+}
+
+
+kel::BGZStreamWriter::BlockType kel::BGZStreamWriter::compressPipeline(BlockType block_ptr) {
+
+  // Stop token.
+  if (not block_ptr) {
+
+    return nullptr;
+
+  }
+
+  auto compressed_opt = compressBlock(block_ptr->block_data_, compression_level_);
+  if (compressed_opt) {
+
+    block_ptr->block_data_ = std::move(compressed_opt.value());
+
+  } else {
+
+    ExecEnv::log().error("BGZStreamWriter::compressPipeline; file: {}, unable to compress block: {}", file_name_, block_ptr->block_id_);
+    compression_error_ = true;
+    block_ptr->block_data_.clear();
+
+  }
+
+  return block_ptr;
+
+}
+
+
+void kel::BGZStreamWriter::writeBlocks() {
+
+  size_t block_count{0};
+  while (true) {
+
+    BlockType block_ptr = compression_pipeline_.waitAndPop();
+    if (not block_ptr) {
+
+      break;
+
+    }
+
+    if (block_ptr->block_id_ != block_count) {
+
+      ExecEnv::log().error("BGZStreamWriter::writeBlocks; Block mismatch, Queued block: {}, Counted block: {}", block_ptr->block_id_, block_count);
+      compression_error_ = true;
+
+    }
+    ++block_count;
+
+    bgz_file_.write(block_ptr->block_data_.data(), static_cast<std::streamsize>(block_ptr->block_data_.size()));
+
+  }
+
+}
+
+
+// The BGZF block is a gzip member with an extra 'BC' subfield holding the total block size minus 1.
+std::optional<std::string> kel::BGZStreamWriter::compressBlock(const std::string& block_data, int compression_level) {
+
+  if (block_data.size() > BLOCK_DATA_SIZE_) {
+
+    ExecEnv::log().error("BGZStreamWriter::compressBlock; block size: {} exceeds maximum: {}", block_data.size(), BLOCK_DATA_SIZE_);
+    return std::nullopt;
+
+  }
+
+  std::string compressed_block(MAX_BLOCK_SIZE_, '\0');
+  auto compressed_ptr = reinterpret_cast<unsigned char*>(compressed_block.data());
+
+  // If the data does not compress into a single block then it is stored uncompressed.
+  size_t deflate_size{0};
+  bool block_fits{false};
+  for (int level : { compression_level, STORE_COMPRESSION_LEVEL_ }) {
+
+    z_stream deflate_stream{};
+    if (deflateInit2(&deflate_stream, level, Z_DEFLATED, RAW_WINDOW_FLAG_, MEMORY_LEVEL_, Z_DEFAULT_STRATEGY) != Z_OK) {
+
+      ExecEnv::log().error("BGZStreamWriter::compressBlock; zlib deflateInit2 failed");
+      return std::nullopt;
+
+    }
+
+    deflate_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block_data.data()));
+    deflate_stream.avail_in = static_cast<uInt>(block_data.size());
+    deflate_stream.next_out = compressed_ptr + HEADER_SIZE_;
+    deflate_stream.avail_out = static_cast<uInt>(MAX_BLOCK_SIZE_ - HEADER_SIZE_ - TRAILER_SIZE_);
+
+    int result = deflate(&deflate_stream, Z_FINISH);
+    deflate_size = deflate_stream.total_out;
+    deflateEnd(&deflate_stream);
+
+    if (result == Z_STREAM_END) {
+
+      block_fits = true;
+      break;
+
+    }
+
+  }
+
+  if (not block_fits) {
+
+    ExecEnv::log().error("BGZStreamWriter::compressBlock; block data: {} bytes, exceeds BGZF block size", block_data.size());
+    return std::nullopt;
+
+  }
+
+  auto write_16 = [](unsigned char* ptr, uint32_t value) { ptr[0] = value & 0xFF; ptr[1] = (value >> 8) & 0xFF; };
+  auto write_32 = [write_16](unsigned char* ptr, uint32_t value) { write_16(ptr, value & 0xFFFF); write_16(ptr + 2, value >> 16); };
+
+  size_t block_size = HEADER_SIZE_ + deflate_size + TRAILER_SIZE_;
+  // Header; gzip id, deflate, FEXTRA flag, no mtime, no extra flags, unknown OS, 6 bytes of extra data.
+  const unsigned char header[HEADER_SIZE_] = { 31, 139, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0, 0, 0 };
+  std::copy(header, header + HEADER_SIZE_, compressed_ptr);
+  write_16(compressed_ptr + HEADER_SIZE_ - 2, static_cast<uint32_t>(block_size - 1));
+
+  // Trailer; CRC32 and uncompressed size.
+  uLong crc = crc32(0L, Z_NULL, 0);
+  crc = crc32(crc, reinterpret_cast<const Bytef*>(block_data.data()), static_cast<uInt>(block_data.size()));
+  write_32(compressed_ptr + HEADER_SIZE_ + deflate_size, static_cast<uint32_t>(crc));
+  write_32(compressed_ptr + HEADER_SIZE_ + deflate_size + 4, static_cast<uint32_t>(block_data.size()));
+
+  compressed_block.resize(block_size);
+
+  return compressed_block;
+
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// The stream buffer, full blocks are passed to the writer for compression.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+void kel::BGZStreamWriter::BlockBuffer::resetBlock() {
+
+  block_buffer_.resize(BLOCK_DATA_SIZE_);
+  setp(block_buffer_.data(), block_buffer_.data() + BLOCK_DATA_SIZE_);
+
+}
+
+
+void kel::BGZStreamWriter::BlockBuffer::queueBlock() {
+
+  auto data_size = static_cast<size_t>(pptr() - pbase());
+  if (data_size > 0) {
+
+    block_buffer_.resize(data_size);
+    writer_.queueBlock(std::move(block_buffer_));
+    block_buffer_ = std::string();
+
+  }
+
+  resetBlock();
+
+}
+
+
+kel::BGZStreamWriter::BlockBuffer::int_type kel::BGZStreamWriter::BlockBuffer::overflow(int_type character) {
+
+  if (not writer_.stream_active_) {
+
+    return traits_type::eof();
+
+  }
+
+  queueBlock();
+  if (not traits_type::eq_int_type(character, traits_type::eof())) {
+
+    *pptr() = traits_type::to_char_type(character);
+    pbump(1);
+
+  }
+
+  return traits_type::not_eof(character);
+
+}
+
+
+std::streamsize kel::BGZStreamWriter::BlockBuffer::xsputn(const char_type* char_ptr, std::streamsize count) {
+
+  std::streamsize written{0};
+  while (written < count) {
+
+    if (pptr() == epptr() and traits_type::eq_int_type(overflow(traits_type::eof()), traits_type::eof())) {
+
+      break;
+
+    }
+
+    auto copy_size = std::min<std::streamsize>(count - written, epptr() - pptr());
+    std::copy(char_ptr + written, char_ptr + written + copy_size, pptr());
+    pbump(static_cast<int>(copy_size));
+    written += copy_size;
+
+  }
+
+  return written;
+
+}
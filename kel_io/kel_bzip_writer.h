@@ -0,0 +1,161 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_BZIP_WRITER_H
+#define KEL_BZIP_WRITER_H
+
+
+#include "kel_workflow_threads.h"
+#include "kel_workflow_pipeline.h"
+
+#include <string>
+#include <memory>
+#include <fstream>
+#include <ostream>
+#include <streambuf>
+#include <atomic>
+#include <future>
+#include <optional>
+
+
+namespace kellerberrin {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// The output counterpart of BGZStreamIO, writes block gzip (.bgz) files.
+// Text written to the stream is buffered into blocks of BLOCK_DATA_SIZE_ bytes (the same block size as bgzip).
+// Each full block is compressed (using zlib) by a multi-threaded pipeline and a writer thread writes the compressed
+// blocks to file in the order they were written. The file is terminated with the standard empty BGZF EOF block.
+// The resulting file can be read by BGZStreamIO, bgzip, tabix and any gzip decompressor.
+//
+// The object is a std::ostream and can be passed to any function that writes to a std::ostream&.
+// Note that flush() (and std::endl) do not write a partial block, the final partial block is written by close().
+// This prevents line by line flushing from generating a multitude of tiny compressed blocks.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+class BGZStreamWriter : public std::ostream {
+
+  // A block of uncompressed data and the subsequent compressed BGZF block.
+  struct WriteBlock {
+
+    size_t block_id_{0};
+    std::string block_data_;
+
+  };
+
+  using BlockType = std::unique_ptr<WriteBlock>;
+  using CompressionPipeline = WorkflowPipeline<BlockType, BlockType>;
+
+  // Buffers the written text and queues each full block for compression.
+  class BlockBuffer : public std::streambuf {
+
+  public:
+
+    explicit BlockBuffer(BGZStreamWriter& writer) : writer_(writer) {}
+    ~BlockBuffer() override = default;
+
+    // Reset the put area to an empty block.
+    void resetBlock();
+    // Queue the current (possibly partial) block for compression, empty blocks are not queued.
+    void queueBlock();
+
+  protected:
+
+    int_type overflow(int_type character) override;
+    std::streamsize xsputn(const char_type* char_ptr, std::streamsize count) override;
+    // Does not queue a partial block, see above.
+    int sync() override { return 0; }
+
+  private:
+
+    BGZStreamWriter& writer_;
+    std::string block_buffer_;
+
+  };
+
+public:
+
+  explicit BGZStreamWriter(size_t thread_count = BGZ_DEFAULT_THREADS, int compression_level = DEFAULT_COMPRESSION_LEVEL_);
+  BGZStreamWriter(const BGZStreamWriter &) = delete;
+  ~BGZStreamWriter() override { close(); }
+
+  // Returns an output stream based on the file name extension, the stream is returned open and ready for writing.
+  // If '.bgz' or '.gz' then a BGZStreamWriter is returned (a '.gz' block gzip file is also a valid gzip file).
+  // Otherwise the file is assumed to be an uncompressed text file and a std::ofstream is returned.
+  // If compressed reports are enabled (see setCompressReports()), '.bgz' is appended to uncompressed file names.
+  // Note that std::nullopt is returned if there is a problem opening the file.
+  [[nodiscard]] static std::optional<std::unique_ptr<std::ostream>> getOutputStream( const std::string& file_name
+                                                                                   , std::ios_base::openmode mode = std::ios_base::out | std::ios_base::trunc
+                                                                                   , size_t compression_threads = BGZ_DEFAULT_THREADS);
+  // The file name actually opened by getOutputStream().
+  [[nodiscard]] static std::string outputFileName(const std::string& file_name);
+  // Process-wide switch (runtime XML 'compressReports'), analysis report files such as 'report.csv' are written as 'report.csv.bgz'.
+  static void setCompressReports(bool compress_reports) { compress_reports_ = compress_reports; }
+
+  // Open the file for writing, if append is specified the new BGZF blocks are appended to an existing file.
+  // Concatenated BGZF files are valid BGZF files.
+  [[nodiscard]] bool open(const std::string &file_name, bool append = false);
+  // Compress and write any remaining data, write the EOF block and close the file.
+  void close();
+
+  [[nodiscard]] bool isOpen() const { return stream_active_; }
+  [[nodiscard]] bool compressionError() const { return compression_error_; }
+
+  // Compress a block of data as a complete BGZF block, an empty block is the BGZF EOF marker block.
+  [[nodiscard]] static std::optional<std::string> compressBlock(const std::string& block_data, int compression_level);
+
+  // The maximum uncompressed data in a block, the same as bgzip.
+  constexpr static const size_t BLOCK_DATA_SIZE_{0xff00};
+
+private:
+
+  std::string file_name_;
+  std::ofstream bgz_file_;
+  BlockBuffer block_buffer_{*this};
+  size_t compression_threads_;
+  int compression_level_;
+  size_t block_count_{0};
+  WorkflowThreads writer_thread_;
+  std::future<void> writer_future_;
+  CompressionPipeline compression_pipeline_{PIPELINE_HIGH_TIDE_, PIPELINE_LOW_TIDE_, PIPELINE_NAME_};
+  std::atomic<bool> compression_error_{false};
+  std::atomic<bool> stream_active_{false};
+
+  // Number of threads used in the compression pipeline.
+  constexpr static const size_t BGZ_DEFAULT_THREADS{15};
+  constexpr static const int DEFAULT_COMPRESSION_LEVEL_{-1};  // Z_DEFAULT_COMPRESSION in zlib.h
+  constexpr static const size_t PIPELINE_HIGH_TIDE_{200};
+  constexpr static const size_t PIPELINE_LOW_TIDE_{100};
+  constexpr static const char* PIPELINE_NAME_{"BGZStreamWriter Compress Pipeline"};
+
+  // The BGZF header and trailer.
+  constexpr static const size_t MAX_BLOCK_SIZE_{65536};
+  constexpr static const size_t HEADER_SIZE_{18};
+  constexpr static const size_t TRAILER_SIZE_{8};
+  constexpr static const int RAW_WINDOW_FLAG_{-15};         // zlib raw deflate encoding.
+  constexpr static const int MEMORY_LEVEL_{8};
+  constexpr static const int STORE_COMPRESSION_LEVEL_{0};    // Used if the data is incompressible.
+  constexpr static const char* GZ_FILE_EXTENSTION_ = ".GZ";
+  constexpr static const char* BGZ_FILE_EXTENSTION_ = ".BGZ";
+  constexpr static const char* REPORT_FILE_EXTENSION_ = ".bgz";
+
+  inline static std::atomic<bool> compress_reports_{false};
+
+  // Called by the block buffer.
+  void queueBlock(std::string&& block_data);
+  // Pipeline function, compress the block.
+  [[nodiscard]] BlockType compressPipeline(BlockType block_ptr);
+  // Write the compressed blocks in order.
+  void writeBlocks();
+
+};
+
+
+
+} // Namespace.
+
+
+#endif //KEL_BZIP_WRITER_H
@@ -9,6 +9,12 @@
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/filter/bzip2.hpp>
 
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 
 namespace bio = boost::iostreams;
 
@@ -21,7 +27,7 @@ namespace kellerberrin {
 
 IOLineRecord TextStreamIO::readLine() {
 
-  std::string line_text;
+  std::string line_text = IOLineRecord::linePool().acquire();
   if (not std::getline(file_, line_text).eof()) {
 
   ++record_counter_;
@@ -79,6 +85,155 @@ std::optional<std::unique_ptr<BaseStreamIO>> TextStreamIO::getStreamIO( const st
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Memory mapped plain text IO.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+bool MMapStreamIO::open(const std::string &file_name) {
+
+  close();
+
+  file_descriptor_ = ::open(file_name.c_str(), O_RDONLY);
+  if (file_descriptor_ == INVALID_DESCRIPTOR_) {
+
+    ExecEnv::log().warn("MMapStreamIO; I/O error; could not open file: {}, error: {}", file_name, std::strerror(errno));
+    return false;
+
+  }
+
+  struct stat file_stat{};
+  if (::fstat(file_descriptor_, &file_stat) != 0 or not S_ISREG(file_stat.st_mode)) {
+
+    // Pipes, devices etc. cannot be mapped.
+    ExecEnv::log().warn("MMapStreamIO; file: {} is not a regular file and cannot be mapped", file_name);
+    close();
+    return false;
+
+  }
+
+  map_size_ = static_cast<size_t>(file_stat.st_size);
+  if (map_size_ == 0) {
+
+    // Empty files are valid, readLine() immediately returns EOF.
+    return true;
+
+  }
+
+  void* map_ptr = ::mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, file_descriptor_, 0);
+  if (map_ptr == MAP_FAILED) {
+
+    ExecEnv::log().warn("MMapStreamIO; could not map file: {}, size: {}, error: {}", file_name, map_size_, std::strerror(errno));
+    close();
+    return false;
+
+  }
+
+  map_ptr_ = static_cast<const char*>(map_ptr);
+  // The file is read once from beginning to end.
+  if (::madvise(map_ptr, map_size_, MADV_SEQUENTIAL) != 0) {
+
+    ExecEnv::log().warn("MMapStreamIO; madvise(MADV_SEQUENTIAL) failed for file: {}, error: {}", file_name, std::strerror(errno));
+
+  }
+
+  return true;
+
+}
+
+
+void MMapStreamIO::close() {
+
+  if (map_ptr_ != nullptr) {
+
+    ::munmap(const_cast<char*>(map_ptr_), map_size_);
+
+  }
+
+  if (file_descriptor_ != INVALID_DESCRIPTOR_) {
+
+    ::close(file_descriptor_);
+
+  }
+
+  file_descriptor_ = INVALID_DESCRIPTOR_;
+  map_ptr_ = nullptr;
+  map_size_ = 0;
+  map_offset_ = 0;
+  record_counter_ = 0;
+
+}
+
+
+IOLineRecord MMapStreamIO::readLine() {
+
+  if (map_offset_ >= map_size_) {
+
+    return IOLineRecord::createEOFMarker();
+
+  }
+
+  const char* line_begin = map_ptr_ + map_offset_;
+  size_t remaining = map_size_ - map_offset_;
+  auto line_end = static_cast<const char*>(std::memchr(line_begin, EOL_MARKER_, remaining));
+
+  // The final line may not be '\n' terminated.
+  size_t line_size = line_end != nullptr ? static_cast<size_t>(line_end - line_begin) : remaining;
+  map_offset_ += line_size + 1;
+
+  ++record_counter_;
+  return IOLineRecord(record_counter_, std::string_view(line_begin, line_size));
+
+}
+
+
+IOLineBlock MMapStreamIO::readBlock() {
+
+  if (map_offset_ >= map_size_) {
+
+    return IOLineBlock::createEOFMarker();
+
+  }
+
+  const char* block_begin = map_ptr_ + map_offset_;
+  size_t remaining = map_size_ - map_offset_;
+  size_t block_size = remaining;
+  if (remaining > LINE_BLOCK_SIZE_) {
+
+    // The block ends with the line containing the block size byte. The final line may not be '\n' terminated.
+    size_t line_search = LINE_BLOCK_SIZE_ - 1;
+    auto line_end = static_cast<const char*>(std::memchr(block_begin + line_search, EOL_MARKER_, remaining - line_search));
+    if (line_end != nullptr) {
+
+      block_size = static_cast<size_t>(line_end - block_begin) + 1;
+
+    }
+
+  }
+
+  IOLineBlock line_block(record_counter_ + 1, std::string_view(block_begin, block_size));
+  map_offset_ += block_size;
+  record_counter_ += line_block.size();
+
+  return line_block;
+
+}
+
+
+std::optional<std::unique_ptr<BaseStreamIO>> MMapStreamIO::getStreamIO( const std::string& file_name) {
+
+  auto stream_ptr = std::make_unique<MMapStreamIO>();
+  if (stream_ptr->open(file_name)) {
+
+    return stream_ptr;
+
+  }
+
+  return std::nullopt;
+
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Implementation of gzip '.gz' decompression uses uses boost::iostreams::filtering_istream.
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -112,7 +267,7 @@ private:
 
 IOLineRecord GZStreamIOImpl::readLine() {
 
-  std::string line_text;
+  std::string line_text = IOLineRecord::linePool().acquire();
   if (not std::getline(gz_file_, line_text).eof()) {
 
     ++record_counter_;
@@ -211,8 +366,17 @@ private:
 
 IOLineRecord BZ2StreamIOImpl::readLine() {
 
-  std::string line_text;
-  if (not std::getline(bz2_file_, line_text).eof()) {
+  std::string line_text = IOLineRecord::linePool().acquire();
+  std::getline(bz2_file_, line_text);
+  // A decompression error sets the bad bit (not eof).
+  if (bz2_file_.bad()) {
+
+    ExecEnv::log().error("BZ2StreamIO; decompression error after line: {}", record_counter_);
+    return IOLineRecord::createEOFMarker();
+
+  }
+
+  if (not bz2_file_.eof()) {
 
     ++record_counter_;
     return IOLineRecord(record_counter_, std::move(line_text));
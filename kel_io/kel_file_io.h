@@ -41,6 +41,47 @@ private:
 };
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Memory mapped plain text IO.
+// The file is mapped read-only and lines are returned as zero-copy std::string_view records (IOLineRecord::mapped()).
+// Line blocks are also zero-copy views of consecutive lines in the mapping (IOLineBlock::mapped()).
+// The kernel is advised that the mapping is read sequentially (aggressive read-ahead and early page release).
+// Line records and blocks are only valid until the stream is closed, consumers that retain data must copy it.
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class MMapStreamIO : public BaseStreamIO {
+
+public:
+
+  MMapStreamIO() = default;
+  MMapStreamIO(const MMapStreamIO &) = delete;
+  ~MMapStreamIO() override { close(); };
+
+  [[nodiscard]] bool open(const std::string &file_name) override;
+  [[nodiscard]] IOLineRecord readLine() override;
+  // Returns the complete lines following approximately LINE_BLOCK_SIZE_ bytes of the mapping.
+  [[nodiscard]] IOLineBlock readBlock() override;
+  void close() override;
+
+  [[nodiscard]] static std::optional<std::unique_ptr<BaseStreamIO>> getStreamIO( const std::string& file_name);
+
+  // The entire mapped file, valid until close().
+  [[nodiscard]] std::string_view mappedView() const { return { map_ptr_, map_size_ }; }
+
+private:
+
+  int file_descriptor_{INVALID_DESCRIPTOR_};
+  const char* map_ptr_{nullptr};
+  size_t map_size_{0};
+  size_t map_offset_{0};
+  size_t record_counter_{0};
+
+  constexpr static const int INVALID_DESCRIPTOR_{-1};
+  constexpr static const char EOL_MARKER_{'\n'};
+
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Implementation of gzip '.gz' decompression uses Pimpl idiom.
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,718 @@
+// Copyright 2023 Kellerberrin
+//
+
+#include "kel_gzip_workflow.h"
+
+#include "kel_exec_env.h"
+#include "kel_utility.h"
+
+#include <cstring>
+#include <tuple>
+#include <bit>
+#include <type_traits>
+#include <filesystem>
+#include <format>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+
+namespace kel = kellerberrin;
+
+
+namespace {
+
+// The checkpoint index is written little endian on all platforms.
+template<typename T> requires std::is_integral_v<T>
+T littleEndian(T value) {
+
+  if constexpr (std::endian::native == std::endian::big and sizeof(T) > 1) {
+
+    return std::byteswap(value);
+
+  } else {
+
+    return value;
+
+  }
+
+}
+
+} // namespace
+
+
+std::optional<std::unique_ptr<kel::BaseStreamIO>> kel::GZParallelStreamIO::getStreamIO( const std::string& file_name
+                                                                                      , size_t decompression_threads) {
+
+  auto stream_ptr = std::make_unique<GZParallelStreamIO>(decompression_threads);
+  if (stream_ptr->open(file_name)) {
+
+    return stream_ptr;
+
+  }
+
+  ExecEnv::log().error("GZParallelStreamIO::getStreamIO; error opening file: {}", file_name);
+  return std::nullopt;
+
+}
+
+
+bool kel::GZParallelStreamIO::open(const std::string &file_name) {
+
+  if (stream_active_) {
+
+    ExecEnv::log().error("GZParallelStreamIO::open; stream is already active; call close().");
+    return false;
+
+  }
+
+  file_name_ = file_name;
+  close_stream_ = false;
+  decompression_error_ = false;
+
+  file_descriptor_ = ::open(file_name_.c_str(), O_RDONLY);
+  if (file_descriptor_ == INVALID_DESCRIPTOR_) {
+
+    ExecEnv::log().error("GZParallelStreamIO::open; I/O error; could not open file: {}, error: {}", file_name_, std::strerror(errno));
+    return false;
+
+  }
+
+  // Use the checkpoint index if it exists and is current.
+  parallel_mode_ = readIndex();
+  if (parallel_mode_) {
+
+    ExecEnv::log().info("GZParallelStreamIO::open; file: {}, decompressing {} checkpoint spans with {} threads",
+                        file_name_, index_.checkpoints_.size(), decompression_threads_);
+
+  } else {
+
+    ExecEnv::log().info("GZParallelStreamIO::open; file: {}, no checkpoint index, sequential decompression creates index: {}",
+                        file_name_, indexFileName(file_name_));
+
+  }
+
+  decompression_pipeline_.activatePipeline(decompression_threads_, &GZParallelStreamIO::decompressSpan, this);
+  reader_thread_.queueThreads(1);
+  if (parallel_mode_) {
+
+    reader_thread_.enqueueVoid(&GZParallelStreamIO::readParallel, this);
+
+  } else {
+
+    reader_thread_.enqueueVoid(&GZParallelStreamIO::readSequential, this);
+
+  }
+  assemble_records_thread_.queueThreads(1);
+  assemble_future_ = assemble_records_thread_.enqueueFuture(&GZParallelStreamIO::assembleRecords, this);
+  stream_active_ = true;
+
+  return true;
+
+}
+
+
+void kel::GZParallelStreamIO::close() {
+
+  close_stream_ = true;
+  // The assembler may be blocked on a full line queue, it then discards the remaining pipeline spans.
+  while (assemble_future_.valid() and assemble_future_.wait_for(CLOSE_WAIT_) != std::future_status::ready) {
+
+    line_queue_.drain();
+
+  }
+  reader_thread_.joinThreads();
+  assemble_records_thread_.joinThreads();
+  decompression_pipeline_.clear();
+  line_queue_.clear();
+  assemble_future_ = {};
+
+  if (file_descriptor_ != INVALID_DESCRIPTOR_) {
+
+    ::close(file_descriptor_);
+    file_descriptor_ = INVALID_DESCRIPTOR_;
+
+  }
+
+  index_ = {};
+  stream_active_ = false;
+
+}
+
+
+std::optional<std::pair<uint64_t, int64_t>> kel::GZParallelStreamIO::fileStatus() const {
+
+  struct stat file_stat{};
+  if (::fstat(file_descriptor_, &file_stat) != 0) {
+
+    return std::nullopt;
+
+  }
+
+  return std::pair<uint64_t, int64_t>{ static_cast<uint64_t>(file_stat.st_size), static_cast<int64_t>(file_stat.st_mtime) };
+
+}
+
+
+void kel::GZParallelStreamIO::readSequential() {
+
+  // The index is rebuilt as the file is decompressed.
+  auto status_opt = fileStatus();
+  index_ = {};
+  if (status_opt) {
+
+    std::tie(index_.file_size_, index_.file_mtime_) = status_opt.value();
+
+  }
+
+  z_stream zlib_params{};
+  if (::inflateInit2(&zlib_params, GZIP_WINDOW_FLAG_) != Z_OK) {
+
+    ExecEnv::log().error("GZParallelStreamIO::readSequential; ::inflateInit2() fail, file: {}", file_name_);
+    decompression_error_ = true;
+    decompression_pipeline_.push(nullptr);
+    return;
+
+  }
+
+  std::vector<unsigned char> input_buffer(INPUT_BUFFER_SIZE_);
+  // Circular buffer holding the most recent WINDOW_SIZE_ bytes of output.
+  DictionaryWindow output_window{};
+  uint64_t file_offset{0};
+  uint64_t total_input{0};
+  uint64_t total_output{0};
+  uint64_t previous_checkpoint{0};
+  bool member_end{false};
+  bool stream_error{false};
+
+  index_.checkpoints_.push_back(Checkpoint{0, 0, 0, true, nullptr});
+  auto span_ptr = std::make_unique<SpanBlock>();
+  span_ptr->decompressed_ = true;
+
+  zlib_params.avail_out = 0;
+  while (not close_stream_) {
+
+    if (zlib_params.avail_in == 0) {
+
+      ssize_t read_size = ::pread(file_descriptor_, input_buffer.data(), INPUT_BUFFER_SIZE_, static_cast<off_t>(file_offset));
+      if (read_size < 0) {
+
+        ExecEnv::log().error("GZParallelStreamIO::readSequential; I/O error reading file: {}", file_name_);
+        stream_error = true;
+        break;
+
+      }
+
+      if (read_size == 0) {
+
+        if (not member_end) {
+
+          ExecEnv::log().error("GZParallelStreamIO::readSequential; unexpected end of gzip file: {}", file_name_);
+          stream_error = true;
+
+        }
+        break;
+
+      }
+
+      file_offset += read_size;
+      zlib_params.next_in = input_buffer.data();
+      zlib_params.avail_in = static_cast<uInt>(read_size);
+
+    }
+
+    // Another gzip member follows the end of the previous member.
+    if (member_end) {
+
+      if (zlib_params.next_in[0] != GZIP_ID1_) {
+
+        ExecEnv::log().warn("GZParallelStreamIO::readSequential; ignoring trailing data after gzip stream, file: {}", file_name_);
+        break;
+
+      }
+
+      ::inflateReset(&zlib_params);
+      member_end = false;
+      // Begin a new span at the member header.
+      span_ptr->span_id_ = index_.checkpoints_.size() - 1;
+      decompression_pipeline_.push(std::move(span_ptr));
+      span_ptr = std::make_unique<SpanBlock>();
+      span_ptr->decompressed_ = true;
+      index_.checkpoints_.push_back(Checkpoint{total_input, total_output, 0, true, nullptr});
+      previous_checkpoint = total_output;
+
+    }
+
+    if (zlib_params.avail_out == 0) {
+
+      zlib_params.avail_out = WINDOW_SIZE_;
+      zlib_params.next_out = output_window.data();
+
+    }
+
+    uInt available_input = zlib_params.avail_in;
+    uInt available_output = zlib_params.avail_out;
+    // Return at each deflate block boundary.
+    int return_code = ::inflate(&zlib_params, Z_BLOCK);
+    uInt output_size = available_output - zlib_params.avail_out;
+    span_ptr->span_data_.append(reinterpret_cast<const char*>(output_window.data() + (WINDOW_SIZE_ - available_output)), output_size);
+    total_input += available_input - zlib_params.avail_in;
+    total_output += output_size;
+
+    if (return_code == Z_NEED_DICT or return_code == Z_DATA_ERROR or return_code == Z_MEM_ERROR or return_code == Z_STREAM_ERROR) {
+
+      std::string zlib_msg = zlib_params.msg != nullptr ? zlib_params.msg : "no msg";
+      ExecEnv::log().error("GZParallelStreamIO::readSequential; ::inflate() fail, return code: {}, msg: {}, file: {}", return_code, zlib_msg, file_name_);
+      stream_error = true;
+      break;
+
+    }
+
+    if (return_code == Z_STREAM_END) {
+
+      member_end = true;
+      continue;
+
+    }
+
+    // At a deflate block boundary (bit 7) that is not the final block (bit 6), record a checkpoint.
+    if ((zlib_params.data_type & 128) != 0 and (zlib_params.data_type & 64) == 0
+        and (total_output - previous_checkpoint) >= CHECKPOINT_SPAN_) {
+
+      Checkpoint checkpoint{total_input, total_output, static_cast<uint8_t>(zlib_params.data_type & 7), false, std::make_unique<DictionaryWindow>()};
+      // Unroll the circular output buffer, the most recent output is at the end of the window.
+      size_t window_left = zlib_params.avail_out;
+      std::memcpy(checkpoint.window_ptr_->data(), output_window.data() + (WINDOW_SIZE_ - window_left), window_left);
+      std::memcpy(checkpoint.window_ptr_->data() + window_left, output_window.data(), WINDOW_SIZE_ - window_left);
+
+      span_ptr->span_id_ = index_.checkpoints_.size() - 1;
+      decompression_pipeline_.push(std::move(span_ptr));
+      span_ptr = std::make_unique<SpanBlock>();
+      span_ptr->decompressed_ = true;
+      index_.checkpoints_.push_back(std::move(checkpoint));
+      previous_checkpoint = total_output;
+
+    }
+
+  }
+
+  ::inflateEnd(&zlib_params);
+
+  if (not close_stream_ and not stream_error) {
+
+    span_ptr->span_id_ = index_.checkpoints_.size() - 1;
+    decompression_pipeline_.push(std::move(span_ptr));
+    index_.total_output_ = total_output;
+    // Save the index so that subsequent reads are decompressed in parallel.
+    // A missing index is not an error, the file is decompressed sequentially again on the next read.
+    if (index_.checkpoints_.size() > 1 and not writeIndex()) {
+
+      ExecEnv::log().warn("GZParallelStreamIO::readSequential; continuing without checkpoint index: {}", indexFileName(file_name_));
+
+    }
+
+  }
+
+  decompression_error_ = stream_error;
+  // Push the workflow stop token.
+  decompression_pipeline_.push(nullptr);
+
+}
+
+
+void kel::GZParallelStreamIO::readParallel() {
+
+  for (size_t span_id = 0; span_id < index_.checkpoints_.size(); ++span_id) {
+
+    if (close_stream_) break;
+
+    auto span_ptr = std::make_unique<SpanBlock>();
+    span_ptr->span_id_ = span_id;
+    decompression_pipeline_.push(std::move(span_ptr));
+
+  }
+
+  // Push the workflow stop token.
+  decompression_pipeline_.push(nullptr);
+
+}
+
+
+kel::GZParallelStreamIO::SpanType kel::GZParallelStreamIO::decompressSpan(SpanType span_ptr) {
+
+  // Check if a stop token.
+  if (not span_ptr) {
+
+    return nullptr;
+
+  }
+
+  if (not span_ptr->decompressed_ and not inflateSpan(*span_ptr)) {
+
+    span_ptr->decompress_success_ = false;
+    return span_ptr;
+
+  }
+
+  span_ptr->decompress_success_ = true;
+
+  return span_ptr;
+
+}
+
+
+// Decompress the span between two checkpoints, the checkpoint index is read only and shared by all threads.
+bool kel::GZParallelStreamIO::inflateSpan(SpanBlock& span_block) const {
+
+  const Checkpoint& checkpoint = index_.checkpoints_[span_block.span_id_];
+  uint64_t span_end = span_block.span_id_ + 1 < index_.checkpoints_.size()
+                      ? index_.checkpoints_[span_block.span_id_ + 1].output_offset_ : index_.total_output_;
+  span_block.span_data_.resize(span_end - checkpoint.output_offset_);
+
+  z_stream zlib_params{};
+  bool raw_mode = not checkpoint.member_start_;
+  if (::inflateInit2(&zlib_params, raw_mode ? RAW_WINDOW_FLAG_ : GZIP_WINDOW_FLAG_) != Z_OK) {
+
+    ExecEnv::log().error("GZParallelStreamIO::inflateSpan; ::inflateInit2() fail, span: {}", span_block.span_id_);
+    return false;
+
+  }
+
+  std::vector<unsigned char> input_buffer(INPUT_BUFFER_SIZE_);
+  uint64_t file_offset = checkpoint.input_offset_;
+  if (raw_mode) {
+
+    // Restore the partial byte preceding the checkpoint and the dictionary window.
+    if (checkpoint.bits_ != 0) {
+
+      unsigned char partial_byte{0};
+      if (::pread(file_descriptor_, &partial_byte, 1, static_cast<off_t>(file_offset - 1)) != 1) {
+
+        ::inflateEnd(&zlib_params);
+        return false;
+
+      }
+      ::inflatePrime(&zlib_params, checkpoint.bits_, partial_byte >> (8 - checkpoint.bits_));
+
+    }
+    ::inflateSetDictionary(&zlib_params, checkpoint.window_ptr_->data(), WINDOW_SIZE_);
+
+  }
+
+  zlib_params.next_out = reinterpret_cast<unsigned char*>(span_block.span_data_.data());
+  zlib_params.avail_out = static_cast<uInt>(span_block.span_data_.size());
+  size_t skip_input{0};
+  bool inflate_success{true};
+
+  while (zlib_params.avail_out > 0) {
+
+    if (zlib_params.avail_in == 0) {
+
+      ssize_t read_size = ::pread(file_descriptor_, input_buffer.data(), INPUT_BUFFER_SIZE_, static_cast<off_t>(file_offset));
+      if (read_size <= 0) {
+
+        ExecEnv::log().error("GZParallelStreamIO::inflateSpan; unexpected end of file, span: {}", span_block.span_id_);
+        inflate_success = false;
+        break;
+
+      }
+      file_offset += read_size;
+      zlib_params.next_in = input_buffer.data();
+      zlib_params.avail_in = static_cast<uInt>(read_size);
+
+    }
+
+    // Skip the gzip trailer of a member decoded in raw mode.
+    if (skip_input > 0) {
+
+      uInt skip_size = std::min<uInt>(skip_input, zlib_params.avail_in);
+      zlib_params.next_in += skip_size;
+      zlib_params.avail_in -= skip_size;
+      skip_input -= skip_size;
+      if (skip_input > 0) continue;
+      ::inflateReset2(&zlib_params, GZIP_WINDOW_FLAG_);
+      raw_mode = false;
+      if (zlib_params.avail_in == 0) continue;
+
+    }
+
+    int return_code = ::inflate(&zlib_params, Z_NO_FLUSH);
+    if (return_code == Z_STREAM_END) {
+
+      if (zlib_params.avail_out == 0) break;
+      // The span continues into the next gzip member.
+      if (raw_mode) {
+
+        skip_input = GZIP_TRAILER_SIZE_;
+
+      } else {
+
+        ::inflateReset(&zlib_params);
+
+      }
+
+    } else if (return_code != Z_OK and return_code != Z_BUF_ERROR) {
+
+      std::string zlib_msg = zlib_params.msg != nullptr ? zlib_params.msg : "no msg";
+      ExecEnv::log().error("GZParallelStreamIO::inflateSpan; ::inflate() fail, return code: {}, msg: {}, span: {}",
+                           return_code, zlib_msg, span_block.span_id_);
+      inflate_success = false;
+      break;
+
+    }
+
+  }
+
+  ::inflateEnd(&zlib_params);
+  return inflate_success;
+
+}
+
+
+void kel::GZParallelStreamIO::assembleRecords() {
+
+  size_t span_count{0};
+  // Joins lines split across spans.
+  IOLineBlockAssembler block_assembler;
+
+  while(true) {
+
+    SpanType span_ptr = decompression_pipeline_.waitAndPop();
+    // Check for eof.
+    if (not span_ptr) {
+
+      break;
+
+    }
+
+    // Discard the remaining spans if the stream is closing.
+    if (close_stream_) continue;
+
+    if (not span_ptr->decompress_success_) {
+
+      ExecEnv::log().error("GZParallelStreamIO::assembleRecords; decompress error with span: {}", span_ptr->span_id_);
+      decompression_error_ = true;
+      close_stream_ = true;
+      continue;
+
+    }
+
+    if (span_ptr->span_id_ != span_count) {
+
+      ExecEnv::log().warn("GZParallelStreamIO::assembleRecords; span mismatch, queued span: {}, counted span: {}", span_ptr->span_id_, span_count);
+
+    }
+    ++span_count;
+
+    IOLineBlock line_block = block_assembler.assemble(span_ptr->span_data_);
+    if (not line_block.empty()) {
+
+      line_queue_.push(std::move(line_block));
+
+    }
+
+  } // while.
+
+  // Queue the final record if non-empty.
+  IOLineBlock final_block = block_assembler.flush();
+  if (not close_stream_ and not final_block.empty()) {
+
+    line_queue_.push(std::move(final_block));
+
+  }
+
+  // Push the eof marker.
+  line_queue_.pushEOF();
+
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Checkpoint index persistence. The index file is gzip compressed and holds little endian binary values.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string kel::GZParallelStreamIO::indexFileName(const std::string& file_name) {
+
+  if (index_directory_.empty()) {
+
+    return file_name + INDEX_EXTENSION_;
+
+  }
+
+  // Gzip files with the same name in different directories have different index files.
+  std::error_code error_code;
+  std::string absolute_path = std::filesystem::absolute(file_name, error_code).string();
+  if (error_code) {
+
+    absolute_path = file_name;
+
+  }
+  std::string index_name = std::format("{}.{:08x}{}",
+                                       std::filesystem::path(file_name).filename().string(),
+                                       Utility::hash(absolute_path),
+                                       INDEX_EXTENSION_);
+
+  return Utility::filePath(index_name, index_directory_);
+
+}
+
+
+bool kel::GZParallelStreamIO::writeIndex() const {
+
+  std::string index_file_name = indexFileName(file_name_);
+  gzFile index_file = ::gzopen(index_file_name.c_str(), "wb");
+  if (index_file == nullptr) {
+
+    ExecEnv::log().warn("GZParallelStreamIO::writeIndex; cannot create checkpoint index: {}, error: {}", index_file_name, std::strerror(errno));
+    return false;
+
+  }
+
+  bool write_ok{true};
+  auto writeValue = [&](const void* value_ptr, size_t size) {
+
+    if (write_ok and ::gzwrite(index_file, value_ptr, static_cast<unsigned>(size)) != static_cast<int>(size)) {
+
+      write_ok = false;
+
+    }
+
+  };
+
+  auto writeInteger = [&](auto value) {
+
+    value = littleEndian(value);
+    writeValue(&value, sizeof(value));
+
+  };
+
+  uint64_t checkpoint_count = index_.checkpoints_.size();
+  writeValue(INDEX_MAGIC_, INDEX_MAGIC_SIZE_);
+  writeInteger(index_.file_size_);
+  writeInteger(index_.file_mtime_);
+  writeInteger(index_.total_output_);
+  writeInteger(checkpoint_count);
+  for (auto const& checkpoint : index_.checkpoints_) {
+
+    uint8_t member_start = checkpoint.member_start_ ? 1 : 0;
+    writeInteger(checkpoint.input_offset_);
+    writeInteger(checkpoint.output_offset_);
+    writeInteger(checkpoint.bits_);
+    writeInteger(member_start);
+    if (not checkpoint.member_start_) {
+
+      writeValue(checkpoint.window_ptr_->data(), WINDOW_SIZE_);
+
+    }
+
+  }
+
+  write_ok = (::gzclose(index_file) == Z_OK) and write_ok;
+  if (not write_ok) {
+
+    ExecEnv::log().warn("GZParallelStreamIO::writeIndex; error writing checkpoint index: {}", index_file_name);
+    std::remove(index_file_name.c_str());
+    return false;
+
+  }
+
+  ExecEnv::log().info("GZParallelStreamIO::writeIndex; wrote checkpoint index: {}, checkpoints: {}", index_file_name, checkpoint_count);
+  return true;
+
+}
+
+
+bool kel::GZParallelStreamIO::readIndex() {
+
+  index_ = {};
+  std::string index_file_name = indexFileName(file_name_);
+  if (not Utility::fileExists(index_file_name)) {
+
+    return false;
+
+  }
+
+  auto status_opt = fileStatus();
+  if (not status_opt) {
+
+    return false;
+
+  }
+
+  gzFile index_file = ::gzopen(index_file_name.c_str(), "rb");
+  if (index_file == nullptr) {
+
+    return false;
+
+  }
+
+  bool read_ok{true};
+  auto readValue = [&](void* value_ptr, size_t size) {
+
+    if (read_ok and ::gzread(index_file, value_ptr, static_cast<unsigned>(size)) != static_cast<int>(size)) {
+
+      read_ok = false;
+
+    }
+
+  };
+
+  auto readInteger = [&](auto& value) {
+
+    readValue(&value, sizeof(value));
+    value = littleEndian(value);
+
+  };
+
+  std::array<char, INDEX_MAGIC_SIZE_> magic{};
+  uint64_t checkpoint_count{0};
+  readValue(magic.data(), INDEX_MAGIC_SIZE_);
+  readInteger(index_.file_size_);
+  readInteger(index_.file_mtime_);
+  readInteger(index_.total_output_);
+  readInteger(checkpoint_count);
+
+  if (not read_ok
+      or std::string_view(magic.data(), INDEX_MAGIC_SIZE_) != INDEX_MAGIC_
+      or index_.file_size_ != status_opt.value().first
+      or index_.file_mtime_ != status_opt.value().second) {
+
+    ExecEnv::log().info("GZParallelStreamIO::readIndex; checkpoint index: {} is invalid or out of date", index_file_name);
+    ::gzclose(index_file);
+    index_ = {};
+    return false;
+
+  }
+
+  for (uint64_t index = 0; index < checkpoint_count and read_ok; ++index) {
+
+    Checkpoint checkpoint;
+    uint8_t member_start{0};
+    readInteger(checkpoint.input_offset_);
+    readInteger(checkpoint.output_offset_);
+    readInteger(checkpoint.bits_);
+    readInteger(member_start);
+    checkpoint.member_start_ = member_start != 0;
+    if (not checkpoint.member_start_) {
+
+      checkpoint.window_ptr_ = std::make_unique<DictionaryWindow>();
+      readValue(checkpoint.window_ptr_->data(), WINDOW_SIZE_);
+
+    }
+    index_.checkpoints_.push_back(std::move(checkpoint));
+
+  }
+
+  ::gzclose(index_file);
+  if (not read_ok or index_.checkpoints_.empty()) {
+
+    ExecEnv::log().warn("GZParallelStreamIO::readIndex; error reading checkpoint index: {}", index_file_name);
+    index_ = {};
+    return false;
+
+  }
+
+  return true;
+
+}
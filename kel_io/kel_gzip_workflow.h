@@ -0,0 +1,173 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_GZIP_WORKFLOW_H
+#define KEL_GZIP_WORKFLOW_H
+
+
+#include "kel_queue_tidal.h"
+#include "kel_workflow_threads.h"
+#include "kel_workflow_pipeline.h"
+
+#include "kel_basic_io.h"
+#include "kel_line_block_queue.h"
+
+#include <string>
+#include <memory>
+#include <array>
+
+
+namespace kellerberrin {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Multi-threaded decompression of ordinary (non-bgz) gzip files using a checkpoint index.
+// A general gzip (RFC1952) file is a single deflate stream and cannot be decompressed in parallel without
+// knowing where deflate blocks begin and the 32k byte dictionary window preceding each block.
+//
+// The first time a file is read it is decompressed by a single thread which records checkpoints (access points)
+// at deflate block boundaries approximately every CHECKPOINT_SPAN_ bytes of uncompressed data. The checkpoints
+// are saved (gzip compressed) to an index file 'file_name.gzidx' alongside the gzip file, or if an index directory
+// is set, to 'file_name.<path hash>.gzidx' in the index directory. If the index cannot be written (for example a
+// read-only data directory) a warning is logged and the file is decompressed sequentially on the next read.
+// Subsequent reads of the file use the index to decompress the spans between checkpoints in parallel.
+// The index is only used if the size and modification time of the gzip file are unchanged.
+// Concatenated multi-member gzip files are supported.
+//
+// In both cases the lines of each decompressed span are queued as a line block and
+// the object presents the same sequential readLine() interface as the other stream objects.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+class GZParallelStreamIO : public BaseStreamIO {
+
+  constexpr static const size_t WINDOW_SIZE_{32768};    // Maximum deflate back reference distance.
+  using DictionaryWindow = std::array<unsigned char, WINDOW_SIZE_>;
+
+  // An access point into the deflate stream.
+  struct Checkpoint {
+
+    uint64_t input_offset_{0};      // File offset of the first complete byte.
+    uint64_t output_offset_{0};     // Uncompressed offset.
+    uint8_t bits_{0};               // Unused bits in the byte preceding input_offset_.
+    bool member_start_{false};      // A gzip member header begins at input_offset_, no dictionary required.
+    std::unique_ptr<DictionaryWindow> window_ptr_;
+
+  };
+
+  // The checkpoint index.
+  struct CheckpointIndex {
+
+    uint64_t file_size_{0};
+    int64_t file_mtime_{0};
+    uint64_t total_output_{0};
+    std::vector<Checkpoint> checkpoints_;
+
+  };
+
+  // A span of decompressed data between two checkpoints.
+  struct SpanBlock {
+
+    size_t span_id_{0};             // Also the checkpoint index of the span begin.
+    bool decompressed_{false};      // Set if the data was decompressed by the sequential reader.
+    std::string span_data_;
+    bool decompress_success_{false};
+
+  };
+
+  using SpanType = std::unique_ptr<SpanBlock>;
+  using DecompressionPipeline = WorkflowPipeline<SpanType, SpanType>;
+
+public:
+
+  explicit GZParallelStreamIO(size_t thread_count = BGZ_DEFAULT_THREADS) : decompression_threads_(thread_count) {}
+  GZParallelStreamIO(const GZParallelStreamIO &) = delete;
+  ~GZParallelStreamIO() override { close(); }
+
+  [[nodiscard]] static std::optional<std::unique_ptr<BaseStreamIO>> getStreamIO( const std::string& file_name
+                                                                               , size_t decompression_threads = BGZ_DEFAULT_THREADS);
+
+  // Guaranteed sequential line reader. Does not block on eof.
+  [[nodiscard]] IOLineRecord readLine() override { return line_queue_.readLine(); }
+  // Guaranteed sequential line block reader. Does not block on eof.
+  [[nodiscard]] IOLineBlock readBlock() override { return line_queue_.readBlock(); }
+  // Opens the gzip file, if a valid checkpoint index exists the file is decompressed in parallel.
+  [[nodiscard]] bool open(const std::string &file_name) override;
+  // Close the file and reset the internal queues and threads.
+  void close() override;
+
+  // True if the file is decompressed in parallel using an existing checkpoint index.
+  [[nodiscard]] bool parallelMode() const { return parallel_mode_; }
+  [[nodiscard]] bool good() const { return not decompression_error_; }
+  // Access queue stats.
+  [[nodiscard]] const QueueTidal<IOLineBlock>& lineQueue() const { return line_queue_.blockQueue(); }
+
+  // The checkpoint index file name.
+  [[nodiscard]] static std::string indexFileName(const std::string& file_name);
+  // Process-wide, checkpoint index files are written to and read from this directory, alongside the gzip file if empty.
+  // Set before any gzip file is opened, the directory is not synchronized.
+  static void setIndexDirectory(const std::string& index_directory) { index_directory_ = index_directory; }
+
+private:
+
+  std::string file_name_;
+  int file_descriptor_{INVALID_DESCRIPTOR_};
+  CheckpointIndex index_;
+  bool parallel_mode_{false};
+  size_t decompression_threads_;
+  WorkflowThreads reader_thread_;
+  WorkflowThreads assemble_records_thread_;
+  std::future<void> assemble_future_;
+  DecompressionPipeline decompression_pipeline_{PIPELINE_HIGH_TIDE_, PIPELINE_LOW_TIDE_, PIPELINE_NAME_};
+  IOLineBlockQueue line_queue_{LINE_HIGH_TIDE_, LINE_LOW_TIDE_, LINE_QUEUE_NAME_, LINE_SAMPLE_FREQ_};
+  std::atomic<bool> decompression_error_{false};
+  std::atomic<bool> close_stream_{false};
+  std::atomic<bool> stream_active_{false};
+
+  // Uncompressed bytes between checkpoints, also the unit of parallel decompression.
+  constexpr static const uint64_t CHECKPOINT_SPAN_{1 << 22};
+  constexpr static const size_t INPUT_BUFFER_SIZE_{1 << 16};
+  // Each queued span is approximately CHECKPOINT_SPAN_ bytes, so the pipeline is kept short.
+  constexpr static const size_t PIPELINE_HIGH_TIDE_{32};
+  constexpr static const size_t PIPELINE_LOW_TIDE_{16};
+  constexpr static const char* PIPELINE_NAME_{"GZParallelStreamIO Decompress Pipeline"};
+  constexpr static const size_t LINE_HIGH_TIDE_{16};
+  constexpr static const size_t LINE_LOW_TIDE_{8};
+  constexpr static const char* LINE_QUEUE_NAME_{"GZParallelStreamIO Line Block Queue"};
+  constexpr static const size_t LINE_SAMPLE_FREQ_{100};
+  constexpr static const std::chrono::milliseconds CLOSE_WAIT_{10};
+
+  constexpr static const int GZIP_WINDOW_FLAG_{15 + 16};    // zlib gzip decoding.
+  constexpr static const int RAW_WINDOW_FLAG_{-15};         // zlib raw deflate decoding.
+  constexpr static const size_t GZIP_TRAILER_SIZE_{8};
+  constexpr static const unsigned char GZIP_ID1_{31};
+  constexpr static const int INVALID_DESCRIPTOR_{-1};
+  constexpr static const char* INDEX_EXTENSION_{".gzidx"};
+  constexpr static const char* INDEX_MAGIC_{"KGZIDX01"};
+  constexpr static const size_t INDEX_MAGIC_SIZE_{8};
+  inline static std::string index_directory_;
+
+  // Sequentially decompress the file and build the checkpoint index.
+  void readSequential();
+  // Queue the checkpoint spans for parallel decompression.
+  void readParallel();
+  // Pipeline function, decompress the span (if required).
+  [[nodiscard]] SpanType decompressSpan(SpanType span_ptr);
+  [[nodiscard]] bool inflateSpan(SpanBlock& span_block) const;
+  // Assemble line blocks and queue as complete records.
+  void assembleRecords();
+
+  [[nodiscard]] bool readIndex();
+  [[nodiscard]] bool writeIndex() const;
+  [[nodiscard]] std::optional<std::pair<uint64_t, int64_t>> fileStatus() const;
+
+};
+
+
+
+} // Namespace.
+
+
+#endif //KEL_GZIP_WORKFLOW_H
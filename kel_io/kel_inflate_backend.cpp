@@ -0,0 +1,355 @@
+// Copyright 2023 Kellerberrin
+//
+
+#include "kel_inflate_backend.h"
+
+#include "kel_exec_env.h"
+#include "kel_utility.h"
+
+#include <zlib.h>
+
+#ifdef KGL_LIBDEFLATE
+#include <libdeflate.h>
+#endif
+
+#ifdef KGL_ISAL
+#include <isa-l/igzip_lib.h>
+#endif
+
+
+namespace kellerberrin {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// The zlib backend. The z_stream is initialized once and reset for each member.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ZlibInflate : public InflateBackend {
+
+public:
+
+  ZlibInflate() = default;
+  ~ZlibInflate() override { if (initialized_) ::inflateEnd(&zlib_stream_); }
+
+  [[nodiscard]] std::optional<size_t> inflateMember( const void* compressed_data
+                                                   , size_t compressed_size
+                                                   , void* output_buffer
+                                                   , size_t output_size) override;
+
+  [[nodiscard]] InflateBackendType backendType() const override { return InflateBackendType::ZLIB; }
+
+private:
+
+  z_stream zlib_stream_{};
+  bool initialized_{false};
+
+  constexpr static const int INFLATE_WINDOW_FLAG_{15 + 32};  // Detect the gzip header.
+
+};
+
+
+std::optional<size_t> ZlibInflate::inflateMember( const void* compressed_data
+                                                , size_t compressed_size
+                                                , void* output_buffer
+                                                , size_t output_size) {
+
+  int return_code{Z_OK};
+  if (not initialized_) {
+
+    return_code = ::inflateInit2(&zlib_stream_, INFLATE_WINDOW_FLAG_);
+    initialized_ = return_code == Z_OK;
+
+  } else {
+
+    return_code = ::inflateReset(&zlib_stream_);
+
+  }
+
+  if (return_code != Z_OK) {
+
+    ExecEnv::log().error("ZlibInflate::inflateMember; zlib initialization fail, return code: {}", return_code);
+    return std::nullopt;
+
+  }
+
+  zlib_stream_.next_in = static_cast<Bytef*>(const_cast<void*>(compressed_data));
+  zlib_stream_.avail_in = static_cast<uInt>(compressed_size);
+  zlib_stream_.next_out = static_cast<Bytef*>(output_buffer);
+  zlib_stream_.avail_out = static_cast<uInt>(output_size);
+
+  return_code = ::inflate(&zlib_stream_, Z_FINISH);
+  if (return_code != Z_STREAM_END) {
+
+    std::string zlib_msg = zlib_stream_.msg != nullptr ? zlib_stream_.msg : "no msg";
+    ExecEnv::log().error("ZlibInflate::inflateMember; ::inflate() fail, return code: {}, msg: {}, Uncompressed: {}, Consumed: {}",
+                         return_code, zlib_msg, output_size - zlib_stream_.avail_out, compressed_size - zlib_stream_.avail_in);
+    return std::nullopt;
+
+  }
+
+  return output_size - zlib_stream_.avail_out;
+
+}
+
+
+#ifdef KGL_LIBDEFLATE
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// The libdeflate backend, the member is decompressed in a single call.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class LibdeflateInflate : public InflateBackend {
+
+public:
+
+  LibdeflateInflate() : decompressor_(::libdeflate_alloc_decompressor()) {}
+  ~LibdeflateInflate() override { if (decompressor_ != nullptr) ::libdeflate_free_decompressor(decompressor_); }
+
+  [[nodiscard]] std::optional<size_t> inflateMember( const void* compressed_data
+                                                   , size_t compressed_size
+                                                   , void* output_buffer
+                                                   , size_t output_size) override;
+
+  [[nodiscard]] InflateBackendType backendType() const override { return InflateBackendType::LIBDEFLATE; }
+
+private:
+
+  libdeflate_decompressor* decompressor_;
+
+};
+
+
+std::optional<size_t> LibdeflateInflate::inflateMember( const void* compressed_data
+                                                      , size_t compressed_size
+                                                      , void* output_buffer
+                                                      , size_t output_size) {
+
+  if (decompressor_ == nullptr) {
+
+    ExecEnv::log().error("LibdeflateInflate::inflateMember; libdeflate decompressor not allocated");
+    return std::nullopt;
+
+  }
+
+  size_t decompressed_size{0};
+  auto result = ::libdeflate_gzip_decompress(decompressor_, compressed_data, compressed_size, output_buffer, output_size, &decompressed_size);
+  if (result != LIBDEFLATE_SUCCESS) {
+
+    ExecEnv::log().error("LibdeflateInflate::inflateMember; libdeflate_gzip_decompress() fail, return code: {}, Compressed: {}",
+                         static_cast<int>(result), compressed_size);
+    return std::nullopt;
+
+  }
+
+  return decompressed_size;
+
+}
+
+#endif
+
+
+#ifdef KGL_ISAL
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// The ISA-L igzip backend.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class IsalInflate : public InflateBackend {
+
+public:
+
+  IsalInflate() { ::isal_inflate_init(&inflate_state_); }
+  ~IsalInflate() override = default;
+
+  [[nodiscard]] std::optional<size_t> inflateMember( const void* compressed_data
+                                                   , size_t compressed_size
+                                                   , void* output_buffer
+                                                   , size_t output_size) override;
+
+  [[nodiscard]] InflateBackendType backendType() const override { return InflateBackendType::ISAL; }
+
+private:
+
+  inflate_state inflate_state_{};
+
+};
+
+
+std::optional<size_t> IsalInflate::inflateMember( const void* compressed_data
+                                                , size_t compressed_size
+                                                , void* output_buffer
+                                                , size_t output_size) {
+
+  ::isal_inflate_reset(&inflate_state_);
+  inflate_state_.crc_flag = ISAL_GZIP;
+  inflate_state_.next_in = static_cast<uint8_t*>(const_cast<void*>(compressed_data));
+  inflate_state_.avail_in = static_cast<uint32_t>(compressed_size);
+  inflate_state_.next_out = static_cast<uint8_t*>(output_buffer);
+  inflate_state_.avail_out = static_cast<uint32_t>(output_size);
+
+  int return_code = ::isal_inflate(&inflate_state_);
+  if (return_code != ISAL_DECOMP_OK or inflate_state_.block_state != ISAL_BLOCK_FINISH) {
+
+    ExecEnv::log().error("IsalInflate::inflateMember; isal_inflate() fail, return code: {}, Uncompressed: {}, Consumed: {}",
+                         return_code, output_size - inflate_state_.avail_out, compressed_size - inflate_state_.avail_in);
+    return std::nullopt;
+
+  }
+
+  return output_size - inflate_state_.avail_out;
+
+}
+
+#endif
+
+
+} // Namespace.
+
+
+namespace kel = kellerberrin;
+
+
+// The fastest compiled backend.
+std::atomic<kel::InflateBackendType> kel::InflateBackend::default_backend_{
+#if defined(KGL_LIBDEFLATE)
+  InflateBackendType::LIBDEFLATE
+#elif defined(KGL_ISAL)
+  InflateBackendType::ISAL
+#else
+  InflateBackendType::ZLIB
+#endif
+};
+
+
+std::optional<std::unique_ptr<kel::InflateBackend>> kel::InflateBackend::createBackend(InflateBackendType backend_type) {
+
+  switch(backend_type) {
+
+    case InflateBackendType::ZLIB:
+      return std::make_unique<ZlibInflate>();
+
+#ifdef KGL_LIBDEFLATE
+    case InflateBackendType::LIBDEFLATE:
+      return std::make_unique<LibdeflateInflate>();
+#endif
+
+#ifdef KGL_ISAL
+    case InflateBackendType::ISAL:
+      return std::make_unique<IsalInflate>();
+#endif
+
+    default:
+      break;
+
+  }
+
+  ExecEnv::log().error("InflateBackend::createBackend; inflate backend: {} is not available", backendName(backend_type));
+  return std::nullopt;
+
+}
+
+
+bool kel::InflateBackend::available(InflateBackendType backend_type) {
+
+  switch(backend_type) {
+
+    case InflateBackendType::ZLIB:
+      return true;
+
+    case InflateBackendType::LIBDEFLATE:
+#ifdef KGL_LIBDEFLATE
+      return true;
+#else
+      return false;
+#endif
+
+    case InflateBackendType::ISAL:
+#ifdef KGL_ISAL
+      return true;
+#else
+      return false;
+#endif
+
+  }
+
+  return false;
+
+}
+
+
+std::vector<kel::InflateBackendType> kel::InflateBackend::availableBackends() {
+
+  std::vector<InflateBackendType> backends;
+  for (auto backend_type : { InflateBackendType::ZLIB, InflateBackendType::LIBDEFLATE, InflateBackendType::ISAL }) {
+
+    if (available(backend_type)) {
+
+      backends.push_back(backend_type);
+
+    }
+
+  }
+
+  return backends;
+
+}
+
+
+std::string kel::InflateBackend::backendName(InflateBackendType backend_type) {
+
+  switch(backend_type) {
+
+    case InflateBackendType::ZLIB:
+      return "zlib";
+
+    case InflateBackendType::LIBDEFLATE:
+      return "libdeflate";
+
+    case InflateBackendType::ISAL:
+      return "isal";
+
+  }
+
+  return "unknown";
+
+}
+
+
+std::optional<kel::InflateBackendType> kel::InflateBackend::backendType(const std::string& backend_name) {
+
+  std::string upper_name = Utility::toupper(Utility::trimEndWhiteSpace(backend_name));
+  for (auto backend_type : { InflateBackendType::ZLIB, InflateBackendType::LIBDEFLATE, InflateBackendType::ISAL }) {
+
+    if (upper_name == Utility::toupper(backendName(backend_type))) {
+
+      return backend_type;
+
+    }
+
+  }
+
+  return std::nullopt;
+
+}
+
+
+bool kel::InflateBackend::setDefaultBackend(InflateBackendType backend_type) {
+
+  if (not available(backend_type)) {
+
+    ExecEnv::log().warn("InflateBackend::setDefaultBackend; inflate backend: {} is not available, default backend: {} unchanged",
+                        backendName(backend_type), backendName(default_backend_));
+    return false;
+
+  }
+
+  default_backend_ = backend_type;
+  return true;
+
+}
@@ -0,0 +1,82 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_INFLATE_BACKEND_H
+#define KEL_INFLATE_BACKEND_H
+
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <optional>
+#include <atomic>
+
+
+namespace kellerberrin {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Decompresses a single complete gzip member, for example a block gzip (.bgz) block, into a caller supplied buffer.
+// The backend libraries are:
+//
+// ZLIB       - Always available, the reference implementation.
+// LIBDEFLATE - Whole buffer decompression, typically 2-3x faster than zlib on the 64k blocks of a '.bgz' file.
+//              Compiled if the library is found by CMake (-DKGL_LIBDEFLATE).
+// ISAL       - Intel ISA-L igzip, SIMD accelerated inflate on x86-64.
+//              Compiled if the library is found by CMake (-DKGL_ISAL).
+//
+// The backend is chosen at build time by the available libraries and can be changed at run time using
+// setDefaultBackend(). The default is the fastest compiled backend (libdeflate, then ISA-L, then zlib).
+// Backend objects hold decompression state and are not thread safe, each decompression thread creates its own.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+enum class InflateBackendType { ZLIB, LIBDEFLATE, ISAL };
+
+
+class InflateBackend {
+
+public:
+
+  InflateBackend() = default;
+  InflateBackend(const InflateBackend &) = delete;
+  virtual ~InflateBackend() = default;
+
+  // Decompress the gzip member into the output buffer, the size of the decompressed data is returned.
+  // The CRC and uncompressed size of the member are verified, std::nullopt is returned on any error.
+  [[nodiscard]] virtual std::optional<size_t> inflateMember( const void* compressed_data
+                                                           , size_t compressed_size
+                                                           , void* output_buffer
+                                                           , size_t output_size) = 0;
+
+  [[nodiscard]] virtual InflateBackendType backendType() const = 0;
+  [[nodiscard]] std::string backendName() const { return backendName(backendType()); }
+
+  // Returns std::nullopt if the backend is not compiled.
+  [[nodiscard]] static std::optional<std::unique_ptr<InflateBackend>> createBackend(InflateBackendType backend_type);
+
+  [[nodiscard]] static bool available(InflateBackendType backend_type);
+  [[nodiscard]] static std::vector<InflateBackendType> availableBackends();
+  [[nodiscard]] static std::string backendName(InflateBackendType backend_type);
+  // Case insensitive, 'zlib', 'libdeflate' or 'isal'.
+  [[nodiscard]] static std::optional<InflateBackendType> backendType(const std::string& backend_name);
+
+  // The process wide backend used by new block gzip streams.
+  [[nodiscard]] static InflateBackendType defaultBackend() { return default_backend_; }
+  // Returns false (and the default is unchanged) if the backend is not compiled.
+  [[nodiscard]] static bool setDefaultBackend(InflateBackendType backend_type);
+
+private:
+
+  static std::atomic<InflateBackendType> default_backend_;
+
+};
+
+
+
+} // Namespace.
+
+
+#endif //KEL_INFLATE_BACKEND_H
@@ -0,0 +1,159 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_LINE_BLOCK_QUEUE_H
+#define KEL_LINE_BLOCK_QUEUE_H
+
+
+#include "kel_basic_io.h"
+#include "kel_queue_tidal.h"
+
+#include <string>
+#include <vector>
+
+
+namespace kellerberrin {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// A tidal queue of line blocks used by the multi-threaded streams.
+// Producer threads push line blocks, the consumer either reads the blocks directly using readBlock() or
+// reads the lines of each block using readLine(). Note that the consumer functions are not thread safe and
+// are called by a single consumer thread (or must be protected by a mutex).
+// After an EOF block has been read, readLine() and readBlock() do not block and return EOF markers.
+//
+// The consumer dequeues up to POP_BATCH_SIZE_ blocks with each queue lock. A single producer thread can stage
+// blocks with stageBlock(), staged blocks are pushed as a batch when the batch is full or the queue is low, so
+// batches only form when the consumer is busy and a waiting consumer is not delayed.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class IOLineBlockQueue {
+
+public:
+
+  IOLineBlockQueue(size_t high_tide, size_t low_tide, std::string queue_name, size_t sample_frequency)
+  : block_queue_(high_tide, low_tide, std::move(queue_name), sample_frequency) {}
+  ~IOLineBlockQueue() = default;
+
+  // Thread safe.
+  void push(IOLineBlock&& line_block) { block_queue_.push(std::move(line_block)); }
+  void pushEOF() { block_queue_.push(IOLineBlock::createEOFMarker()); }
+  // Thread safe, the blocks are moved and the vector is cleared.
+  void pushBatch(std::vector<IOLineBlock>& line_blocks) {
+
+    if (not line_blocks.empty()) {
+
+      block_queue_.pushBatch(line_blocks);
+      line_blocks.clear();
+
+    }
+
+  }
+
+  // Single producer, the staged blocks are owned by the producer and must be pushed with pushBatch() before pushEOF().
+  void stageBlock(IOLineBlock&& line_block, std::vector<IOLineBlock>& staged_blocks) {
+
+    staged_blocks.push_back(std::move(line_block));
+    if (staged_blocks.size() >= PUSH_BATCH_SIZE_ or block_queue_.size() <= PUSH_BATCH_SIZE_) {
+
+      pushBatch(staged_blocks);
+
+    }
+
+  }
+
+  // Single consumer.
+  [[nodiscard]] IOLineRecord readLine() {
+
+    while (line_index_ >= current_block_.size()) {
+
+      if (eof_) return IOLineRecord::createEOFMarker();
+      current_block_ = nextBlock();
+      line_index_ = 0;
+      eof_ = current_block_.EOFBlock();
+
+    }
+
+    IOLineRecord line_record = current_block_.lineRecord(line_index_);
+    ++line_index_;
+    return line_record;
+
+  }
+
+  // Single consumer.
+  [[nodiscard]] IOLineBlock readBlock() {
+
+    // Return any lines remaining from a partially read block.
+    if (line_index_ < current_block_.size()) {
+
+      IOLineBlock remaining_block(current_block_.lineCount(line_index_));
+      for (; line_index_ < current_block_.size(); ++line_index_) {
+
+        remaining_block.appendLine(current_block_.lineView(line_index_));
+
+      }
+      return remaining_block;
+
+    }
+
+    if (eof_) return IOLineBlock::createEOFMarker();
+    IOLineBlock line_block = nextBlock();
+    eof_ = line_block.EOFBlock();
+    return line_block;
+
+  }
+
+  // Discards all queued blocks and resets the consumer.
+  void clear() {
+
+    block_queue_.clear();
+    block_batch_.clear();
+    batch_index_ = 0;
+    current_block_ = IOLineBlock(0);
+    line_index_ = 0;
+    eof_ = false;
+
+  }
+
+  // Discard queued blocks, used to unblock producers.
+  void drain() { block_queue_.clear(); }
+
+  // Access queue stats.
+  [[nodiscard]] const QueueTidal<IOLineBlock>& blockQueue() const { return block_queue_; }
+
+private:
+
+  QueueTidal<IOLineBlock> block_queue_;
+  // Blocks dequeued as a batch and not yet read.
+  std::vector<IOLineBlock> block_batch_;
+  size_t batch_index_{0};
+  IOLineBlock current_block_{0};
+  size_t line_index_{0};
+  bool eof_{false};
+
+  // The maximum blocks dequeued and staged per queue lock.
+  constexpr static const size_t POP_BATCH_SIZE_{16};
+  constexpr static const size_t PUSH_BATCH_SIZE_{8};
+
+  [[nodiscard]] IOLineBlock nextBlock() {
+
+    if (batch_index_ >= block_batch_.size()) {
+
+      block_batch_ = block_queue_.popBatch(POP_BATCH_SIZE_);
+      batch_index_ = 0;
+
+    }
+
+    return std::move(block_batch_[batch_index_++]);
+
+  }
+
+};
+
+
+} // Namespace.
+
+
+#endif //KEL_LINE_BLOCK_QUEUE_H
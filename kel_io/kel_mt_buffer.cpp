@@ -23,10 +23,11 @@ bool kel::StreamMTBuffer::open(const std::string &file_name) {
 
   }
 
-  EOF_received_ = false;
+  close_buffer_ = false;
+  line_io_queue_.clear();
   stream_ptr_ = std::move(stream_opt.value());
   line_io_thread_.queueThreads(WORKER_THREAD_COUNT);
-  line_io_thread_.enqueueVoid(&StreamMTBuffer::enqueueIOLineRecord, this);
+  enqueue_future_ = line_io_thread_.enqueueFuture(&StreamMTBuffer::enqueueIOLineBlock, this);
 
   return true;
 
@@ -51,7 +52,7 @@ std::optional<std::unique_ptr<kel::BaseStreamIO>> kel::StreamMTBuffer::getStream
   auto stream_ptr = std::make_unique<StreamMTBuffer>();
   stream_ptr->stream_ptr_ = std::move(open_stream_ptr);
   stream_ptr->line_io_thread_.queueThreads(WORKER_THREAD_COUNT);
-  stream_ptr->line_io_thread_.enqueueVoid(&StreamMTBuffer::enqueueIOLineRecord, stream_ptr.get());
+  stream_ptr->enqueue_future_ = stream_ptr->line_io_thread_.enqueueFuture(&StreamMTBuffer::enqueueIOLineBlock, stream_ptr.get());
 
   return stream_ptr;
 
@@ -60,32 +61,40 @@ std::optional<std::unique_ptr<kel::BaseStreamIO>> kel::StreamMTBuffer::getStream
 
 void kel::StreamMTBuffer::close() {
 
-  {
+  // The reader thread may be blocked on a full queue.
+  close_buffer_ = true;
+  while (enqueue_future_.valid() and enqueue_future_.wait_for(CLOSE_WAIT_) != std::future_status::ready) {
 
-    std::lock_guard<std::mutex> lock(mutex_);
-    EOF_received_ = true;
+    line_io_queue_.drain();
 
   }
   line_io_thread_.joinThreads();
+  enqueue_future_ = {};
   stream_ptr_ = nullptr;
   line_io_queue_.clear();
+  // Subsequent reads do not block.
+  line_io_queue_.pushEOF();
 
 }
 
-void kel::StreamMTBuffer::enqueueIOLineRecord() {
+void kel::StreamMTBuffer::enqueueIOLineBlock() {
+
+  // Line blocks staged for a batch push to the line queue.
+  std::vector<IOLineBlock> staged_blocks;
 
-  while(true) {
+  while(not close_buffer_) {
 
-    auto line_record = stream_ptr_->readLine();
+    auto line_block = stream_ptr_->readBlock();
 
-    if (line_record.EOFRecord()) {
+    if (line_block.EOFBlock()) {
 
-      line_io_queue_.push(std::move(line_record));
+      line_io_queue_.pushBatch(staged_blocks);
+      line_io_queue_.push(std::move(line_block));
       break;
 
     }
 
-    line_io_queue_.push(std::move(line_record));
+    line_io_queue_.stageBlock(std::move(line_block), staged_blocks);
 
   }
 
@@ -95,14 +104,14 @@ kel::IOLineRecord kel::StreamMTBuffer::readLine() {
 
   // Don't block on EOF, return additional EOF markers.
   std::lock_guard<std::mutex> lock(mutex_);
-  if (EOF_received_) return IOLineRecord::createEOFMarker();
-  auto line_record = line_io_queue_.waitAndPop();
-  if (line_record.EOFRecord()) {
+  return line_io_queue_.readLine();
 
-    EOF_received_ = true;
+}
 
-  }
-  return line_record;
+kel::IOLineBlock kel::StreamMTBuffer::readBlock() {
 
-}
+  // Don't block on EOF, return additional EOF markers.
+  std::lock_guard<std::mutex> lock(mutex_);
+  return line_io_queue_.readBlock();
 
+}
@@ -7,6 +7,7 @@
 
 #include "kel_basic_io.h"
 #include "kel_queue_tidal.h"
+#include "kel_line_block_queue.h"
 #include "kel_workflow_threads.h"
 
 #include <string>
@@ -23,8 +24,8 @@ namespace kellerberrin {   //  organization::project level namespace
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // A buffered thread safe adapter for StreamIO objects.
-// As soon as the underlying stream is successfully opened, records are read and stored in a tidal queue and can be
-// retrieved using readLine().
+// As soon as the underlying stream is successfully opened, blocks of records are read and stored in a tidal queue and can be
+// retrieved using readLine() or readBlock().
 // This object cannot be copied.
 //
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -50,6 +51,8 @@ public:
   // This function will block on an empty queue and no EOF.
   // After an EOF has been received, then subsequent calls will not block and will return EOF objects.
   [[nodiscard]] IOLineRecord readLine() override;
+  // As above, but returns a block of records.
+  [[nodiscard]] IOLineBlock readBlock() override;
 
   // Static constructor.
   [[nodiscard]] static std::optional<std::unique_ptr<BaseStreamIO>> getStreamIO( const std::string& file_name);
@@ -57,28 +60,31 @@ public:
   [[nodiscard]] static std::optional<std::unique_ptr<BaseStreamIO>> getStreamIO(std::unique_ptr<BaseStreamIO> open_stream_ptr);
 
   // Access queue stats.
-  [[nodiscard]] const QueueTidal<IOLineRecord>& lineQueue() const { return line_io_queue_; }
+  [[nodiscard]] const QueueTidal<IOLineBlock>& lineQueue() const { return line_io_queue_.blockQueue(); }
 
 private:
 
   // The tidal IO queue parameters.
-  static constexpr const size_t IO_HIGH_TIDE_{10000};          // Maximum QueueTidal size
-  static constexpr const size_t IO_LOW_TIDE_{2000};            // Low water mark to begin queueing data records
+  static constexpr const size_t IO_HIGH_TIDE_{200};          // Maximum QueueTidal size (line blocks)
+  static constexpr const size_t IO_LOW_TIDE_{40};            // Low water mark to begin queueing line blocks
   static constexpr const char* IO_QUEUE_NAME_{"StreamMTBuffer Queue"};      // The queue name
   static constexpr const size_t IO_SAMPLE_RATE_{100};            // The queue monitor sampling rate (ms), zero (0) disables the monitor.
-  // Tidal queue holds buffered IOLineRecord objects.
-  QueueTidal<IOLineRecord> line_io_queue_{IO_HIGH_TIDE_, IO_LOW_TIDE_, IO_QUEUE_NAME_, IO_SAMPLE_RATE_};
-  // Thread pool asynchronously queues IOLineRecord objects to the queue.
+  // Tidal queue holds buffered IOLineBlock objects.
+  IOLineBlockQueue line_io_queue_{IO_HIGH_TIDE_, IO_LOW_TIDE_, IO_QUEUE_NAME_, IO_SAMPLE_RATE_};
+  // Thread pool asynchronously queues IOLineBlock objects to the queue.
   static constexpr const size_t WORKER_THREAD_COUNT{1};
   WorkflowThreads line_io_thread_;
   // The StreamIO object.
   std::unique_ptr<BaseStreamIO> stream_ptr_;
-  // Set if an EOF has been received and queued.
-  std::atomic<bool> EOF_received_{false};
+  // Completes when the reader thread terminates.
+  std::future<void> enqueue_future_;
+  // Set to stop the reader thread.
+  std::atomic<bool> close_buffer_{false};
+  static constexpr const std::chrono::milliseconds CLOSE_WAIT_{10};
   // Mutex for readLine()
   std::mutex mutex_;
   // The thread worker function.
-  void enqueueIOLineRecord();
+  void enqueueIOLineBlock();
 
 };
 
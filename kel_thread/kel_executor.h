@@ -0,0 +1,583 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_EXECUTOR_H
+#define KEL_EXECUTOR_H
+
+#include "kel_workflow_stealing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace kellerberrin {  //  organization level namespace
+
+
+// Optional pinning of the executor threads.
+enum class ThreadAffinity { NONE, CORE, NUMA };
+
+struct ExecutorConfig {
+
+  size_t threads{0};    // Zero is the default, available hardware threads minus 1.
+  ThreadAffinity affinity{ThreadAffinity::NONE};
+
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// A process-wide executor. All parallel helpers share a single work stealing thread pool
+// instead of creating and joining a thread pool on each call.
+//
+// The pool is created on first use with the hardware default thread count. configure() is
+// called at application startup (before any parallel work) to set the thread count and to
+// optionally pin each thread to a CPU core (CORE) or to the CPUs of a NUMA node (NUMA).
+//
+// parallelFor() and parallelReduce() divide an index range, or a sized range such as a
+// genome map or contig map, into chunks. The calling thread processes chunks together with
+// the pool threads and returns when all chunks are complete. Since the caller never waits
+// on a chunk that has not started, these functions can be nested (called from a task or a
+// chunk running on the executor) without deadlock. The first exception thrown by a chunk is
+// rethrown to the caller.
+//
+// enqueueFuture() and enqueueVoid() submit independent tasks. A task must not wait on the
+// future of another executor task, nested parallelism should use parallelFor() or the
+// coroutine tasks of kel_task.h.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+class Executor
+{
+
+public:
+
+  Executor() = delete;
+  ~Executor() = delete;
+
+  // Replaces the executor thread pool, only call when no parallel work is active.
+  static void configure(const ExecutorConfig& config) {
+
+    std::lock_guard<std::mutex> lock(executor_mutex_);
+    config_ = config;
+    auto executor_state = std::make_unique<ExecutorState>(config_);
+    pool_ptr_.store(&executor_state->pool_, std::memory_order_release);
+    std::swap(executor_state_, executor_state);
+    // The previous pool is destroyed before returning, its destructor completes any queued tasks and joins the threads.
+    executor_state.reset();
+
+  }
+
+  [[nodiscard]] static WorkStealingThreads& pool() {
+
+    WorkStealingThreads* pool_ptr = pool_ptr_.load(std::memory_order_acquire);
+    if (pool_ptr == nullptr) {
+
+      std::lock_guard<std::mutex> lock(executor_mutex_);
+      if (not executor_state_) {
+
+        executor_state_ = std::make_unique<ExecutorState>(config_);
+        pool_ptr_.store(&executor_state_->pool_, std::memory_order_release);
+
+      }
+      pool_ptr = &executor_state_->pool_;
+
+    }
+
+    return *pool_ptr;
+
+  }
+
+  [[nodiscard]] static size_t threadCount() { return pool().threadCount(); }
+  [[nodiscard]] static ExecutorConfig config() { std::lock_guard<std::mutex> lock(executor_mutex_); return config_; }
+
+  // Submit an independent task, returns a std::future holding the work function return value.
+  template<typename F, typename... Args>
+  requires std::invocable<F, Args...> && move_constructable_variadic<Args...>
+  [[nodiscard]] static auto enqueueFuture(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+
+    return pool().enqueueFuture(std::forward<F>(f), std::forward<Args>(args)...);
+
+  }
+
+  // Submit an independent task with a void return type.
+  template<typename F, typename... Args>
+  requires std::invocable<F, Args...> && move_constructable_variadic<Args...>
+  static void enqueueVoid(F&& f, Args&&... args) {
+
+    pool().enqueueVoid(std::forward<F>(f), std::forward<Args>(args)...);
+
+  }
+
+  // Call f(index) for each index in [begin, end). A zero grain selects the chunk size.
+  template<typename F>
+  requires std::invocable<F&, size_t>
+  static void parallelFor(size_t begin, size_t end, F&& f, size_t grain = 0) {
+
+    if (end <= begin) {
+
+      return;
+
+    }
+
+    const size_t size = end - begin;
+    grain = chunkSize(size, grain);
+    runChunks(chunkCount(size, grain), [begin, end, grain, &f](size_t chunk) {
+
+      const size_t chunk_begin = begin + (chunk * grain);
+      const size_t chunk_end = std::min(end, chunk_begin + grain);
+      for (size_t index = chunk_begin; index < chunk_end; ++index) {
+
+        std::invoke(f, index);
+
+      }
+
+    });
+
+  }
+
+  // Call f(element) for each element of a sized range, for example a genome map or contig map.
+  template<std::ranges::forward_range Range, typename F>
+  requires std::ranges::sized_range<Range> && std::invocable<F&, std::ranges::range_reference_t<Range>>
+  static void parallelFor(Range&& range, F&& f, size_t grain = 0) {
+
+    const size_t size = std::ranges::size(range);
+    if (size == 0) {
+
+      return;
+
+    }
+
+    grain = chunkSize(size, grain);
+    auto chunk_iterators = chunkIterators(range, grain);
+    runChunks(chunk_iterators.size() - 1, [&chunk_iterators, &f](size_t chunk) {
+
+      for (auto iter = chunk_iterators[chunk]; iter != chunk_iterators[chunk + 1]; ++iter) {
+
+        std::invoke(f, *iter);
+
+      }
+
+    });
+
+  }
+
+  // Returns reduce(...reduce(reduce(identity, map(begin)), map(begin + 1))..., map(end - 1)).
+  // Each chunk is reduced from the identity and the chunk results are reduced in index order,
+  // so the result is deterministic for an associative reduce function.
+  template<typename T, typename Map, typename Reduce>
+  requires std::invocable<Map&, size_t> && std::invocable<Reduce&, T, std::invoke_result_t<Map&, size_t>>
+  [[nodiscard]] static T parallelReduce(size_t begin, size_t end, T identity, Map&& map, Reduce&& reduce, size_t grain = 0) {
+
+    if (end <= begin) {
+
+      return identity;
+
+    }
+
+    const size_t size = end - begin;
+    grain = chunkSize(size, grain);
+    std::vector<std::optional<T>> chunk_results(chunkCount(size, grain));
+    runChunks(chunk_results.size(), [begin, end, grain, &identity, &chunk_results, &map, &reduce](size_t chunk) {
+
+      const size_t chunk_begin = begin + (chunk * grain);
+      const size_t chunk_end = std::min(end, chunk_begin + grain);
+      T chunk_result = identity;
+      for (size_t index = chunk_begin; index < chunk_end; ++index) {
+
+        chunk_result = std::invoke(reduce, std::move(chunk_result), std::invoke(map, index));
+
+      }
+      chunk_results[chunk].emplace(std::move(chunk_result));
+
+    });
+
+    return reduceChunks(std::move(identity), chunk_results, reduce);
+
+  }
+
+  // Reduce map(element) over the elements of a sized range in range order.
+  template<std::ranges::forward_range Range, typename T, typename Map, typename Reduce>
+  requires std::ranges::sized_range<Range>
+           && std::invocable<Map&, std::ranges::range_reference_t<Range>>
+           && std::invocable<Reduce&, T, std::invoke_result_t<Map&, std::ranges::range_reference_t<Range>>>
+  [[nodiscard]] static T parallelReduce(Range&& range, T identity, Map&& map, Reduce&& reduce, size_t grain = 0) {
+
+    const size_t size = std::ranges::size(range);
+    if (size == 0) {
+
+      return identity;
+
+    }
+
+    grain = chunkSize(size, grain);
+    auto chunk_iterators = chunkIterators(range, grain);
+    std::vector<std::optional<T>> chunk_results(chunk_iterators.size() - 1);
+    runChunks(chunk_results.size(), [&chunk_iterators, &identity, &chunk_results, &map, &reduce](size_t chunk) {
+
+      T chunk_result = identity;
+      for (auto iter = chunk_iterators[chunk]; iter != chunk_iterators[chunk + 1]; ++iter) {
+
+        chunk_result = std::invoke(reduce, std::move(chunk_result), std::invoke(map, *iter));
+
+      }
+      chunk_results[chunk].emplace(std::move(chunk_result));
+
+    });
+
+    return reduceChunks(std::move(identity), chunk_results, reduce);
+
+  }
+
+private:
+
+  // The pool is held with the configuration so that both are replaced together.
+  struct ExecutorState {
+
+    explicit ExecutorState(const ExecutorConfig& config)
+    : pool_(config.threads > 0 ? config.threads : WorkflowThreads::defaultThreads()) {
+
+      if (config.affinity != ThreadAffinity::NONE) {
+
+        pinThreads(pool_, config.affinity);
+
+      }
+
+    }
+
+    WorkStealingThreads pool_;
+
+  };
+
+  // Shared between the caller and the pool threads processing the chunks of a parallelFor().
+  // Pool tasks that start after all chunks are claimed only access this state.
+  struct ChunkState {
+
+    size_t chunk_count_{0};
+    const std::function<void(size_t)>* chunk_function_{nullptr};
+    std::atomic<size_t> next_chunk_{0};
+    std::atomic<size_t> completed_chunks_{0};
+    std::mutex exception_mutex_;
+    std::exception_ptr exception_ptr_;
+
+  };
+
+  inline static std::mutex executor_mutex_;
+  inline static ExecutorConfig config_;
+  inline static std::unique_ptr<ExecutorState> executor_state_;
+  inline static std::atomic<WorkStealingThreads*> pool_ptr_{nullptr};
+
+  // The default number of chunks per thread, balances load when the work per element varies.
+  constexpr static const size_t CHUNKS_PER_THREAD_{4};
+
+  [[nodiscard]] static size_t chunkSize(size_t size, size_t grain) {
+
+    if (grain > 0) {
+
+      return grain;
+
+    }
+
+    return std::max<size_t>(size / (threadCount() * CHUNKS_PER_THREAD_), 1);
+
+  }
+
+  [[nodiscard]] static size_t chunkCount(size_t size, size_t grain) { return (size + grain - 1) / grain; }
+
+  // The iterators at the beginning of each chunk and the end iterator.
+  template<typename Range>
+  [[nodiscard]] static auto chunkIterators(Range& range, size_t grain) {
+
+    using Iterator = std::ranges::iterator_t<Range>;
+    std::vector<Iterator> chunk_iterators;
+    chunk_iterators.reserve(chunkCount(std::ranges::size(range), grain) + 1);
+
+    Iterator iter = std::ranges::begin(range);
+    const auto end = std::ranges::end(range);
+    while (iter != end) {
+
+      chunk_iterators.push_back(iter);
+      std::ranges::advance(iter, static_cast<std::ranges::range_difference_t<Range>>(grain), end);
+
+    }
+    chunk_iterators.push_back(iter);
+
+    return chunk_iterators;
+
+  }
+
+  // Chunk results are held as optionals, each chunk writes a separate object (no std::vector<bool> proxies).
+  template<typename T, typename Reduce>
+  [[nodiscard]] static T reduceChunks(T identity, std::vector<std::optional<T>>& chunk_results, Reduce& reduce) {
+
+    T result = std::move(identity);
+    for (auto& chunk_result : chunk_results) {
+
+      result = std::invoke(reduce, std::move(result), std::move(chunk_result.value()));
+
+    }
+
+    return result;
+
+  }
+
+  static void runChunks(size_t chunk_count, const std::function<void(size_t)>& chunk_function) {
+
+    // A single chunk is run on the calling thread.
+    if (chunk_count == 1) {
+
+      chunk_function(0);
+      return;
+
+    }
+
+    auto state_ptr = std::make_shared<ChunkState>();
+    state_ptr->chunk_count_ = chunk_count;
+    state_ptr->chunk_function_ = &chunk_function;
+
+    // The calling thread also processes chunks.
+    const size_t helper_count = std::min(threadCount(), chunk_count - 1);
+    for (size_t helper = 0; helper < helper_count; ++helper) {
+
+      pool().enqueueVoid(&Executor::processChunks, state_ptr);
+
+    }
+
+    processChunks(state_ptr);
+
+    // Wait for the chunks claimed by the pool threads.
+    size_t completed = state_ptr->completed_chunks_.load(std::memory_order_acquire);
+    while (completed != chunk_count) {
+
+      state_ptr->completed_chunks_.wait(completed, std::memory_order_acquire);
+      completed = state_ptr->completed_chunks_.load(std::memory_order_acquire);
+
+    }
+
+    if (state_ptr->exception_ptr_) {
+
+      std::rethrow_exception(state_ptr->exception_ptr_);
+
+    }
+
+  }
+
+  static void processChunks(const std::shared_ptr<ChunkState>& state_ptr) {
+
+    ChunkState& state = *state_ptr;
+    size_t chunk = state.next_chunk_.fetch_add(1, std::memory_order_relaxed);
+    while (chunk < state.chunk_count_) {
+
+      try {
+
+        (*state.chunk_function_)(chunk);
+
+      } catch (...) {
+
+        std::lock_guard<std::mutex> lock(state.exception_mutex_);
+        if (not state.exception_ptr_) {
+
+          state.exception_ptr_ = std::current_exception();
+
+        }
+
+      }
+
+      if (state.completed_chunks_.fetch_add(1, std::memory_order_acq_rel) + 1 == state.chunk_count_) {
+
+        state.completed_chunks_.notify_all();
+
+      }
+
+      chunk = state.next_chunk_.fetch_add(1, std::memory_order_relaxed);
+
+    }
+
+  }
+
+  // The CPUs available to the process grouped by NUMA node (a single group if the node topology is unavailable).
+  [[nodiscard]] static std::vector<std::vector<size_t>> cpuNodes() {
+
+    std::vector<std::vector<size_t>> cpu_nodes;
+
+#if defined(__linux__)
+    cpu_set_t process_cpus;
+    CPU_ZERO(&process_cpus);
+    if (sched_getaffinity(0, sizeof(process_cpus), &process_cpus) != 0) {
+
+      return cpu_nodes;
+
+    }
+
+    for (size_t node = 0; ; ++node) {
+
+      std::ifstream cpu_list_file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+      std::string cpu_list;
+      if (not cpu_list_file.good() or not std::getline(cpu_list_file, cpu_list)) {
+
+        break;
+
+      }
+
+      std::vector<size_t> node_cpus;
+      for (auto cpu : parseCpuList(cpu_list)) {
+
+        if (cpu < CPU_SETSIZE and CPU_ISSET(cpu, &process_cpus)) {
+
+          node_cpus.push_back(cpu);
+
+        }
+
+      }
+
+      if (not node_cpus.empty()) {
+
+        cpu_nodes.push_back(std::move(node_cpus));
+
+      }
+
+    }
+
+    if (cpu_nodes.empty()) {
+
+      std::vector<size_t> process_cpu_vector;
+      for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+
+        if (CPU_ISSET(cpu, &process_cpus)) {
+
+          process_cpu_vector.push_back(cpu);
+
+        }
+
+      }
+      cpu_nodes.push_back(std::move(process_cpu_vector));
+
+    }
+#endif
+
+    return cpu_nodes;
+
+  }
+
+  // Parse a kernel cpu list, for example "0-3,8-11".
+  [[nodiscard]] static std::vector<size_t> parseCpuList(const std::string& cpu_list) {
+
+    std::vector<size_t> cpus;
+    size_t position{0};
+    while (position < cpu_list.size()) {
+
+      size_t separator = cpu_list.find(',', position);
+      if (separator == std::string::npos) {
+
+        separator = cpu_list.size();
+
+      }
+
+      std::string cpu_range = cpu_list.substr(position, separator - position);
+      size_t dash = cpu_range.find('-');
+      try {
+
+        size_t first = std::stoul(cpu_range.substr(0, dash));
+        size_t last = dash == std::string::npos ? first : std::stoul(cpu_range.substr(dash + 1));
+        for (size_t cpu = first; cpu <= last; ++cpu) {
+
+          cpus.push_back(cpu);
+
+        }
+
+      } catch (...) {
+
+        // Ignore malformed entries.
+
+      }
+
+      position = separator + 1;
+
+    }
+
+    return cpus;
+
+  }
+
+  // Pin each pool thread to a core (round robin over the nodes) or to all the CPUs of a node.
+  static void pinThreads(WorkStealingThreads& pool, ThreadAffinity affinity) {
+
+#if defined(__linux__)
+    auto cpu_nodes = cpuNodes();
+    if (cpu_nodes.empty()) {
+
+      return;
+
+    }
+
+    // Cores are interleaved across the nodes.
+    size_t cpu_count{0};
+    for (auto const& node_cpus : cpu_nodes) {
+
+      cpu_count += node_cpus.size();
+
+    }
+
+    std::vector<size_t> core_order;
+    for (size_t index = 0; core_order.size() < cpu_count; ++index) {
+
+      for (auto const& node_cpus : cpu_nodes) {
+
+        if (index < node_cpus.size()) {
+
+          core_order.push_back(node_cpus[index]);
+
+        }
+
+      }
+
+    }
+
+    auto native_handles = pool.nativeHandles();
+    for (size_t thread = 0; thread < native_handles.size(); ++thread) {
+
+      cpu_set_t thread_cpus;
+      CPU_ZERO(&thread_cpus);
+      if (affinity == ThreadAffinity::NUMA) {
+
+        for (auto cpu : cpu_nodes[thread % cpu_nodes.size()]) {
+
+          CPU_SET(cpu, &thread_cpus);
+
+        }
+
+      } else {
+
+        CPU_SET(core_order[thread % core_order.size()], &thread_cpus);
+
+      }
+
+      pthread_setaffinity_np(native_handles[thread], sizeof(thread_cpus), &thread_cpus);
+
+    }
+#endif
+
+  }
+
+};
+
+
+} // namespace
+
+
+#endif //KEL_EXECUTOR_H
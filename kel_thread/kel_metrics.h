@@ -0,0 +1,641 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_METRICS_H
+#define KEL_METRICS_H
+
+#include "kel_exec_env.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace kellerberrin {  //  organization level namespace
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Runtime metrics for the queues, pipelines and stream stages.
+//
+// Each instrumented object (QueueTidal, WorkflowPipeline, WorkflowOrdered, BGZStreamIO,
+// VCFReaderMT) registers a MetricSet with the process-wide MetricsRegistry when it is
+// constructed and updates its counters, gauges and histograms directly. The metric
+// updates are relaxed atomic operations and never take a lock. Per item latencies are
+// timed per batch or accumulated per thread so that the shared histograms are not
+// updated for every item.
+//
+// The registry periodically writes all registered metrics to a file as JSON or as
+// Prometheus text (exposition format), the file is replaced atomically so that it can be
+// read (or scraped by a node exporter textfile collector) during a production run.
+// The metrics of destroyed objects are written once more and then dropped.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+
+// A monotonic count, for example objects enqueued or nanoseconds blocked.
+class MetricCounter {
+
+public:
+
+  MetricCounter() = default;
+  MetricCounter(const MetricCounter&) = delete;
+  ~MetricCounter() = default;
+
+  MetricCounter& operator=(const MetricCounter&) = delete;
+
+  void add(uint64_t count = 1) { value_.fetch_add(count, std::memory_order_relaxed); }
+  void addTime(std::chrono::nanoseconds duration) { add(static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0))); }
+
+  [[nodiscard]] uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+
+  std::atomic<uint64_t> value_{0};
+
+};
+
+
+// A sampled value, for example the current queue size.
+class MetricGauge {
+
+public:
+
+  MetricGauge() = default;
+  MetricGauge(const MetricGauge&) = delete;
+  ~MetricGauge() = default;
+
+  MetricGauge& operator=(const MetricGauge&) = delete;
+
+  void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+
+  [[nodiscard]] int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+
+  std::atomic<int64_t> value_{0};
+
+};
+
+
+// A latency histogram with power of 2 nanosecond buckets from 1 microsecond to 8.6 seconds.
+class MetricHistogram {
+
+public:
+
+  // Bucket i counts observations <= 2^(i + FIRST_BUCKET_EXPONENT_) nanoseconds, the last bucket is unbounded.
+  constexpr static const size_t BUCKET_COUNT_{25};
+
+  MetricHistogram() = default;
+  MetricHistogram(const MetricHistogram&) = delete;
+  ~MetricHistogram() = default;
+
+  MetricHistogram& operator=(const MetricHistogram&) = delete;
+
+  void observe(std::chrono::nanoseconds duration) {
+
+    auto nanoseconds = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+    buckets_[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(nanoseconds, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+
+  }
+
+  // Records a batch of observations timed as a whole, each observation is assigned the mean duration of the batch.
+  void observeBatch(std::chrono::nanoseconds batch_duration, uint64_t observations) {
+
+    if (observations == 0) {
+
+      return;
+
+    }
+
+    auto nanoseconds = static_cast<uint64_t>(std::max<int64_t>(batch_duration.count(), 0));
+    buckets_[bucketIndex(nanoseconds / observations)].fetch_add(observations, std::memory_order_relaxed);
+    sum_ns_.fetch_add(nanoseconds, std::memory_order_relaxed);
+    count_.fetch_add(observations, std::memory_order_relaxed);
+
+  }
+
+  [[nodiscard]] uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  [[nodiscard]] uint64_t sumNanoseconds() const { return sum_ns_.load(std::memory_order_relaxed); }
+  [[nodiscard]] uint64_t bucketCount(size_t bucket) const { return buckets_[bucket].load(std::memory_order_relaxed); }
+  // The upper bound of a bucket, the last bucket has no upper bound.
+  [[nodiscard]] static uint64_t bucketBound(size_t bucket) { return uint64_t{1} << (bucket + FIRST_BUCKET_EXPONENT_); }
+
+private:
+
+  friend class MetricHistogramBuffer;
+
+  constexpr static const size_t FIRST_BUCKET_EXPONENT_{10};
+
+  std::array<std::atomic<uint64_t>, BUCKET_COUNT_> buckets_{};
+  std::atomic<uint64_t> sum_ns_{0};
+  std::atomic<uint64_t> count_{0};
+
+  [[nodiscard]] static size_t bucketIndex(uint64_t nanoseconds) {
+
+    if (nanoseconds <= bucketBound(0)) {
+
+      return 0;
+
+    }
+
+    // The smallest exponent with 2^exponent >= nanoseconds.
+    size_t exponent = std::bit_width(nanoseconds - 1);
+    return std::min(exponent - FIRST_BUCKET_EXPONENT_, BUCKET_COUNT_ - 1);
+
+  }
+
+};
+
+
+// Accumulates the observations of a single thread without atomic operations. The observations are published
+// to the shared histogram once per batch, before the thread blocks, and when the buffer is destroyed.
+class MetricHistogramBuffer {
+
+public:
+
+  constexpr static const uint64_t DEFAULT_PUBLISH_COUNT_{64};
+
+  explicit MetricHistogramBuffer(MetricHistogram& histogram, uint64_t publish_count = DEFAULT_PUBLISH_COUNT_)
+  : histogram_(histogram), publish_count_(std::max<uint64_t>(publish_count, 1)) {}
+  MetricHistogramBuffer(const MetricHistogramBuffer&) = delete;
+  ~MetricHistogramBuffer() { publish(); }
+
+  MetricHistogramBuffer& operator=(const MetricHistogramBuffer&) = delete;
+
+  void observe(std::chrono::nanoseconds duration) {
+
+    auto nanoseconds = static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0));
+    ++buckets_[MetricHistogram::bucketIndex(nanoseconds)];
+    sum_ns_ += nanoseconds;
+    ++count_;
+    if (count_ >= publish_count_) {
+
+      publish();
+
+    }
+
+  }
+
+  void publish() {
+
+    if (count_ == 0) {
+
+      return;
+
+    }
+
+    for (size_t bucket = 0; bucket < MetricHistogram::BUCKET_COUNT_; ++bucket) {
+
+      if (buckets_[bucket] != 0) {
+
+        histogram_.buckets_[bucket].fetch_add(buckets_[bucket], std::memory_order_relaxed);
+        buckets_[bucket] = 0;
+
+      }
+
+    }
+    histogram_.sum_ns_.fetch_add(sum_ns_, std::memory_order_relaxed);
+    histogram_.count_.fetch_add(count_, std::memory_order_relaxed);
+    sum_ns_ = 0;
+    count_ = 0;
+
+  }
+
+private:
+
+  MetricHistogram& histogram_;
+  const uint64_t publish_count_;
+  std::array<uint64_t, MetricHistogram::BUCKET_COUNT_> buckets_{};
+  uint64_t sum_ns_{0};
+  uint64_t count_{0};
+
+};
+
+
+// Times a scope and records the elapsed time in a histogram or a thread local histogram buffer.
+template<typename Histogram>
+class MetricTimer {
+
+public:
+
+  explicit MetricTimer(Histogram& histogram) : histogram_(histogram) {}
+  MetricTimer(const MetricTimer&) = delete;
+  ~MetricTimer() { histogram_.observe(std::chrono::steady_clock::now() - start_); }
+
+  MetricTimer& operator=(const MetricTimer&) = delete;
+
+private:
+
+  Histogram& histogram_;
+  std::chrono::steady_clock::time_point start_{std::chrono::steady_clock::now()};
+
+};
+
+
+// The metrics of a single registered object. Metrics are created by the owner when it is constructed,
+// the returned references are stable for the lifetime of the set.
+class MetricSet {
+
+public:
+
+  MetricSet(std::string source_type, std::string source_name, size_t source_id)
+  : source_type_(std::move(source_type)), source_name_(std::move(source_name)), source_id_(source_id) {}
+  MetricSet(const MetricSet&) = delete;
+  ~MetricSet() = default;
+
+  MetricSet& operator=(const MetricSet&) = delete;
+
+  [[nodiscard]] MetricCounter& counter(const std::string& metric_name) { return addMetric(counters_, metric_name); }
+  [[nodiscard]] MetricGauge& gauge(const std::string& metric_name) { return addMetric(gauges_, metric_name); }
+  [[nodiscard]] MetricHistogram& histogram(const std::string& metric_name) { return addMetric(histograms_, metric_name); }
+
+  [[nodiscard]] const std::string& sourceType() const { return source_type_; }
+  [[nodiscard]] const std::string& sourceName() const { return source_name_; }
+  [[nodiscard]] size_t sourceId() const { return source_id_; }
+
+  // Called by the registry to export the metrics.
+  template<typename F>
+  void visitMetrics(F&& f) const {
+
+    std::lock_guard<std::mutex> lock(metric_mutex_);
+    for (auto const& [metric_name, counter] : counters_) f(metric_name, counter);
+    for (auto const& [metric_name, gauge] : gauges_) f(metric_name, gauge);
+    for (auto const& [metric_name, histogram] : histograms_) f(metric_name, histogram);
+
+  }
+
+private:
+
+  const std::string source_type_;
+  const std::string source_name_;
+  const size_t source_id_;
+  mutable std::mutex metric_mutex_;
+  std::map<std::string, MetricCounter> counters_;
+  std::map<std::string, MetricGauge> gauges_;
+  std::map<std::string, MetricHistogram> histograms_;
+
+  template<typename Metric>
+  [[nodiscard]] Metric& addMetric(std::map<std::string, Metric>& metric_map, const std::string& metric_name) {
+
+    std::lock_guard<std::mutex> lock(metric_mutex_);
+    auto [iter, result] = metric_map.try_emplace(metric_name);
+    return iter->second;
+
+  }
+
+};
+
+
+enum class MetricsFormat { JSON, PROMETHEUS };
+
+struct MetricsConfig {
+
+  std::string file_name;            // No periodic export if empty.
+  MetricsFormat format{MetricsFormat::JSON};
+  size_t interval_ms{10000};
+
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// The process-wide metrics registry.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+class MetricsRegistry {
+
+public:
+
+  MetricsRegistry() = delete;
+  ~MetricsRegistry() = delete;
+
+  // The returned metric set is owned by the registered object.
+  [[nodiscard]] static std::shared_ptr<MetricSet> registerSource(std::string source_type, std::string source_name) {
+
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    // Without an active export, metric sets released by their owners are never collected and are removed here.
+    // An active export collects the released sets (and reports their final values) at each interval.
+    if (not export_active_.load(std::memory_order_acquire)) {
+
+      std::erase_if(metric_sets_, [](const std::shared_ptr<MetricSet>& metric_set_ptr) { return metric_set_ptr.use_count() == 1; });
+
+    }
+    auto metric_set_ptr = std::make_shared<MetricSet>(std::move(source_type), std::move(source_name), ++source_count_);
+    metric_sets_.push_back(metric_set_ptr);
+    return metric_set_ptr;
+
+  }
+
+  [[nodiscard]] static std::string exportMetrics(MetricsFormat format) {
+
+    auto metric_sets = collectSources();
+    return format == MetricsFormat::JSON ? exportJSON(metric_sets) : exportPrometheus(metric_sets);
+
+  }
+
+  // The file is written to a temporary and renamed so that readers never see a partial file.
+  static bool writeMetrics(const std::string& file_name, MetricsFormat format) {
+
+    std::string metrics_text = exportMetrics(format);
+    std::string temp_file_name = file_name + TEMP_EXTENSION_;
+    {
+      std::ofstream metrics_file(temp_file_name, std::ios::out | std::ios::trunc);
+      if (not metrics_file.good()) {
+
+        ExecEnv::log().error("MetricsRegistry::writeMetrics; unable to open metrics file: {}", temp_file_name);
+        return false;
+
+      }
+      metrics_file << metrics_text;
+    }
+
+    std::error_code error_code;
+    std::filesystem::rename(temp_file_name, file_name, error_code);
+    if (error_code) {
+
+      ExecEnv::log().error("MetricsRegistry::writeMetrics; unable to rename: {} to: {}, error: {}", temp_file_name, file_name, error_code.message());
+      return false;
+
+    }
+
+    return true;
+
+  }
+
+  // Periodically write the metrics file, any active export is stopped.
+  static void startExport(const MetricsConfig& config) {
+
+    stopExport();
+
+    if (config.file_name.empty()) {
+
+      return;
+
+    }
+
+    std::lock_guard<std::mutex> lock(export_mutex_);
+    export_config_ = config;
+    export_config_.interval_ms = std::max<size_t>(export_config_.interval_ms, MIN_INTERVAL_MS_);
+    stop_export_ = false;
+    export_active_.store(true, std::memory_order_release);
+    export_thread_ = std::thread(&MetricsRegistry::exportLoop);
+    ExecEnv::log().info("MetricsRegistry; writing {} metrics to: {}, every milliseconds: {}",
+                        (export_config_.format == MetricsFormat::JSON ? "JSON" : "Prometheus"),
+                        export_config_.file_name, export_config_.interval_ms);
+
+  }
+
+  // Stops the periodic export and writes the final metrics.
+  static void stopExport() {
+
+    {
+      std::lock_guard<std::mutex> lock(export_mutex_);
+      if (not export_thread_.joinable()) {
+
+        return;
+
+      }
+      stop_export_ = true;
+    }
+    export_condition_.notify_all();
+    export_thread_.join();
+    [[maybe_unused]] bool result = writeMetrics(export_config_.file_name, export_config_.format);
+    export_active_.store(false, std::memory_order_release);
+
+  }
+
+private:
+
+  inline static std::mutex registry_mutex_;
+  inline static std::vector<std::shared_ptr<MetricSet>> metric_sets_;
+  inline static size_t source_count_{0};
+
+  inline static std::mutex export_mutex_;
+  inline static std::condition_variable export_condition_;
+  inline static std::thread export_thread_;
+  inline static MetricsConfig export_config_;
+  inline static bool stop_export_{false};
+  inline static std::atomic<bool> export_active_{false};
+
+  constexpr static const char* TEMP_EXTENSION_{".tmp"};
+  constexpr static const char* PROMETHEUS_PREFIX_{"kel_"};
+  constexpr static const size_t MIN_INTERVAL_MS_{100};
+
+  // Metric sets released by their owners are returned once more and then removed.
+  [[nodiscard]] static std::vector<std::shared_ptr<const MetricSet>> collectSources() {
+
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    std::vector<std::shared_ptr<const MetricSet>> metric_sets;
+    std::vector<std::shared_ptr<MetricSet>> active_sets;
+    for (auto& metric_set_ptr : metric_sets_) {
+
+      // Still held by the registered object.
+      if (metric_set_ptr.use_count() > 1) {
+
+        active_sets.push_back(metric_set_ptr);
+
+      }
+      metric_sets.push_back(std::move(metric_set_ptr));
+
+    }
+    metric_sets_ = std::move(active_sets);
+
+    return metric_sets;
+
+  }
+
+  static void exportLoop() {
+
+    std::unique_lock<std::mutex> lock(export_mutex_);
+    while (not stop_export_) {
+
+      export_condition_.wait_for(lock, std::chrono::milliseconds(export_config_.interval_ms), []() { return stop_export_; });
+      if (stop_export_) {
+
+        break;
+
+      }
+
+      lock.unlock();
+      [[maybe_unused]] bool result = writeMetrics(export_config_.file_name, export_config_.format);
+      lock.lock();
+
+    }
+
+  }
+
+  [[nodiscard]] static double seconds(uint64_t nanoseconds) { return static_cast<double>(nanoseconds) * 1.0e-9; }
+
+  [[nodiscard]] static std::string escape(const std::string& text) {
+
+    std::string escaped;
+    for (auto character : text) {
+
+      if (character == '"' or character == '\\') {
+
+        escaped.push_back('\\');
+
+      }
+      escaped.push_back(character == '\n' ? ' ' : character);
+
+    }
+
+    return escaped;
+
+  }
+
+  [[nodiscard]] static std::string exportJSON(const std::vector<std::shared_ptr<const MetricSet>>& metric_sets) {
+
+    std::ostringstream json;
+    json << "{\n  \"timestamp_ms\": "
+         << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()
+         << ",\n  \"sources\": [";
+
+    bool first_source{true};
+    for (auto const& metric_set_ptr : metric_sets) {
+
+      // Active sets are held by the registered object, the registry and the collected vector.
+      json << (first_source ? "\n" : ",\n")
+           << "    {\"type\": \"" << escape(metric_set_ptr->sourceType())
+           << "\", \"name\": \"" << escape(metric_set_ptr->sourceName())
+           << "\", \"id\": " << metric_set_ptr->sourceId()
+           << ", \"active\": " << (metric_set_ptr.use_count() > 2 ? "true" : "false")
+           << ", \"metrics\": {";
+      first_source = false;
+
+      bool first_metric{true};
+      metric_set_ptr->visitMetrics([&json, &first_metric](const std::string& metric_name, const auto& metric) {
+
+        json << (first_metric ? "" : ", ") << '"' << escape(metric_name) << "\": ";
+        first_metric = false;
+
+        using Metric = std::decay_t<decltype(metric)>;
+        if constexpr (std::is_same_v<Metric, MetricHistogram>) {
+
+          json << "{\"count\": " << metric.count() << ", \"sum_seconds\": " << seconds(metric.sumNanoseconds()) << ", \"buckets\": [";
+          for (size_t bucket = 0; bucket < MetricHistogram::BUCKET_COUNT_; ++bucket) {
+
+            json << (bucket == 0 ? "" : ", ") << metric.bucketCount(bucket);
+
+          }
+          json << "]}";
+
+        } else {
+
+          json << metric.value();
+
+        }
+
+      });
+
+      json << "}}";
+
+    }
+
+    json << "\n  ],\n  \"histogram_bucket_bounds_seconds\": [";
+    for (size_t bucket = 0; bucket + 1 < MetricHistogram::BUCKET_COUNT_; ++bucket) {
+
+      json << (bucket == 0 ? "" : ", ") << seconds(MetricHistogram::bucketBound(bucket));
+
+    }
+    json << "]\n}\n";
+
+    return json.str();
+
+  }
+
+  // Samples are grouped by metric name, each group has a single TYPE line.
+  [[nodiscard]] static std::string exportPrometheus(const std::vector<std::shared_ptr<const MetricSet>>& metric_sets) {
+
+    // Metric name -> (type, sample lines).
+    std::map<std::string, std::pair<std::string, std::vector<std::string>>> metric_groups;
+
+    for (auto const& metric_set_ptr : metric_sets) {
+
+      std::string labels = "type=\"" + escape(metric_set_ptr->sourceType())
+                         + "\",name=\"" + escape(metric_set_ptr->sourceName())
+                         + "\",id=\"" + std::to_string(metric_set_ptr->sourceId()) + '"';
+      std::string metric_prefix = std::string(PROMETHEUS_PREFIX_) + metric_set_ptr->sourceType() + '_';
+
+      metric_set_ptr->visitMetrics([&metric_groups, &labels, &metric_prefix](const std::string& metric_name, const auto& metric) {
+
+        std::string full_name = metric_prefix + metric_name;
+        using Metric = std::decay_t<decltype(metric)>;
+        if constexpr (std::is_same_v<Metric, MetricHistogram>) {
+
+          auto& [metric_type, sample_lines] = metric_groups[full_name];
+          metric_type = "histogram";
+          uint64_t cumulative_count{0};
+          for (size_t bucket = 0; bucket < MetricHistogram::BUCKET_COUNT_; ++bucket) {
+
+            cumulative_count += metric.bucketCount(bucket);
+            std::ostringstream bound;
+            if (bucket + 1 < MetricHistogram::BUCKET_COUNT_) {
+
+              bound << seconds(MetricHistogram::bucketBound(bucket));
+
+            } else {
+
+              bound << "+Inf";
+
+            }
+            sample_lines.push_back(full_name + "_bucket{" + labels + ",le=\"" + bound.str() + "\"} " + std::to_string(cumulative_count));
+
+          }
+          std::ostringstream sum;
+          sum << seconds(metric.sumNanoseconds());
+          sample_lines.push_back(full_name + "_sum{" + labels + "} " + sum.str());
+          sample_lines.push_back(full_name + "_count{" + labels + "} " + std::to_string(metric.count()));
+
+        } else {
+
+          auto& [metric_type, sample_lines] = metric_groups[full_name];
+          metric_type = std::is_same_v<Metric, MetricCounter> ? "counter" : "gauge";
+          sample_lines.push_back(full_name + '{' + labels + "} " + std::to_string(metric.value()));
+
+        }
+
+      });
+
+    }
+
+    std::string prometheus_text;
+    for (auto const& [metric_name, metric_group] : metric_groups) {
+
+      auto const& [metric_type, sample_lines] = metric_group;
+      prometheus_text += "# TYPE " + metric_name + ' ' + metric_type + '\n';
+      for (auto const& sample_line : sample_lines) {
+
+        prometheus_text += sample_line + '\n';
+
+      }
+
+    }
+
+    return prometheus_text;
+
+  }
+
+};
+
+
+} // namespace
+
+
+#endif //KEL_METRICS_H
@@ -0,0 +1,208 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_PIPELINE_BALANCER_H
+#define KEL_PIPELINE_BALANCER_H
+
+#include "kel_exec_env.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace kellerberrin {  //  organization level namespace
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Rebalances threads between the stages of a pipeline using the measured queue occupancy.
+//
+// Each stage supplies the occupancy of its input queue (the fraction of the queue holding
+// objects waiting for the stage, in [0, 1]) and a function to set the number of active
+// stage threads. The stage has more threads than are active, the inactive threads are parked.
+//
+// The occupancy of each stage is sampled periodically and smoothed. If a stage has a full
+// input queue (it is the pipeline bottleneck) and another stage has an empty input queue
+// (it is starved), then one thread is moved from the starved stage to the bottleneck stage.
+// The total number of active threads is unchanged.
+//
+// stop() must be called before the stages are stopped (joined).
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+class PipelineBalancer {
+
+  struct BalancedStage {
+
+    std::string stage_name_;
+    std::function<double()> occupancy_;
+    std::function<void(size_t)> set_threads_;
+    size_t active_threads_;
+    size_t max_threads_;
+    double smoothed_occupancy_{0.0};
+
+  };
+
+public:
+
+  PipelineBalancer() = default;
+  PipelineBalancer(const PipelineBalancer&) = delete;
+  ~PipelineBalancer() { stop(); }
+
+  PipelineBalancer& operator=(const PipelineBalancer&) = delete;
+
+  // Not thread safe, stages are added before start().
+  void addStage( std::string stage_name
+               , std::function<double()> occupancy
+               , std::function<void(size_t)> set_threads
+               , size_t active_threads
+               , size_t max_threads) {
+
+    active_threads = std::clamp<size_t>(active_threads, MIN_STAGE_THREADS_, std::max(max_threads, MIN_STAGE_THREADS_));
+    stages_.push_back(BalancedStage{ std::move(stage_name)
+                                   , std::move(occupancy)
+                                   , std::move(set_threads)
+                                   , active_threads
+                                   , std::max(max_threads, active_threads)});
+
+  }
+
+  void start(size_t interval_ms) {
+
+    stop();
+    if (stages_.size() < 2) {
+
+      return;
+
+    }
+
+    for (auto& stage : stages_) {
+
+      stage.set_threads_(stage.active_threads_);
+
+    }
+
+    std::lock_guard<std::mutex> lock(balance_mutex_);
+    stop_balance_ = false;
+    interval_ms_ = std::max<size_t>(interval_ms, 1);
+    balance_thread_ = std::thread(&PipelineBalancer::balanceLoop, this);
+
+  }
+
+  void stop() {
+
+    {
+      std::lock_guard<std::mutex> lock(balance_mutex_);
+      if (not balance_thread_.joinable()) {
+
+        return;
+
+      }
+      stop_balance_ = true;
+    }
+    balance_condition_.notify_all();
+    balance_thread_.join();
+
+    for (auto const& stage : stages_) {
+
+      ExecEnv::log().info("PipelineBalancer; stage: {}, final active threads: {}", stage.stage_name_, stage.active_threads_);
+
+    }
+
+  }
+
+private:
+
+  std::vector<BalancedStage> stages_;
+  std::thread balance_thread_;
+  std::mutex balance_mutex_;
+  std::condition_variable balance_condition_;
+  bool stop_balance_{false};
+  size_t interval_ms_{1};
+
+  constexpr static const size_t MIN_STAGE_THREADS_{1};
+  // A bottleneck stage has a full input queue and a starved stage has an empty input queue.
+  constexpr static const double BOTTLENECK_OCCUPANCY_{0.5};
+  constexpr static const double STARVED_OCCUPANCY_{0.1};
+  // Exponential smoothing of the sampled occupancy.
+  constexpr static const double SMOOTHING_{0.5};
+
+  void balanceLoop() {
+
+    std::unique_lock<std::mutex> lock(balance_mutex_);
+    while (not stop_balance_) {
+
+      balance_condition_.wait_for(lock, std::chrono::milliseconds(interval_ms_), [this]() { return stop_balance_; });
+      if (stop_balance_) {
+
+        break;
+
+      }
+
+      rebalance();
+
+    }
+
+  }
+
+  void rebalance() {
+
+    for (auto& stage : stages_) {
+
+      double occupancy = std::clamp(stage.occupancy_(), 0.0, 1.0);
+      stage.smoothed_occupancy_ = (SMOOTHING_ * occupancy) + ((1.0 - SMOOTHING_) * stage.smoothed_occupancy_);
+
+    }
+
+    BalancedStage* bottleneck_ptr{nullptr};
+    BalancedStage* starved_ptr{nullptr};
+    for (auto& stage : stages_) {
+
+      if (stage.smoothed_occupancy_ >= BOTTLENECK_OCCUPANCY_ and stage.active_threads_ < stage.max_threads_) {
+
+        if (bottleneck_ptr == nullptr or stage.smoothed_occupancy_ > bottleneck_ptr->smoothed_occupancy_) {
+
+          bottleneck_ptr = &stage;
+
+        }
+
+      }
+
+      if (stage.smoothed_occupancy_ <= STARVED_OCCUPANCY_ and stage.active_threads_ > MIN_STAGE_THREADS_) {
+
+        if (starved_ptr == nullptr or stage.smoothed_occupancy_ < starved_ptr->smoothed_occupancy_) {
+
+          starved_ptr = &stage;
+
+        }
+
+      }
+
+    }
+
+    if (bottleneck_ptr == nullptr or starved_ptr == nullptr or bottleneck_ptr == starved_ptr) {
+
+      return;
+
+    }
+
+    --starved_ptr->active_threads_;
+    starved_ptr->set_threads_(starved_ptr->active_threads_);
+    ++bottleneck_ptr->active_threads_;
+    bottleneck_ptr->set_threads_(bottleneck_ptr->active_threads_);
+
+  }
+
+};
+
+
+} // namespace
+
+
+#endif //KEL_PIPELINE_BALANCER_H
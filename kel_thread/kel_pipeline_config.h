@@ -0,0 +1,116 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_PIPELINE_CONFIG_H
+#define KEL_PIPELINE_CONFIG_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+
+namespace kellerberrin {  //  organization level namespace
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// The configuration of a multi-stage pipeline, for example the VCF ingest pipeline
+// (decompress -> parse -> ingest). Each named stage has a thread count, a queue depth
+// (high tide and low tide) and a batch size. A zero value selects the default of the stage.
+//
+// The configuration is composed with the builder functions:
+//
+//   PipelineConfig config = PipelineConfig().stage("parse", {.threads = 32, .high_tide = 400})
+//                                           .stage("ingest", {.threads = 64, .batch_size = 128})
+//                                           .autoBalance(true);
+//
+// If auto balance is set, the pipeline threads are rebalanced between the stages
+// during processing, see PipelineBalancer.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+struct PipelineStageConfig {
+
+  size_t threads{0};
+  size_t high_tide{0};
+  size_t low_tide{0};
+  size_t batch_size{0};
+
+  // The non-zero values of this stage override the defaults.
+  [[nodiscard]] PipelineStageConfig mergeDefaults(const PipelineStageConfig& defaults) const {
+
+    PipelineStageConfig merged;
+    merged.threads = threads > 0 ? threads : defaults.threads;
+    merged.high_tide = high_tide > 0 ? high_tide : defaults.high_tide;
+    merged.low_tide = low_tide > 0 ? low_tide : defaults.low_tide;
+    merged.batch_size = batch_size > 0 ? batch_size : defaults.batch_size;
+    // The low tide must be below the high tide.
+    if (merged.high_tide > 0 and merged.low_tide >= merged.high_tide) {
+
+      merged.low_tide = merged.high_tide / 2;
+
+    }
+
+    return merged;
+
+  }
+
+};
+
+
+class PipelineConfig {
+
+public:
+
+  PipelineConfig() = default;
+  ~PipelineConfig() = default;
+
+  // Builder functions.
+  PipelineConfig& stage(const std::string& stage_name, const PipelineStageConfig& stage_config) {
+
+    stage_map_[stage_name] = stage_config;
+    return *this;
+
+  }
+  PipelineConfig& autoBalance(bool auto_balance, size_t interval_ms = DEFAULT_BALANCE_INTERVAL_MS_) {
+
+    auto_balance_ = auto_balance;
+    balance_interval_ms_ = interval_ms > 0 ? interval_ms : DEFAULT_BALANCE_INTERVAL_MS_;
+    return *this;
+
+  }
+
+  // The stage configuration merged with the stage defaults.
+  [[nodiscard]] PipelineStageConfig stageConfig(const std::string& stage_name, const PipelineStageConfig& defaults) const {
+
+    auto result = stage_map_.find(stage_name);
+    if (result == stage_map_.end()) {
+
+      return PipelineStageConfig{}.mergeDefaults(defaults);
+
+    }
+
+    auto const& [name, stage_config] = *result;
+    return stage_config.mergeDefaults(defaults);
+
+  }
+
+  [[nodiscard]] const std::map<std::string, PipelineStageConfig>& stageMap() const { return stage_map_; }
+  [[nodiscard]] bool autoBalance() const { return auto_balance_; }
+  [[nodiscard]] size_t balanceInterval() const { return balance_interval_ms_; }
+
+private:
+
+  std::map<std::string, PipelineStageConfig> stage_map_;
+  bool auto_balance_{false};
+  size_t balance_interval_ms_{DEFAULT_BALANCE_INTERVAL_MS_};
+
+  constexpr static const size_t DEFAULT_BALANCE_INTERVAL_MS_{500};
+
+};
+
+
+} // namespace
+
+
+#endif //KEL_PIPELINE_CONFIG_H
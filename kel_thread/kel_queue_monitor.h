@@ -205,12 +205,12 @@ constexpr static const char* TIDAL_QUEUE_DEFAULT_NAME{"QueueTidal"};
 // Forward queue declaration.
 template<typename T> requires std::move_constructible<T> class QueueTidal;
 
-// Realtime queue monitor
-template<typename T> class MonitorTidal {
+// Realtime queue monitor, the monitored queue type is any queue with the QueueTidal statistics interface.
+template<typename T, typename QueueType = QueueTidal<T>> class MonitorTidal {
 
 public:
 
-  explicit MonitorTidal(QueueTidal<T> *queue_ptr) : queue_ptr_(queue_ptr) {}
+  explicit MonitorTidal(QueueType *queue_ptr) : queue_ptr_(queue_ptr) {}
   ~MonitorTidal() {
 
     stopStats();
@@ -287,7 +287,7 @@ public:
 
 private:
 
-  QueueTidal<T> *queue_ptr_;
+  QueueType *queue_ptr_;
   size_t sample_milliseconds_{0};
   bool monitor_stalled_{true};
   std::string queue_name_;
@@ -0,0 +1,367 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_QUEUE_RING_H
+#define KEL_QUEUE_RING_H
+
+
+#include "kel_queue_tidal.h"
+#include "kel_queue_monitor.h"
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <chrono>
+
+
+namespace kellerberrin {   //  organization level namespace
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// A lock-free bounded multi-producer multi-consumer ring queue with the same interface and tidal semantics as QueueTidal.
+// QueueRing can be used wherever the queue type is a template parameter (WorkflowAsync, WorkflowPipeline).
+//
+// The queue is an array of cells, each with a sequence number that records whether the cell is free for the producer
+// at a given enqueue position or holds an object for the consumer at a given dequeue position. Producers and consumers
+// claim positions using compare and exchange on the (cache line separated) enqueue and dequeue positions, a push or
+// pop that does not block never takes a lock.
+//
+// Threads only block when the queue is at high tide (producers) or empty (consumers). Blocked threads wait on an atomic
+// (std::atomic::wait, a futex on Linux) and are only notified if a thread is known to be waiting, so the notify system
+// call is avoided when the queue is flowing. Consumers briefly spin before blocking on an empty queue.
+//
+// The ring capacity is twice the high tide rounded up to a power of 2. Since producers check the tidal state before
+// pushing, a burst of concurrent producers can overshoot high tide. If the ring is full then producers yield until a
+// cell is free.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+template<typename T>
+requires std::move_constructible<T>
+class QueueRing {
+
+public:
+
+  explicit QueueRing( size_t high_tide = TIDAL_QUEUE_DEFAULT_HIGH_TIDE
+                    , size_t low_tide = TIDAL_QUEUE_DEFAULT_LOW_TIDE) : high_tide_(high_tide), low_tide_(low_tide) {
+
+    monitor_ptr_ = std::make_unique<MonitorTidal<T, QueueRing<T>>>(this);
+
+  }
+
+  // This constructor attaches a queue monitor to check for a 'stalled' condition and generates tidal statistics.
+  QueueRing( size_t high_tide
+           , size_t low_tide
+           , std::string queue_name
+           , size_t sample_frequency): high_tide_(high_tide), low_tide_(low_tide) {
+
+    monitor_ptr_ = std::make_unique<MonitorTidal<T, QueueRing<T>>>(this);
+    monitor_ptr_->launchStats(sample_frequency, queue_name);
+
+  }
+  QueueRing(const QueueRing&) = delete;
+  ~QueueRing() {
+
+    monitor_ptr_ = nullptr;
+    // Destroy any remaining queued objects.
+    while (tryPop()) {}
+
+  }
+
+  QueueRing& operator=(const QueueRing&) = delete;
+
+  // Enqueue function can be called by multiple threads.
+  // These threads will block if the queue has reached high-tide size until the queue size reaches low-tide (EBB_TIDE)
+  // Once the queue has reached low-tide through consumer activity the producer threads are once again unblocked (FLOOD_TIDE).
+  void push(T new_value) {
+
+    if (queue_tidal_state_.load(std::memory_order_acquire) != QueueTidalState::FLOOD_TIDE) {
+
+      waitFloodTide();
+
+    }
+
+    while (not tryPush(new_value)) {
+
+      // The ring is full, only possible if concurrent producers overshoot high tide.
+      std::this_thread::yield();
+
+    }
+
+    // Pairs with the consumer fence in waitAndPop() so that a waiting consumer is always notified.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (size() >= high_tide_) {
+
+      setEbbTide();
+
+    }
+
+    if (pop_waiters_.load(std::memory_order_relaxed) > 0) {
+
+      push_epoch_.fetch_add(1, std::memory_order_release);
+      push_epoch_.notify_all();
+
+    }
+
+  }
+
+  // Dequeue function can be called by multiple threads.
+  // These threads will block if the queue is empty.
+  [[nodiscard]] T waitAndPop() {
+
+    for (size_t spin_count = 0; spin_count < SPIN_COUNT_; ++spin_count) {
+
+      std::optional<T> value = tryPop();
+      if (value) {
+
+        return std::move(value.value());
+
+      }
+
+      std::this_thread::yield();
+
+    }
+
+    // Time spent blocked on an empty queue.
+    auto stall_start = std::chrono::steady_clock::now();
+    pop_waiters_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    while (true) {
+
+      uint32_t epoch = push_epoch_.load(std::memory_order_acquire);
+      std::optional<T> value = tryPop();
+      if (value) {
+
+        pop_waiters_.fetch_sub(1, std::memory_order_relaxed);
+        pop_stall_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - stall_start).count();
+        return std::move(value.value());
+
+      }
+
+      push_epoch_.wait(epoch, std::memory_order_acquire);
+
+    }
+
+  }
+
+  // Discard all queued objects and unblock producers.
+  void clear() {
+
+    while (tryPop()) {}
+
+    queue_tidal_state_.store(QueueTidalState::FLOOD_TIDE);
+    if (push_waiters_.load() > 0) {
+
+      queue_tidal_state_.notify_all();
+
+    }
+
+  }
+
+  [[nodiscard]] MonitorTidal<T, QueueRing<T>>& monitor() const { return *monitor_ptr_; };
+  // All of these functions are thread safe.
+  [[nodiscard]] bool empty() const { return size() == 0; }
+  // The dequeue position is read first, the size is never negative and may be momentarily overstated.
+  [[nodiscard]] size_t size() const {
+
+    size_t dequeue_position = dequeue_position_.load(std::memory_order_seq_cst);
+    return enqueue_position_.load(std::memory_order_seq_cst) - dequeue_position;
+
+  }
+  [[nodiscard]] size_t activity() const { return enqueue_position_.load(std::memory_order_relaxed) + dequeue_position_.load(std::memory_order_relaxed); }
+  [[nodiscard]] QueueTidalState queueTidalState() const { return queue_tidal_state_; }
+  [[nodiscard]] bool queueState() const { return queue_tidal_state_ == QueueTidalState::FLOOD_TIDE; }
+
+  [[nodiscard]] size_t highTide() const { return high_tide_; }
+  [[nodiscard]] size_t lowTide() const { return low_tide_; }
+  [[nodiscard]] size_t capacity() const { return capacity_; }
+  // Cumulative time producers were blocked at high tide and consumers were blocked on an empty queue.
+  [[nodiscard]] std::chrono::nanoseconds pushStallTime() const { return std::chrono::nanoseconds(push_stall_ns_); }
+  [[nodiscard]] std::chrono::nanoseconds popStallTime() const { return std::chrono::nanoseconds(pop_stall_ns_); }
+
+private:
+
+  // The cell sequence is the enqueue position at which the cell can be written and (position + 1)
+  // when the cell holds an object to be dequeued.
+  // The object is a union member so that it is only constructed by a push and destroyed by a pop.
+  struct Cell {
+
+    Cell() {}
+    ~Cell() {}
+
+    std::atomic<size_t> sequence_{0};
+    union { T object_; };
+
+  };
+
+  // Tidal limits.
+  const size_t high_tide_;
+  const size_t low_tide_;
+  const size_t capacity_{std::bit_ceil(std::max<size_t>(high_tide_, 1) * 2)};
+  const size_t index_mask_{capacity_ - 1};
+  const std::unique_ptr<Cell[]> cells_{initializeCells(capacity_)};
+
+  // Producer and consumer positions are on separate cache lines.
+  alignas(64) std::atomic<size_t> enqueue_position_{0};
+  alignas(64) std::atomic<size_t> dequeue_position_{0};
+
+  // Producers wait on the tidal state, consumers wait on the push epoch.
+  alignas(64) std::atomic<QueueTidalState> queue_tidal_state_{QueueTidalState::FLOOD_TIDE};
+  std::atomic<uint32_t> push_waiters_{0};
+  alignas(64) std::atomic<uint32_t> push_epoch_{0};
+  std::atomic<uint32_t> pop_waiters_{0};
+
+  alignas(64) std::atomic<int64_t> push_stall_ns_{0};
+  std::atomic<int64_t> pop_stall_ns_{0};
+
+  // Queue monitor asynchronously gathers dynamic producer/consumer statistics.
+  // it also (optionally) monitors for a 'stalled' queue where there is a possible deadlock condition and the queue is inactive.
+  // Held in a pointer for explicit object lifetime.
+  std::unique_ptr<MonitorTidal<T, QueueRing<T>>> monitor_ptr_;
+
+  // Attempts to dequeue before a consumer blocks on an empty queue.
+  constexpr static const size_t SPIN_COUNT_{16};
+
+  [[nodiscard]] static std::unique_ptr<Cell[]> initializeCells(size_t capacity) {
+
+    auto cells = std::make_unique<Cell[]>(capacity);
+    for (size_t index = 0; index < capacity; ++index) {
+
+      cells[index].sequence_.store(index, std::memory_order_relaxed);
+
+    }
+
+    return cells;
+
+  }
+
+  // Returns false if the ring is full, the value is only moved if the push succeeds.
+  [[nodiscard]] bool tryPush(T& value) {
+
+    size_t position = enqueue_position_.load(std::memory_order_relaxed);
+    while (true) {
+
+      Cell& cell = cells_[position & index_mask_];
+      size_t sequence = cell.sequence_.load(std::memory_order_acquire);
+      auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+      if (difference == 0) {
+
+        if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+
+          std::construct_at(std::addressof(cell.object_), std::move(value));
+          cell.sequence_.store(position + 1, std::memory_order_release);
+          return true;
+
+        }
+
+      } else if (difference < 0) {
+
+        return false;
+
+      } else {
+
+        position = enqueue_position_.load(std::memory_order_relaxed);
+
+      }
+
+    }
+
+  }
+
+  // Returns std::nullopt if the queue is empty.
+  [[nodiscard]] std::optional<T> tryPop() {
+
+    size_t position = dequeue_position_.load(std::memory_order_relaxed);
+    while (true) {
+
+      Cell& cell = cells_[position & index_mask_];
+      size_t sequence = cell.sequence_.load(std::memory_order_acquire);
+      auto difference = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+      if (difference == 0) {
+
+        if (dequeue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+
+          std::optional<T> value(std::in_place, std::move(cell.object_));
+          std::destroy_at(std::addressof(cell.object_));
+          cell.sequence_.store(position + capacity_, std::memory_order_release);
+
+          // Pairs with the producer fence in setEbbTide().
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          if (queue_tidal_state_.load(std::memory_order_relaxed) == QueueTidalState::EBB_TIDE and size() <= low_tide_) {
+
+            setFloodTide();
+
+          }
+
+          return value;
+
+        }
+
+      } else if (difference < 0) {
+
+        return std::nullopt;
+
+      } else {
+
+        position = dequeue_position_.load(std::memory_order_relaxed);
+
+      }
+
+    }
+
+  }
+
+  void setEbbTide() {
+
+    queue_tidal_state_.store(QueueTidalState::EBB_TIDE);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // Consumers may have drained the queue before the state change was visible.
+    if (size() <= low_tide_) {
+
+      setFloodTide();
+
+    }
+
+  }
+
+  void setFloodTide() {
+
+    QueueTidalState expected_state{QueueTidalState::EBB_TIDE};
+    if (queue_tidal_state_.compare_exchange_strong(expected_state, QueueTidalState::FLOOD_TIDE)
+        and push_waiters_.load() > 0) {
+
+      queue_tidal_state_.notify_all();
+
+    }
+
+  }
+
+  void waitFloodTide() {
+
+    // Time spent blocked at high tide.
+    auto stall_start = std::chrono::steady_clock::now();
+    push_waiters_.fetch_add(1);
+    while (queue_tidal_state_.load() != QueueTidalState::FLOOD_TIDE) {
+
+      queue_tidal_state_.wait(QueueTidalState::EBB_TIDE);
+
+    }
+    push_waiters_.fetch_sub(1);
+    push_stall_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - stall_start).count();
+
+  }
+
+};
+
+
+} // namespace
+
+#endif //KEL_QUEUE_RING_H
@@ -7,6 +7,7 @@
 
 #include "kel_queue_mt_safe.h"
 #include "kel_queue_monitor.h"
+#include "kel_metrics.h"
 #include "kel_exec_env.h"
 
 #include <iostream>
@@ -15,6 +16,10 @@
 #include <optional>
 #include <queue>
 #include <utility>
+#include <chrono>
+#include <vector>
+#include <ranges>
+#include <algorithm>
 
 namespace kellerberrin {   //  organization level namespace
 
@@ -34,6 +39,9 @@ namespace kellerberrin {   //  organization level namespace
 // 'low-tide', 'flood-tide', 'ebb-tide' and average queue size. These statistics can be used to efficiently allocate
 // CPU resources (threads) between producers and consumers.
 //
+// Every queue registers a MetricSet (type "queue") with the MetricsRegistry, the enqueue and dequeue counts, the
+// queue size and the time producers were blocked at high tide and consumers were starved on an empty queue are exported.
+//
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
@@ -62,7 +70,8 @@ class QueueTidal {
 public:
 
   explicit QueueTidal( size_t high_tide = TIDAL_QUEUE_DEFAULT_HIGH_TIDE
-                       , size_t low_tide = TIDAL_QUEUE_DEFAULT_LOW_TIDE) : high_tide_(high_tide), low_tide_(low_tide) {
+                       , size_t low_tide = TIDAL_QUEUE_DEFAULT_LOW_TIDE)
+  : high_tide_(high_tide), low_tide_(low_tide), metrics_ptr_(MetricsRegistry::registerSource(METRICS_TYPE_, METRICS_NAME_)) {
 
     monitor_ptr_ = std::make_unique<MonitorTidal<T>>(this);
 
@@ -72,7 +81,8 @@ public:
   QueueTidal( size_t high_tide
               , size_t low_tide
               , std::string queue_name
-              , size_t sample_frequency): high_tide_(high_tide), low_tide_(low_tide) {
+              , size_t sample_frequency)
+  : high_tide_(high_tide), low_tide_(low_tide), metrics_ptr_(MetricsRegistry::registerSource(METRICS_TYPE_, queue_name)) {
 
     monitor_ptr_ = std::make_unique<MonitorTidal<T>>(this);
     monitor_ptr_->launchStats(sample_frequency, queue_name);
@@ -87,16 +97,26 @@ public:
 
     { // Mutex
       std::unique_lock<std::mutex> lock(queue_mutex_);
-      tide_cond_.wait(lock, [this]()->bool{ return queue_tidal_state_ == QueueTidalState::FLOOD_TIDE; });
+      if (queue_tidal_state_ != QueueTidalState::FLOOD_TIDE) {
+
+        // Time spent blocked at high tide.
+        auto stall_start = std::chrono::steady_clock::now();
+        tide_cond_.wait(lock, [this]()->bool{ return queue_tidal_state_ == QueueTidalState::FLOOD_TIDE; });
+        push_stall_.addTime(std::chrono::steady_clock::now() - stall_start);
+
+      }
 
       queue_.push(std::move(new_value));
 
       ++queue_size_;
       ++queue_activity_;
+      enqueued_.add();
+      size_gauge_.set(queue_size_);
 
       if (queue_size_ >= high_tide_) {
 
         queue_tidal_state_ = QueueTidalState::EBB_TIDE;
+        high_tide_events_.add();
 
       }
 
@@ -111,13 +131,22 @@ public:
   [[nodiscard]] T waitAndPop() {
 
     std::unique_lock<std::mutex> lock(queue_mutex_);
-    empty_cond_.wait(lock, [this]()->bool{ return not empty(); });
+    if (empty()) {
+
+      // Time spent blocked on an empty queue.
+      auto stall_start = std::chrono::steady_clock::now();
+      empty_cond_.wait(lock, [this]()->bool{ return not empty(); });
+      pop_stall_.addTime(std::chrono::steady_clock::now() - stall_start);
+
+    }
 
     T value(std::move(queue_.front()));
     queue_.pop();
 
     --queue_size_;
     ++queue_activity_;
+    dequeued_.add();
+    size_gauge_.set(queue_size_);
 
     if (queue_tidal_state_ == QueueTidalState::EBB_TIDE and queue_size_ <= low_tide_) {
 
@@ -133,6 +162,116 @@ public:
 
   }
 
+  // Enqueue a range of objects under one lock acquisition, the objects are moved from the range.
+  // The tidal state is checked for each object, if high tide is reached during the batch then the objects already
+  // pushed are made available to consumers and the producer blocks until low tide.
+  template<std::ranges::input_range Range>
+  requires std::constructible_from<T, std::ranges::range_rvalue_reference_t<Range>>
+  void pushBatch(Range&& values) {
+
+    size_t pushed_count{0};
+    { // Mutex
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      for (auto&& value : values) {
+
+        if (queue_tidal_state_ != QueueTidalState::FLOOD_TIDE) {
+
+          if (pushed_count > 0) {
+
+            empty_cond_.notify_all();
+
+          }
+
+          // Time spent blocked at high tide.
+          auto stall_start = std::chrono::steady_clock::now();
+          tide_cond_.wait(lock, [this]()->bool{ return queue_tidal_state_ == QueueTidalState::FLOOD_TIDE; });
+          push_stall_.addTime(std::chrono::steady_clock::now() - stall_start);
+
+        }
+
+        queue_.push(std::move(value));
+
+        ++queue_size_;
+        ++queue_activity_;
+        ++pushed_count;
+
+        if (queue_size_ >= high_tide_) {
+
+          queue_tidal_state_ = QueueTidalState::EBB_TIDE;
+          high_tide_events_.add();
+
+        }
+
+      }
+
+      enqueued_.add(pushed_count);
+      size_gauge_.set(queue_size_);
+
+    } // ~Mutex
+
+    if (pushed_count > 1) {
+
+      empty_cond_.notify_all();
+
+    } else if (pushed_count == 1) {
+
+      empty_cond_.notify_one();
+
+    }
+
+  }
+
+  // Dequeue up to max_count objects under one lock acquisition.
+  // These threads will block if the queue is empty, at least one object is returned.
+  [[nodiscard]] std::vector<T> popBatch(size_t max_count) {
+
+    std::vector<T> batch;
+    batch.reserve(std::max<size_t>(max_count, 1));
+
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    if (empty()) {
+
+      // Time spent blocked on an empty queue.
+      auto stall_start = std::chrono::steady_clock::now();
+      empty_cond_.wait(lock, [this]()->bool{ return not empty(); });
+      pop_stall_.addTime(std::chrono::steady_clock::now() - stall_start);
+
+    }
+
+    const size_t pop_count = std::clamp<size_t>(max_count, 1, queue_size_);
+    for (size_t count = 0; count < pop_count; ++count) {
+
+      batch.push_back(std::move(queue_.front()));
+      queue_.pop();
+
+    }
+
+    queue_size_ -= pop_count;
+    queue_activity_ += pop_count;
+    dequeued_.add(pop_count);
+    size_gauge_.set(queue_size_);
+
+    bool flood_tide{false};
+    if (queue_tidal_state_ == QueueTidalState::EBB_TIDE and queue_size_ <= low_tide_) {
+
+      queue_tidal_state_ = QueueTidalState::FLOOD_TIDE;
+      flood_tide = true;
+
+    }
+
+    lock.unlock();  // ~Mutex
+
+    // All blocked producers can resume at flood tide.
+    if (flood_tide) {
+
+      tide_cond_.notify_all();
+
+    }
+
+    return batch;
+
+  }
+
   void clear() {
 
     { // Mutex
@@ -140,6 +279,7 @@ public:
       std::scoped_lock<std::mutex> lock(queue_mutex_);
       queue_ = {};
       queue_size_ = 0;
+      size_gauge_.set(0);
       queue_tidal_state_ = QueueTidalState::FLOOD_TIDE;
 
     } // ~Mutex
@@ -158,6 +298,9 @@ public:
 
   [[nodiscard]] size_t highTide() const { return high_tide_; }
   [[nodiscard]] size_t lowTide() const { return low_tide_; }
+  // Cumulative time producers were blocked at high tide and consumers were blocked on an empty queue.
+  [[nodiscard]] std::chrono::nanoseconds pushStallTime() const { return std::chrono::nanoseconds(push_stall_.value()); }
+  [[nodiscard]] std::chrono::nanoseconds popStallTime() const { return std::chrono::nanoseconds(pop_stall_.value()); }
 
 private:
 
@@ -165,6 +308,17 @@ private:
   const size_t high_tide_;
   const size_t low_tide_;
 
+  // Runtime metrics, updated by the queue and exported by the MetricsRegistry.
+  constexpr static const char* METRICS_TYPE_{"queue"};
+  constexpr static const char* METRICS_NAME_{"QueueTidal"};
+  std::shared_ptr<MetricSet> metrics_ptr_;
+  MetricCounter& enqueued_{metrics_ptr_->counter("enqueued_total")};
+  MetricCounter& dequeued_{metrics_ptr_->counter("dequeued_total")};
+  MetricCounter& high_tide_events_{metrics_ptr_->counter("high_tide_total")};
+  MetricCounter& push_stall_{metrics_ptr_->counter("push_stall_nanoseconds_total")};
+  MetricCounter& pop_stall_{metrics_ptr_->counter("pop_stall_nanoseconds_total")};
+  MetricGauge& size_gauge_{metrics_ptr_->gauge("size")};
+
   // Actual queue implementation.
   std::queue<T> queue_;
 
@@ -0,0 +1,541 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_TASK_H
+#define KEL_TASK_H
+
+#include "kel_executor.h"
+#include "kel_workflow_threads.h"
+#include "kel_exec_env.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+
+namespace kellerberrin {  //  organization level namespace
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Coroutine tasks scheduled on the process-wide Executor.
+//
+// A Task<T> is a lazily started coroutine, it runs when it is awaited (co_await task) and
+// the awaiting coroutine is resumed with the task result when the task completes. A task
+// waiting for another task, for a group of tasks (whenAll) or for a file read (readFile)
+// is suspended and does not occupy an executor thread while it waits. Dependent parallel
+// steps can therefore be chained and nested without blocking pool threads (as waiting on
+// a std::future does) and without creating additional threads.
+//
+// co_await TaskScheduler::schedule() moves the running coroutine onto an executor thread.
+// TaskScheduler::spawn(f, args...) returns a task that calls f(args...) on an executor
+// thread, the arguments are copied into the coroutine frame.
+// TaskScheduler::whenAll(tasks) starts all the tasks and completes when they have all
+// completed, returning the results in task order.
+// TaskScheduler::readFile(file_name) reads a file on a dedicated IO thread and resumes the
+// awaiting coroutine on the executor.
+// TaskScheduler::syncWait(task) is called from a thread that is not an executor thread
+// (the main thread) to run a task and wait for the result.
+//
+// An exception thrown by a task is rethrown to the awaiting coroutine, whenAll() waits
+// for all tasks to complete and then rethrows the first exception.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+
+template<typename T = void>
+class Task;
+
+
+// The promise functionality shared by value and void tasks.
+class TaskPromiseBase {
+
+public:
+
+  TaskPromiseBase() = default;
+  ~TaskPromiseBase() = default;
+
+  // Resumes the awaiting coroutine on completion.
+  struct FinalAwaiter {
+
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+    template<typename Promise>
+    [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept { return handle.promise().continuation_; }
+    void await_resume() const noexcept {}
+
+  };
+
+  // Tasks are lazily started.
+  [[nodiscard]] std::suspend_always initial_suspend() const noexcept { return {}; }
+  [[nodiscard]] FinalAwaiter final_suspend() const noexcept { return {}; }
+  void unhandled_exception() noexcept { exception_ = std::current_exception(); }
+
+  void setContinuation(std::coroutine_handle<> continuation) { continuation_ = continuation; }
+
+protected:
+
+  void rethrowException() const { if (exception_) std::rethrow_exception(exception_); }
+
+private:
+
+  std::coroutine_handle<> continuation_{std::noop_coroutine()};
+  std::exception_ptr exception_;
+
+};
+
+
+template<typename T>
+class TaskPromise : public TaskPromiseBase {
+
+public:
+
+  void return_value(T value) { value_.emplace(std::move(value)); }
+
+  [[nodiscard]] T result() {
+
+    rethrowException();
+    return std::move(value_.value());
+
+  }
+
+private:
+
+  std::optional<T> value_;
+
+};
+
+
+template<>
+class TaskPromise<void> : public TaskPromiseBase {
+
+public:
+
+  void return_void() const noexcept {}
+
+  void result() const { rethrowException(); }
+
+};
+
+
+template<typename T>
+class [[nodiscard]] Task {
+
+public:
+
+  struct promise_type : public TaskPromise<T> {
+
+    [[nodiscard]] Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+  };
+
+  using ResultType = T;
+
+  Task() = default;
+  Task(Task&& task) noexcept : handle_(std::exchange(task.handle_, nullptr)) {}
+  Task(const Task&) = delete;
+  ~Task() { if (handle_) handle_.destroy(); }
+
+  Task& operator=(Task&& task) noexcept {
+
+    if (this != &task) {
+
+      if (handle_) handle_.destroy();
+      handle_ = std::exchange(task.handle_, nullptr);
+
+    }
+    return *this;
+
+  }
+  Task& operator=(const Task&) = delete;
+
+  [[nodiscard]] bool valid() const { return static_cast<bool>(handle_); }
+
+  // Starts the task and suspends the awaiting coroutine until the task completes.
+  [[nodiscard]] auto operator co_await() const noexcept {
+
+    struct TaskAwaiter {
+
+      std::coroutine_handle<promise_type> handle_;
+
+      [[nodiscard]] bool await_ready() const noexcept { return not handle_ or handle_.done(); }
+      [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) const noexcept {
+
+        handle_.promise().setContinuation(awaiting);
+        return handle_;
+
+      }
+      T await_resume() const { return handle_.promise().result(); }
+
+    };
+
+    return TaskAwaiter{handle_};
+
+  }
+
+private:
+
+  std::coroutine_handle<promise_type> handle_;
+
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// Schedules tasks on the process-wide Executor.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+class TaskScheduler {
+
+  // Counts task completions, the final arrival resumes the continuation.
+  class TaskLatch {
+
+  public:
+
+    explicit TaskLatch(size_t count) : count_(count) {}
+    TaskLatch(const TaskLatch&) = delete;
+    ~TaskLatch() = default;
+
+    TaskLatch& operator=(const TaskLatch&) = delete;
+
+    // Returns true for the final arrival.
+    [[nodiscard]] bool arrive() { return count_.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+    void setContinuation(std::coroutine_handle<> continuation) { continuation_ = continuation; }
+    [[nodiscard]] std::coroutine_handle<> continuation() const { return continuation_; }
+
+    // Only the first exception is kept.
+    void setException(std::exception_ptr exception) {
+
+      if (not exception_set_.exchange(true, std::memory_order_acq_rel)) {
+
+        exception_ = std::move(exception);
+
+      }
+
+    }
+    void rethrowException() const { if (exception_) std::rethrow_exception(exception_); }
+
+    // Used by syncWait() to block a thread that is not a coroutine.
+    // The flag is set under the mutex so the waiting thread cannot destroy the latch during complete().
+    void complete() {
+
+      std::lock_guard<std::mutex> lock(complete_mutex_);
+      complete_ = true;
+      complete_condition_.notify_all();
+
+    }
+    void wait() {
+
+      std::unique_lock<std::mutex> lock(complete_mutex_);
+      complete_condition_.wait(lock, [this]()->bool { return complete_; });
+
+    }
+
+  private:
+
+    std::atomic<size_t> count_;
+    std::coroutine_handle<> continuation_{std::noop_coroutine()};
+    std::atomic<bool> exception_set_{false};
+    std::exception_ptr exception_;
+    std::mutex complete_mutex_;
+    std::condition_variable complete_condition_;
+    bool complete_{false};
+
+  };
+
+  // Awaits a task and arrives at a latch on completion. Exceptions are passed to the latch.
+  class CompletionTask {
+
+  public:
+
+    struct promise_type {
+
+      TaskLatch* latch_{nullptr};
+
+      struct FinalAwaiter {
+
+        [[nodiscard]] bool await_ready() const noexcept { return false; }
+        [[nodiscard]] std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) const noexcept {
+
+          TaskLatch& latch = *handle.promise().latch_;
+          if (latch.arrive()) {
+
+            // The latch (and this frame) may be destroyed by a waiting thread after complete().
+            std::coroutine_handle<> continuation = latch.continuation();
+            latch.complete();
+            return continuation;
+
+          }
+
+          return std::noop_coroutine();
+
+        }
+        void await_resume() const noexcept {}
+
+      };
+
+      [[nodiscard]] CompletionTask get_return_object() { return CompletionTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+      [[nodiscard]] std::suspend_always initial_suspend() const noexcept { return {}; }
+      [[nodiscard]] FinalAwaiter final_suspend() const noexcept { return {}; }
+      void return_void() const noexcept {}
+      void unhandled_exception() const noexcept { latch_->setException(std::current_exception()); }
+
+    };
+
+    CompletionTask(CompletionTask&& task) noexcept : handle_(std::exchange(task.handle_, nullptr)) {}
+    CompletionTask(const CompletionTask&) = delete;
+    ~CompletionTask() { if (handle_) handle_.destroy(); }
+
+    CompletionTask& operator=(const CompletionTask&) = delete;
+
+    void start(TaskLatch& latch) {
+
+      handle_.promise().latch_ = &latch;
+      handle_.resume();
+
+    }
+
+  private:
+
+    std::coroutine_handle<promise_type> handle_;
+
+    explicit CompletionTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+  };
+
+  // Starts the completion tasks and suspends until they have all arrived at the latch.
+  class WhenAllAwaiter {
+
+  public:
+
+    WhenAllAwaiter(TaskLatch& latch, std::vector<CompletionTask>& completion_tasks) : latch_(latch), completion_tasks_(completion_tasks) {}
+
+    [[nodiscard]] bool await_ready() const noexcept { return completion_tasks_.empty(); }
+    [[nodiscard]] bool await_suspend(std::coroutine_handle<> awaiting) {
+
+      latch_.setContinuation(awaiting);
+      for (auto& completion_task : completion_tasks_) {
+
+        completion_task.start(latch_);
+
+      }
+
+      // The awaiting coroutine is resumed immediately if all the tasks have already completed.
+      return not latch_.arrive();
+
+    }
+    void await_resume() const noexcept {}
+
+  private:
+
+    TaskLatch& latch_;
+    std::vector<CompletionTask>& completion_tasks_;
+
+  };
+
+  // Reads the file on an IO thread and then resumes the awaiting coroutine on the executor.
+  class FileReadAwaiter {
+
+  public:
+
+    explicit FileReadAwaiter(const std::string& file_name) : file_name_(file_name) {}
+
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> awaiting) {
+
+      ioThreads().enqueueVoid([this, awaiting]() {
+
+        file_contents_ = readContents(file_name_);
+        Executor::enqueueVoid([awaiting]() { awaiting.resume(); });
+
+      });
+
+    }
+    [[nodiscard]] std::optional<std::string> await_resume() { return std::move(file_contents_); }
+
+  private:
+
+    const std::string& file_name_;
+    std::optional<std::string> file_contents_;
+
+  };
+
+  // Void task results are held as std::monostate.
+  template<typename T>
+  using ResultStore = std::optional<std::conditional_t<std::is_void_v<T>, std::monostate, T>>;
+
+public:
+
+  TaskScheduler() = delete;
+  ~TaskScheduler() = delete;
+
+  // co_await schedule() resumes the awaiting coroutine on an executor thread.
+  [[nodiscard]] static auto schedule() noexcept {
+
+    struct ScheduleAwaiter {
+
+      [[nodiscard]] bool await_ready() const noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> awaiting) const { Executor::enqueueVoid([awaiting]() { awaiting.resume(); }); }
+      void await_resume() const noexcept {}
+
+    };
+
+    return ScheduleAwaiter{};
+
+  }
+
+  // A task that calls f(args...) on an executor thread, the arguments are copied into the task.
+  template<typename F, typename... Args>
+  requires std::invocable<F&, Args&...>
+  [[nodiscard]] static Task<std::invoke_result_t<F&, Args&...>> spawn(F f, Args... args) {
+
+    co_await schedule();
+    co_return std::invoke(f, args...);
+
+  }
+
+  // Runs the tasks concurrently and returns the results in task order.
+  template<typename T>
+  requires (not std::is_void_v<T>)
+  [[nodiscard]] static Task<std::vector<T>> whenAll(std::vector<Task<T>> tasks) {
+
+    std::vector<ResultStore<T>> results(tasks.size());
+    TaskLatch latch(tasks.size() + 1);
+    std::vector<CompletionTask> completion_tasks;
+    completion_tasks.reserve(tasks.size());
+    for (size_t index = 0; index < tasks.size(); ++index) {
+
+      completion_tasks.push_back(completeTask(std::move(tasks[index]), results[index]));
+
+    }
+
+    co_await WhenAllAwaiter(latch, completion_tasks);
+    latch.rethrowException();
+
+    std::vector<T> values;
+    values.reserve(results.size());
+    for (auto& result : results) {
+
+      values.push_back(std::move(result.value()));
+
+    }
+
+    co_return values;
+
+  }
+
+  static Task<> whenAll(std::vector<Task<>> tasks) {
+
+    std::vector<ResultStore<void>> results(tasks.size());
+    TaskLatch latch(tasks.size() + 1);
+    std::vector<CompletionTask> completion_tasks;
+    completion_tasks.reserve(tasks.size());
+    for (size_t index = 0; index < tasks.size(); ++index) {
+
+      completion_tasks.push_back(completeTask(std::move(tasks[index]), results[index]));
+
+    }
+
+    co_await WhenAllAwaiter(latch, completion_tasks);
+    latch.rethrowException();
+
+  }
+
+  // Reads the entire file without occupying an executor thread, returns std::nullopt on error.
+  [[nodiscard]] static Task<std::optional<std::string>> readFile(std::string file_name) {
+
+    co_return co_await FileReadAwaiter(file_name);
+
+  }
+
+  // Runs the task and blocks the calling thread until it completes. Must not be called on an executor thread.
+  template<typename T>
+  static T syncWait(Task<T> task) {
+
+    ResultStore<T> result;
+    TaskLatch latch(1);
+    CompletionTask completion_task = completeTask(std::move(task), result);
+    completion_task.start(latch);
+    latch.wait();
+    latch.rethrowException();
+
+    if constexpr (not std::is_void_v<T>) {
+
+      return std::move(result.value());
+
+    }
+
+  }
+
+private:
+
+  constexpr static const size_t IO_THREADS_{2};
+
+  // Created on first use.
+  [[nodiscard]] static WorkflowThreads& ioThreads() {
+
+    static WorkflowThreads io_threads(IO_THREADS_);
+    return io_threads;
+
+  }
+
+  [[nodiscard]] static std::optional<std::string> readContents(const std::string& file_name) {
+
+    std::ifstream file(file_name, std::ios::in | std::ios::binary);
+    if (not file.good()) {
+
+      ExecEnv::log().error("TaskScheduler::readFile; unable to open file: {}", file_name);
+      return std::nullopt;
+
+    }
+
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    if (file.bad()) {
+
+      ExecEnv::log().error("TaskScheduler::readFile; error reading file: {}", file_name);
+      return std::nullopt;
+
+    }
+
+    return std::move(contents).str();
+
+  }
+
+  template<typename T>
+  [[nodiscard]] static CompletionTask completeTask(Task<T> task, ResultStore<T>& result) {
+
+    if constexpr (std::is_void_v<T>) {
+
+      co_await task;
+      result.emplace();
+
+    } else {
+
+      result.emplace(co_await task);
+
+    }
+
+  }
+
+};
+
+
+} // namespace
+
+
+#endif //KEL_TASK_H
@@ -6,6 +6,7 @@
 
 #include "kel_queue_mt_safe.h"
 #include "kel_queue_tidal.h"
+#include "kel_queue_ring.h"
 
 #include <functional>
 #include <vector>
@@ -27,7 +28,7 @@ namespace kellerberrin {  //  organization level namespace
 
 // The objects must be std::move constructable. In addition, the objects should be comparable
 // to enable the detection of a stop token placed on the workflow queue.
-// The object queue can be specified as QueueMtSafe (unbounded) or QueueTidal (bounded tidal).
+// The object queue can be specified as QueueMtSafe (unbounded), QueueTidal (bounded tidal) or QueueRing (lock-free bounded tidal).
 template<typename QueuedObj, template <typename> typename Queue = QueueMtSafe>
 requires (std::move_constructible<QueuedObj> && std::equality_comparable<QueuedObj>)
 class WorkflowAsync
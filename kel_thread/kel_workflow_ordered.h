@@ -0,0 +1,352 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_WORKFLOW_ORDERED_H
+#define KEL_WORKFLOW_ORDERED_H
+
+
+#include "kel_queue_ring.h"
+#include "kel_metrics.h"
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace kellerberrin {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// An ordered pipeline with the same interface as WorkflowPipeline. InputObjects are transformed by a single supplied
+// function 'auto f(args..., InputObject)->OutputObject' using multiple threads and the OutputObjects are dequeued
+// in the same order as the InputObjects were enqueued.
+//
+// WorkflowPipeline preserves order by queueing a std::future for each object. Here each object is tagged with a
+// sequence number when it is enqueued, the worker threads take objects from a shared lock-free input queue
+// (QueueRing) and write each result directly to the slot of its sequence number in a bounded reorder buffer.
+// waitAndPop() returns the results in sequence order. There is no per object promise, future or heap allocated functor.
+//
+// The reorder buffer holds high tide slots (rounded up to a power of 2) and bounds the number of objects in the
+// pipeline, push() blocks until the slot of its sequence number has been dequeued. Since every enqueued object
+// has a slot, the worker threads never block writing results.
+//
+// push() and waitAndPop() are thread safe, objects are dequeued in sequence number order. As with WorkflowPipeline,
+// if single threads are used to Enqueue and Dequeue objects, then sequential ordering of input-output objects is
+// guaranteed.
+//
+// setActiveThreads() limits the worker threads processing objects, the remaining threads are parked. This is used
+// to rebalance threads between pipeline stages (PipelineBalancer).
+//
+// The pipeline registers a MetricSet (type "pipeline") with the MetricsRegistry, the object counts, the time blocked
+// on a full pipeline, the time waiting for the next object in sequence and the work function latency are exported.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+template<typename InputObject, typename OutputObject>
+requires std::move_constructible<InputObject> && std::move_constructible<OutputObject>
+class WorkflowOrdered {
+
+  using WorkflowFunc = std::move_only_function<OutputObject(InputObject)>;
+
+  // Input objects tagged with a sequence number, an empty input is the thread stop token.
+  struct SequencedInput {
+
+    size_t sequence_{0};
+    std::optional<InputObject> input_;
+
+  };
+
+  // The slot turn is (2 * sequence) when the slot is waiting for the result of the sequence
+  // and (2 * sequence + 1) when it holds the result.
+  struct ReorderSlot {
+
+    std::atomic<size_t> turn_{0};
+    std::optional<OutputObject> output_;
+
+  };
+
+public:
+
+  explicit WorkflowOrdered(size_t high_tide = HIGH_TIDE_, size_t low_tide = LOW_TIDE_, std::string pipeline_name = METRICS_NAME_)
+  : metrics_ptr_(MetricsRegistry::registerSource(METRICS_TYPE_, std::move(pipeline_name)))
+  , capacity_(std::bit_ceil(std::max<size_t>(high_tide, 1)))
+  , index_mask_(capacity_ - 1)
+  , reorder_slots_(std::make_unique<ReorderSlot[]>(capacity_))
+  , input_queue_(high_tide, low_tide) { resetSlots(); }
+  // The default queue parameters with a pipeline name for the exported metrics.
+  explicit WorkflowOrdered(std::string pipeline_name) : WorkflowOrdered(HIGH_TIDE_, LOW_TIDE_, std::move(pipeline_name)) {}
+  WorkflowOrdered(const WorkflowOrdered&) = delete;
+  ~WorkflowOrdered() { joinThreads(); }
+
+  WorkflowOrdered& operator=(const WorkflowOrdered&) = delete;
+
+  // Note that the variadic args... are presented to ALL active threads and must be thread safe (or made so).
+  // If the work function is a non-static class member then the first of the ...args should be a
+  // pointer (MyClass* this) to the class instance.
+  // The supplied function should be of the form 'auto f(args..., InputObject)->OutputObject'.
+  template<typename F, typename... Args>
+  bool activatePipeline(size_t threads, F&& f, Args&&... args)
+  {
+
+    // Clear any active threads.
+    joinThreads();
+
+    // The function is only called by the worker threads, which are started after it is assigned.
+    workflow_function_ = std::bind_front(std::forward<F>(f), std::forward<Args>(args)...);
+    // Re-populate the thread pool.
+    return queueThreads(threads);
+
+  }
+
+  [[nodiscard]] OutputObject waitAndPop() {
+
+    size_t sequence = pop_sequence_.fetch_add(1, std::memory_order_relaxed);
+    ReorderSlot& slot = reorder_slots_[sequence & index_mask_];
+
+    const size_t output_turn = (2 * sequence) + 1;
+    size_t turn = slot.turn_.load(std::memory_order_acquire);
+    if (turn != output_turn) {
+
+      // Time spent waiting for the next object in sequence.
+      auto stall_start = std::chrono::steady_clock::now();
+      while (turn != output_turn) {
+
+        slot.turn_.wait(turn, std::memory_order_acquire);
+        turn = slot.turn_.load(std::memory_order_acquire);
+
+      }
+      pop_stall_.addTime(std::chrono::steady_clock::now() - stall_start);
+
+    }
+
+    OutputObject output(std::move(slot.output_.value()));
+    slot.output_.reset();
+    // The slot is now available to the object enqueued capacity_ objects later.
+    slot.turn_.store(2 * (sequence + capacity_), std::memory_order_release);
+    slot.turn_.notify_all();
+    output_count_.add();
+
+    return output;
+
+  }
+
+  void push(InputObject input_object) {
+
+    size_t sequence = push_sequence_.fetch_add(1, std::memory_order_relaxed);
+    ReorderSlot& slot = reorder_slots_[sequence & index_mask_];
+
+    // Wait until the object enqueued capacity_ objects earlier has been dequeued.
+    const size_t input_turn = 2 * sequence;
+    size_t turn = slot.turn_.load(std::memory_order_acquire);
+    if (turn != input_turn) {
+
+      // Time spent blocked on a full pipeline.
+      auto stall_start = std::chrono::steady_clock::now();
+      while (turn != input_turn) {
+
+        slot.turn_.wait(turn, std::memory_order_acquire);
+        turn = slot.turn_.load(std::memory_order_acquire);
+
+      }
+      push_stall_.addTime(std::chrono::steady_clock::now() - stall_start);
+
+    }
+
+    input_queue_.push(SequencedInput{sequence, std::move(input_object)});
+    input_count_.add();
+
+  }
+
+  // Not thread safe, the pipeline is stopped and all queued objects are discarded.
+  void clear() {
+
+    joinThreads();
+    input_queue_.clear();
+    resetSlots();
+
+  }
+
+  // Thread safe, threads above the active limit are parked after processing their current object.
+  void setActiveThreads(size_t active_threads) {
+
+    std::lock_guard<std::mutex> lock(active_mutex_);
+    if (stopping_) {
+
+      return;
+
+    }
+    active_threads_.store(std::max<size_t>(active_threads, 1), std::memory_order_release);
+    active_threads_.notify_all();
+
+  }
+  // Not thread safe, the worker threads started by activatePipeline().
+  [[nodiscard]] size_t threadCount() const { return threads_.size(); }
+  // The fraction of the pipeline capacity held by objects waiting for a worker thread.
+  [[nodiscard]] double inputOccupancy() const { return static_cast<double>(input_queue_.size()) / static_cast<double>(capacity_); }
+  // The fraction of the pipeline capacity held by objects being processed or waiting to be dequeued.
+  [[nodiscard]] double outputOccupancy() const {
+
+    size_t in_pipeline = push_sequence_.load(std::memory_order_relaxed) - pop_sequence_.load(std::memory_order_relaxed);
+    size_t waiting = std::min(input_queue_.size(), in_pipeline);
+    return static_cast<double>(in_pipeline - waiting) / static_cast<double>(capacity_);
+
+  }
+
+  // Access queue stats.
+  [[nodiscard]] const QueueRing<SequencedInput>& inputQueue() const { return input_queue_; }
+  // Cumulative time producers were blocked on a full pipeline and consumers waited for the next object in sequence.
+  [[nodiscard]] std::chrono::nanoseconds pushStallTime() const { return std::chrono::nanoseconds(push_stall_.value()); }
+  [[nodiscard]] std::chrono::nanoseconds popStallTime() const { return std::chrono::nanoseconds(pop_stall_.value()); }
+
+private:
+
+  // The default tidal IO queue parameters.
+  static constexpr const size_t HIGH_TIDE_{10000};          // Maximum objects in the pipeline.
+  static constexpr const size_t LOW_TIDE_{2000};            // Low water mark of the input queue.
+
+  // Runtime metrics, updated by the pipeline and exported by the MetricsRegistry.
+  constexpr static const char* METRICS_TYPE_{"pipeline"};
+  constexpr static const char* METRICS_NAME_{"WorkflowOrdered"};
+  std::shared_ptr<MetricSet> metrics_ptr_;
+  MetricCounter& input_count_{metrics_ptr_->counter("input_total")};
+  MetricCounter& output_count_{metrics_ptr_->counter("output_total")};
+  MetricCounter& push_stall_{metrics_ptr_->counter("push_stall_nanoseconds_total")};
+  MetricCounter& pop_stall_{metrics_ptr_->counter("pop_stall_nanoseconds_total")};
+  MetricHistogram& stage_latency_{metrics_ptr_->histogram("stage_latency_seconds")};
+
+  const size_t capacity_;
+  const size_t index_mask_;
+  std::unique_ptr<ReorderSlot[]> reorder_slots_;
+  // Producer and consumer sequence numbers are on separate cache lines.
+  alignas(64) std::atomic<size_t> push_sequence_{0};
+  alignas(64) std::atomic<size_t> pop_sequence_{0};
+  // Sequenced input objects waiting for a worker thread.
+  QueueRing<SequencedInput> input_queue_;
+  // Thread Pool.
+  std::vector<std::thread> threads_;
+  // Threads with an index at or above the active limit are parked.
+  std::atomic<size_t> active_threads_{std::numeric_limits<size_t>::max()};
+  std::mutex active_mutex_;
+  bool stopping_{false};
+  // The supplied processing function, shared by all threads.
+  WorkflowFunc workflow_function_;
+
+
+  void threadProlog(size_t thread_index) {
+
+    // Stage latencies are published to the shared histogram in batches.
+    MetricHistogramBuffer stage_buffer(stage_latency_);
+    while(true)
+    {
+
+      size_t active_threads = active_threads_.load(std::memory_order_acquire);
+      while (thread_index >= active_threads) {
+
+        stage_buffer.publish();
+        active_threads_.wait(active_threads, std::memory_order_acquire);
+        active_threads = active_threads_.load(std::memory_order_acquire);
+
+      }
+
+      // Publish the buffered latencies before the thread waits for input.
+      if (input_queue_.empty()) {
+
+        stage_buffer.publish();
+
+      }
+
+      SequencedInput sequenced_input = input_queue_.waitAndPop();
+
+      if (not sequenced_input.input_) {
+
+        input_queue_.push(std::move(sequenced_input));
+        break;
+
+      }
+
+      ReorderSlot& slot = reorder_slots_[sequenced_input.sequence_ & index_mask_];
+      {
+        MetricTimer stage_timer(stage_buffer);
+        slot.output_.emplace(workflow_function_(std::move(sequenced_input.input_.value())));
+      }
+      slot.turn_.store((2 * sequenced_input.sequence_) + 1, std::memory_order_release);
+      // Only issues a wake-up (system call) if a consumer is waiting on the slot.
+      slot.turn_.notify_all();
+
+    }
+
+  }
+
+  void joinThreads() {
+
+    // Release any parked threads, the active limit cannot be reduced while stopping.
+    {
+      std::lock_guard<std::mutex> lock(active_mutex_);
+      stopping_ = true;
+      active_threads_.store(std::numeric_limits<size_t>::max(), std::memory_order_release);
+      active_threads_.notify_all();
+    }
+
+    input_queue_.push(SequencedInput{});
+
+    for(auto& thread : threads_) {
+
+      thread.join();
+
+    }
+
+    threads_.clear();
+    input_queue_.clear();
+
+    std::lock_guard<std::mutex> lock(active_mutex_);
+    stopping_ = false;
+
+  }
+
+  bool queueThreads(size_t threads)
+  {
+
+    // Always have at least one worker thread queued.
+    threads = std::max<size_t>(threads, 1);
+
+    // Queue the worker threads,
+    for(size_t i = 0; i < threads; ++i) {
+
+      threads_.emplace_back(&WorkflowOrdered::threadProlog, this, i);
+
+    }
+
+    return true;
+
+  }
+
+  void resetSlots() {
+
+    for (size_t index = 0; index < capacity_; ++index) {
+
+      reorder_slots_[index].output_.reset();
+      reorder_slots_[index].turn_.store(2 * index, std::memory_order_relaxed);
+
+    }
+    push_sequence_.store(0, std::memory_order_relaxed);
+    pop_sequence_.store(0, std::memory_order_relaxed);
+
+  }
+
+};
+
+
+} // namespace
+
+
+#endif //KEL_WORKFLOW_ORDERED_H
@@ -7,6 +7,8 @@
 
 
 #include "kel_queue_tidal.h"
+#include "kel_queue_ring.h"
+#include "kel_metrics.h"
 
 #include <future>
 #include <vector>
@@ -14,6 +16,7 @@
 #include <thread>
 #include <fstream>
 #include <functional>
+#include <string>
 
 
 namespace kellerberrin {   //  organization::project level namespace
@@ -28,11 +31,14 @@ namespace kellerberrin {   //  organization::project level namespace
 // is not guaranteed if multiple threads are used to Enqueue and Dequeue.
 // Conversely, if single threads are used to Enqueue and Dequeue objects, then sequential ordering of input-output
 // objects is guaranteed.
+// The input and output queues are bounded tidal queues, either QueueTidal (mutex) or QueueRing (lock-free).
+// The pipeline registers a MetricSet (type "pipeline") with the MetricsRegistry, the object counts and the work
+// function latency are exported.
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
-template<typename InputObject, typename OutputObject>
+template<typename InputObject, typename OutputObject, template <typename> typename Queue = QueueTidal>
 requires std::move_constructible<InputObject> && std::move_constructible<OutputObject>
 class WorkflowPipeline {
 
@@ -62,7 +68,10 @@ class WorkflowPipeline {
 
 public:
 
-  explicit WorkflowPipeline(size_t high_tide = HIGH_TIDE_, size_t low_tide = LOW_TIDE_) : high_tide_(high_tide), low_tide_(low_tide) {}
+  explicit WorkflowPipeline(size_t high_tide = HIGH_TIDE_, size_t low_tide = LOW_TIDE_, std::string pipeline_name = METRICS_NAME_)
+  : high_tide_(high_tide), low_tide_(low_tide), metrics_ptr_(MetricsRegistry::registerSource(METRICS_TYPE_, std::move(pipeline_name))) {}
+  // The default queue parameters with a pipeline name for the exported metrics.
+  explicit WorkflowPipeline(std::string pipeline_name) : WorkflowPipeline(HIGH_TIDE_, LOW_TIDE_, std::move(pipeline_name)) {}
   ~WorkflowPipeline() { joinThreads(); }
 
   // Note that the variadic args... are presented to ALL active threads and must be thread safe (or made so).
@@ -87,6 +96,7 @@ public:
   [[nodiscard]] OutputObject waitAndPop() {
 
     auto future_output = output_queue_.waitAndPop();
+    output_count_.add();
     return future_output.get();
 
   }
@@ -97,6 +107,7 @@ public:
     auto future = func_ptr->getFuture();
     input_queue_.push(std::move(func_ptr));
     output_queue_.push(std::move(future));
+    input_count_.add();
 
   }
 
@@ -108,8 +119,8 @@ public:
 
   }
   // Access queue stats.
-  [[nodiscard]] const QueueTidal<std::future<OutputObject>>& outputQueue() const { return output_queue_; }
-  [[nodiscard]] const QueueTidal<std::unique_ptr<QueuedFunctor>>& inputQueue() const { return input_queue_; }
+  [[nodiscard]] const Queue<std::future<OutputObject>>& outputQueue() const { return output_queue_; }
+  [[nodiscard]] const Queue<std::unique_ptr<QueuedFunctor>>& inputQueue() const { return input_queue_; }
 
 private:
 
@@ -118,10 +129,17 @@ private:
   static constexpr const size_t LOW_TIDE_{2000};            // Low water mark to begin queueing data records
   size_t high_tide_{HIGH_TIDE_};
   size_t low_tide_{LOW_TIDE_};
+  // Runtime metrics, updated by the pipeline and exported by the MetricsRegistry.
+  constexpr static const char* METRICS_TYPE_{"pipeline"};
+  constexpr static const char* METRICS_NAME_{"WorkflowPipeline"};
+  std::shared_ptr<MetricSet> metrics_ptr_;
+  MetricCounter& input_count_{metrics_ptr_->counter("input_total")};
+  MetricCounter& output_count_{metrics_ptr_->counter("output_total")};
+  MetricHistogram& stage_latency_{metrics_ptr_->histogram("stage_latency_seconds")};
   // Tidal queue holds buffered output objects.
-  QueueTidal<std::future<OutputObject>> output_queue_{high_tide_, low_tide_};
+  Queue<std::future<OutputObject>> output_queue_{high_tide_, low_tide_};
   // Tidal queue holds buffered input objects.
-  QueueTidal<std::unique_ptr<QueuedFunctor>> input_queue_{high_tide_, low_tide_};
+  Queue<std::unique_ptr<QueuedFunctor>> input_queue_{high_tide_, low_tide_};
   // Thread Pool.
   std::vector<std::thread> threads_;
   // The supplied processing function held in the std::MoveFunction functional object.
@@ -130,9 +148,18 @@ private:
 
   void threadProlog() {
 
+    // Stage latencies are published to the shared histogram in batches.
+    MetricHistogramBuffer stage_buffer(stage_latency_);
     while(true)
     {
 
+      // Publish the buffered latencies before the thread waits for input.
+      if (input_queue_.empty()) {
+
+        stage_buffer.publish();
+
+      }
+
       auto functor_ptr = input_queue_.waitAndPop();
 
       if (not functor_ptr) {
@@ -142,6 +169,7 @@ private:
 
       }
 
+      MetricTimer stage_timer(stage_buffer);
       (*functor_ptr)();
 
     }
@@ -0,0 +1,431 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_WORKFLOW_STEALING_H
+#define KEL_WORKFLOW_STEALING_H
+
+#include "kel_workflow_threads.h"
+
+#include <functional>
+#include <future>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <random>
+#include <memory>
+#include <cstddef>
+
+
+namespace kellerberrin {  //  organization level namespace
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// A move only, type erased void() task. Small callables (a packaged task or a bound member
+// function and a few arguments) are stored inline, larger callables are heap allocated.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+class WorkTask
+{
+
+public:
+
+  WorkTask() = default;
+
+  template<typename F>
+  requires (not std::same_as<std::decay_t<F>, WorkTask>) && std::invocable<std::decay_t<F>&>
+  explicit WorkTask(F&& f)
+  {
+
+    using Callable = std::decay_t<F>;
+    if constexpr (sizeof(Callable) <= INLINE_SIZE_
+                  and alignof(Callable) <= alignof(std::max_align_t)
+                  and std::is_nothrow_move_constructible_v<Callable>) {
+
+      ::new (static_cast<void*>(storage_)) Callable(std::forward<F>(f));
+      operations_ = &inline_operations_<Callable>;
+
+    } else {
+
+      ::new (static_cast<void*>(storage_)) Callable*(new Callable(std::forward<F>(f)));
+      operations_ = &heap_operations_<Callable>;
+
+    }
+
+  }
+  WorkTask(WorkTask&& task) noexcept { moveFrom(task); }
+  WorkTask(const WorkTask&) = delete;
+  ~WorkTask() { reset(); }
+
+  WorkTask& operator=(WorkTask&& task) noexcept {
+
+    if (this != &task) {
+
+      reset();
+      moveFrom(task);
+
+    }
+
+    return *this;
+
+  }
+  WorkTask& operator=(const WorkTask&) = delete;
+
+  [[nodiscard]] explicit operator bool() const { return operations_ != nullptr; }
+  void operator()() { operations_->invoke(storage_); }
+
+private:
+
+  struct Operations {
+
+    void (*invoke)(void* storage);
+    void (*move)(void* target, void* source) noexcept;
+    void (*destroy)(void* storage) noexcept;
+
+  };
+
+  template<typename Callable>
+  static constexpr const Operations inline_operations_{
+    [](void* storage) { std::invoke(*static_cast<Callable*>(storage)); },
+    [](void* target, void* source) noexcept { ::new (target) Callable(std::move(*static_cast<Callable*>(source)));
+                                              static_cast<Callable*>(source)->~Callable(); },
+    [](void* storage) noexcept { static_cast<Callable*>(storage)->~Callable(); }
+  };
+
+  template<typename Callable>
+  static constexpr const Operations heap_operations_{
+    [](void* storage) { std::invoke(**static_cast<Callable**>(storage)); },
+    [](void* target, void* source) noexcept { ::new (target) Callable*(*static_cast<Callable**>(source)); },
+    [](void* storage) noexcept { delete *static_cast<Callable**>(storage); }
+  };
+
+  // Together with the operations pointer the task occupies a single cache line.
+  constexpr static const size_t INLINE_SIZE_{48};
+
+  alignas(std::max_align_t) std::byte storage_[INLINE_SIZE_];
+  const Operations* operations_{nullptr};
+
+  void moveFrom(WorkTask& task) noexcept {
+
+    operations_ = task.operations_;
+    if (operations_ != nullptr) {
+
+      operations_->move(storage_, task.storage_);
+      task.operations_ = nullptr;
+
+    }
+
+  }
+
+  void reset() noexcept {
+
+    if (operations_ != nullptr) {
+
+      operations_->destroy(storage_);
+      operations_ = nullptr;
+
+    }
+
+  }
+
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////
+//
+// A work stealing thread pool with the same interface as WorkflowThreads.
+// Callers can switch between the two pools by changing the pool type.
+//
+// Each worker thread has a task queue. Tasks enqueued by a worker (nested tasks) are pushed
+// onto the worker's own queue, tasks enqueued by other threads are distributed round-robin
+// across the worker queues. Workers execute tasks from their own queue in FIFO order and,
+// when their queue is empty, steal the oldest task from another worker queue starting at a
+// random worker. Idle workers spin briefly and then sleep until a task is enqueued.
+// A worker only sleeps when all queues are empty, so (as with WorkflowThreads) a queued task
+// always runs if any worker is idle.
+//
+// Tasks are stored by value in the queues with small-task inline storage (WorkTask), so
+// enqueueVoid() does not allocate for small callables.
+//
+// joinThreads() completes all queued tasks before returning. Tasks enqueued before
+// queueThreads() are held until the threads are started. queueThreads() and joinThreads()
+// must not be called concurrently with the enqueue functions.
+//
+///////////////////////////////////////////////////////////////////////////////////////////
+
+class WorkStealingThreads
+{
+
+public:
+
+  WorkStealingThreads() = default;
+  explicit WorkStealingThreads(size_t threads) { queueThreads(threads); }
+  WorkStealingThreads(const WorkStealingThreads&) = delete;
+  ~WorkStealingThreads() { joinThreads(); }
+
+  WorkStealingThreads& operator=(const WorkStealingThreads&) = delete;
+
+  // Convenience routines, default is available hardware threads minus 1, minimum 1 thread.
+  [[nodiscard]] static size_t defaultThreads() { return WorkflowThreads::defaultThreads(); }
+  [[nodiscard]] static size_t defaultThreads(size_t job_size) { return WorkflowThreads::defaultThreads(job_size); }
+
+
+  // A task is a work function and associated arguments. Tasks can be heterogeneous.
+  // Returns a std::future holding the work function return value.
+  // Note that any exceptions thrown by the work function will also be returned in the std::future and
+  // can be captured enclosing the external future.get() in a try/catch block.
+  template<typename F, typename... Args>
+  requires std::invocable<F, Args...> && move_constructable_variadic<Args...>
+  [[nodiscard]] auto enqueueFuture(F&& f,  Args&&... args) -> std::future<std::invoke_result_t<F, Args...>>
+  {
+
+    using return_type = std::invoke_result_t<F, Args...>;
+
+    auto callable = std::bind_front(std::forward<F>(f), std::forward<Args>(args)...);
+    auto task = std::packaged_task<return_type()>(std::move(callable));
+    std::future<return_type> future = task.get_future();
+    submitTask(WorkTask(std::move(task)));
+
+    return future;
+
+  }
+
+  // Assumes the work function has a void return type and therefore does not return a future.
+  template<typename F, typename... Args>
+  requires std::invocable<F, Args...> && move_constructable_variadic<Args...>
+  void enqueueVoid(F&& f, Args&&... args)
+  {
+
+    submitTask(WorkTask(std::bind_front(std::forward<F>(f), std::forward<Args>(args)...)));
+
+  }
+
+
+  // Complete all queued tasks and join the threads.
+  void joinThreads() {
+
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      stop_ = true;
+    }
+    sleep_condition_.notify_all();
+
+    for(auto& thread : threads_) {
+
+      thread.join();
+
+    }
+
+    threads_.clear();
+    worker_count_.store(0, std::memory_order_release);
+    worker_queues_.reset();
+    pending_tasks_.clear();
+    stop_ = false;
+
+  }
+
+  // This function is only valid if there are no active threads (threadCount() == 0).
+  bool queueThreads(size_t threads)
+  {
+
+    if (not threads_.empty()) {
+
+      return false;
+
+    }
+
+    // Always have at least one worker thread queued.
+    threads = std::max<size_t>(threads, 1);
+
+    worker_queues_ = std::make_unique<WorkerQueue[]>(threads);
+    {
+      // Distribute any tasks enqueued before the threads were started.
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      for (size_t index = 0; index < pending_tasks_.size(); ++index) {
+
+        worker_queues_[index % threads].tasks_.push_back(std::move(pending_tasks_[index]));
+
+      }
+      queued_tasks_.fetch_add(pending_tasks_.size());
+      pending_tasks_.clear();
+    }
+    worker_count_.store(threads, std::memory_order_release);
+
+    for(size_t index = 0; index < threads; ++index) {
+
+      threads_.emplace_back(&WorkStealingThreads::threadProlog, this, index);
+
+    }
+
+    return true;
+
+  }
+
+  [[nodiscard]] size_t threadCount() const { return threads_.size(); }
+
+  // The native thread handles, used to set thread affinity.
+  [[nodiscard]] std::vector<std::thread::native_handle_type> nativeHandles() {
+
+    std::vector<std::thread::native_handle_type> native_handles;
+    for (auto& thread : threads_) {
+
+      native_handles.push_back(thread.native_handle());
+
+    }
+
+    return native_handles;
+
+  }
+
+private:
+
+  // Worker queues are cache line aligned to avoid false sharing.
+  struct alignas(64) WorkerQueue {
+
+    std::mutex mutex_;
+    std::deque<WorkTask> tasks_;
+
+  };
+
+  std::vector<std::thread> threads_;
+  std::unique_ptr<WorkerQueue[]> worker_queues_;
+  std::atomic<size_t> worker_count_{0};
+  // Tasks enqueued before the threads are started.
+  std::vector<WorkTask> pending_tasks_;
+  // Total tasks held in the worker queues.
+  alignas(64) std::atomic<size_t> queued_tasks_{0};
+  alignas(64) std::atomic<size_t> submit_index_{0};
+  alignas(64) std::atomic<size_t> sleeping_workers_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_condition_;
+  bool stop_{false};
+
+  // The pool and worker index of the current thread, used to push nested tasks onto the worker queue.
+  inline static thread_local const WorkStealingThreads* current_pool_{nullptr};
+  inline static thread_local size_t current_worker_{0};
+
+  // Steal attempts (each a scan of all worker queues) before an idle worker sleeps.
+  constexpr static const size_t SPIN_COUNT_{64};
+
+  void submitTask(WorkTask&& task) {
+
+    size_t worker_count = worker_count_.load(std::memory_order_acquire);
+    if (worker_count == 0) {
+
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      pending_tasks_.push_back(std::move(task));
+      return;
+
+    }
+
+    size_t worker_index = current_pool_ == this ? current_worker_
+                                                : submit_index_.fetch_add(1, std::memory_order_relaxed) % worker_count;
+    WorkerQueue& worker_queue = worker_queues_[worker_index];
+    {
+      std::lock_guard<std::mutex> lock(worker_queue.mutex_);
+      worker_queue.tasks_.push_back(std::move(task));
+      queued_tasks_.fetch_add(1);
+    }
+
+    // A sleeping worker increments the count before checking for queued tasks, so a wake up cannot be lost.
+    if (sleeping_workers_.load() > 0) {
+
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      sleep_condition_.notify_one();
+
+    }
+
+  }
+
+  bool popTask(size_t worker_index, WorkTask& task) {
+
+    WorkerQueue& worker_queue = worker_queues_[worker_index];
+    std::lock_guard<std::mutex> lock(worker_queue.mutex_);
+    if (worker_queue.tasks_.empty()) {
+
+      return false;
+
+    }
+
+    task = std::move(worker_queue.tasks_.front());
+    worker_queue.tasks_.pop_front();
+    queued_tasks_.fetch_sub(1);
+
+    return true;
+
+  }
+
+  bool stealTask(size_t worker_index, std::minstd_rand& random, WorkTask& task) {
+
+    size_t worker_count = worker_count_.load(std::memory_order_acquire);
+    size_t victim = random() % worker_count;
+    for (size_t count = 0; count < worker_count; ++count, victim = (victim + 1) % worker_count) {
+
+      if (victim != worker_index and popTask(victim, task)) {
+
+        return true;
+
+      }
+
+    }
+
+    return false;
+
+  }
+
+  void threadProlog(size_t worker_index) {
+
+    current_pool_ = this;
+    current_worker_ = worker_index;
+    std::minstd_rand random(static_cast<std::minstd_rand::result_type>(worker_index + 1));
+
+    size_t idle_count{0};
+    while(true)
+    {
+
+      WorkTask task;
+      if (popTask(worker_index, task) or stealTask(worker_index, random, task)) {
+
+        idle_count = 0;
+        std::invoke(task);
+        continue;
+
+      }
+
+      if (++idle_count < SPIN_COUNT_ and queued_tasks_.load() > 0) {
+
+        std::this_thread::yield();
+        continue;
+
+      }
+
+      idle_count = 0;
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      sleeping_workers_.fetch_add(1);
+      sleep_condition_.wait(lock, [this]() { return queued_tasks_.load() > 0 or stop_; });
+      sleeping_workers_.fetch_sub(1);
+
+      // All queued tasks are completed before the thread exits.
+      if (stop_ and queued_tasks_.load() == 0) {
+
+        break;
+
+      }
+
+    }
+
+    current_pool_ = nullptr;
+
+  }
+
+};
+
+
+} // namespace
+
+
+#endif //KEL_WORKFLOW_STEALING_H
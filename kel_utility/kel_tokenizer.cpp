@@ -0,0 +1,279 @@
+// Copyright 2023 Kellerberrin
+//
+
+
+#include "kel_tokenizer.h"
+
+#include <array>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define KEL_TOKENIZER_X86 1
+#include <immintrin.h>
+#endif
+
+
+namespace kel = kellerberrin;
+
+
+namespace {   // Kernel implementation.
+
+// Byte scan, also scans the text tail that is shorter than a vector block.
+size_t scalarOffsets(std::string_view text, char delimiter, size_t& position, std::span<size_t> offsets, size_t count) {
+
+  while (position < text.size() and count < offsets.size()) {
+
+    if (text[position] == delimiter) {
+
+      offsets[count++] = position;
+
+    }
+    ++position;
+
+  }
+
+  return count;
+
+}
+
+
+#ifdef KEL_TOKENIZER_X86
+
+// SSE2 is part of the x86-64 base instruction set.
+size_t sse2Offsets(std::string_view text, char delimiter, size_t& position, std::span<size_t> offsets) {
+
+  constexpr const size_t BLOCK_SIZE{16};
+  const __m128i delimiter_block = _mm_set1_epi8(delimiter);
+  size_t count{0};
+
+  while (position + BLOCK_SIZE <= text.size() and count + BLOCK_SIZE <= offsets.size()) {
+
+    const __m128i text_block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + position));
+    auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(text_block, delimiter_block)));
+    while (mask != 0) {
+
+      offsets[count++] = position + __builtin_ctz(mask);
+      mask &= mask - 1;
+
+    }
+    position += BLOCK_SIZE;
+
+  }
+
+  if (position + BLOCK_SIZE > text.size()) {
+
+    count = scalarOffsets(text, delimiter, position, offsets, count);
+
+  }
+
+  return count;
+
+}
+
+
+__attribute__((target("avx2")))
+size_t avx2Offsets(std::string_view text, char delimiter, size_t& position, std::span<size_t> offsets) {
+
+  constexpr const size_t BLOCK_SIZE{32};
+  const __m256i delimiter_block = _mm256_set1_epi8(delimiter);
+  size_t count{0};
+
+  while (position + BLOCK_SIZE <= text.size() and count + BLOCK_SIZE <= offsets.size()) {
+
+    const __m256i text_block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + position));
+    auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(text_block, delimiter_block)));
+    while (mask != 0) {
+
+      offsets[count++] = position + __builtin_ctz(mask);
+      mask &= mask - 1;
+
+    }
+    position += BLOCK_SIZE;
+
+  }
+
+  if (position + BLOCK_SIZE > text.size()) {
+
+    count = scalarOffsets(text, delimiter, position, offsets, count);
+
+  }
+
+  return count;
+
+}
+
+#endif
+
+}   // end anonymous namespace
+
+
+kel::TokenizerKernel kel::FieldTokenizer::activeKernel() {
+
+#ifdef KEL_TOKENIZER_X86
+
+  static const TokenizerKernel active_kernel = __builtin_cpu_supports("avx2") ? TokenizerKernel::AVX2 : TokenizerKernel::SSE2;
+  return active_kernel;
+
+#else
+
+  return TokenizerKernel::SCALAR;
+
+#endif
+
+}
+
+
+std::string_view kel::FieldTokenizer::kernelName(TokenizerKernel kernel) {
+
+  switch (kernel) {
+
+    case TokenizerKernel::AVX2:
+      return "avx2";
+
+    case TokenizerKernel::SSE2:
+      return "sse2";
+
+    case TokenizerKernel::SCALAR:
+    default:
+      return "scalar";
+
+  }
+
+}
+
+
+size_t kel::FieldTokenizer::delimiterOffsets(TokenizerKernel kernel, std::string_view text, char delimiter, size_t& position, std::span<size_t> offsets) {
+
+#ifdef KEL_TOKENIZER_X86
+
+  // Never execute an unsupported instruction set.
+  if (kernel == TokenizerKernel::AVX2 and activeKernel() != TokenizerKernel::AVX2) {
+
+    kernel = TokenizerKernel::SSE2;
+
+  }
+
+  switch (kernel) {
+
+    case TokenizerKernel::AVX2:
+      return avx2Offsets(text, delimiter, position, offsets);
+
+    case TokenizerKernel::SSE2:
+      return sse2Offsets(text, delimiter, position, offsets);
+
+    case TokenizerKernel::SCALAR:
+    default:
+      return scalarOffsets(text, delimiter, position, offsets, 0);
+
+  }
+
+#else
+
+  return scalarOffsets(text, delimiter, position, offsets, 0);
+
+#endif
+
+}
+
+
+void kel::FieldTokenizer::tokenize(TokenizerKernel kernel, std::string_view text, char delimiter, std::vector<std::string_view>& fields) {
+
+  fields.clear();
+  std::array<size_t, TOKENIZE_OFFSETS_> offsets;
+  size_t field_begin{0};
+  size_t position{0};
+  while (position < text.size()) {
+
+    size_t count = delimiterOffsets(kernel, text, delimiter, position, offsets);
+    for (size_t index = 0; index < count; ++index) {
+
+      fields.emplace_back(text.substr(field_begin, offsets[index] - field_begin));
+      field_begin = offsets[index] + 1;
+
+    }
+
+  }
+
+  // The last field, empty if the text is empty or ends with a delimiter.
+  fields.emplace_back(text.substr(field_begin));
+
+}
+
+
+void kel::FieldTokenizer::selectFields(std::string_view text, char delimiter, std::span<const size_t> field_indices, std::vector<std::string_view>& fields) {
+
+  fields.clear();
+  if (field_indices.empty()) {
+
+    return;
+
+  }
+
+  std::array<size_t, TOKENIZE_OFFSETS_> offsets;
+  size_t select_index{0};
+  size_t field_index{0};
+  size_t field_begin{0};
+  size_t position{0};
+  while (position < text.size()) {
+
+    size_t count = delimiterOffsets(text, delimiter, position, offsets);
+    for (size_t index = 0; index < count; ++index) {
+
+      if (field_index == field_indices[select_index]) {
+
+        fields.emplace_back(text.substr(field_begin, offsets[index] - field_begin));
+        ++select_index;
+        if (select_index == field_indices.size()) {
+
+          return;
+
+        }
+
+      }
+      ++field_index;
+      field_begin = offsets[index] + 1;
+
+    }
+
+  }
+
+  // The last field is not delimited.
+  if (field_index == field_indices[select_index]) {
+
+    fields.emplace_back(text.substr(field_begin));
+
+  }
+
+}
+
+
+size_t kel::FieldTokenizer::leadingFields(std::string_view text, char delimiter, std::span<std::string_view> fields, size_t& remainder) {
+
+  // A minimum sized buffer limits the scan to a single vector block beyond the leading fields.
+  std::array<size_t, MINIMUM_OFFSETS_> offsets;
+  size_t field_count{0};
+  size_t field_begin{0};
+  size_t position{0};
+  while (field_count < fields.size() and position < text.size()) {
+
+    size_t count = delimiterOffsets(text, delimiter, position, offsets);
+    for (size_t index = 0; index < count and field_count < fields.size(); ++index) {
+
+      fields[field_count++] = text.substr(field_begin, offsets[index] - field_begin);
+      field_begin = offsets[index] + 1;
+
+    }
+
+  }
+
+  // The final field is not delimited.
+  if (field_count < fields.size()) {
+
+    fields[field_count++] = text.substr(field_begin);
+    field_begin = text.size();
+
+  }
+
+  remainder = field_begin;
+  return field_count;
+
+}
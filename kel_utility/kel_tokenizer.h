@@ -0,0 +1,74 @@
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KEL_TOKENIZER_H
+#define KEL_TOKENIZER_H
+
+#include <string_view>
+#include <vector>
+#include <span>
+#include <cstddef>
+
+
+namespace kellerberrin {   //  organization level namespace
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Vectorized delimiter scanning for the tab and colon delimited text parsers.
+// The kernel compares a block of text against the delimiter character and writes the offsets of the
+// delimiters found into a caller supplied buffer. The AVX2 (32 byte) kernel is selected at runtime if the CPU
+// supports it, otherwise the SSE2 (16 byte) kernel is used on x86-64 and a byte scan on other architectures.
+// The kernels return identical offsets and the tokenizers return identical fields to Utility::viewTokenizer().
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum class TokenizerKernel { SCALAR, SSE2, AVX2 };
+
+class FieldTokenizer {
+
+public:
+
+  FieldTokenizer() = delete;
+  ~FieldTokenizer() = delete;
+
+  // The offset buffer must be able to hold the delimiters of a complete vector block.
+  constexpr static const size_t MINIMUM_OFFSETS_{32};
+
+  // Scan the text from 'position' and write the offsets of any delimiter chars into the buffer.
+  // Returns the number of offsets written, 'position' is updated to the first unscanned char.
+  // The scan stops when the buffer cannot hold another vector block or the text is exhausted.
+  [[nodiscard]] static size_t delimiterOffsets(std::string_view text, char delimiter, size_t& position, std::span<size_t> offsets) {
+
+    return delimiterOffsets(activeKernel(), text, delimiter, position, offsets);
+
+  }
+  // As above with an explicit kernel, the kernel falls back to a supported kernel if not available (used by the benchmark).
+  [[nodiscard]] static size_t delimiterOffsets(TokenizerKernel kernel, std::string_view text, char delimiter, size_t& position, std::span<size_t> offsets);
+
+  // Tokenize the text into field views, the field vector is cleared and reused.
+  static void tokenize(std::string_view text, char delimiter, std::vector<std::string_view>& fields) { tokenize(activeKernel(), text, delimiter, fields); }
+  static void tokenize(TokenizerKernel kernel, std::string_view text, char delimiter, std::vector<std::string_view>& fields);
+
+  // Tokenize only the fields with the (ascending) field indices, the other fields are skipped and the scan stops
+  // after the last selected field. Indices beyond the last field are ignored. The field vector is cleared and reused.
+  static void selectFields(std::string_view text, char delimiter, std::span<const size_t> field_indices, std::vector<std::string_view>& fields);
+
+  // Tokenize only the leading fields of the text into a small fixed buffer. Returns the number of fields found.
+  // 'remainder' is set to the offset of the text following the delimiter of the last field (text.size() if none).
+  [[nodiscard]] static size_t leadingFields(std::string_view text, char delimiter, std::span<std::string_view> fields, size_t& remainder);
+
+  // The kernel selected for this CPU.
+  [[nodiscard]] static TokenizerKernel activeKernel();
+  [[nodiscard]] static std::string_view kernelName(TokenizerKernel kernel);
+
+private:
+
+  // Offset buffer used by the tokenizers.
+  constexpr static const size_t TOKENIZE_OFFSETS_{256};
+
+};
+
+
+}   // end namespace
+
+
+#endif //KEL_TOKENIZER_H
@@ -4,6 +4,7 @@
 
 #include "kel_utility.h"
 #include "kel_exec_env.h"
+#include "kel_tokenizer.h"
 
 #include <unistd.h>
 #include <ios>
@@ -241,6 +242,25 @@ std::string kel::Utility::trimEndWhiteSpace(const std::string &s) {
 }
 
 
+std::string_view kel::Utility::trimEndWhiteSpaceView(std::string_view view) {
+
+  while (not view.empty() and std::isspace(static_cast<unsigned char>(view.front()))) {
+
+    view.remove_prefix(1);
+
+  }
+
+  while (not view.empty() and std::isspace(static_cast<unsigned char>(view.back()))) {
+
+    view.remove_suffix(1);
+
+  }
+
+  return view;
+
+}
+
+
 std::string kel::Utility::findAndReplaceAll(const std::string& source, const std::string& search, const std::string& replace)
 {
 
@@ -266,31 +286,16 @@ std::string kel::Utility::findAndReplaceAll(const std::string& source, const std
 std::vector<std::string_view> kel::Utility::viewTokenizer(const std::string_view& str_view, char delim) {
 
   std::vector<std::string_view> token_vector;
-  size_t token_index{0};
-  size_t index{0};
+  viewTokenizer(str_view, delim, token_vector);
 
-  for (; index < str_view.size(); ++index) {
-
-    if (str_view[index] == delim) {
-
-      token_vector.emplace_back(&str_view[token_index], (index-token_index));
-      token_index = index + 1;
-
-    }
-
-  }
-
-  if (token_index > index) {
-
-    token_vector.emplace_back();
+  return token_vector;
 
-  } else {
+}
 
-    token_vector.emplace_back(&str_view[token_index], (index-token_index));
 
-  }
+void kel::Utility::viewTokenizer(const std::string_view& str_view, char delim, std::vector<std::string_view>& token_vector) {
 
-  return token_vector;
+  FieldTokenizer::tokenize(str_view, delim, token_vector);
 
 }
 
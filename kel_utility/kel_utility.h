@@ -41,9 +41,11 @@ public:
   [[nodiscard]] static std::string toupper(const std::string& s); // Covert to upper case.
   [[nodiscard]] static std::string trimAllWhiteSpace(const std::string &s); // Trim any whitespace in a string
   [[nodiscard]] static std::string trimEndWhiteSpace(const std::string &s); // Only trim whitespace at either end of the string.
+  [[nodiscard]] static std::string_view trimEndWhiteSpaceView(std::string_view view); // As above, returns a view of the argument (no copy).
   [[nodiscard]] static std::string trimAllChar(const std::string &s, char nc); // Returns a string with all nc char removed.
   [[nodiscard]] static std::string findAndReplaceAll(const std::string& source, const std::string& search, const std::string& replace);
   [[nodiscard]] static std::vector<std::string_view> viewTokenizer(const std::string_view& str_view, char delim); // Tokenize a string using delimiter chars, return std::string_view tokens.
+  static void viewTokenizer(const std::string_view& str_view, char delim, std::vector<std::string_view>& token_vector); // As above, the token vector is cleared and reused.
   [[nodiscard]] static std::vector<std::string> charTokenizer(const std::string_view& str_view, char delim); // Tokenize a string using delimiter chars, return std::string tokens.
   // Split string on encountering char. Default version splits on first whitespace,
   [[nodiscard]] static std::pair<std::string, std::string> firstSplit(const std::string& source, bool(* char_delim_fn)(char c) = [](char c)->bool { return std::isspace(c) != 0; });
@@ -7,6 +7,7 @@
 #include "kgl_variant_filter_db_contig.h"
 #include "kgl_variant_filter_db_offset.h"
 #include "kel_utility.h"
+#include "kel_bzip_writer.h"
 
 #include <fstream>
 
@@ -97,14 +98,16 @@ void kga::GenomeGeneVariantAnalysis::getGeneVariants(const std::shared_ptr<const
 
 void kga::GenomeGeneVariantAnalysis::writeGeneResults(const std::string& variant_file_name) {
 
-  std::ofstream variant_file(variant_file_name);
+  // A '.bgz' or '.gz' file extension writes a block gzip compressed file.
+  auto variant_file_opt = BGZStreamWriter::getOutputStream(variant_file_name);
 
-  if (not variant_file.good()) {
+  if (not variant_file_opt) {
 
     ExecEnv::log().error("GenomeGeneVariantAnalysis::setGeneVector; Unable to open gene variant results file: {}", variant_file_name);
     return;
 
   }
+  std::ostream& variant_file = *variant_file_opt.value();
 
   variant_file << "Gene_ID"
                << CSV_DELIMITER_
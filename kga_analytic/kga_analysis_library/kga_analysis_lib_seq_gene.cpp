@@ -2,7 +2,7 @@
 // Created by kellerberrin on 17/11/23.
 //
 
-#include "kel_workflow_threads.h"
+#include "kel_executor.h"
 #include "kga_analysis_lib_seq_gene.h"
 #include "kgl_sequence_motif.h"
 #include "kgl_mutation_transcript.h"
@@ -91,27 +91,26 @@ bool kga::TranscriptSequenceRecord::addSequenceRecord(const std::shared_ptr<cons
 void kga::AnalysisTranscriptSequence::performTranscriptAnalysis( const std::shared_ptr<const PopulationDB>& gene_population_ptr) {
 
   auto const& transcipt_id = transcript_ptr_->getParent()->id();
-  // Multithreading for each genome.
-  // Calc how many threads are required as a function of available HW processors.
-  size_t thread_count = WorkflowThreads::defaultThreads(gene_population_ptr->getMap().size());
-  WorkflowThreads thread_pool(thread_count);
-  // A vector for futures.
-  using FutureType = std::future<GenomeRecordOpt>;
-  std::vector<FutureType> future_vector;
-
-
-  // Queue a thread for each genome.
+  // Multithreading for each genome using the process-wide executor.
+  std::vector<std::shared_ptr<const GenomeDB>> genome_vector;
   for (auto const& [genome_id, genome_ptr] : gene_population_ptr->getMap()) {
 
-    std::future<GenomeRecordOpt> future = thread_pool.enqueueFuture(&AnalysisTranscriptSequence::genomeTranscriptMutation, this, genome_ptr);
-    future_vector.emplace_back(std::move(future));
+    genome_vector.push_back(genome_ptr);
 
   }
 
-  // Process the queued futures as they become available.
-  for (auto & future : future_vector) {
+  // Each genome record is written to its own slot, returns when all genomes are processed.
+  std::vector<GenomeRecordOpt> record_vector(genome_vector.size());
+  auto genome_lambda = [this, &genome_vector, &record_vector](size_t index) {
+
+    record_vector[index] = genomeTranscriptMutation(genome_vector[index]);
+
+  };
+  Executor::parallelFor(0, genome_vector.size(), genome_lambda, 1);
+
+  // Process the genome records in genome order.
+  for (auto& record_ptr_opt : record_vector) {
 
-    auto record_ptr_opt  = future.get();
     if (not record_ptr_opt) {
 
       ExecEnv::log().warn("AnalysisTranscriptSequence; problem analyzing transcript: {}", transcipt_id);
@@ -145,7 +144,7 @@ void kga::AnalysisTranscriptSequence::performTranscriptAnalysis( const std::shar
 
     }
 
-  } // For all futures (genomes).
+  } // For all genomes.
 
 }
 
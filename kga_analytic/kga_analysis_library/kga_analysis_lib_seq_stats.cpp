@@ -8,7 +8,7 @@
 #include "kgl_sequence_node_view.h"
 #include "kgl_classification_tree.h"
 
-#include "kel_workflow_threads.h"
+#include "kel_executor.h"
 
 #include <fstream>
 #include <ranges>
@@ -166,20 +166,13 @@ void kga::AnalysisTranscriptFamily::createClassificationTree(const std::string&
 
   }
 
-  // Use threads to speed things up.
-  WorkflowThreads thread_pool(WorkflowThreads::defaultThreads());
-  for (auto const& [transcript_id, transcript_analysis] : analysis_map_) {
+  // Use the process-wide executor to speed things up, returns when all trees are created.
+  auto tree_lambda = [&genome_analysis_ptr, &report_directory, &annotations, &sample_selection](const auto& transcript_entry) {
 
-    thread_pool.enqueueVoid( &GenomeTranscriptAnalysis::createClassificationTree,
-                             genome_analysis_ptr.get(),
-                             report_directory,
-                             transcript_id,
-                             annotations,
-                             sample_selection);
+    genome_analysis_ptr->createClassificationTree(report_directory, transcript_entry.first, annotations, sample_selection);
 
-  }
-  // Wait for completion (technically unnecessary, OK to use RAII here).
-  thread_pool.joinThreads();
+  };
+  Executor::parallelFor(analysis_map_, tree_lambda, 1);
 
 }
 
@@ -5,7 +5,7 @@
 #include "kga_analysis_lib_seqmutation.h"
 #include "kgl_variant_filter_db_offset.h"
 #include "kgl_mutation_variant_filter.h"
-#include "kel_workflow_threads.h"
+#include "kel_executor.h"
 #include "kgl_mutation_sequence.h"
 #include "kgl_mutation_transcript.h"
 
@@ -113,34 +113,30 @@ kga::MutateStats kga::MutateGenes::mutateGenomes( const std::shared_ptr<const Ge
                                                   const std::shared_ptr<const PopulationDB>& gene_population_ptr,
                                                   const std::shared_ptr<const GenomeReference>& reference_genome_ptr) {
 
-  // All other filters are multi-threaded for each genome.
-  // Calc how many threads required.
-  size_t thread_count = WorkflowThreads::defaultThreads(gene_population_ptr->getMap().size());
-  WorkflowThreads thread_pool(thread_count);
-  // A vector for futures.
-  // The tuple is variant map, total modifying variants, multiple variants (more than 1 modifying variant per offset).
-  using FutureType = std::future<std::pair<SequenceStats, bool>>;
-  std::vector<std::pair<FutureType, std::string>> future_vector;
-
-
-  // Queue a thread for each genome.
+  // Multi-threaded for each genome using the process-wide executor.
+  // The pair is the sequence statistics and a valid flag, each genome result is written to its own slot.
+  using GenomeResult = std::optional<std::pair<SequenceStats, bool>>;
+  std::vector<std::pair<std::string, std::shared_ptr<const GenomeDB>>> genome_vector;
   for (auto const& [genome_id, genome_ptr] : gene_population_ptr->getMap()) {
 
-    std::future<std::pair<SequenceStats, bool>> future = thread_pool.enqueueFuture(&MutateGenes::genomeTranscriptMutation,
-                                                                                this,
-                                                                                genome_ptr,
-                                                                                gene_ptr,
-                                                                                transcript_id,
-                                                                                reference_genome_ptr);
-    future_vector.push_back({std::move(future), genome_id});
+    genome_vector.emplace_back(genome_id, genome_ptr);
 
   }
 
+  std::vector<GenomeResult> result_vector(genome_vector.size());
+  auto genome_lambda = [&](size_t index) {
+
+    result_vector[index] = genomeTranscriptMutation(genome_vector[index].second, gene_ptr, transcript_id, reference_genome_ptr);
+
+  };
+  // Returns when all genomes are processed.
+  Executor::parallelFor(0, genome_vector.size(), genome_lambda, 1);
+
   MutateStats mutate_stats;
-  // Wait for all the threads to return.
-  for (auto & [future, genome_id] : future_vector) {
+  for (size_t index = 0; index < genome_vector.size(); ++index) {
 
-    auto const [stats, valid_return]  = future.get();
+    auto const& genome_id = genome_vector[index].first;
+    auto const& [stats, valid_return]  = result_vector[index].value();
     if (not valid_return) {
 
       // Skip the statistics
@@ -3,7 +3,7 @@
 //
 
 
-#include "kel_workflow_threads.h"
+#include "kel_executor.h"
 #include "kga_analysis_inbreed_diploid.h"
 #include "kga_analysis_inbreed_locus.h"
 #include "kga_analysis_inbreed_output.h"
@@ -113,9 +113,16 @@ kga::ResultsMap kga::InbreedingAnalysis::processResults( const ContigLocusMap& c
 
   for (auto const& [genome_contig_id, locus_map] : contig_locus_map) {
 
-    // Use a thread pool to calculate inbreeding and relatedness.
-    WorkflowThreads thread_pool(WorkflowThreads::defaultThreads());
-    std::vector<std::future<LocusResults>> future_vector;
+    // The genome contigs and the locus lists of their super populations.
+    struct GenomeLocus {
+
+      GenomeId_t genome_id;
+      std::shared_ptr<const ContigDB> contig_ptr;
+      std::string super_pop_id;
+      std::shared_ptr<const ContigDB> locus_list;
+
+    };
+    std::vector<GenomeLocus> genome_loci;
     for (auto const&[genome_id, genome_ptr] : diploid_population.getMap()) {
 
       auto contig_opt = genome_ptr->getContig(genome_contig_id);
@@ -139,21 +146,25 @@ kga::ResultsMap kga::InbreedingAnalysis::processResults( const ContigLocusMap& c
         }
         auto const& [super_pop_id, locus_list] = *locus_result;
 
-        std::future<LocusResults> future = thread_pool.enqueueFuture(algorithm_opt.value(),
-                                                                     genome_id,
-                                                                     contig_opt.value(),
-                                                                     super_pop_id,
-                                                                     locus_list);
-        future_vector.push_back(std::move(future));
+        genome_loci.push_back({genome_id, contig_opt.value(), super_pop_id, locus_list});
 
       }
 
     }
 
-    // Retrieve the thread results into a map.
-    for (auto &future : future_vector) {
+    // Use the process-wide executor to calculate inbreeding and relatedness.
+    std::vector<LocusResults> results_vector(genome_loci.size());
+    auto genome_lambda = [&](size_t index) {
+
+      auto const& genome_locus = genome_loci[index];
+      results_vector[index] = algorithm_opt.value()(genome_locus.genome_id, genome_locus.contig_ptr, genome_locus.super_pop_id, genome_locus.locus_list);
+
+    };
+    Executor::parallelFor(0, genome_loci.size(), genome_lambda, 1);
+
+    // Retrieve the results into a map.
+    for (auto const& locus_results : results_vector) {
 
-      auto locus_results = future.get();
       ExecEnv::log().info("Processed Diploid genome: {} for inbreeding and relatedness", locus_results.genome);
       results_map[locus_results.genome] = locus_results;
 
@@ -5,7 +5,7 @@
 #include "kgl_variant_factory_vcf_evidence_analysis.h"
 #include "kgl_variant_db.h"
 #include "kga_analysis_inbreed_locus.h"
-#include "kel_workflow_threads.h"
+#include "kel_executor.h"
 
 
 namespace kga = kellerberrin::genome::analysis;
@@ -227,25 +227,18 @@ kga::LocusMap kga::InbreedSampling::getPopulationLocus(std::shared_ptr<const Pop
                                                        const LociiVectorArguments& locii_args) {
 
 
-  WorkflowThreads threadpool(FrequencyDatabaseRead::superPopulations().size());
-  std::vector<std::future<LocusReturnPair>> futures_vec;
+  // The locus list of each super population is generated by the process-wide executor.
+  auto const& super_populations = FrequencyDatabaseRead::superPopulations();
+  std::vector<LocusReturnPair> locus_vector(super_populations.size());
+  auto locus_lambda = [&](size_t index) {
 
-  for (auto const& super_pop : FrequencyDatabaseRead::superPopulations()) {
+    locus_vector[index] = getLocusList(unphased_ptr, contig_id, super_populations[index], locii_args);
 
-    auto return_future = threadpool.enqueueFuture(&InbreedSampling::getLocusList,
-                                                  unphased_ptr,
-                                                  contig_id,
-                                                  super_pop,
-                                                  locii_args);
-
-    futures_vec.push_back(std::move(return_future));
-
-  }
+  };
+  Executor::parallelFor(0, super_populations.size(), locus_lambda, 1);
 
   LocusMap locus_map;
-  for (auto& future : futures_vec) {
-
-    auto [ super_population, locus_list] = future.get();
+  for (auto const& [super_population, locus_list] : locus_vector) {
 
     locus_map[super_population] = locus_list;
 
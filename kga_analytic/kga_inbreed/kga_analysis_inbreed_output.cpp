@@ -5,6 +5,7 @@
 
 #include "kga_analysis_inbreed_output.h"
 #include "kga_analysis_inbreed_syngen.h"
+#include "kel_bzip_writer.h"
 
 
 #include <fstream>
@@ -103,17 +104,17 @@ bool kga::InbreedingOutput::writeNoPedResults(const InbreedParamOutput& output_r
   }
 
   // Open the output file.
-  std::ofstream outfile;
   std::string output_file_name = Utility::filePath(output_results.getParameters().outputFile(), file_path);
   std::string file_name_ext = output_file_name + FILE_EXT_;
-  outfile.open(file_name_ext, std::ofstream::out |  std::ofstream::trunc);
+  auto outfile_opt = BGZStreamWriter::getOutputStream(file_name_ext, std::ofstream::out |  std::ofstream::trunc);
 
-  if (not outfile.good()) {
+  if (not outfile_opt) {
 
     ExecEnv::log().error("InbreedingAnalysis::writeColumnResults; could not open output file: {}", file_name_ext);
     return false;
 
   }
+  std::ostream& outfile = *outfile_opt.value();
 
 
   auto const& parameters = output_results.getParameters();
@@ -202,17 +203,17 @@ bool kga::InbreedingOutput::writePedResults( const InbreedParamOutput& output_re
   }
 
   // Open the output file.
-  std::ofstream outfile;
   std::string output_file_name = Utility::filePath(output_results.getParameters().outputFile(), file_path);
   std::string file_name_ext = output_file_name + FILE_EXT_;
-  outfile.open(file_name_ext, std::ofstream::out |  std::ofstream::trunc);
+  auto outfile_opt = BGZStreamWriter::getOutputStream(file_name_ext, std::ofstream::out |  std::ofstream::trunc);
 
-  if (not outfile.good()) {
+  if (not outfile_opt) {
 
     ExecEnv::log().error("InbreedingAnalysis::writeColumnResults; could not open output file: {}", file_name_ext);
     return false;
 
   }
+  std::ostream& outfile = *outfile_opt.value();
 
 
   auto const& parameters = output_results.getParameters();
@@ -326,17 +327,17 @@ bool kga::InbreedingOutput::writeSynthetic(const InbreedParamOutput& output_resu
   }
 
   // Open the output file.
-  std::ofstream outfile;
   std::string output_file_name = Utility::filePath(output_results.getParameters().outputFile(), file_path);
   std::string file_name_ext = output_file_name + FILE_EXT_;
-  outfile.open(file_name_ext, std::ofstream::out |  std::ofstream::trunc);
+  auto outfile_opt = BGZStreamWriter::getOutputStream(file_name_ext, std::ofstream::out |  std::ofstream::trunc);
 
-  if (not outfile.good()) {
+  if (not outfile_opt) {
 
     ExecEnv::log().error("InbreedingAnalysis::writeSynthetic; could not open output file: {}", file_name_ext);
     return false;
 
   }
+  std::ostream& outfile = *outfile_opt.value();
 
 
   auto const& parameters = output_results.getParameters();
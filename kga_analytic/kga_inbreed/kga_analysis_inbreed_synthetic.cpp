@@ -7,7 +7,7 @@
 #include "kga_analysis_inbreed_syngen.h"
 #include "kga_analysis_inbreed_output.h"
 #include "kgl_variant_filter_db_variant.h"
-#include "kel_workflow_threads.h"
+#include "kel_executor.h"
 
 
 namespace kga = kellerberrin::genome::analysis;
@@ -100,30 +100,31 @@ kga::ResultsMap kga::SyntheticAnalysis::processSynResults( std::shared_ptr<const
                                                                                                      *locus_list,
                                                                                                      parameters.lociiArguments());
 
-      WorkflowThreads thread_pool(WorkflowThreads::defaultThreads());
-      std::vector<std::future<LocusResults>> future_vector;
+      std::vector<std::pair<GenomeId_t, std::shared_ptr<const ContigDB>>> genome_contigs;
       for (auto const&[genome_id, genome_ptr] : population->getMap()) {
 
         auto contig_opt = genome_ptr->getContig(genome_contig_id);
 
         if (contig_opt) {
 
-
-          std::future<LocusResults> future = thread_pool.enqueueFuture(algorithm_opt.value(),
-                                                                       genome_id,
-                                                                       contig_opt.value(),
-                                                                       super_pop_id,
-                                                                       locus_list);
-          future_vector.push_back(std::move(future));
+          genome_contigs.emplace_back(genome_id, contig_opt.value());
 
         }
 
       }
 
-      // Retrieve the thread results into a map.
-      for (auto &future : future_vector) {
+      std::vector<LocusResults> results_vector(genome_contigs.size());
+      auto genome_lambda = [&](size_t index) {
+
+        auto const& [genome_id, contig_ptr] = genome_contigs[index];
+        results_vector[index] = algorithm_opt.value()(genome_id, contig_ptr, super_pop_id, locus_list);
+
+      };
+      Executor::parallelFor(0, genome_contigs.size(), genome_lambda, 1);
+
+      // Retrieve the results into a map.
+      for (auto const& locus_results : results_vector) {
 
-        auto locus_results = future.get();
         ExecEnv::log().info("Processed Diploid genome: {} for inbreeding and relatedness", locus_results.genome);
         results_map[locus_results.genome] = locus_results;
 
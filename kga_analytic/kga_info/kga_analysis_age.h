@@ -95,6 +95,15 @@ public:
 
   [[nodiscard]] const HetHomAgeMatrix& hetHomMatrix() const { return het_hom_matrix_; }
 
+  // The VCF INFO fields read by the age analysis.
+  [[nodiscard]] static std::vector<std::string> infoFields() {
+
+    return { HETERO_AGE_FIELD_, HETERO_UNDER30_FIELD_, HETERO_80OVER_FIELD_,
+             HOMO_AGE_FIELD_, HOMO_UNDER30_FIELD_, HOMO_80OVER_FIELD_,
+             TOTAL_ALLELE_COUNT_, ALTERNATE_ALLELE_COUNT_ };
+
+  }
+
 private:
 
   std::string analysis_title_;
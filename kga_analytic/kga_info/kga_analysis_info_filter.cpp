@@ -3,6 +3,7 @@
 //
 
 #include "kga_analysis_info_filter.h"
+#include "kel_bzip_writer.h"
 
 #include <fstream>
 
@@ -40,10 +41,8 @@ bool kga::InfoFilterAnalysis::initializeAnalysis( const std::string& work_direct
 
   }
 
-// Clear the data file.
-  std::ofstream outfile;
-  outfile.open(output_file_name_, std::ofstream::out | std::ofstream::trunc);
-  outfile.close();
+// Clear the data file, a compressed output file is initialized as an empty block gzip file.
+  auto outfile_opt = BGZStreamWriter::getOutputStream(output_file_name_, std::ofstream::out | std::ofstream::trunc);
 
   return true;
 
@@ -77,17 +76,7 @@ bool kga::InfoFilterAnalysis::fileReadAnalysis(std::shared_ptr<const DataDB> dat
   // Pre-filter variants for quality, using the VQSLOD and rf_tp_probability fields.
   filtered_vcf_population_ = qualityFilter(vcf_population);
 
-  std::ofstream outfile(output_file_name_,  std::ofstream::out | std::ofstream::app);
-
-  if (not outfile.good()) {
-
-    ExecEnv::log().error("InfoFilterAnalysis::finalizeAnalysis; could not open results file: {}", output_file_name_);
-    return false;
-
-  }
-
-
-  // Perform the chromosome analysis.
+  // Perform the chromosome analysis, the results are appended to the output file.
   bool result = performAnalysis(vcf_population);
 
   return result;
@@ -115,6 +104,21 @@ bool kga::InfoFilterAnalysis::finalizeAnalysis() {
 }
 
 
+std::optional<kgl::EvidenceInfoSet> kga::InfoFilterAnalysis::requiredInfoFields() const {
+
+  EvidenceInfoSet required_fields{ VQSLOD_FIELD_, RANDOM_FOREST_FIELD_, INBREEDING_FIELD_, VEPSubFieldHeader::VEP_FIELD_ID };
+  required_fields.insert(AF_FIELDS_.begin(), AF_FIELDS_.end());
+  for (auto const& age_field : InfoAgeAnalysis::infoFields()) {
+
+    required_fields.insert(age_field);
+
+  }
+
+  return required_fields;
+
+}
+
+
 bool kga::InfoFilterAnalysis::getParameters( const std::string& work_directory,
                                              const ActiveParameterList& named_parameters) {
 
@@ -164,10 +168,9 @@ kga::InfoFilterAnalysis::qualityFilter( std::shared_ptr<const PopulationDB> vcf_
   size_t unfiltered = vcf_population->variantCount();
   ExecEnv::log().info("Population: {} size: {} before filtering", vcf_population->populationId(), unfiltered);
 
-  const std::string VQSLOD_FIELD{"VQSLOD"};
   // const double VQSLOD_LEVEL{1.775};
   const double VQSLOD_LEVEL{1.2168};
-  auto vqslod_filter = InfoFilter<double, false>(VQSLOD_FIELD, [VQSLOD_LEVEL](double compare) ->bool { return compare >= VQSLOD_LEVEL; });
+  auto vqslod_filter = InfoFilter<double, false>(VQSLOD_FIELD_, [VQSLOD_LEVEL](double compare) ->bool { return compare >= VQSLOD_LEVEL; });
 
   std::shared_ptr<PopulationDB> filtered_population = vcf_population->viewFilter(vqslod_filter);
 
@@ -177,10 +180,9 @@ kga::InfoFilterAnalysis::qualityFilter( std::shared_ptr<const PopulationDB> vcf_
   ExecEnv::log().info("Population: {} size: {} ({}%) after VQSLOD filter level: {}",
                       filtered_population->populationId(), filtered_VQSLOD, percent_filtered, VQSLOD_LEVEL);
 
-  const std::string RANDOM_FOREST_FIELD{"rf_tp_probability"};
   const double RANDOM_FOREST_LEVEL{0.90};
 
-  auto random_forest_filter = InfoFilter<double, false>(RANDOM_FOREST_FIELD, [RANDOM_FOREST_LEVEL](double compare)->bool { return compare >= RANDOM_FOREST_LEVEL; });
+  auto random_forest_filter = InfoFilter<double, false>(RANDOM_FOREST_FIELD_, [RANDOM_FOREST_LEVEL](double compare)->bool { return compare >= RANDOM_FOREST_LEVEL; });
 
   filtered_population = filtered_population->viewFilter(random_forest_filter);
 
@@ -198,14 +200,16 @@ kga::InfoFilterAnalysis::qualityFilter( std::shared_ptr<const PopulationDB> vcf_
 bool kga::InfoFilterAnalysis::performAnalysis( std::shared_ptr<const kgl::PopulationDB> vcf_population) {
 
 
-  std::ofstream outfile(output_file_name_,  std::ofstream::out | std::ofstream::app);
+  // Block gzip compressed output is appended as additional compressed blocks.
+  auto outfile_opt = BGZStreamWriter::getOutputStream(output_file_name_, std::ofstream::out | std::ofstream::app);
 
-  if (not outfile.good()) {
+  if (not outfile_opt) {
 
     ExecEnv::log().error("InfoFilterAnalysis::fileReadAnalysis; could not open results file: {}", output_file_name_);
     return false;
 
   }
+  std::ostream& outfile = *outfile_opt.value();
 
 
   ExecEnv::log().info("Population: {} size after filtering: {}", vcf_population->populationId(), vcf_population->variantCount());
@@ -219,13 +223,7 @@ bool kga::InfoFilterAnalysis::performAnalysis( std::shared_ptr<const kgl::Popula
 
 
   // Filter on the VEP Impact field.
-  const std::string vep_sub_field("IMPACT");
-  const std::string vep_high_impact("HIGH");
-  const std::string vep_moderate_impact("MODERATE");
-
-  auto high_impact_filter =  VepSubStringFilter<false>(vep_sub_field, vep_high_impact);
-  auto moderate_impact_filter = VepSubStringFilter<false>(vep_sub_field, vep_moderate_impact);
-  auto vep_impact_filter = OrFilter(high_impact_filter, moderate_impact_filter);
+  auto vep_impact_filter = VepImpactFilter(std::vector<VepImpact>{VepImpact::HIGH, VepImpact::MODERATE});
   // Analyze high and moderate impact variants.
   analyzeFilteredPopulation(vep_impact_filter, vcf_population, outfile);
 
@@ -236,26 +234,12 @@ bool kga::InfoFilterAnalysis::performAnalysis( std::shared_ptr<const kgl::Popula
   const std::vector<double> AF_values{0.001, 0.01, 0.02, 0.05, 0.10, 0.20, 0.50, 0.90};
   const std::vector<double> inbreeding_values{ -0.9, -0.5, -0.2, -0.1, 0.0, 0.1, 0.20, 0.50, 0.90};
 
-  analyzeField("InbreedingCoeff", inbreeding_values, vcf_population, outfile);
-  analyzeField("AF", AF_values, vcf_population, outfile);
-  analyzeField("AF_male", AF_values, vcf_population, outfile);
-  analyzeField("AF_female", AF_values, vcf_population, outfile);
-  analyzeField("AF_afr", AF_values, vcf_population, outfile);
-  analyzeField("AF_amr", AF_values, vcf_population, outfile);
-  analyzeField("AF_asj", AF_values, vcf_population, outfile);
-  analyzeField("AF_eas", AF_values, vcf_population, outfile);
-  analyzeField("AC_eas_jpn", AF_values, vcf_population, outfile);
-  analyzeField("AC_eas_kor", AF_values, vcf_population, outfile);
-  analyzeField("AC_eas_oea", AF_values, vcf_population, outfile);
-  analyzeField("AF_fin", AF_values, vcf_population, outfile);
-  analyzeField("AF_nfe", AF_values, vcf_population, outfile);
-  analyzeField("AF_nfe_est", AF_values, vcf_population, outfile);
-  analyzeField("AC_nfe_bgr", AF_values, vcf_population, outfile);
-  analyzeField("AF_nfe_nwe", AF_values, vcf_population, outfile);
-  analyzeField("AF_nfe_onf", AF_values, vcf_population, outfile);
-  analyzeField("AF_nfe_seu", AF_values, vcf_population, outfile);
-  analyzeField("AC_nfe_swe", AF_values, vcf_population, outfile);
-  analyzeField("AF_oth", AF_values, vcf_population, outfile);
+  analyzeField(INBREEDING_FIELD_, inbreeding_values, vcf_population, outfile);
+  for (auto af_field : AF_FIELDS_) {
+
+    analyzeField(af_field, AF_values, vcf_population, outfile);
+
+  }
 
   return true;
 
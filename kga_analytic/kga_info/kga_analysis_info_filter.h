@@ -15,6 +15,8 @@
 #include "kgl_variant_filter_info.h"
 #include "kga_analysis_age.h"
 
+#include <array>
+
 namespace kellerberrin::genome::analysis {   //  organization::project level namespace
 
 
@@ -49,6 +51,9 @@ public:
   // All VCF data has been presented, finalize analysis and write results (need not be redefined)
   [[nodiscard]] bool finalizeAnalysis() override;
 
+  // The quality, vep, age and allele frequency INFO fields.
+  [[nodiscard]] std::optional<EvidenceInfoSet> requiredInfoFields() const override;
+
   [[nodiscard]] bool getParameters(const std::string& work_directory, const ActiveParameterList& named_parameters);
 
 private:
@@ -61,6 +66,16 @@ private:
   constexpr static const char* OUTPUT_FILE_ = "OutputFile";
   constexpr static const char* OUTPUT_FILE_EXT_ = ".csv";
 
+  // Quality filter fields.
+  constexpr static const char* VQSLOD_FIELD_ = "VQSLOD";
+  constexpr static const char* RANDOM_FOREST_FIELD_ = "rf_tp_probability";
+
+  // Analyzed fields.
+  constexpr static const char* INBREEDING_FIELD_ = "InbreedingCoeff";
+  constexpr static const std::array<const char*, 19> AF_FIELDS_{ "AF", "AF_male", "AF_female", "AF_afr", "AF_amr", "AF_asj", "AF_eas",
+                                                                "AC_eas_jpn", "AC_eas_kor", "AC_eas_oea", "AF_fin", "AF_nfe", "AF_nfe_est",
+                                                                "AC_nfe_bgr", "AF_nfe_nwe", "AF_nfe_onf", "AF_nfe_seu", "AC_nfe_swe", "AF_oth" };
+
   std::shared_ptr<PopulationDB> qualityFilter(std::shared_ptr<const PopulationDB> vcf_population);
 
   void analyzeField( const std::string& info_field_ident,
@@ -26,9 +26,8 @@ class InfoIntervalData {
 
 public:
 
-  InfoIntervalData() : vep_impact_filter_(VepSubStringFilter<false>(VEP_IMPACT_FIELD_, VEP_HIGH_IMPACT_),
-                                          VepSubStringFilter<false>(VEP_IMPACT_FIELD_, VEP_MODERATE_FIELD_)),
-                                          age_analysis_("AgeInterval") {}
+  InfoIntervalData() : vep_impact_filter_(std::vector<VepImpact>{VepImpact::HIGH, VepImpact::MODERATE}),
+                       age_analysis_("AgeInterval") {}
   ~InfoIntervalData() = default;
 
   void processVariant(const std::shared_ptr<const Variant>& variant_ptr);
@@ -47,16 +46,13 @@ public:
 
 private:
 
-  OrFilter vep_impact_filter_;
+  VepImpactFilter vep_impact_filter_;
   size_t consequence_count_{0};
   Percentile<double, std::shared_ptr<const Variant>> freq_percentile_;
   Percentile<double, std::shared_ptr<const Variant>> age_percentile_;
   Percentile<double, std::shared_ptr<const Variant>> het_hom_percentile_;
   InfoAgeAnalysis age_analysis_;
 
-  constexpr static const char* VEP_IMPACT_FIELD_ = "IMPACT";
-  constexpr static const char* VEP_HIGH_IMPACT_ = "HIGH";
-  constexpr static const char* VEP_MODERATE_FIELD_ = "MODERATE";
 
   constexpr static const char* VARIANT_FREQUENCY_FIELD_ = "AF";
 
@@ -4,6 +4,7 @@
 
 #include "kga_analysis_json.h"
 #include "kgl_json_parser.h"
+#include "kel_executor.h"
 
 namespace kga= kellerberrin::genome::analysis;
 namespace kgl= kellerberrin::genome;
@@ -83,23 +84,17 @@ bool kga::JsonAnalysis::finalizeAnalysis() {
 
   ExecEnv::log().info("Finalize Analysis called for Analysis Id: {}", ident());
 
-  WorkflowThreads thread_pool(WorkflowThreads::defaultThreads(json_file_names_.size()));
-  // Simplify the future vector type definition.
-  using CitationResult = std::shared_ptr<const DBCitationMap>;
-  using FutureResult = std::future<CitationResult>;
-  std::vector<FutureResult> future_vector;
+  // Parse the Json files using the process-wide executor, each citation map is written to its own slot.
+  std::vector<std::shared_ptr<const DBCitationMap>> citation_vector(json_file_names_.size());
+  auto parse_lambda = [this, &citation_vector](size_t index) {
 
-  for (auto const& json_file : json_file_names_) {
+    citation_vector[index] = parseJsonFile(json_file_names_[index]);
 
-    FutureResult future = thread_pool.enqueueFuture(&JsonAnalysis::parseJsonFile, json_file);
+  };
+  Executor::parallelFor(0, json_file_names_.size(), parse_lambda, 1);
 
-    future_vector.push_back(std::move(future));
+  for (auto const& citation_map_ptr : citation_vector) {
 
-  }
-
-  for (auto &future : future_vector) {
-
-    auto citation_map_ptr = future.get();
     if (not writeAppendCitations(*citation_map_ptr)) {
 
       ExecEnv::log().error("JsonAnalysis::finalizeAnalysis; problem writing to Citation File");
@@ -6,6 +6,7 @@
 #include "kgl_uniprot_parser.h"
 #include "kga_analysis_mutation_gene.h"
 #include "kgl_variant_filter_db_contig.h"
+#include "kel_task.h"
 
 
 #include <memory_resource>
@@ -167,38 +168,28 @@ bool kga::GenomeMutation::variantAnalysis(const std::shared_ptr<const Population
 
   }
 
-  // The gene analysis is multithreaded.
-  WorkflowThreads thread_pool(WorkflowThreads::defaultThreads());
-  // A vector for futures.
-  std::vector<std::future<GeneMutation>> future_vector;
+  // The gene analysis is multithreaded, each gene is analyzed by a task on the executor.
+  std::vector<Task<GeneMutation>> gene_tasks;
 
   ExecEnv::log().info("Unphased variants sorted by Ensembl Gene code: {}, Total Unphased filter: {}",
                       ensembl_index_map_ptr->size(), unphased_population_ptr->variantCount());
-  // Queue a thread for each gene.
+  // Queue a task for each gene.
   for (auto& gene_mutation : gene_vector_) {
 
-    std::future<GeneMutation> future = thread_pool.enqueueFuture(&GenomeMutation::geneSpanAnalysis,
-                                                                 this,
-                                                                 population_ptr,
-                                                                 unphased_population_ptr,
-                                                                 clinvar_population_ptr,
-                                                                 genome_aux_data,
-                                                                 allele_citation_ptr,
-                                                                 ensembl_index_map_ptr,
-                                                                 gene_mutation);
-    future_vector.push_back(std::move(future));
+    gene_tasks.push_back(TaskScheduler::spawn(&GenomeMutation::geneSpanAnalysis,
+                                              this,
+                                              population_ptr,
+                                              unphased_population_ptr,
+                                              clinvar_population_ptr,
+                                              genome_aux_data,
+                                              allele_citation_ptr,
+                                              ensembl_index_map_ptr,
+                                              gene_mutation));
 
   } // for genes
 
-
-  std::vector<GeneMutation> gene_vector;
-  // Wait on completed threads
-  gene_vector.reserve(future_vector.size());
-  for (auto& future : future_vector) {
-
-    gene_vector.emplace_back(future.get());
-
-  }
+  // Wait on the completed tasks, the results are returned in gene order.
+  std::vector<GeneMutation> gene_vector = TaskScheduler::syncWait(TaskScheduler::whenAll(std::move(gene_tasks)));
 
   // todo: This logic is inefficient, the entire gene vector is copied for each VCF file (24 times). Re-design and Re-code.
   gene_vector_ = std::move(gene_vector);
@@ -7,6 +7,7 @@
 #include "kgl_variant_sort.h"
 #include "kgl_variant_factory_vcf_evidence_analysis.h"
 #include "kel_distribution.h"
+#include "kel_bzip_writer.h"
 
 #include <fstream>
 
@@ -162,7 +163,7 @@ std::set<std::string> kga::GenerateGeneAllele::getDiseaseCitations(const std::st
 
 
 
-void kga::GenerateGeneAllele::writeHeader(std::ofstream& outfile, char delimiter) {
+void kga::GenerateGeneAllele::writeHeader(std::ostream& outfile, char delimiter) {
 
   outfile << "SymbolGeneId" << delimiter
           << "EnsemblGeneId" << delimiter
@@ -195,14 +196,15 @@ void kga::GenerateGeneAllele::writeHeader(std::ofstream& outfile, char delimiter
 
 void kga::GenerateGeneAllele::writeOutput(const std::string& output_file, char delimiter) const {
 
-  std::ofstream out_file(output_file);
+  auto out_file_opt = BGZStreamWriter::getOutputStream(output_file);
 
-  if (not out_file.good()) {
+  if (not out_file_opt) {
 
     ExecEnv::log().error("GenerateGeneAllele::writePopLiterature; cannot open output file: {}", output_file);
     return;
 
   }
+  std::ostream& out_file = *out_file_opt.value();
 
   ExecEnv::log().info("Writing VEP, PMID information for {} variants to file: {}", cited_allele_map_.size(), output_file);
 
@@ -400,14 +402,15 @@ std::map<std::string, std::string> kga::GenerateGeneAllele::retrieveVepFields( c
 
 void kga::GenerateGeneAllele::writeLiteratureAlleleSummary(const std::string& output_file) {
 
-  std::ofstream out_file(output_file);
+  auto out_file_opt = BGZStreamWriter::getOutputStream(output_file);
 
-  if (not out_file.good()) {
+  if (not out_file_opt) {
 
     ExecEnv::log().error("GenerateGeneAllele::writeLiteratureAlleleSummary; cannot open output file: {}", output_file);
     return;
 
   }
+  std::ostream& out_file = *out_file_opt.value();
 
   ExecEnv::log().info("Writing literature  summaries for: {} variants to file: {}", cited_allele_map_.size(), output_file);
 
@@ -488,14 +491,15 @@ void kga::GenerateGeneAllele::writeLiteratureAlleleSummary(const std::string& ou
 // For each Allele print all the relevant publications.
 void kga::GenerateGeneAllele::writeAlleleLiteratureSummary(const std::string& output_file) {
 
-  std::ofstream out_file(output_file);
+  auto out_file_opt = BGZStreamWriter::getOutputStream(output_file);
 
-  if (not out_file.good()) {
+  if (not out_file_opt) {
 
     ExecEnv::log().error("GenerateGeneAllele::writeAlleleLiteratureSummary; cannot open output file: {}", output_file);
     return;
 
   }
+  std::ostream& out_file = *out_file_opt.value();
 
   ExecEnv::log().info("Writing literature  summaries for: {} variants to file: {}", cited_allele_map_.size(), output_file);
 
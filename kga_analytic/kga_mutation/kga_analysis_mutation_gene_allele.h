@@ -61,7 +61,7 @@ private:
   std::map<std::string, std::string> ensembl_symbol_map_;
   DBCitationMap disease_allele_map_;
 
-  static void writeHeader(std::ofstream& outfile, char delimiter);
+  static void writeHeader(std::ostream& outfile, char delimiter);
 
   const static constexpr char CONCATENATE_VEP_FIELDS_{'&'};
   inline const static std::vector<std::string> VEP_FIELD_LIST_{ "Amino_acids",
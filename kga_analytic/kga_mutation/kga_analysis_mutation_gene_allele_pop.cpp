@@ -4,6 +4,8 @@
 
 #include "kga_analysis_mutation_gene_allele_pop.h"
 #include "kgl_literature_filter.h"
+#include "kel_task.h"
+#include "kel_bzip_writer.h"
 
 
 namespace kga = kellerberrin::genome::analysis;
@@ -68,27 +70,21 @@ void kga::GeneratePopulationAllele::processPopulation( const std::shared_ptr<con
 
   ExecEnv::log().info("Begin analyzing Literature Population: {}, with Genomes: {}", population_ptr->populationId(), population_ptr->getMap().size());
 
-  WorkflowThreads thread_pool(WorkflowThreads::defaultThreads());
-  std::vector<std::future<ThreadReturnType>> future_vector;
+  std::vector<Task<ThreadReturnType>> genome_tasks;
 
   // Create a disease allele map resource.
   std::shared_ptr<const DBCitationMap> disease_allele_ptr(std::make_shared<const DBCitationMap>(disease_allele_map_));
 
-  // Queue a thread for each genome.
+  // Queue a task for each genome.
   for (auto const& [genome_id, genome_ptr] : population_ptr->getMap()) {
 
     // Function ptr, args by value.
-    std::future<std::pair<std::string, std::set<std::string>>> future = thread_pool.enqueueFuture(&GeneratePopulationAllele::getGenomePublications,
-                                                                                                  genome_ptr,
-                                                                                                  disease_allele_ptr);
-    future_vector.push_back(std::move(future));
+    genome_tasks.push_back(TaskScheduler::spawn(&GeneratePopulationAllele::getGenomePublications, genome_ptr, disease_allele_ptr));
 
   }
 
   // Unpack the results.
-  for (auto& future : future_vector) {
-
-    auto [genome_id, allele_set] = future.get();
+  for (auto& [genome_id, allele_set] : TaskScheduler::syncWait(TaskScheduler::whenAll(std::move(genome_tasks)))) {
 
     reference_ethnic_.genomeAnalysis(genome_id, 1, genome_aux_ptr_);
 
@@ -174,14 +170,15 @@ kga::GeneratePopulationAllele::ThreadReturnType kga::GeneratePopulationAllele::g
 void kga::GeneratePopulationAllele::writePopLiterature(const std::string& output_file) const {
 
 
-  std::ofstream out_file(output_file);
+  auto out_file_opt = BGZStreamWriter::getOutputStream(output_file);
 
-  if (not out_file.good()) {
+  if (not out_file_opt) {
 
     ExecEnv::log().error("GeneratePopulationAllele::writePopLiterature; cannot open output file: {}", output_file);
     return;
 
   }
+  std::ostream& out_file = *out_file_opt.value();
 
   ExecEnv::log().info("Writing literature analysis for: {} variants to file: {}", variant_allele_map_.size(), output_file);
 
@@ -5,6 +5,7 @@
 
 
 #include "kga_analysis_mutation_gene.h"
+#include "kel_bzip_writer.h"
 
 #include <fstream>
 
@@ -19,9 +20,9 @@ bool kga::GenomeMutation::writeOutput( const std::shared_ptr<const HsGenomeAux>&
                                        const std::string& output_file_name,
                                        char output_delimiter) const {
 
-  std::ofstream out_file(output_file_name);
+  auto out_file_opt = BGZStreamWriter::getOutputStream(output_file_name);
 
-  if (not out_file.good()) {
+  if (not out_file_opt) {
 
     ExecEnv::log().error("GenomeMutation::writePopLiterature; could not open file: {} for output", output_file_name);
     return false;
@@ -31,6 +32,7 @@ bool kga::GenomeMutation::writeOutput( const std::shared_ptr<const HsGenomeAux>&
     ExecEnv::log().info("GenomeMutation writing output to file: {}", output_file_name);
 
   }
+  std::ostream& out_file = *out_file_opt.value();
 
   if (not gene_vector_.empty()) {
 
@@ -43,6 +43,9 @@ public:
   // All VCF data has been presented, finalize analysis and write results
   [[nodiscard]] bool finalizeAnalysis() override;
 
+  // No INFO fields are used.
+  [[nodiscard]] std::optional<EvidenceInfoSet> requiredInfoFields() const override { return EvidenceInfoSet{}; }
+
 private:
 
 
@@ -5,6 +5,8 @@
 #include "kgl_gene_app.h"
 #include "kgl_properties.h"
 #include "kgl_package.h"
+#include "kel_gzip_workflow.h"
+#include "kel_bzip_writer.h"
 
 
 namespace kgl = kellerberrin::genome;
@@ -25,10 +27,23 @@ void kgl::GeneExecEnv::executeApp() {
 
   }
 
+  // Size (and optionally pin) the process-wide executor before any parallel work.
+  Executor::configure(runtime_options_.getExecutorConfig());
+  ExecEnv::log().info("Process-wide executor threads: {}", Executor::threadCount());
+  // Optionally export the queue, pipeline and stream metrics during the run.
+  MetricsRegistry::startExport(runtime_options_.getMetricsConfig());
+  // Optionally write the gzip checkpoint indexes to a writable directory.
+  GZParallelStreamIO::setIndexDirectory(runtime_options_.getGzipIndexDirectory());
+  // Optionally write the analysis reports as block gzip files.
+  BGZStreamWriter::setCompressReports(runtime_options_.getCompressReports());
+
   // Disassemble the XML runtime into a series of data and analysis operations.
   const ExecutePackage execute_package(runtime_options_, args.workDirectory);
   // Individually executes the specified XML components (the package).
   // Executes the application logic and performs requested analysis.
   execute_package.executeActive();
 
+  // Write the final metrics.
+  MetricsRegistry::stopExport();
+
 }
@@ -97,8 +97,32 @@ kgl::ExecutePackage::readDataFile(const RuntimePackage& package,
 
   auto [file_ident, file_info_ptr] = *result;
 
+  // The INFO fields read are restricted by the package allow list, or if not specified, by the fields the active analyses require.
+  std::optional<EvidenceInfoSet> info_allow_list = package.infoAllowList();
+  if (not info_allow_list) {
+
+    info_allow_list = package_analysis_.requiredInfoFields();
+
+  }
+
+  VariantEvidenceMap evidence_map = runtime_config_.evidenceMap();
+  if (info_allow_list) {
+
+    ExecEnv::log().info("Package: {}, VCF INFO fields restricted to: {} fields", package.packageIdentifier(), info_allow_list->size());
+    evidence_map = evidence_map.restrictEvidence(info_allow_list.value());
+
+  }
+
   // Selects the appropriate parser and returns a base class data object.
-  std::shared_ptr<kgl::DataDB> data_ptr = ParserSelection::parseData(resource_ptr, file_info_ptr, runtime_config_.evidenceMap(), runtime_config_.contigAlias());
+  // VCF files are read using the optional ingest pipeline configuration and genomic regions of the package.
+  // If a snapshot directory is specified, parsed VCF populations are saved as snapshots and are reused if the VCF and projections are unchanged.
+  std::shared_ptr<kgl::DataDB> data_ptr = ParserSelection::parseData( resource_ptr
+                                                                    , file_info_ptr
+                                                                    , evidence_map
+                                                                    , runtime_config_.contigAlias()
+                                                                    , package.ingestPipeline()
+                                                                    , package.vcfRegions()
+                                                                    , runtime_config_.snapshotDirectory());
 
   return data_ptr;
 
@@ -147,3 +147,30 @@ bool kgl::PackageAnalysis::finalizeAnalysis() const {
   return true;
 
 }
+
+
+std::optional<kgl::EvidenceInfoSet> kgl::PackageAnalysis::requiredInfoFields() const {
+
+  EvidenceInfoSet required_fields;
+  for (auto const& [analysis, active] : active_analysis_) {
+
+    if (not active) {
+
+      continue;
+
+    }
+
+    auto analysis_fields = analysis->requiredInfoFields();
+    if (not analysis_fields) {
+
+      return std::nullopt;
+
+    }
+
+    required_fields.insert(analysis_fields->begin(), analysis_fields->end());
+
+  }
+
+  return required_fields;
+
+}
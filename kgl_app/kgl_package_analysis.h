@@ -41,6 +41,10 @@ public:
   // All data has been presented, finalize analysis and write results.
   [[nodiscard]] bool finalizeAnalysis() const;
 
+  // The union of the INFO fields required by the active analyses.
+  // Returns std::nullopt if any active analysis does not specify its INFO fields.
+  [[nodiscard]] std::optional<EvidenceInfoSet> requiredInfoFields() const;
+
 private:
 
   const RuntimeConfiguration runtime_contig_;
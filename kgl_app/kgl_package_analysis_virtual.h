@@ -43,6 +43,10 @@ public:
   // All VCF data has been presented, finalize analysis and write results
   [[nodiscard]] virtual bool finalizeAnalysis() = 0;
 
+  // The VCF INFO fields used by the analysis, called after initializeAnalysis().
+  // The default std::nullopt means the fields are not known and all the fields of the file evidence set are read.
+  [[nodiscard]] virtual std::optional<EvidenceInfoSet> requiredInfoFields() const { return std::nullopt; }
+
   // The key is the analysis ident the value is the factory function to create the corresponding analysis object.
   // Note the key value must match the corresponding analysis ident in the definition XML file.
   using AnalysisFactoryMap = std::map<std::string, std::function<std::unique_ptr<VirtualAnalysis>(void)>>;
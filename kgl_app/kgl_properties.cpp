@@ -8,6 +8,7 @@
 #include <set>
 
 namespace kgl = kellerberrin::genome;
+namespace kel = kellerberrin;
 
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -26,6 +27,201 @@ bool kgl::RuntimeProperties::readProperties(const std::string& properties_file)
 //  Runtime xml retrieval
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// The executor thread count and affinity, the defaults are used if not specified.
+kel::ExecutorConfig kgl::RuntimeProperties::getExecutorConfig() const {
+
+  ExecutorConfig executor_config;
+
+  std::string key = std::string(RUNTIME_ROOT_) + std::string(DOT_) + std::string(EXECUTOR_) + std::string(DOT_) + std::string(EXECUTOR_THREADS_);
+  if (property_tree_ptr_->checkProperty(key)) {
+
+    size_t threads{0};
+    if (not property_tree_ptr_->getProperty(key, threads)) {
+
+      ExecEnv::log().error("RuntimeProperties::getExecutorConfig, invalid executor thread count, using the default thread count");
+
+    } else {
+
+      executor_config.threads = threads;
+
+    }
+
+  }
+
+  key = std::string(RUNTIME_ROOT_) + std::string(DOT_) + std::string(EXECUTOR_) + std::string(DOT_) + std::string(EXECUTOR_AFFINITY_);
+  std::string affinity;
+  if (property_tree_ptr_->getOptionalProperty(key, affinity)) {
+
+    affinity = Utility::toupper(Utility::trimEndWhiteSpace(affinity));
+    if (affinity == Utility::toupper(AFFINITY_CORE_)) {
+
+      executor_config.affinity = ThreadAffinity::CORE;
+
+    } else if (affinity == Utility::toupper(AFFINITY_NUMA_)) {
+
+      executor_config.affinity = ThreadAffinity::NUMA;
+
+    } else if (not affinity.empty()) {
+
+      ExecEnv::log().warn("RuntimeProperties::getExecutorConfig, unknown executor affinity: {}, threads are not pinned", affinity);
+
+    }
+
+  }
+
+  return executor_config;
+
+}
+
+
+// The metrics are only exported if a file is specified, the file is relative to the work directory.
+kel::MetricsConfig kgl::RuntimeProperties::getMetricsConfig() const {
+
+  MetricsConfig metrics_config;
+
+  std::string key = std::string(RUNTIME_ROOT_) + std::string(DOT_) + std::string(METRICS_) + std::string(DOT_) + std::string(METRICS_FILE_);
+  std::string file_name;
+  if (not property_tree_ptr_->getOptionalProperty(key, file_name)) {
+
+    return metrics_config;
+
+  }
+
+  file_name = Utility::trimEndWhiteSpace(file_name);
+  if (file_name.empty()) {
+
+    return metrics_config;
+
+  }
+  metrics_config.file_name = Utility::filePath(file_name, work_directory_);
+
+  key = std::string(RUNTIME_ROOT_) + std::string(DOT_) + std::string(METRICS_) + std::string(DOT_) + std::string(METRICS_FORMAT_);
+  std::string format;
+  if (property_tree_ptr_->getOptionalProperty(key, format)) {
+
+    format = Utility::toupper(Utility::trimEndWhiteSpace(format));
+    if (format == Utility::toupper(FORMAT_PROMETHEUS_)) {
+
+      metrics_config.format = MetricsFormat::PROMETHEUS;
+
+    } else if (not format.empty() and format != Utility::toupper(FORMAT_JSON_)) {
+
+      ExecEnv::log().warn("RuntimeProperties::getMetricsConfig, unknown metrics format: {}, using JSON", format);
+
+    }
+
+  }
+
+  key = std::string(RUNTIME_ROOT_) + std::string(DOT_) + std::string(METRICS_) + std::string(DOT_) + std::string(METRICS_INTERVAL_);
+  if (property_tree_ptr_->checkProperty(key)) {
+
+    size_t interval_ms{0};
+    if (not property_tree_ptr_->getProperty(key, interval_ms)) {
+
+      ExecEnv::log().error("RuntimeProperties::getMetricsConfig, invalid metrics interval, using the default interval");
+
+    } else {
+
+      metrics_config.interval_ms = interval_ms;
+
+    }
+
+  }
+
+  return metrics_config;
+
+}
+
+
+// The gzip checkpoint index directory is relative to the work directory and is created if it does not exist.
+// Used when the data directories are read-only, for example <gzipIndexDirectory>gzip_index</gzipIndexDirectory>.
+std::string kgl::RuntimeProperties::getGzipIndexDirectory() const {
+
+  std::string key = std::string(RUNTIME_ROOT_) + std::string(DOT_) + std::string(GZIP_INDEX_DIRECTORY_);
+  std::string index_directory;
+  if (not property_tree_ptr_->getOptionalProperty(key, index_directory)) {
+
+    return {};
+
+  }
+
+  index_directory = Utility::trimEndWhiteSpace(index_directory);
+  if (index_directory.empty()) {
+
+    return {};
+
+  }
+
+  index_directory = Utility::filePath(index_directory, work_directory_);
+  if (not Utility::directoryExists(index_directory) and not Utility::createDirectory(index_directory)) {
+
+    ExecEnv::log().warn("RuntimeProperties::getGzipIndexDirectory, cannot create directory: {}, gzip indexes are written alongside the gzip files",
+                        index_directory);
+    return {};
+
+  }
+
+  return index_directory;
+
+}
+
+
+// For example <compressReports>true</compressReports>, each report file name is appended with '.bgz'.
+bool kgl::RuntimeProperties::getCompressReports() const {
+
+  std::string key = std::string(RUNTIME_ROOT_) + std::string(DOT_) + std::string(COMPRESS_REPORTS_);
+  std::string compress_reports;
+  if (not property_tree_ptr_->getOptionalProperty(key, compress_reports)) {
+
+    return false;
+
+  }
+
+  compress_reports = Utility::toupper(Utility::trimEndWhiteSpace(compress_reports));
+  if (compress_reports != TRUE_ and compress_reports != FALSE_) {
+
+    ExecEnv::log().warn("RuntimeProperties::getCompressReports, invalid value: {}, reports are not compressed", compress_reports);
+
+  }
+
+  return compress_reports == TRUE_;
+
+}
+
+
+// Population snapshots are only read and written if a snapshot directory is specified. The directory is relative to
+// the work directory and is created if it does not exist, for example <snapshotDirectory>snapshot</snapshotDirectory>.
+std::string kgl::RuntimeProperties::getSnapshotDirectory() const {
+
+  std::string key = std::string(RUNTIME_ROOT_) + std::string(DOT_) + std::string(SNAPSHOT_DIRECTORY_);
+  std::string snapshot_directory;
+  if (not property_tree_ptr_->getOptionalProperty(key, snapshot_directory)) {
+
+    return {};
+
+  }
+
+  snapshot_directory = Utility::trimEndWhiteSpace(snapshot_directory);
+  if (snapshot_directory.empty()) {
+
+    return {};
+
+  }
+
+  snapshot_directory = Utility::filePath(snapshot_directory, work_directory_);
+  if (not Utility::directoryExists(snapshot_directory) and not Utility::createDirectory(snapshot_directory)) {
+
+    ExecEnv::log().warn("RuntimeProperties::getSnapshotDirectory, cannot create directory: {}, population snapshots are not used",
+                        snapshot_directory);
+    return {};
+
+  }
+
+  return snapshot_directory;
+
+}
+
+
 // A vector of active packages.
 
 
@@ -178,7 +374,20 @@ kgl::RuntimePackageMap kgl::RuntimeProperties::getPackageMap() const {
 
     }
 
-    std::pair<std::string, RuntimePackage> new_package(package_ident, RuntimePackage(package_ident, analysis_vector, resources_def, vector_iteration_files));
+    // The optional threads, queue depths and batch sizes of the pipeline reading the package data files.
+    PipelineConfig ingest_pipeline = getIngestPipeline(sub_tree.second, package_ident);
+    // The optional INFO fields read from the package data files.
+    std::optional<EvidenceInfoSet> info_allow_list = getInfoAllowList(sub_tree.second, package_ident);
+    // The optional genomic regions read from the package data files.
+    BGZRegionVector vcf_regions = getRegionList(sub_tree.second, package_ident);
+
+    std::pair<std::string, RuntimePackage> new_package(package_ident, RuntimePackage( package_ident,
+                                                                                      analysis_vector,
+                                                                                      resources_def,
+                                                                                      vector_iteration_files,
+                                                                                      ingest_pipeline,
+                                                                                      info_allow_list,
+                                                                                      vcf_regions));
 
     auto [iter, result] = package_map.insert(new_package);
     if (not result) {
@@ -194,6 +403,155 @@ kgl::RuntimePackageMap kgl::RuntimeProperties::getPackageMap() const {
 }
 
 
+// The optional ingest pipeline of a package, for example:
+// <ingestPipeline><auto>true</auto><balanceInterval>500</balanceInterval>
+//   <stage><stageIdent>parse</stageIdent><threads>32</threads><highTide>400</highTide><lowTide>200</lowTide></stage>
+//   <stage><stageIdent>ingest</stageIdent><threads>64</threads><batchSize>128</batchSize></stage>
+// </ingestPipeline>
+kel::PipelineConfig kgl::RuntimeProperties::getIngestPipeline(const PropertyTree& package_tree, const std::string& package_ident) {
+
+  PipelineConfig pipeline_config;
+
+  std::vector<SubPropertyTree> pipeline_vector;
+  if (not package_tree.checkProperty(PACKAGE_PIPELINE_) or not package_tree.getPropertyTreeVector(PACKAGE_PIPELINE_, pipeline_vector)) {
+
+    return pipeline_config;
+
+  }
+
+  for (auto const& [node_name, node_tree] : pipeline_vector) {
+
+    if (node_name == PIPELINE_AUTO_) {
+
+      std::string auto_balance = Utility::toupper(Utility::trimEndWhiteSpace(node_tree.getValue()));
+      pipeline_config.autoBalance(auto_balance == "TRUE", pipeline_config.balanceInterval());
+
+    } else if (node_name == PIPELINE_INTERVAL_) {
+
+      size_t interval_ms{0};
+      try {
+
+        interval_ms = std::stoull(node_tree.getValue());
+
+      } catch(...) {
+
+        ExecEnv::log().error("RuntimeProperties::getIngestPipeline, Package: {}, invalid balance interval: {}", package_ident, node_tree.getValue());
+
+      }
+      pipeline_config.autoBalance(pipeline_config.autoBalance(), interval_ms);
+
+    } else if (node_name == PIPELINE_STAGE_) {
+
+      std::string stage_ident;
+      if (not node_tree.getProperty(PIPELINE_STAGE_IDENT_, stage_ident)) {
+
+        ExecEnv::log().error("RuntimeProperties::getIngestPipeline, Package: {}, pipeline stage has no identifier", package_ident);
+        continue;
+
+      }
+
+      // Missing stage values are zero and are replaced by the stage defaults.
+      PipelineStageConfig stage_config;
+      auto stage_value = [&node_tree, &package_ident, &stage_ident](const char* value_name, size_t& value) {
+
+        if (node_tree.checkProperty(value_name) and not node_tree.getProperty(value_name, value)) {
+
+          ExecEnv::log().error("RuntimeProperties::getIngestPipeline, Package: {}, stage: {}, invalid value: {}", package_ident, stage_ident, value_name);
+
+        }
+
+      };
+      stage_value(PIPELINE_THREADS_, stage_config.threads);
+      stage_value(PIPELINE_HIGH_TIDE_, stage_config.high_tide);
+      stage_value(PIPELINE_LOW_TIDE_, stage_config.low_tide);
+      stage_value(PIPELINE_BATCH_SIZE_, stage_config.batch_size);
+
+      pipeline_config.stage(Utility::trimEndWhiteSpace(stage_ident), stage_config);
+
+    }
+
+  }
+
+  return pipeline_config;
+
+}
+
+
+// The optional INFO field allow list of a package, for example:
+// <vcfInfoList><vcfInfoItem>AF</vcfInfoItem><vcfInfoItem>vep</vcfInfoItem></vcfInfoList>
+// An empty list reads no INFO fields.
+std::optional<kgl::EvidenceInfoSet> kgl::RuntimeProperties::getInfoAllowList(const PropertyTree& package_tree, const std::string& package_ident) {
+
+  if (not package_tree.checkProperty(EVIDENCE_INFO_LIST_)) {
+
+    return std::nullopt;
+
+  }
+
+  EvidenceInfoSet info_allow_list;
+  std::vector<SubPropertyTree> info_tree_vector;
+  if (not package_tree.getPropertyTreeVector(EVIDENCE_INFO_LIST_, info_tree_vector)) {
+
+    ExecEnv::log().info("RuntimeProperties::getInfoAllowList, Package: {}, empty INFO list, no INFO fields are read", package_ident);
+    return info_allow_list;
+
+  }
+
+  for (auto const& [node_name, node_tree] : info_tree_vector) {
+
+    if (node_name != EVIDENCE_INFO_ITEM_) continue;
+
+    std::string info = Utility::trimEndWhiteSpace(node_tree.getValue());
+    if (not info_allow_list.insert(info).second) {
+
+      ExecEnv::log().warn("RuntimeProperties::getInfoAllowList, Package: {}, duplicate Info item: {}", package_ident, info);
+
+    }
+
+  }
+
+  return info_allow_list;
+
+}
+
+
+// The optional genomic regions of a package, for example:
+// <vcfRegionList><vcfRegion>chr7:117480025-117668665</vcfRegion><vcfRegion>chr17</vcfRegion></vcfRegionList>
+// Only records overlapping the regions are read from the package VCF files, which must be indexed '.bgz' files.
+kel::BGZRegionVector kgl::RuntimeProperties::getRegionList(const PropertyTree& package_tree, const std::string& package_ident) {
+
+  BGZRegionVector vcf_regions;
+  std::vector<SubPropertyTree> region_tree_vector;
+  if (not package_tree.checkProperty(PACKAGE_REGION_LIST_)
+      or not package_tree.getPropertyTreeVector(PACKAGE_REGION_LIST_, region_tree_vector)) {
+
+    return vcf_regions;
+
+  }
+
+  for (auto const& [node_name, node_tree] : region_tree_vector) {
+
+    if (node_name != PACKAGE_REGION_) continue;
+
+    std::string region_text = Utility::trimEndWhiteSpace(node_tree.getValue());
+    auto region_opt = BGZRegion::parseRegion(region_text);
+    if (not region_opt) {
+
+      ExecEnv::log().critical("RuntimeProperties::getRegionList, Package: {}, invalid VCF region: {}", package_ident, region_text);
+
+    }
+
+    vcf_regions.push_back(region_opt.value());
+
+  }
+
+  ExecEnv::log().info("RuntimeProperties::getRegionList, Package: {}, VCF records restricted to: {} regions", package_ident, vcf_regions.size());
+
+  return vcf_regions;
+
+}
+
+
 // A map of analysis
 kgl::RuntimeAnalysisMap kgl::RuntimeProperties::getAnalysisMap() const {
 
@@ -334,11 +692,43 @@ kgl::RuntimeDataFileMap kgl::RuntimeProperties::getDataFiles() const {
 
       }
 
+      // The optional sample subset, all samples are parsed if not specified.
+      key = std::string(VCF_SAMPLE_LIST_);
+      VCFSampleSelection sample_selection;
+      std::vector<SubPropertyTree> sample_tree_vector;
+      if (sub_tree.second.checkProperty(key) and sub_tree.second.getPropertyTreeVector(key, sample_tree_vector)) {
+
+        for (const auto& sample_sub_tree : sample_tree_vector) {
+
+          std::string sample_value = Utility::trimEndWhiteSpace(sample_sub_tree.second.getValue());
+          if (sample_sub_tree.first == VCF_SAMPLE_) {
+
+            sample_selection.samples.insert(sample_value);
+
+          } else if (sample_sub_tree.first == VCF_SAMPLE_POPULATION_) {
+
+            sample_selection.populations.insert(sample_value);
+
+          } else if (sample_sub_tree.first == VCF_SAMPLE_SUPER_POPULATION_) {
+
+            sample_selection.super_populations.insert(sample_value);
+
+          }
+
+        }
+
+        ExecEnv::log().info("RuntimeProperties::getDataFiles; VCF file: {}, selected samples: {}, populations: {}, super populations: {}",
+                            vcf_ident, sample_selection.samples.size(), sample_selection.populations.size(),
+                            sample_selection.super_populations.size());
+
+      }
+
       std::shared_ptr<BaseFileInfo> file_info_ptr = std::make_shared<RuntimeVCFFileInfo>( vcf_ident,
                                                                                           vcf_file_name,
                                                                                           vcf_parser_type,
                                                                                           vcf_reference_genome,
-                                                                                          evidence_ident);
+                                                                                          evidence_ident,
+                                                                                          std::move(sample_selection));
 
       auto result = data_file_map.try_emplace(vcf_ident, file_info_ptr);
 
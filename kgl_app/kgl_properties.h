@@ -11,6 +11,8 @@
 #include "kel_property_tree.h"
 #include "kgl_genome_types.h"
 #include "kgl_properties_resource.h"
+#include "kel_executor.h"
+#include "kel_metrics.h"
 
 #include <memory>
 #include <string>
@@ -61,17 +63,63 @@ public:
 
   [[nodiscard]] ActiveParameterList getParameterMap() const;
 
+  // The optional process-wide executor thread count and thread affinity.
+  [[nodiscard]] ExecutorConfig getExecutorConfig() const;
+
+  // The optional runtime metrics export file, format and interval.
+  [[nodiscard]] MetricsConfig getMetricsConfig() const;
+
+  // The optional directory of the gzip checkpoint index files, empty if the indexes are written alongside the gzip files.
+  [[nodiscard]] std::string getGzipIndexDirectory() const;
+
+  // True if analysis reports are written as block gzip ('.bgz') files, the default is uncompressed reports.
+  [[nodiscard]] bool getCompressReports() const;
+
+  // The optional directory of the parsed VCF population snapshots, empty (the default) if snapshots are not used.
+  [[nodiscard]] std::string getSnapshotDirectory() const;
+
 private:
 
   std::string work_directory_;  // The work directory, all files are specified 'work_directory/file_name'
   std::shared_ptr<PropertyTree> property_tree_ptr_;   // The aggregated and parsed XML property tree.
 
+  // The optional ingest pipeline configuration of a package.
+  [[nodiscard]] static PipelineConfig getIngestPipeline(const PropertyTree& package_tree, const std::string& package_ident);
+  [[nodiscard]] static std::optional<EvidenceInfoSet> getInfoAllowList(const PropertyTree& package_tree, const std::string& package_ident);
+  [[nodiscard]] static BGZRegionVector getRegionList(const PropertyTree& package_tree, const std::string& package_ident);
+
   // Node categories.
   constexpr static const char DOT_[] = ".";
   constexpr static const char RUNTIME_ROOT_[] = "runTime";
   constexpr static const char ACTIVE_[] = "active";
   constexpr static const char VALUE_[] = "value";
 
+  // Process-wide executor categories.
+  constexpr static const char EXECUTOR_[] = "executor";
+  constexpr static const char EXECUTOR_THREADS_[] = "threads";
+  constexpr static const char EXECUTOR_AFFINITY_[] = "affinity";
+  constexpr static const char AFFINITY_CORE_[] = "core";
+  constexpr static const char AFFINITY_NUMA_[] = "numa";
+
+  // Runtime metrics export categories.
+  constexpr static const char METRICS_[] = "metrics";
+  constexpr static const char METRICS_FILE_[] = "file";
+  constexpr static const char METRICS_FORMAT_[] = "format";
+  constexpr static const char METRICS_INTERVAL_[] = "interval";
+  constexpr static const char FORMAT_JSON_[] = "json";
+  constexpr static const char FORMAT_PROMETHEUS_[] = "prometheus";
+
+  // Gzip checkpoint index directory.
+  constexpr static const char GZIP_INDEX_DIRECTORY_[] = "gzipIndexDirectory";
+
+  // Parsed VCF population snapshot directory.
+  constexpr static const char SNAPSHOT_DIRECTORY_[] = "snapshotDirectory";
+
+  // Compressed analysis reports.
+  constexpr static const char COMPRESS_REPORTS_[] = "compressReports";
+  constexpr static const char TRUE_[] = "TRUE";
+  constexpr static const char FALSE_[] = "FALSE";
+
   // Active Package Runtime categories.
   constexpr static const char EXECUTE_LIST_[] = "executeList";
   // Package Runtime categories.
@@ -82,6 +130,17 @@ private:
   constexpr static const char PACKAGE_RESOURCE_LIST_[] = "resourceList";
   constexpr static const char PACKAGE_ITERATION_[] = "iteration";
   constexpr static const char PACKAGE_ITERATION_LIST_[] = "iterationList";
+  constexpr static const char PACKAGE_PIPELINE_[] = "ingestPipeline";
+  constexpr static const char PIPELINE_AUTO_[] = "auto";
+  constexpr static const char PIPELINE_INTERVAL_[] = "balanceInterval";
+  constexpr static const char PIPELINE_STAGE_[] = "stage";
+  constexpr static const char PIPELINE_STAGE_IDENT_[] = "stageIdent";
+  constexpr static const char PIPELINE_THREADS_[] = "threads";
+  constexpr static const char PIPELINE_HIGH_TIDE_[] = "highTide";
+  constexpr static const char PIPELINE_LOW_TIDE_[] = "lowTide";
+  constexpr static const char PIPELINE_BATCH_SIZE_[] = "batchSize";
+  constexpr static const char PACKAGE_REGION_LIST_[] = "vcfRegionList";
+  constexpr static const char PACKAGE_REGION_[] = "vcfRegion";
   // Analysis Runtime categories.
   constexpr static const char ANALYSIS_LIST_[] = "analysisList";
   constexpr static const char ANALYSIS_[] = "analysis";
@@ -106,6 +165,11 @@ private:
   constexpr static const char VCF_DATA_FILE_TYPE_[] = "vcfFile";
   constexpr static const char VCF_FILE_GENOME_[] =  "vcfGenome";
   constexpr static const char VCF_INFO_EVIDENCE_[] =  "vcfInfo";
+  // Optional VCF sample subset.
+  constexpr static const char VCF_SAMPLE_LIST_[] =  "vcfSampleList";
+  constexpr static const char VCF_SAMPLE_[] =  "vcfSample";
+  constexpr static const char VCF_SAMPLE_POPULATION_[] =  "vcfPopulation";
+  constexpr static const char VCF_SAMPLE_SUPER_POPULATION_[] =  "vcfSuperPopulation";
   // VCF Info Evidence categories.
   constexpr static const char EVIDENCE_LIST_[] = "evidenceList";
   constexpr static const char EVIDENCE_IDENT_[] = "evidenceIdent";
@@ -6,6 +6,9 @@
 #include "kel_utility.h"
 #include "kgl_runtime.h"
 
+#include <algorithm>
+#include <iterator>
+
 
 namespace kgl = kellerberrin::genome;
 
@@ -103,6 +106,38 @@ std::optional<const kgl::EvidenceInfoSet> kgl::VariantEvidenceMap::lookupEvidenc
 }
 
 
+kgl::VariantEvidenceMap kgl::VariantEvidenceMap::restrictEvidence(const EvidenceInfoSet& allow_list) const {
+
+  VariantEvidenceMap restricted_map;
+  for (auto const& [evidence_ident, info_set] : evidence_map_) {
+
+    EvidenceInfoSet restricted_set;
+    if (info_set.empty()) {
+
+      restricted_set = allow_list;
+
+    } else {
+
+      std::ranges::set_intersection(info_set, allow_list, std::inserter(restricted_set, restricted_set.end()));
+
+    }
+
+    // An empty set would subscribe all fields.
+    if (restricted_set.empty()) {
+
+      restricted_set.insert(NO_INFO_FIELDS_);
+
+    }
+
+    restricted_map.setEvidence(evidence_ident, restricted_set);
+
+  }
+
+  return restricted_map;
+
+}
+
+
 void kgl::VariantEvidenceMap::setEvidence(const std::string& evidence_ident, const std::set<std::string>& info_list) {
 
   auto result = evidence_map_.emplace(evidence_ident, info_list);
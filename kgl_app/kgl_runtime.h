@@ -7,6 +7,8 @@
 
 #include "kgl_genome_types.h"
 #include "kgl_runtime_resource.h"
+#include "kel_pipeline_config.h"
+#include "kel_bzip_index.h"
 
 #include <memory>
 #include <string>
@@ -50,6 +52,9 @@ private:
 // Object to hold a Package object and associated analysis, genome database and VCF file objects (only identifiers).
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// An ordered set of VCF INFO field IDs.
+using EvidenceInfoSet = std::set<std::string>;
+
 class RuntimePackage;
 using RuntimePackageMap = std::map<std::string, RuntimePackage>;
 
@@ -60,11 +65,17 @@ public:
   RuntimePackage( std::string package_identifier,
                   std::vector<std::string> analysis_list,
                   std::vector<std::pair<std::string, std::string>> resource_database_def,
-                  std::vector<std::vector<std::string>> iterative_file_list)
+                  std::vector<std::vector<std::string>> iterative_file_list,
+                  PipelineConfig ingest_pipeline = PipelineConfig(),
+                  std::optional<EvidenceInfoSet> info_allow_list = std::nullopt,
+                  BGZRegionVector vcf_regions = BGZRegionVector())
                   : package_identifier_(std::move(package_identifier)),
                     analysis_list_(std::move(analysis_list)),
                     resource_list_(std::move(resource_database_def)),
-                    iterative_file_list_(std::move(iterative_file_list)) {}
+                    iterative_file_list_(std::move(iterative_file_list)),
+                    ingest_pipeline_(std::move(ingest_pipeline)),
+                    info_allow_list_(std::move(info_allow_list)),
+                    vcf_regions_(std::move(vcf_regions)) {}
   RuntimePackage(const RuntimePackage&) = default;
   ~RuntimePackage() = default;
 
@@ -72,6 +83,12 @@ public:
   [[nodiscard]] const std::vector<std::string>& analysisList() const { return analysis_list_; }
   [[nodiscard]] const std::vector<std::pair<std::string, std::string>>& resourceList() const { return resource_list_; }
   [[nodiscard]] const std::vector<std::vector<std::string>>& iterativeFileList() const { return iterative_file_list_; }
+  // The optional stage threads, queue depths and batch sizes used to read the package data files.
+  [[nodiscard]] const PipelineConfig& ingestPipeline() const { return ingest_pipeline_; }
+  // The optional INFO fields read from the package VCF files, other INFO fields are skipped and not stored.
+  [[nodiscard]] const std::optional<EvidenceInfoSet>& infoAllowList() const { return info_allow_list_; }
+  // The optional genomic regions read from the package VCF files (indexed '.bgz' files), all records if empty.
+  [[nodiscard]] const BGZRegionVector& vcfRegions() const { return vcf_regions_; }
 
 private:
 
@@ -79,6 +96,9 @@ private:
   std::vector<std::string> analysis_list_;
   std::vector<std::pair<std::string, std::string>> resource_list_;
   std::vector<std::vector<std::string>> iterative_file_list_;
+  PipelineConfig ingest_pipeline_;
+  std::optional<EvidenceInfoSet> info_allow_list_;
+  BGZRegionVector vcf_regions_;
 
 };
 
@@ -147,6 +167,22 @@ private:
 
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Optional subset of the VCF samples (genomes) to parse. Samples are explicitly named or are selected by population
+// and super population codes from the genome genealogy (genomeAux) resources. All samples are parsed if empty.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct VCFSampleSelection {
+
+  std::set<std::string> samples;
+  std::set<std::string> populations;
+  std::set<std::string> super_populations;
+
+  [[nodiscard]] bool empty() const { return samples.empty() and populations.empty() and super_populations.empty(); }
+
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Object to hold vcf file information.
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -160,21 +196,25 @@ public:
                      const std::string& file_name,
                      const std::string& file_type,
                      const std::string& reference_genome,
-                     const std::string& evidence_ident)
+                     const std::string& evidence_ident,
+                     VCFSampleSelection sample_selection = VCFSampleSelection())
   : BaseFileInfo(identifier, file_name, file_type),
     reference_genome_(reference_genome),
-    evidence_ident_(evidence_ident) {}
+    evidence_ident_(evidence_ident),
+    sample_selection_(std::move(sample_selection)) {}
   RuntimeVCFFileInfo(const RuntimeVCFFileInfo&) = default;
   ~RuntimeVCFFileInfo() override = default;
 
   [[nodiscard]] const std::string& referenceGenome() const { return reference_genome_; }
   [[nodiscard]] const std::string& evidenceIdent() const { return evidence_ident_; }
+  [[nodiscard]] const VCFSampleSelection& sampleSelection() const { return sample_selection_; }
 
 
 private:
 
   std::string reference_genome_;
   std::string evidence_ident_;
+  VCFSampleSelection sample_selection_;
 
 };
 
@@ -217,7 +257,6 @@ private:
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Indexed by the identifier <evidenceIdent>, an ordered set of INFO field IDs.
-using EvidenceInfoSet = std::set<std::string>;
 using EvidenceMap = std::map<std::string, EvidenceInfoSet>;
 
 class VariantEvidenceMap {
@@ -231,6 +270,11 @@ public:
   [[nodiscard]] const EvidenceMap& getMap() const { return evidence_map_; }
   [[nodiscard]] std::optional<const EvidenceInfoSet> lookupEvidence(const std::string& evidence_ident) const;
   void setEvidence(const std::string& evidence_ident, const std::set<std::string>& info_ids);
+  // Restrict all INFO sets to the allow list. An empty INFO set (all fields) becomes the allow list.
+  [[nodiscard]] VariantEvidenceMap restrictEvidence(const EvidenceInfoSet& allow_list) const;
+
+  // An INFO set containing only this field ID subscribes no INFO fields.
+  constexpr static const char* NO_INFO_FIELDS_{"None"};
 
 private:
 
@@ -32,7 +32,8 @@ public:
         package_map_(runtime_options.getPackageMap()),
         evidence_map_(runtime_options.getEvidenceMap()),
         defined_parameters_(runtime_options.getParameterMap()),
-        work_directory_(std::move(work_directory)) { verifyPackages(); }
+        work_directory_(std::move(work_directory)),
+        snapshot_directory_(runtime_options.getSnapshotDirectory()) { verifyPackages(); }
 
   ~RuntimeConfiguration() = default;
 
@@ -54,6 +55,9 @@ public:
 
   [[nodiscard]] const std::string &workDirectory() const { return work_directory_; }
 
+  // Empty if population snapshots are not used.
+  [[nodiscard]] const std::string &snapshotDirectory() const { return snapshot_directory_; }
+
 private:
 
   // The Runtime information loaded from the XML config files.
@@ -66,6 +70,7 @@ private:
   const VariantEvidenceMap evidence_map_;
   const ActiveParameterList defined_parameters_;
   const std::string work_directory_;
+  const std::string snapshot_directory_;
 
   // Check the integrity of all the XML information.
   void verifyPackages() const;
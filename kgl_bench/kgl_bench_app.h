@@ -0,0 +1,66 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KGL_BENCH_APP_H
+#define KGL_BENCH_APP_H
+
+
+#include "kel_exec_env.h"
+
+#include <string>
+
+
+namespace kellerberrin::genome {   //  organization::project level namespace
+
+
+// Holds the Commandline Arguments.
+struct BenchCmdLineArgs {
+
+  std::string workDirectory{"./"};
+  std::string logFile{"kgl_bench.log"};
+  std::string bgzFile;        // Optional, if not specified the synthetic '.bgz' file is used for the inflate benchmarks.
+  std::string jsonFile{"kgl_bench.json"};
+  std::string syntheticFile{"kgl_bench_synthetic"}; // The synthetic VCF file prefix.
+  size_t records{200000};
+  size_t samples{100};
+  size_t infoFields{10};
+  size_t repeat{3};
+  size_t threads{15};
+  size_t max_error_count{1000};
+  size_t max_warn_count{1000};
+
+};
+
+// The Runtime environment of the benchmark executable.
+class BenchExecEnv {
+
+public:
+
+  BenchExecEnv()=delete;
+  ~BenchExecEnv()=delete;
+
+
+// The following 5 static members are required for all applications.
+  inline static constexpr const char* VERSION = "0.1";
+  inline static constexpr const char* MODULE_NAME = "kglBench";
+  static void executeApp(); // Application mainline.
+  [[nodiscard]] static bool parseCommandLine(int argc, char const ** argv);  // Parse command line arguments.
+  [[nodiscard]] static std::unique_ptr<ExecEnvLogger> createLogger(); // Create application logger.
+
+
+  [[nodiscard]] inline static const BenchCmdLineArgs& getArgs() { return args_; }
+
+private:
+
+  inline static BenchCmdLineArgs args_;
+
+};
+
+
+
+} //  end namespace
+
+
+
+#endif //KGL_BENCH_APP_H
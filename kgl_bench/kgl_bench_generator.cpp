@@ -0,0 +1,323 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+#include "kgl_bench_generator.h"
+#include "kel_bzip_writer.h"
+#include "kel_exec_env.h"
+
+#include <fstream>
+#include <random>
+#include <array>
+#include <filesystem>
+
+#include <zlib.h>
+#include <bzlib.h>
+
+
+namespace kgl = kellerberrin::genome;
+
+
+void kgl::SyntheticVCF::writeHeader(std::ostream& vcf_stream) const {
+
+  vcf_stream << "##fileformat=VCFv4.2\n"
+             << "##source=kgl_bench synthetic VCF\n";
+
+  for (size_t contig = 1; contig <= parameters_.contig_count; ++contig) {
+
+    vcf_stream << "##contig=<ID=chr" << contig << ",length=" << CONTIG_SIZE_ << ">\n";
+
+  }
+
+  // Cycle through the INFO field types.
+  static const std::array<const char*, 4> info_types{ "Integer", "Float", "String", "Flag" };
+  for (size_t field = 0; field < parameters_.info_fields; ++field) {
+
+    const char* info_type = info_types[field % info_types.size()];
+    vcf_stream << "##INFO=<ID=INFO" << field
+               << ",Number=" << (field % info_types.size() == 3 ? "0" : "A")
+               << ",Type=" << info_type
+               << ",Description=\"Synthetic " << info_type << " field\">\n";
+
+  }
+
+  vcf_stream << "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">\n";
+  vcf_stream << "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO";
+  if (parameters_.sample_count > 0) {
+
+    vcf_stream << "\tFORMAT";
+
+  }
+
+  for (size_t sample = 0; sample < parameters_.sample_count; ++sample) {
+
+    vcf_stream << "\tSAMPLE" << sample;
+
+  }
+  vcf_stream << '\n';
+
+}
+
+
+void kgl::SyntheticVCF::generate(std::ostream& vcf_stream) const {
+
+  writeHeader(vcf_stream);
+
+  std::mt19937_64 generator(parameters_.seed);
+  std::uniform_int_distribution<size_t> base_dist(0, 3);
+  std::uniform_int_distribution<size_t> gap_dist(1, 200);
+  std::uniform_int_distribution<size_t> count_dist(0, 5000);
+  std::uniform_real_distribution<double> freq_dist(0.0, 1.0);
+  // Most genotypes are reference homozygous.
+  std::discrete_distribution<size_t> genotype_dist({ 80, 8, 8, 3, 1 });
+  static const std::array<char, 4> bases{ 'A', 'C', 'G', 'T' };
+  static const std::array<const char*, 5> genotypes{ "0|0", "0|1", "1|0", "1|1", "./." };
+
+  size_t records_per_contig = std::max<size_t>(1, parameters_.record_count / std::max<size_t>(1, parameters_.contig_count));
+  size_t contig{1};
+  size_t position{0};
+  std::string line;
+  for (size_t record = 0; record < parameters_.record_count; ++record) {
+
+    if (record > 0 and record % records_per_contig == 0 and contig < parameters_.contig_count) {
+
+      ++contig;
+      position = 0;
+
+    }
+    position += gap_dist(generator);
+
+    char reference = bases[base_dist(generator)];
+    char alternate = bases[(base_dist(generator) % 3 + 1 + static_cast<size_t>(reference == 'C') + static_cast<size_t>(reference == 'G') * 2 + static_cast<size_t>(reference == 'T') * 3) % 4];
+
+    line.clear();
+    line += "chr";
+    line += std::to_string(contig);
+    line += '\t';
+    line += std::to_string(position);
+    line += "\trs";
+    line += std::to_string(record + 1);
+    line += '\t';
+    line += reference;
+    line += '\t';
+    line += alternate;
+    line += "\t50\tPASS\t";
+
+    for (size_t field = 0; field < parameters_.info_fields; ++field) {
+
+      if (field > 0) {
+
+        line += ';';
+
+      }
+      line += "INFO";
+      line += std::to_string(field);
+      switch(field % 4) {
+
+        case 0:
+          line += '=';
+          line += std::to_string(count_dist(generator));
+          break;
+
+        case 1:
+          line += '=';
+          line += std::to_string(freq_dist(generator));
+          break;
+
+        case 2:
+          line += "=value";
+          line += std::to_string(count_dist(generator) % 100);
+          break;
+
+        default:
+          break;
+
+      }
+
+    }
+
+    if (parameters_.info_fields == 0) {
+
+      line += '.';
+
+    }
+
+    if (parameters_.sample_count > 0) {
+
+      line += "\tGT";
+
+    }
+
+    for (size_t sample = 0; sample < parameters_.sample_count; ++sample) {
+
+      line += '\t';
+      line += genotypes[genotype_dist(generator)];
+
+    }
+    line += '\n';
+
+    vcf_stream << line;
+
+  }
+
+}
+
+
+std::optional<kgl::SyntheticVCFFiles> kgl::SyntheticVCF::generateFiles(const std::string& file_prefix) const {
+
+  SyntheticVCFFiles files;
+  files.text_file = file_prefix + TEXT_EXTENSION_;
+  files.gz_file = file_prefix + GZ_EXTENSION_;
+  files.bgz_file = file_prefix + BGZ_EXTENSION_;
+  files.bz2_file = file_prefix + BZ2_EXTENSION_;
+
+  {
+    std::ofstream text_stream(files.text_file, std::ios::binary | std::ios::trunc);
+    if (not text_stream.good()) {
+
+      ExecEnv::log().error("SyntheticVCF::generateFiles; could not open file: {}", files.text_file);
+      return std::nullopt;
+
+    }
+
+    generate(text_stream);
+
+    if (not text_stream.good()) {
+
+      ExecEnv::log().error("SyntheticVCF::generateFiles; error writing file: {}", files.text_file);
+      return std::nullopt;
+
+    }
+
+  }
+
+  // A stale checkpoint index would be rejected (size and modification time), but is removed to time index creation.
+  std::error_code error_code;
+  std::filesystem::remove(files.gz_file + GZ_INDEX_EXTENSION_, error_code);
+
+  if (not compressGzip(files.text_file, files.gz_file)
+      or not compressBGZ(files.text_file, files.bgz_file)
+      or not compressBzip2(files.text_file, files.bz2_file)) {
+
+    return std::nullopt;
+
+  }
+
+  ExecEnv::log().info("SyntheticVCF::generateFiles; records: {}, samples: {}, INFO fields: {}, text file: {} ({} bytes)",
+                      parameters_.record_count, parameters_.sample_count, parameters_.info_fields,
+                      files.text_file, std::filesystem::file_size(files.text_file, error_code));
+
+  return files;
+
+}
+
+
+bool kgl::SyntheticVCF::compressGzip(const std::string& text_file, const std::string& gz_file) {
+
+  std::ifstream text_stream(text_file, std::ios::binary);
+  gzFile gz_stream = ::gzopen(gz_file.c_str(), "wb");
+  if (not text_stream.good() or gz_stream == nullptr) {
+
+    ExecEnv::log().error("SyntheticVCF::compressGzip; could not open file: {} or {}", text_file, gz_file);
+    if (gz_stream != nullptr) ::gzclose(gz_stream);
+    return false;
+
+  }
+
+  std::string buffer(COPY_BUFFER_SIZE_, '\0');
+  bool write_ok{true};
+  while (write_ok) {
+
+    text_stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    auto read_size = static_cast<unsigned>(text_stream.gcount());
+    if (read_size == 0) {
+
+      break;
+
+    }
+    write_ok = ::gzwrite(gz_stream, buffer.data(), read_size) == static_cast<int>(read_size);
+
+  }
+
+  write_ok = (::gzclose(gz_stream) == Z_OK) and write_ok;
+  if (not write_ok) {
+
+    ExecEnv::log().error("SyntheticVCF::compressGzip; error writing file: {}", gz_file);
+
+  }
+
+  return write_ok;
+
+}
+
+
+bool kgl::SyntheticVCF::compressBGZ(const std::string& text_file, const std::string& bgz_file) {
+
+  std::ifstream text_stream(text_file, std::ios::binary);
+  BGZStreamWriter bgz_stream;
+  if (not text_stream.good() or not bgz_stream.open(bgz_file)) {
+
+    ExecEnv::log().error("SyntheticVCF::compressBGZ; could not open file: {} or {}", text_file, bgz_file);
+    return false;
+
+  }
+
+  bgz_stream << text_stream.rdbuf();
+  bgz_stream.close();
+
+  if (bgz_stream.compressionError()) {
+
+    ExecEnv::log().error("SyntheticVCF::compressBGZ; error writing file: {}", bgz_file);
+    return false;
+
+  }
+
+  return true;
+
+}
+
+
+bool kgl::SyntheticVCF::compressBzip2(const std::string& text_file, const std::string& bz2_file) {
+
+  constexpr const int BLOCK_SIZE_100K{9};
+
+  std::ifstream text_stream(text_file, std::ios::binary);
+  FILE* bz2_handle = std::fopen(bz2_file.c_str(), "wb");
+  if (not text_stream.good() or bz2_handle == nullptr) {
+
+    ExecEnv::log().error("SyntheticVCF::compressBzip2; could not open file: {} or {}", text_file, bz2_file);
+    if (bz2_handle != nullptr) std::fclose(bz2_handle);
+    return false;
+
+  }
+
+  int bz_error{BZ_OK};
+  BZFILE* bz2_stream = ::BZ2_bzWriteOpen(&bz_error, bz2_handle, BLOCK_SIZE_100K, 0, 0);
+  std::string buffer(COPY_BUFFER_SIZE_, '\0');
+  while (bz_error == BZ_OK) {
+
+    text_stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    auto read_size = static_cast<int>(text_stream.gcount());
+    if (read_size == 0) {
+
+      break;
+
+    }
+    ::BZ2_bzWrite(&bz_error, bz2_stream, buffer.data(), read_size);
+
+  }
+
+  bool write_ok = bz_error == BZ_OK;
+  ::BZ2_bzWriteClose(&bz_error, bz2_stream, write_ok ? 0 : 1, nullptr, nullptr);
+  write_ok = write_ok and bz_error == BZ_OK;
+  write_ok = (std::fclose(bz2_handle) == 0) and write_ok;
+
+  if (not write_ok) {
+
+    ExecEnv::log().error("SyntheticVCF::compressBzip2; error writing file: {}", bz2_file);
+
+  }
+
+  return write_ok;
+
+}
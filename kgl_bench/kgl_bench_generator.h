@@ -0,0 +1,95 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KGL_BENCH_GENERATOR_H
+#define KGL_BENCH_GENERATOR_H
+
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <optional>
+#include <cstdint>
+
+
+namespace kellerberrin::genome {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Generates a reproducible synthetic VCF file so that the benchmarks run offline.
+// The record count, sample (genotype column) count and INFO density (INFO fields per record) are configurable.
+// The same parameters and seed always generate the same file.
+//
+// The text file is also written in each compressed format read by the stream objects:
+// '.gz' (a single gzip member, not block gzipped), '.bgz' (block gzip) and '.bz2'.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+struct SyntheticVCFParameters {
+
+  size_t record_count{200000};
+  size_t sample_count{100};
+  size_t info_fields{10};
+  size_t contig_count{4};
+  uint64_t seed{42};
+
+};
+
+
+// The synthetic files written by generateFiles().
+struct SyntheticVCFFiles {
+
+  std::string text_file;
+  std::string gz_file;
+  std::string bgz_file;
+  std::string bz2_file;
+
+};
+
+
+class SyntheticVCF {
+
+public:
+
+  explicit SyntheticVCF(const SyntheticVCFParameters& parameters) : parameters_(parameters) {}
+  ~SyntheticVCF() = default;
+
+  // Write the VCF text.
+  void generate(std::ostream& vcf_stream) const;
+
+  // Write the text file and the compressed files using the file prefix (which may include a directory path).
+  // Any existing gzip checkpoint index is removed.
+  [[nodiscard]] std::optional<SyntheticVCFFiles> generateFiles(const std::string& file_prefix) const;
+
+  [[nodiscard]] const SyntheticVCFParameters& parameters() const { return parameters_; }
+
+private:
+
+  SyntheticVCFParameters parameters_;
+
+  constexpr static const size_t CONTIG_SIZE_{100000000};
+  constexpr static const size_t COPY_BUFFER_SIZE_{1 << 20};
+  constexpr static const char* TEXT_EXTENSION_{".vcf"};
+  constexpr static const char* GZ_EXTENSION_{".vcf.gz"};
+  constexpr static const char* BGZ_EXTENSION_{".vcf.bgz"};
+  constexpr static const char* BZ2_EXTENSION_{".vcf.bz2"};
+  constexpr static const char* GZ_INDEX_EXTENSION_{".gzidx"};
+
+  void writeHeader(std::ostream& vcf_stream) const;
+
+  [[nodiscard]] static bool compressGzip(const std::string& text_file, const std::string& gz_file);
+  [[nodiscard]] static bool compressBGZ(const std::string& text_file, const std::string& bgz_file);
+  [[nodiscard]] static bool compressBzip2(const std::string& text_file, const std::string& bz2_file);
+
+};
+
+
+
+} //  end namespace
+
+
+
+#endif //KGL_BENCH_GENERATOR_H
@@ -0,0 +1,235 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+#include "kgl_bench_inflate.h"
+#include "kel_bzip_workflow.h"
+#include "kel_exec_env.h"
+
+#include <fstream>
+#include <iostream>
+#include <chrono>
+
+
+namespace kgl = kellerberrin::genome;
+
+
+std::vector<kgl::InflateBenchResult> kgl::InflateBenchmark::runBenchmark(const std::string& bgz_file_name) {
+
+  std::vector<InflateBenchResult> results;
+
+  if (not loadBlocks(bgz_file_name)) {
+
+    return results;
+
+  }
+
+  ExecEnv::log().info("InflateBenchmark::runBenchmark; file: {}, blocks loaded: {}, compressed MB: {:.1f}, repeat: {}, stream threads: {}",
+                      bgz_file_name, block_offsets_.size(), static_cast<double>(block_buffer_.size()) / BYTES_PER_MB_, repeat_, threads_);
+
+  for (auto backend_type : InflateBackend::availableBackends()) {
+
+    auto result_opt = blockInflate(backend_type);
+    if (not result_opt) {
+
+      continue;
+
+    }
+
+    auto& result = result_opt.value();
+    if (not streamInflate(bgz_file_name, result)) {
+
+      continue;
+
+    }
+
+    ExecEnv::log().info("InflateBenchmark; backend: {}, block inflate MB/s: {:.1f}, stream MB/s: {:.1f}, lines: {}",
+                        InflateBackend::backendName(backend_type), result.block_mbs, result.stream_mbs, result.line_count);
+    std::cout << InflateBackend::backendName(backend_type)
+              << " block_inflate_MB/s " << result.block_mbs
+              << " stream_MB/s " << result.stream_mbs << '\n';
+
+    results.push_back(result);
+
+  }
+
+  return results;
+
+}
+
+
+// Read the compressed blocks into memory.
+bool kgl::InflateBenchmark::loadBlocks(const std::string& bgz_file_name) {
+
+  block_buffer_.clear();
+  block_offsets_.clear();
+
+  std::ifstream bgz_file(bgz_file_name, std::ios::binary);
+  if (not bgz_file.good()) {
+
+    ExecEnv::log().error("InflateBenchmark::loadBlocks; could not open file: {}", bgz_file_name);
+    return false;
+
+  }
+
+  std::string block(MAX_BLOCK_SIZE_, '\0');
+  while (block_buffer_.size() < MAX_LOAD_SIZE_) {
+
+    bgz_file.read(block.data(), BGZ_HEADER_SIZE_);
+    if (static_cast<size_t>(bgz_file.gcount()) != BGZ_HEADER_SIZE_) {
+
+      break;
+
+    }
+
+    auto size_ptr = reinterpret_cast<const unsigned char*>(block.data()) + BLOCK_SIZE_OFFSET_;
+    size_t block_size = (static_cast<size_t>(size_ptr[0]) | (static_cast<size_t>(size_ptr[1]) << 8)) + 1;
+    if (static_cast<unsigned char>(block[0]) != 31 or static_cast<unsigned char>(block[1]) != 139 or block_size <= BGZ_HEADER_SIZE_) {
+
+      ExecEnv::log().error("InflateBenchmark::loadBlocks; file: {} is not a valid '.bgz' file", bgz_file_name);
+      return false;
+
+    }
+
+    bgz_file.read(block.data() + BGZ_HEADER_SIZE_, static_cast<std::streamsize>(block_size - BGZ_HEADER_SIZE_));
+    if (static_cast<size_t>(bgz_file.gcount()) != block_size - BGZ_HEADER_SIZE_) {
+
+      ExecEnv::log().error("InflateBenchmark::loadBlocks; file: {} truncated block", bgz_file_name);
+      return false;
+
+    }
+
+    block_offsets_.push_back(block_buffer_.size());
+    block_buffer_.append(block.data(), block_size);
+
+  }
+
+  if (block_offsets_.empty()) {
+
+    ExecEnv::log().error("InflateBenchmark::loadBlocks; no blocks read from file: {}", bgz_file_name);
+    return false;
+
+  }
+
+  return true;
+
+}
+
+
+// Single thread inflate of the in-memory blocks.
+std::optional<kgl::InflateBenchResult> kgl::InflateBenchmark::blockInflate(InflateBackendType backend_type) const {
+
+  auto backend_opt = InflateBackend::createBackend(backend_type);
+  if (not backend_opt) {
+
+    return std::nullopt;
+
+  }
+  auto& backend_ptr = backend_opt.value();
+
+  InflateBenchResult result;
+  result.backend_type = backend_type;
+  result.compressed_bytes = block_buffer_.size();
+
+  std::string output_buffer(MAX_BLOCK_SIZE_, '\0');
+  double best_seconds{0.0};
+  for (size_t run = 0; run < repeat_; ++run) {
+
+    size_t uncompressed_bytes{0};
+    auto start = std::chrono::steady_clock::now();
+    for (size_t index = 0; index < block_offsets_.size(); ++index) {
+
+      size_t block_end = index + 1 < block_offsets_.size() ? block_offsets_[index + 1] : block_buffer_.size();
+      auto inflate_size = backend_ptr->inflateMember( block_buffer_.data() + block_offsets_[index]
+                                                    , block_end - block_offsets_[index]
+                                                    , output_buffer.data()
+                                                    , output_buffer.size());
+      if (not inflate_size) {
+
+        ExecEnv::log().error("InflateBenchmark::blockInflate; backend: {} failed on block: {}", backend_ptr->backendName(), index);
+        return std::nullopt;
+
+      }
+      uncompressed_bytes += inflate_size.value();
+
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    result.uncompressed_bytes = uncompressed_bytes;
+    if (run == 0 or elapsed.count() < best_seconds) {
+
+      best_seconds = elapsed.count();
+
+    }
+
+  }
+
+  if (best_seconds > 0.0) {
+
+    result.block_mbs = static_cast<double>(result.uncompressed_bytes) / (best_seconds * BYTES_PER_MB_);
+
+  }
+
+  return result;
+
+}
+
+
+// Multi-threaded decompression of the file using BGZStreamIO.
+bool kgl::InflateBenchmark::streamInflate(const std::string& bgz_file_name, InflateBenchResult& result) const {
+
+  double best_seconds{0.0};
+  for (size_t run = 0; run < repeat_; ++run) {
+
+    BGZStreamIO bgz_stream(threads_);
+    if (not bgz_stream.setInflateBackend(result.backend_type)) {
+
+      return false;
+
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (not bgz_stream.open(bgz_file_name)) {
+
+      return false;
+
+    }
+
+    size_t line_count{0};
+    size_t data_size{0};
+    while (true) {
+
+      auto line_block = bgz_stream.readBlock();
+      if (line_block.EOFBlock()) {
+
+        break;
+
+      }
+      line_count += line_block.size();
+      data_size += line_block.dataSize();
+
+    }
+    bgz_stream.close();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (not bgz_stream.good()) {
+
+      ExecEnv::log().error("InflateBenchmark::streamInflate; backend: {}, decompression error, file: {}",
+                           InflateBackend::backendName(result.backend_type), bgz_file_name);
+      return false;
+
+    }
+
+    result.line_count = line_count;
+    if (run == 0 or elapsed.count() < best_seconds) {
+
+      best_seconds = elapsed.count();
+      result.stream_mbs = best_seconds > 0.0 ? static_cast<double>(data_size) / (best_seconds * BYTES_PER_MB_) : 0.0;
+
+    }
+
+  }
+
+  return true;
+
+}
@@ -0,0 +1,80 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KGL_BENCH_INFLATE_H
+#define KGL_BENCH_INFLATE_H
+
+
+#include "kel_inflate_backend.h"
+
+#include <string>
+#include <vector>
+#include <optional>
+
+
+namespace kellerberrin::genome {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Benchmarks each compiled inflate backend on a sample '.bgz' file.
+//
+// Block inflate: the compressed blocks are loaded into memory (up to MAX_LOAD_SIZE_ bytes) and decompressed by a
+// single thread, this measures the raw decoder speed without I/O.
+// Stream: the file is read line by line through BGZStreamIO using the backend, this measures the end to end speed.
+//
+// Results are reported as uncompressed MB/s (best of 'repeat' runs) to the log and to std::cout.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+struct InflateBenchResult {
+
+  InflateBackendType backend_type{InflateBackendType::ZLIB};
+  double block_mbs{0.0};
+  double stream_mbs{0.0};
+  size_t compressed_bytes{0};
+  size_t uncompressed_bytes{0};
+  size_t line_count{0};
+
+};
+
+
+class InflateBenchmark {
+
+public:
+
+  InflateBenchmark(size_t repeat, size_t threads) : repeat_(repeat), threads_(threads) {}
+  ~InflateBenchmark() = default;
+
+  // Benchmark all available backends and report.
+  std::vector<InflateBenchResult> runBenchmark(const std::string& bgz_file_name);
+
+private:
+
+  size_t repeat_;
+  size_t threads_;
+  // Compressed blocks held in memory, the offsets of each block in the buffer.
+  std::string block_buffer_;
+  std::vector<size_t> block_offsets_;
+
+  constexpr static const size_t MAX_LOAD_SIZE_{1 << 28};
+  constexpr static const size_t BGZ_HEADER_SIZE_{18};
+  constexpr static const size_t BLOCK_SIZE_OFFSET_{16};
+  constexpr static const size_t MAX_BLOCK_SIZE_{65536};
+  constexpr static const double BYTES_PER_MB_{1024.0 * 1024.0};
+
+  [[nodiscard]] bool loadBlocks(const std::string& bgz_file_name);
+  [[nodiscard]] std::optional<InflateBenchResult> blockInflate(InflateBackendType backend_type) const;
+  [[nodiscard]] bool streamInflate(const std::string& bgz_file_name, InflateBenchResult& result) const;
+
+};
+
+
+
+} //  end namespace
+
+
+
+#endif //KGL_BENCH_INFLATE_H
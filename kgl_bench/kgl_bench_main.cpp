@@ -0,0 +1,18 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+#include "kgl_bench_app.h"
+#include "kel_exec_env_app.h"
+
+
+/// The benchmark mainline.
+int main(int argc, char const ** argv)
+{
+
+  namespace kgl = kellerberrin::genome;
+  namespace kel = kellerberrin;
+
+  return kel::ExecEnv::runApplication<kgl::BenchExecEnv>(argc, argv);
+
+}
@@ -0,0 +1,224 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Setup logger and parse the benchmark command line.
+
+#include "kgl_bench_app.h"
+#include "kgl_bench_inflate.h"
+#include "kgl_bench_generator.h"
+#include "kgl_bench_stream.h"
+#include "kgl_bench_report.h"
+#include "kgl_bench_queue.h"
+#include "kgl_bench_tokenizer.h"
+#include "kel_utility.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <iostream>
+
+// Define namespace alias
+namespace fs = boost::filesystem;
+namespace po = boost::program_options;
+namespace kgl = kellerberrin::genome;
+namespace kel = kellerberrin;
+
+
+
+// Parse the command line.
+bool kgl::BenchExecEnv::parseCommandLine(int argc, char const ** argv)
+{
+
+  std::stringstream ss;
+  ss << "I/O Throughput Benchmarks, module: "
+     << MODULE_NAME
+     << " version: "
+     << VERSION << '\n'
+     << "Usage: [--workDirectory=<work_directory>] [--logFile=<log_file>] [--jsonFile=<json_file>] [--bgzFile=<sample.bgz>]\n"
+     << "       [--records=<n>] [--samples=<n>] [--infoFields=<n>] [--repeat=<n>] [--threads=<n>]";
+  const char* help_flag = "help";
+
+  po::options_description runtime_options(ss.str());
+
+  const char* dir_desc = R"(The work directory where the log file is written (default "./"), the directory must exist.)";
+  const char* work_directory_flag = "workDirectory";
+
+  const char* log_desc = R"(Log file (default "kgl_bench.log"). The log file always resides in the work directory.)";
+  const char* log_file_flag = "logFile";
+
+  const char* json_desc = R"(JSON results file (default "kgl_bench.json"). The JSON file always resides in the work directory.)";
+  const char* json_file_flag = "jsonFile";
+
+  const char* bgz_desc = R"(A sample block gzipped file (.bgz) used to benchmark the inflate backends (default the synthetic VCF file).)";
+  const char* bgz_file_flag = "bgzFile";
+
+  const char* records_desc = R"(The number of records in the synthetic VCF file (default 200000).)";
+  const char* records_flag = "records";
+
+  const char* samples_desc = R"(The number of samples (genotype columns) in the synthetic VCF file (default 100).)";
+  const char* samples_flag = "samples";
+
+  const char* info_desc = R"(The number of INFO fields in each synthetic VCF record (default 10).)";
+  const char* info_flag = "infoFields";
+
+  const char* repeat_desc = R"(The number of times each benchmark is repeated, the best time is reported (default 3).)";
+  const char* repeat_flag = "repeat";
+
+  const char* threads_desc = R"(The number of decompression threads used by stream benchmarks (default 15).)";
+  const char* threads_flag = "threads";
+
+  runtime_options.add_options ()
+      (help_flag, ss.str().c_str())
+      (work_directory_flag, po::value<std::string>(), dir_desc)
+      (log_file_flag, po::value<std::string>(), log_desc)
+      (json_file_flag, po::value<std::string>(), json_desc)
+      (bgz_file_flag, po::value<std::string>(), bgz_desc)
+      (records_flag, po::value<size_t>(), records_desc)
+      (samples_flag, po::value<size_t>(), samples_desc)
+      (info_flag, po::value<size_t>(), info_desc)
+      (repeat_flag, po::value<size_t>(), repeat_desc)
+      (threads_flag, po::value<size_t>(), threads_desc);
+
+  po::variables_map variable_map;
+
+  try {
+
+    po::store(po::command_line_parser(argc, argv).options(runtime_options).run(), variable_map);
+    po::notify(variable_map);
+
+  } catch (po::error& e) {
+    std::cerr << "ERROR: " << e.what() << "\n";
+    std::cerr << "Problem Parsing Command Line. Use '--help' for argument formats." << std::endl;
+    std::cerr << MODULE_NAME << " exits" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+
+  if (variable_map.count(help_flag)) {
+
+    std::cerr << ss.str() << std::endl;
+    std::exit(EXIT_SUCCESS);
+
+  }
+
+  if (variable_map.count(work_directory_flag)) {
+
+    args_.workDirectory = variable_map[work_directory_flag].as<std::string>();
+
+  }
+
+  fs::path directory_path = fs::path(getArgs().workDirectory);
+  boost::system::error_code error_code;
+  if (not fs::exists(directory_path, error_code)) {
+
+    std::cerr << "Specified work directory:" << directory_path.string() << " does not exist." << std::endl;
+    std::cerr << MODULE_NAME << " exits" << std::endl;
+    std::exit(EXIT_FAILURE);
+
+  }
+
+  if (variable_map.count(log_file_flag)) {
+
+    args_.logFile = variable_map[log_file_flag].as<std::string>();
+
+  }
+  args_.logFile = (directory_path / fs::path(args_.logFile)).string();
+
+  if (variable_map.count(bgz_file_flag)) {
+
+    args_.bgzFile = variable_map[bgz_file_flag].as<std::string>();
+
+  }
+
+  if (variable_map.count(json_file_flag)) {
+
+    args_.jsonFile = variable_map[json_file_flag].as<std::string>();
+
+  }
+  args_.jsonFile = (directory_path / fs::path(args_.jsonFile)).string();
+  args_.syntheticFile = (directory_path / fs::path(args_.syntheticFile)).string();
+
+  if (variable_map.count(records_flag)) {
+
+    args_.records = std::max<size_t>(1, variable_map[records_flag].as<size_t>());
+
+  }
+
+  if (variable_map.count(samples_flag)) {
+
+    args_.samples = variable_map[samples_flag].as<size_t>();
+
+  }
+
+  if (variable_map.count(info_flag)) {
+
+    args_.infoFields = variable_map[info_flag].as<size_t>();
+
+  }
+
+  if (variable_map.count(repeat_flag)) {
+
+    args_.repeat = std::max<size_t>(1, variable_map[repeat_flag].as<size_t>());
+
+  }
+
+  if (variable_map.count(threads_flag)) {
+
+    args_.threads = std::max<size_t>(1, variable_map[threads_flag].as<size_t>());
+
+  }
+
+  return true;
+
+}
+
+
+std::unique_ptr<kel::ExecEnvLogger> kgl::BenchExecEnv::createLogger() {
+
+  // Setup the Logger.
+  return ExecEnv::createLogger(MODULE_NAME, getArgs().logFile, getArgs().max_error_count, getArgs().max_warn_count);
+
+}
+
+
+// Run the benchmarks.
+void kgl::BenchExecEnv::executeApp() {
+
+  SyntheticVCFParameters parameters;
+  parameters.record_count = getArgs().records;
+  parameters.sample_count = getArgs().samples;
+  parameters.info_fields = getArgs().infoFields;
+
+  auto files_opt = SyntheticVCF(parameters).generateFiles(getArgs().syntheticFile);
+  if (not files_opt) {
+
+    ExecEnv::log().error("BenchExecEnv::executeApp; unable to generate the synthetic VCF files: {}", getArgs().syntheticFile);
+    return;
+
+  }
+  auto const& files = files_opt.value();
+
+  BenchReport bench_report;
+  bench_report.setParameters(parameters, getArgs().repeat, getArgs().threads);
+
+  StreamBenchmark stream_benchmark(getArgs().repeat, getArgs().threads, bench_report);
+  stream_benchmark.runBenchmark(files);
+
+  InflateBenchmark inflate_benchmark(getArgs().repeat, getArgs().threads);
+  auto const& inflate_file = getArgs().bgzFile.empty() ? files.bgz_file : getArgs().bgzFile;
+  bench_report.addInflateResults(inflate_benchmark.runBenchmark(inflate_file));
+
+  QueueBenchmark queue_benchmark(getArgs().repeat, getArgs().threads);
+  bench_report.addQueueResults(queue_benchmark.runBenchmark());
+
+  TokenizerBenchmark tokenizer_benchmark(getArgs().repeat);
+  bench_report.addTokenizerResults(tokenizer_benchmark.runBenchmark(files.text_file));
+
+  if (not bench_report.writeJSON(getArgs().jsonFile)) {
+
+    ExecEnv::log().error("BenchExecEnv::executeApp; unable to write benchmark results to JSON file: {}", getArgs().jsonFile);
+
+  }
+
+}
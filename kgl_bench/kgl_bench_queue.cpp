@@ -0,0 +1,172 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+#include "kgl_bench_queue.h"
+#include "kgl_bench_report.h"
+#include "kel_queue_mt_safe.h"
+#include "kel_queue_tidal.h"
+#include "kel_queue_ring.h"
+#include "kel_exec_env.h"
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <limits>
+#include <atomic>
+
+
+namespace kgl = kellerberrin::genome;
+
+
+std::vector<kgl::QueueBenchResult> kgl::QueueBenchmark::runBenchmark() const {
+
+  std::vector<QueueBenchResult> results;
+
+  ExecEnv::log().info("QueueBenchmark::runBenchmark; items: {}, high tide: {}, low tide: {}, repeat: {}, threads: {}",
+                      ITEM_COUNT_, HIGH_TIDE_, LOW_TIDE_, repeat_, threads_);
+
+  for (auto const& [producers, consumers] : threadCombinations()) {
+
+    results.push_back(timeQueue("QueueMtSafe",
+                                []() { return std::make_unique<QueueMtSafe<size_t>>(); },
+                                producers, consumers));
+    results.push_back(timeQueue("QueueTidal",
+                                []() { return std::make_unique<QueueTidal<size_t>>(HIGH_TIDE_, LOW_TIDE_); },
+                                producers, consumers));
+    results.push_back(timeQueue("QueueRing",
+                                []() { return std::make_unique<QueueRing<size_t>>(HIGH_TIDE_, LOW_TIDE_); },
+                                producers, consumers));
+
+  }
+
+  for (auto const& result : results) {
+
+    ExecEnv::log().info("QueueBenchmark; queue: {}, producers: {}, consumers: {}, items/s: {:.0f}, push stall ms: {:.1f}, pop stall ms: {:.1f}",
+                        result.queue, result.producers, result.consumers, result.items_per_second,
+                        result.push_stall_ms, result.pop_stall_ms);
+    std::cout << result.queue << " producers " << result.producers << " consumers " << result.consumers
+              << " items/s " << static_cast<size_t>(result.items_per_second) << '\n';
+
+  }
+
+  return results;
+
+}
+
+
+std::vector<std::pair<size_t, size_t>> kgl::QueueBenchmark::threadCombinations() const {
+
+  std::vector<std::pair<size_t, size_t>> combinations{{1, 1}};
+  if (threads_ > 1) {
+
+    combinations.emplace_back(1, threads_);
+    combinations.emplace_back(threads_, 1);
+    combinations.emplace_back(threads_, threads_);
+
+  }
+
+  return combinations;
+
+}
+
+
+// The queue is created for each run by the factory so that every run starts with an empty queue.
+template<typename QueueFactory>
+kgl::QueueBenchResult kgl::QueueBenchmark::timeQueue( const std::string& queue_name
+                                                    , const QueueFactory& queue_factory
+                                                    , size_t producers
+                                                    , size_t consumers) const {
+
+  // Consumers stop on this value.
+  constexpr const size_t STOP_TOKEN{std::numeric_limits<size_t>::max()};
+
+  QueueBenchResult best_result;
+  best_result.queue = queue_name;
+  best_result.producers = producers;
+  best_result.consumers = consumers;
+  best_result.items = (ITEM_COUNT_ / producers) * producers;
+
+  for (size_t run = 0; run < std::max<size_t>(repeat_, 1); ++run) {
+
+    auto queue_ptr = queue_factory();
+    std::atomic<size_t> consumed_count{0};
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> consumer_threads;
+    for (size_t index = 0; index < consumers; ++index) {
+
+      consumer_threads.emplace_back([&queue_ptr, &consumed_count]() {
+
+        size_t count{0};
+        while (queue_ptr->waitAndPop() != STOP_TOKEN) {
+
+          ++count;
+
+        }
+        consumed_count += count;
+
+      });
+
+    }
+
+    std::vector<std::thread> producer_threads;
+    for (size_t index = 0; index < producers; ++index) {
+
+      producer_threads.emplace_back([&queue_ptr, items = ITEM_COUNT_ / producers]() {
+
+        for (size_t item = 0; item < items; ++item) {
+
+          queue_ptr->push(item);
+
+        }
+
+      });
+
+    }
+
+    for (auto& thread : producer_threads) {
+
+      thread.join();
+
+    }
+    for (size_t index = 0; index < consumers; ++index) {
+
+      queue_ptr->push(STOP_TOKEN);
+
+    }
+    for (auto& thread : consumer_threads) {
+
+      thread.join();
+
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (consumed_count != best_result.items) {
+
+      ExecEnv::log().error("QueueBenchmark::timeQueue; queue: {}, items pushed: {}, items popped: {}",
+                           queue_name, best_result.items, consumed_count.load());
+
+    }
+
+    if (best_result.seconds == 0.0 or elapsed.count() < best_result.seconds) {
+
+      best_result.seconds = elapsed.count();
+      best_result.items_per_second = static_cast<double>(best_result.items) / best_result.seconds;
+      if constexpr (requires { queue_ptr->pushStallTime(); queue_ptr->popStallTime(); }) {
+
+        best_result.queue_stats = true;
+        best_result.push_stall_ms = BenchReport::stallMilliseconds(queue_ptr->pushStallTime());
+        best_result.pop_stall_ms = BenchReport::stallMilliseconds(queue_ptr->popStallTime());
+
+      }
+
+    }
+
+  }
+
+  return best_result;
+
+}
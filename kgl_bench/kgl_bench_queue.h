@@ -0,0 +1,81 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KGL_BENCH_QUEUE_H
+#define KGL_BENCH_QUEUE_H
+
+
+#include <string>
+#include <vector>
+#include <utility>
+
+
+namespace kellerberrin::genome {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// A contention benchmark of the thread safe queues: QueueMtSafe (unbounded, mutex), QueueTidal (bounded, mutex)
+// and QueueRing (bounded, lock-free).
+//
+// Producer threads push ITEM_COUNT_ integers onto the queue and consumer threads pop them, this measures the
+// synchronization cost of the queue with no work done per item. Each queue is measured with single and multiple
+// producers and consumers, the bounded queues use the same high and low tides.
+//
+// Results are reported as items/s (best of 'repeat' runs) to the log and to std::cout.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+struct QueueBenchResult {
+
+  std::string queue;
+  size_t producers{0};
+  size_t consumers{0};
+  size_t items{0};
+  double seconds{0.0};
+  double items_per_second{0.0};
+  bool queue_stats{false};      // True if the queue reports stall times.
+  double push_stall_ms{0.0};
+  double pop_stall_ms{0.0};
+
+};
+
+
+class QueueBenchmark {
+
+public:
+
+  QueueBenchmark(size_t repeat, size_t threads) : repeat_(repeat), threads_(threads) {}
+  ~QueueBenchmark() = default;
+
+  // Benchmark all queues and report.
+  std::vector<QueueBenchResult> runBenchmark() const;
+
+private:
+
+  size_t repeat_;
+  size_t threads_;
+
+  constexpr static const size_t ITEM_COUNT_{1000000};
+  constexpr static const size_t HIGH_TIDE_{10000};
+  constexpr static const size_t LOW_TIDE_{2000};
+
+  // The (producers, consumers) thread combinations.
+  [[nodiscard]] std::vector<std::pair<size_t, size_t>> threadCombinations() const;
+  template<typename QueueFactory>
+  [[nodiscard]] QueueBenchResult timeQueue( const std::string& queue_name
+                                          , const QueueFactory& queue_factory
+                                          , size_t producers
+                                          , size_t consumers) const;
+
+};
+
+
+
+} //  end namespace
+
+
+
+#endif //KGL_BENCH_QUEUE_H
@@ -0,0 +1,256 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+#include "kgl_bench_report.h"
+#include "kel_exec_env.h"
+
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/prettywriter.h"
+
+#include <fstream>
+#include <iostream>
+
+
+namespace kgl = kellerberrin::genome;
+
+
+void kgl::BenchReport::setParameters(const SyntheticVCFParameters& parameters, size_t repeat, size_t threads) {
+
+  parameters_ = parameters;
+  repeat_ = repeat;
+  threads_ = threads;
+
+}
+
+
+void kgl::BenchReport::addResult(BenchResult result) {
+
+  if (result.seconds > 0.0) {
+
+    result.lines_per_second = static_cast<double>(result.line_count) / result.seconds;
+    result.mb_per_second = static_cast<double>(result.data_bytes) / (result.seconds * BYTES_PER_MB_);
+
+  }
+
+  ExecEnv::log().info("BenchReport; {} ({}), lines/s: {:.0f}, MB/s: {:.1f}, peak RSS KB: {}, push stall ms: {:.1f}, pop stall ms: {:.1f}",
+                      result.benchmark, result.mode, result.lines_per_second, result.mb_per_second,
+                      result.peak_rss_kb, result.push_stall_ms, result.pop_stall_ms);
+  std::cout << result.benchmark << " " << result.mode
+            << " lines/s " << static_cast<size_t>(result.lines_per_second)
+            << " MB/s " << result.mb_per_second
+            << " peak_RSS_KB " << result.peak_rss_kb << '\n';
+
+  results_.push_back(std::move(result));
+
+}
+
+
+void kgl::BenchReport::addInflateResults(const std::vector<InflateBenchResult>& inflate_results) {
+
+  inflate_results_.insert(inflate_results_.end(), inflate_results.begin(), inflate_results.end());
+
+}
+
+
+void kgl::BenchReport::addQueueResults(const std::vector<QueueBenchResult>& queue_results) {
+
+  queue_results_.insert(queue_results_.end(), queue_results.begin(), queue_results.end());
+
+}
+
+
+void kgl::BenchReport::addTokenizerResults(const std::vector<TokenizerBenchResult>& tokenizer_results) {
+
+  tokenizer_results_.insert(tokenizer_results_.end(), tokenizer_results.begin(), tokenizer_results.end());
+
+}
+
+
+bool kgl::BenchReport::writeJSON(const std::string& json_file_name) const {
+
+  rapidjson::StringBuffer json_buffer;
+  rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(json_buffer);
+
+  writer.StartObject();
+
+  writer.Key("parameters");
+  writer.StartObject();
+  writer.Key("records");
+  writer.Uint64(parameters_.record_count);
+  writer.Key("samples");
+  writer.Uint64(parameters_.sample_count);
+  writer.Key("info_fields");
+  writer.Uint64(parameters_.info_fields);
+  writer.Key("repeat");
+  writer.Uint64(repeat_);
+  writer.Key("threads");
+  writer.Uint64(threads_);
+  writer.EndObject();
+
+  writer.Key("streams");
+  writer.StartArray();
+  for (auto const& result : results_) {
+
+    writer.StartObject();
+    writer.Key("benchmark");
+    writer.String(result.benchmark.c_str());
+    writer.Key("mode");
+    writer.String(result.mode.c_str());
+    writer.Key("file");
+    writer.String(result.file_name.c_str());
+    writer.Key("lines");
+    writer.Uint64(result.line_count);
+    writer.Key("bytes");
+    writer.Uint64(result.data_bytes);
+    writer.Key("seconds");
+    writer.Double(result.seconds);
+    writer.Key("lines_per_second");
+    writer.Double(result.lines_per_second);
+    writer.Key("mb_per_second");
+    writer.Double(result.mb_per_second);
+    writer.Key("peak_rss_kb");
+    writer.Uint64(result.peak_rss_kb);
+    if (result.queue_stats) {
+
+      writer.Key("push_stall_ms");
+      writer.Double(result.push_stall_ms);
+      writer.Key("pop_stall_ms");
+      writer.Double(result.pop_stall_ms);
+
+    }
+    writer.EndObject();
+
+  }
+  writer.EndArray();
+
+  writer.Key("inflate");
+  writer.StartArray();
+  for (auto const& result : inflate_results_) {
+
+    writer.StartObject();
+    writer.Key("backend");
+    writer.String(InflateBackend::backendName(result.backend_type).c_str());
+    writer.Key("block_mb_per_second");
+    writer.Double(result.block_mbs);
+    writer.Key("stream_mb_per_second");
+    writer.Double(result.stream_mbs);
+    writer.Key("compressed_bytes");
+    writer.Uint64(result.compressed_bytes);
+    writer.Key("uncompressed_bytes");
+    writer.Uint64(result.uncompressed_bytes);
+    writer.EndObject();
+
+  }
+  writer.EndArray();
+
+  writer.Key("queues");
+  writer.StartArray();
+  for (auto const& result : queue_results_) {
+
+    writer.StartObject();
+    writer.Key("queue");
+    writer.String(result.queue.c_str());
+    writer.Key("producers");
+    writer.Uint64(result.producers);
+    writer.Key("consumers");
+    writer.Uint64(result.consumers);
+    writer.Key("items");
+    writer.Uint64(result.items);
+    writer.Key("seconds");
+    writer.Double(result.seconds);
+    writer.Key("items_per_second");
+    writer.Double(result.items_per_second);
+    if (result.queue_stats) {
+
+      writer.Key("push_stall_ms");
+      writer.Double(result.push_stall_ms);
+      writer.Key("pop_stall_ms");
+      writer.Double(result.pop_stall_ms);
+
+    }
+    writer.EndObject();
+
+  }
+  writer.EndArray();
+
+  writer.Key("tokenizers");
+  writer.StartArray();
+  for (auto const& result : tokenizer_results_) {
+
+    writer.StartObject();
+    writer.Key("kernel");
+    writer.String(result.kernel.c_str());
+    writer.Key("workload");
+    writer.String(result.workload.c_str());
+    writer.Key("bytes");
+    writer.Uint64(result.bytes);
+    writer.Key("fields");
+    writer.Uint64(result.fields);
+    writer.Key("seconds");
+    writer.Double(result.seconds);
+    writer.Key("mb_per_second");
+    writer.Double(result.mb_per_second);
+    writer.Key("fields_per_second");
+    writer.Double(result.fields_per_second);
+    writer.EndObject();
+
+  }
+  writer.EndArray();
+
+  writer.EndObject();
+
+  std::ofstream json_file(json_file_name, std::ios::trunc);
+  if (not json_file.good()) {
+
+    ExecEnv::log().error("BenchReport::writeJSON; could not open JSON file: {}", json_file_name);
+    return false;
+
+  }
+
+  json_file << json_buffer.GetString() << '\n';
+  ExecEnv::log().info("BenchReport::writeJSON; benchmark results written to JSON file: {}", json_file_name);
+
+  return json_file.good();
+
+}
+
+
+void kgl::BenchReport::resetPeakRSS() {
+
+  std::ofstream clear_refs(CLEAR_REFS_FILE_);
+  if (clear_refs.good()) {
+
+    clear_refs << CLEAR_PEAK_RSS_;
+
+  }
+
+}
+
+
+size_t kgl::BenchReport::peakRSS() {
+
+  std::ifstream status_file(STATUS_FILE_);
+  std::string status_line;
+  while (std::getline(status_file, status_line)) {
+
+    if (status_line.starts_with(PEAK_RSS_KEY_)) {
+
+      try {
+
+        return std::stoull(status_line.substr(std::string_view(PEAK_RSS_KEY_).size()));
+
+      } catch (std::exception& e) {
+
+        ExecEnv::log().warn("BenchReport::peakRSS; unable to parse status line: {}, exception: {}", status_line, e.what());
+        return 0;
+
+      }
+
+    }
+
+  }
+
+  return 0;
+
+}
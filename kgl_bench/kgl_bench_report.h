@@ -0,0 +1,103 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KGL_BENCH_REPORT_H
+#define KGL_BENCH_REPORT_H
+
+
+#include "kgl_bench_generator.h"
+#include "kgl_bench_inflate.h"
+#include "kgl_bench_queue.h"
+#include "kgl_bench_tokenizer.h"
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+
+namespace kellerberrin::genome {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Collects the benchmark results and writes them as a JSON document.
+//
+// Each result records lines/s, MB/s (uncompressed), the peak resident set size (RSS) during the benchmark and,
+// for the multi-threaded objects, the time producer threads were blocked on a full queue (push stall) and
+// consumer threads were blocked on an empty queue (pop stall).
+//
+// The peak RSS is the Linux 'VmHWM' value, this is reset before each benchmark by writing to '/proc/self/clear_refs'.
+// If the reset fails (older kernels) then the reported value is the process peak RSS.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+struct BenchResult {
+
+  std::string benchmark;        // The object benchmarked, e.g. "BGZStreamIO".
+  std::string mode;             // How the object was read, e.g. "readLine" or "readBlock".
+  std::string file_name;
+  size_t line_count{0};
+  size_t data_bytes{0};         // Uncompressed bytes.
+  double seconds{0.0};
+  double lines_per_second{0.0};
+  double mb_per_second{0.0};
+  size_t peak_rss_kb{0};
+  bool queue_stats{false};      // True if the object reports queue stall times.
+  double push_stall_ms{0.0};
+  double pop_stall_ms{0.0};
+
+};
+
+
+class BenchReport {
+
+public:
+
+  BenchReport() = default;
+  ~BenchReport() = default;
+
+  void setParameters(const SyntheticVCFParameters& parameters, size_t repeat, size_t threads);
+  // Calculates the per second rates and logs the result.
+  void addResult(BenchResult result);
+  void addInflateResults(const std::vector<InflateBenchResult>& inflate_results);
+  void addQueueResults(const std::vector<QueueBenchResult>& queue_results);
+  void addTokenizerResults(const std::vector<TokenizerBenchResult>& tokenizer_results);
+
+  [[nodiscard]] bool writeJSON(const std::string& json_file_name) const;
+
+  [[nodiscard]] const std::vector<BenchResult>& results() const { return results_; }
+
+  // Reset the peak RSS to the current RSS.
+  static void resetPeakRSS();
+  // The peak RSS in kilobytes since the last reset, zero if not available.
+  [[nodiscard]] static size_t peakRSS();
+
+  [[nodiscard]] static double stallMilliseconds(std::chrono::nanoseconds stall_time) { return static_cast<double>(stall_time.count()) / 1.0e6; }
+
+private:
+
+  SyntheticVCFParameters parameters_;
+  size_t repeat_{0};
+  size_t threads_{0};
+  std::vector<BenchResult> results_;
+  std::vector<InflateBenchResult> inflate_results_;
+  std::vector<QueueBenchResult> queue_results_;
+  std::vector<TokenizerBenchResult> tokenizer_results_;
+
+  constexpr static const double BYTES_PER_MB_{1024.0 * 1024.0};
+  constexpr static const char* CLEAR_REFS_FILE_{"/proc/self/clear_refs"};
+  constexpr static const char* CLEAR_PEAK_RSS_{"5"};
+  constexpr static const char* STATUS_FILE_{"/proc/self/status"};
+  constexpr static const char* PEAK_RSS_KEY_{"VmHWM:"};
+
+};
+
+
+
+} //  end namespace
+
+
+
+#endif //KGL_BENCH_REPORT_H
@@ -0,0 +1,367 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+#include "kgl_bench_stream.h"
+#include "kel_file_io.h"
+#include "kel_bzip_workflow.h"
+#include "kel_gzip_workflow.h"
+#include "kel_bz2_workflow.h"
+#include "kel_mt_buffer.h"
+#include "kel_exec_env.h"
+#include "kgl_variant_factory_readvcf_impl.h"
+
+#include <algorithm>
+#include <atomic>
+
+
+namespace kgl = kellerberrin::genome;
+
+
+namespace kellerberrin::genome {   //  organization::project level namespace
+
+
+// Counts the records and INFO fields of the parsed VCF records.
+class BenchVCFReader : public VCFReaderMT {
+
+public:
+
+  explicit BenchVCFReader(size_t thread_count) : VCFReaderMT(thread_count) {}
+  ~BenchVCFReader() override = default;
+
+  void ProcessVCFRecord(std::unique_ptr<const VCFRecordView> vcf_record_ptr) override {
+
+    ++record_count_;
+    data_bytes_ += vcf_record_ptr->lineView().size() + 1;
+    if (not vcf_record_ptr->info.empty()) {
+
+      info_count_ += std::ranges::count(vcf_record_ptr->info, INFO_DELIMITER_) + 1;
+
+    }
+
+  }
+
+  void processVCFHeader(const VCFHeaderInfo&) override {}
+
+  [[nodiscard]] size_t recordCount() const { return record_count_; }
+  [[nodiscard]] size_t dataBytes() const { return data_bytes_; }
+  [[nodiscard]] size_t infoCount() const { return info_count_; }
+
+private:
+
+  std::atomic<size_t> record_count_{0};
+  std::atomic<size_t> data_bytes_{0};
+  std::atomic<size_t> info_count_{0};
+
+  constexpr static const char INFO_DELIMITER_{';'};
+
+};
+
+
+} //  end namespace
+
+
+void kgl::StreamBenchmark::runBenchmark(const SyntheticVCFFiles& files) {
+
+  ExecEnv::log().info("StreamBenchmark::runBenchmark; repeat: {}, threads: {}", repeat_, threads_);
+
+  streamRead("TextStreamIO", files.text_file, [](const std::string& file_name) { return TextStreamIO::getStreamIO(file_name); });
+  streamRead("MMapStreamIO", files.text_file, [](const std::string& file_name) { return MMapStreamIO::getStreamIO(file_name); });
+  streamRead("GZStreamIO", files.gz_file, [](const std::string& file_name) { return GZStreamIO::getStreamIO(file_name); });
+
+  auto threads = threads_;
+  StreamFactory gz_parallel_factory = [threads](const std::string& file_name) { return GZParallelStreamIO::getStreamIO(file_name, threads); };
+  // The first read of the gzip file builds the checkpoint index.
+  auto index_result = timeStream("GZParallelStreamIO", INDEX_MODE_, files.gz_file, gz_parallel_factory, true);
+  if (index_result) {
+
+    report_.addResult(std::move(index_result.value()));
+
+  }
+  streamRead("GZParallelStreamIO", files.gz_file, gz_parallel_factory);
+
+  streamRead("BGZStreamIO", files.bgz_file, [threads](const std::string& file_name) { return BGZStreamIO::getStreamIO(file_name, threads); });
+  streamRead("BZ2StreamIO", files.bz2_file, [](const std::string& file_name) { return BZ2StreamIO::getStreamIO(file_name); });
+  streamRead("BZ2ParallelStreamIO", files.bz2_file, [threads](const std::string& file_name) { return BZ2ParallelStreamIO::getStreamIO(file_name, threads); });
+  streamRead("StreamMTBuffer", files.bgz_file, [threads](const std::string& file_name) -> std::optional<std::unique_ptr<BaseStreamIO>> {
+
+    auto bgz_stream_opt = BGZStreamIO::getStreamIO(file_name, threads);
+    if (not bgz_stream_opt) {
+
+      return std::nullopt;
+
+    }
+    return StreamMTBuffer::getStreamIO(std::move(bgz_stream_opt.value()));
+
+  });
+
+  parseVCF(files.bgz_file);
+  readerVCF(files.bgz_file);
+
+}
+
+
+void kgl::StreamBenchmark::streamRead(const std::string& benchmark, const std::string& file_name, const StreamFactory& stream_factory) {
+
+  for (bool read_blocks : { false, true }) {
+
+    std::optional<BenchResult> best;
+    for (size_t run = 0; run < repeat_; ++run) {
+
+      auto result_opt = timeStream(benchmark, read_blocks ? READ_BLOCK_MODE_ : READ_LINE_MODE_, file_name, stream_factory, read_blocks);
+      if (not result_opt) {
+
+        return;
+
+      }
+      bestResult(best, std::move(result_opt.value()));
+
+    }
+
+    if (best) {
+
+      report_.addResult(std::move(best.value()));
+
+    }
+
+  }
+
+}
+
+
+std::optional<kgl::BenchResult> kgl::StreamBenchmark::timeStream( const std::string& benchmark
+                                                               , const std::string& mode
+                                                               , const std::string& file_name
+                                                               , const StreamFactory& stream_factory
+                                                               , bool read_blocks) const {
+
+  BenchResult result;
+  result.benchmark = benchmark;
+  result.mode = mode;
+  result.file_name = file_name;
+
+  BenchReport::resetPeakRSS();
+  auto start = std::chrono::steady_clock::now();
+
+  auto stream_opt = stream_factory(file_name);
+  if (not stream_opt) {
+
+    ExecEnv::log().error("StreamBenchmark::timeStream; {} could not open file: {}", benchmark, file_name);
+    return std::nullopt;
+
+  }
+  auto& stream_ptr = stream_opt.value();
+
+  if (read_blocks) {
+
+    while (true) {
+
+      auto line_block = stream_ptr->readBlock();
+      if (line_block.EOFBlock()) {
+
+        break;
+
+      }
+      result.line_count += line_block.size();
+      result.data_bytes += line_block.dataSize();
+
+    }
+
+  } else {
+
+    while (true) {
+
+      auto line_record = stream_ptr->readLine();
+      if (line_record.EOFRecord()) {
+
+        break;
+
+      }
+      ++result.line_count;
+      result.data_bytes += line_record.getView().size() + 1;
+
+    }
+
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  result.seconds = elapsed.count();
+  result.peak_rss_kb = BenchReport::peakRSS();
+  queueStats(*stream_ptr, result);
+  stream_ptr->close();
+
+  return result;
+
+}
+
+
+void kgl::StreamBenchmark::parseVCF(const std::string& file_name) {
+
+  std::optional<BenchResult> best;
+  for (size_t run = 0; run < repeat_; ++run) {
+
+    BenchResult result;
+    result.benchmark = "ParseVCF";
+    result.mode = PARSE_MODE_;
+    result.file_name = file_name;
+
+    BenchReport::resetPeakRSS();
+    auto start = std::chrono::steady_clock::now();
+
+    std::atomic<size_t> record_count{0};
+    std::atomic<size_t> data_bytes{0};
+    {
+      ParseVCF vcf_parser;
+      if (not vcf_parser.open(file_name, threads_, threads_)) {
+
+        ExecEnv::log().error("StreamBenchmark::parseVCF; could not open file: {}", file_name);
+        return;
+
+      }
+
+      auto consumer = [&vcf_parser, &record_count, &data_bytes]() {
+
+        while (true) {
+
+          auto vcf_record_ptr = vcf_parser.readVCFRecord();
+          if (vcf_record_ptr->EOFRecord()) {
+
+            // Release the other consumers.
+            vcf_parser.enqueueEOF();
+            break;
+
+          }
+
+          ++record_count;
+          data_bytes += vcf_record_ptr->lineView().size() + 1;
+
+        }
+
+      };
+
+      WorkflowThreads consumer_threads(threads_);
+      std::vector<std::future<void>> consumer_futures;
+      for (size_t index = 0; index < threads_; ++index) {
+
+        consumer_futures.push_back(consumer_threads.enqueueFuture(consumer));
+
+      }
+
+      for (auto const& future : consumer_futures) {
+
+        future.wait();
+
+      }
+
+      result.queue_stats = true;
+      result.push_stall_ms = BenchReport::stallMilliseconds(vcf_parser.workFlow().pushStallTime());
+      result.pop_stall_ms = BenchReport::stallMilliseconds(vcf_parser.workFlow().popStallTime());
+
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+    result.peak_rss_kb = BenchReport::peakRSS();
+    result.line_count = record_count;
+    result.data_bytes = data_bytes;
+
+    bestResult(best, std::move(result));
+
+  }
+
+  if (best) {
+
+    report_.addResult(std::move(best.value()));
+
+  }
+
+}
+
+
+void kgl::StreamBenchmark::readerVCF(const std::string& file_name) {
+
+  std::optional<BenchResult> best;
+  for (size_t run = 0; run < repeat_; ++run) {
+
+    BenchResult result;
+    result.benchmark = "VCFReaderMT";
+    result.mode = CONSUMER_MODE_;
+    result.file_name = file_name;
+
+    BenchReport::resetPeakRSS();
+    auto start = std::chrono::steady_clock::now();
+
+    BenchVCFReader vcf_reader(threads_);
+    vcf_reader.readVCFFile(file_name);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.seconds = elapsed.count();
+    result.peak_rss_kb = BenchReport::peakRSS();
+    result.line_count = vcf_reader.recordCount();
+    result.data_bytes = vcf_reader.dataBytes();
+    result.queue_stats = true;
+    result.push_stall_ms = BenchReport::stallMilliseconds(vcf_reader.vcfParser().workFlow().pushStallTime());
+    result.pop_stall_ms = BenchReport::stallMilliseconds(vcf_reader.vcfParser().workFlow().popStallTime());
+
+    if (vcf_reader.recordCount() == 0) {
+
+      ExecEnv::log().error("StreamBenchmark::readerVCF; no records read from file: {}", file_name);
+      return;
+
+    }
+
+    ExecEnv::log().info("StreamBenchmark::readerVCF; records: {}, INFO fields: {}", vcf_reader.recordCount(), vcf_reader.infoCount());
+    bestResult(best, std::move(result));
+
+  }
+
+  if (best) {
+
+    report_.addResult(std::move(best.value()));
+
+  }
+
+}
+
+
+void kgl::StreamBenchmark::bestResult(std::optional<BenchResult>& best, BenchResult&& result) {
+
+  if (not best or result.seconds < best.value().seconds) {
+
+    best = std::move(result);
+
+  }
+
+}
+
+
+void kgl::StreamBenchmark::queueStats(const BaseStreamIO& stream, BenchResult& result) {
+
+  const QueueTidal<IOLineBlock>* line_queue_ptr{nullptr};
+  if (auto bgz_ptr = dynamic_cast<const BGZStreamIO*>(&stream); bgz_ptr != nullptr) {
+
+    line_queue_ptr = &bgz_ptr->lineQueue();
+
+  } else if (auto gz_ptr = dynamic_cast<const GZParallelStreamIO*>(&stream); gz_ptr != nullptr) {
+
+    line_queue_ptr = &gz_ptr->lineQueue();
+
+  } else if (auto bz2_ptr = dynamic_cast<const BZ2ParallelStreamIO*>(&stream); bz2_ptr != nullptr) {
+
+    line_queue_ptr = &bz2_ptr->lineQueue();
+
+  } else if (auto buffer_ptr = dynamic_cast<const StreamMTBuffer*>(&stream); buffer_ptr != nullptr) {
+
+    line_queue_ptr = &buffer_ptr->lineQueue();
+
+  }
+
+  if (line_queue_ptr != nullptr) {
+
+    result.queue_stats = true;
+    result.push_stall_ms = BenchReport::stallMilliseconds(line_queue_ptr->pushStallTime());
+    result.pop_stall_ms = BenchReport::stallMilliseconds(line_queue_ptr->popStallTime());
+
+  }
+
+}
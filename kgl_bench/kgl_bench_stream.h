@@ -0,0 +1,83 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KGL_BENCH_STREAM_H
+#define KGL_BENCH_STREAM_H
+
+
+#include "kgl_bench_generator.h"
+#include "kgl_bench_report.h"
+#include "kel_basic_io.h"
+
+#include <string>
+#include <functional>
+#include <optional>
+#include <memory>
+
+
+namespace kellerberrin::genome {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Benchmarks each BaseStreamIO implementation and the VCF parsers on the synthetic VCF files.
+//
+// Stream objects are read using readLine() and readBlock(), the open() time is included.
+// GZParallelStreamIO is measured twice, the first read builds the checkpoint index and subsequent
+// reads decompress in parallel using the index.
+// StreamMTBuffer is layered on a BGZStreamIO.
+// ParseVCF is read by 'threads' consumers and VCFReaderMT by 'threads' consumers that count the INFO fields
+// of each record (the variant objects are not created).
+//
+// The best time of 'repeat' runs is reported.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+class StreamBenchmark {
+
+  using StreamFactory = std::function<std::optional<std::unique_ptr<BaseStreamIO>>(const std::string&)>;
+
+public:
+
+  StreamBenchmark(size_t repeat, size_t threads, BenchReport& report) : repeat_(repeat), threads_(threads), report_(report) {}
+  ~StreamBenchmark() = default;
+
+  void runBenchmark(const SyntheticVCFFiles& files);
+
+private:
+
+  size_t repeat_;
+  size_t threads_;
+  BenchReport& report_;
+
+  constexpr static const char* READ_LINE_MODE_{"readLine"};
+  constexpr static const char* READ_BLOCK_MODE_{"readBlock"};
+  constexpr static const char* INDEX_MODE_{"readBlock (index build)"};
+  constexpr static const char* PARSE_MODE_{"readVCFRecord"};
+  constexpr static const char* CONSUMER_MODE_{"ProcessVCFRecord"};
+
+  void streamRead(const std::string& benchmark, const std::string& file_name, const StreamFactory& stream_factory);
+  [[nodiscard]] std::optional<BenchResult> timeStream( const std::string& benchmark
+                                                     , const std::string& mode
+                                                     , const std::string& file_name
+                                                     , const StreamFactory& stream_factory
+                                                     , bool read_blocks) const;
+  void parseVCF(const std::string& file_name);
+  void readerVCF(const std::string& file_name);
+
+  // Keep the best result.
+  static void bestResult(std::optional<BenchResult>& best, BenchResult&& result);
+  // The queue statistics of the multi-threaded stream objects.
+  static void queueStats(const BaseStreamIO& stream, BenchResult& result);
+
+};
+
+
+
+} //  end namespace
+
+
+
+#endif //KGL_BENCH_STREAM_H
@@ -0,0 +1,163 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+#include "kgl_bench_tokenizer.h"
+#include "kel_exec_env.h"
+
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+
+
+namespace kgl = kellerberrin::genome;
+
+
+std::vector<kgl::TokenizerBenchResult> kgl::TokenizerBenchmark::runBenchmark(const std::string& vcf_text_file) {
+
+  std::vector<TokenizerBenchResult> results;
+
+  if (not loadLines(vcf_text_file)) {
+
+    return results;
+
+  }
+
+  ExecEnv::log().info("TokenizerBenchmark::runBenchmark; file: {}, records: {}, genotypes: {}, active kernel: {}, repeat: {}",
+                      vcf_text_file, vcf_lines_.size(), genotype_views_.size(),
+                      FieldTokenizer::kernelName(FieldTokenizer::activeKernel()), repeat_);
+
+  std::vector<TokenizerKernel> kernels{TokenizerKernel::SCALAR};
+  if (FieldTokenizer::activeKernel() != TokenizerKernel::SCALAR) {
+
+    kernels.push_back(TokenizerKernel::SSE2);
+
+  }
+  if (FieldTokenizer::activeKernel() == TokenizerKernel::AVX2) {
+
+    kernels.push_back(TokenizerKernel::AVX2);
+
+  }
+
+  std::vector<std::string_view> line_views(vcf_lines_.begin(), vcf_lines_.end());
+  for (auto kernel : kernels) {
+
+    results.push_back(timeKernel(kernel, "vcf_tab", line_views, FIELD_DELIMITER_));
+    results.push_back(timeKernel(kernel, "genotype_colon", genotype_views_, FORMAT_DELIMITER_));
+
+  }
+
+  for (auto const& result : results) {
+
+    ExecEnv::log().info("TokenizerBenchmark; kernel: {}, workload: {}, MB/s: {:.1f}, fields/s: {:.0f}",
+                        result.kernel, result.workload, result.mb_per_second, result.fields_per_second);
+    std::cout << "tokenizer " << result.kernel << " " << result.workload
+              << " MB/s " << result.mb_per_second
+              << " fields/s " << static_cast<size_t>(result.fields_per_second) << '\n';
+
+  }
+
+  return results;
+
+}
+
+
+bool kgl::TokenizerBenchmark::loadLines(const std::string& vcf_text_file) {
+
+  std::ifstream vcf_file(vcf_text_file);
+  if (not vcf_file.good()) {
+
+    ExecEnv::log().error("TokenizerBenchmark::loadLines; could not open VCF file: {}", vcf_text_file);
+    return false;
+
+  }
+
+  vcf_lines_.clear();
+  std::string line;
+  while (vcf_lines_.size() < LINE_LIMIT_ and std::getline(vcf_file, line)) {
+
+    if (line.empty() or line.front() == HEADER_CHAR_) {
+
+      continue;
+
+    }
+
+    vcf_lines_.push_back(std::move(line));
+
+  }
+
+  // The genotype columns are views into the held records.
+  genotype_views_.clear();
+  std::vector<std::string_view> field_views;
+  for (auto const& vcf_line : vcf_lines_) {
+
+    FieldTokenizer::tokenize(vcf_line, FIELD_DELIMITER_, field_views);
+    if (field_views.size() > GENOTYPE_FIELD_OFFSET_) {
+
+      genotype_views_.insert(genotype_views_.end(), field_views.begin() + GENOTYPE_FIELD_OFFSET_, field_views.end());
+
+    }
+
+  }
+
+  if (vcf_lines_.empty()) {
+
+    ExecEnv::log().error("TokenizerBenchmark::loadLines; no VCF records found in file: {}", vcf_text_file);
+    return false;
+
+  }
+
+  return true;
+
+}
+
+
+kgl::TokenizerBenchResult kgl::TokenizerBenchmark::timeKernel( TokenizerKernel kernel
+                                                             , const std::string& workload
+                                                             , const std::vector<std::string_view>& text_vector
+                                                             , char delimiter) const {
+
+  TokenizerBenchResult best_result;
+  best_result.kernel = FieldTokenizer::kernelName(kernel);
+  best_result.workload = workload;
+  for (auto const& text : text_vector) {
+
+    best_result.bytes += text.size();
+
+  }
+
+  std::vector<std::string_view> field_views;
+  for (size_t run = 0; run < std::max<size_t>(repeat_, 1); ++run) {
+
+    size_t field_count{0};
+    auto start = std::chrono::steady_clock::now();
+
+    for (auto const& text : text_vector) {
+
+      FieldTokenizer::tokenize(kernel, text, delimiter, field_views);
+      field_count += field_views.size();
+
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    best_result.fields = field_count;
+
+    if (best_result.seconds == 0.0 or elapsed.count() < best_result.seconds) {
+
+      best_result.seconds = elapsed.count();
+
+    }
+
+  }
+
+  if (best_result.seconds > 0.0) {
+
+    best_result.mb_per_second = (static_cast<double>(best_result.bytes) / BYTES_PER_MB_) / best_result.seconds;
+    best_result.fields_per_second = static_cast<double>(best_result.fields) / best_result.seconds;
+
+  }
+
+  return best_result;
+
+}
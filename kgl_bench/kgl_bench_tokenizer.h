@@ -0,0 +1,81 @@
+//
+// Copyright 2023 Kellerberrin
+//
+
+#ifndef KGL_BENCH_TOKENIZER_H
+#define KGL_BENCH_TOKENIZER_H
+
+
+#include "kel_tokenizer.h"
+
+#include <string>
+#include <vector>
+
+
+namespace kellerberrin::genome {   //  organization::project level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// A microbenchmark of the FieldTokenizer delimiter kernels (scalar, SSE2 and, if supported, AVX2).
+//
+// The first LINE_LIMIT_ records of the uncompressed synthetic VCF file are held in memory. The 'vcf_tab' workload
+// splits each record on the tab delimiter (long text, vector blocks dominate) and the 'genotype_colon' workload splits
+// each genotype column on the ':' format delimiter (short text, the scalar tail dominates).
+//
+// Results are reported as MB/s and fields/s (best of 'repeat' runs) to the log and to std::cout.
+//
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+struct TokenizerBenchResult {
+
+  std::string kernel;
+  std::string workload;
+  size_t bytes{0};
+  size_t fields{0};
+  double seconds{0.0};
+  double mb_per_second{0.0};
+  double fields_per_second{0.0};
+
+};
+
+
+class TokenizerBenchmark {
+
+public:
+
+  explicit TokenizerBenchmark(size_t repeat) : repeat_(repeat) {}
+  ~TokenizerBenchmark() = default;
+
+  // Benchmark all available kernels using the uncompressed VCF file and report.
+  std::vector<TokenizerBenchResult> runBenchmark(const std::string& vcf_text_file);
+
+private:
+
+  size_t repeat_;
+  std::vector<std::string> vcf_lines_;
+  std::vector<std::string_view> genotype_views_;
+
+  constexpr static const size_t LINE_LIMIT_{20000};
+  constexpr static const double BYTES_PER_MB_{1024.0 * 1024.0};
+  constexpr static const char HEADER_CHAR_{'#'};
+  constexpr static const char FIELD_DELIMITER_{'\t'};
+  constexpr static const char FORMAT_DELIMITER_{':'};
+  constexpr static const size_t GENOTYPE_FIELD_OFFSET_{9};
+
+  [[nodiscard]] bool loadLines(const std::string& vcf_text_file);
+  [[nodiscard]] TokenizerBenchResult timeKernel( TokenizerKernel kernel
+                                               , const std::string& workload
+                                               , const std::vector<std::string_view>& text_vector
+                                               , char delimiter) const;
+
+};
+
+
+
+} //  end namespace
+
+
+
+#endif //KGL_BENCH_TOKENIZER_H
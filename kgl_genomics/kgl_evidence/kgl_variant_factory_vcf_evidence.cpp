@@ -166,7 +166,8 @@ bool kgl::InfoEvidenceHeader::setupEvidenceHeader( const VCFInfoRecord& vcf_info
                                                    std::shared_ptr<const InfoEvidenceHeader> self_ptr,
                                                    ManageInfoData& manage_info_data) {
 
-  InfoSubscribedField subscribed_field(vcf_info_record, self_ptr, manage_info_data);
+  // Slots are allocated in subscription order.
+  InfoSubscribedField subscribed_field(vcf_info_record, info_subscribed_map_.size(), self_ptr, manage_info_data);
   auto result = info_subscribed_map_.try_emplace(vcf_info_record.ID, subscribed_field);
 
   if (not result.second) {
@@ -180,6 +181,21 @@ bool kgl::InfoEvidenceHeader::setupEvidenceHeader( const VCFInfoRecord& vcf_info
 
 }
 
+// Only the subscribed field keys are compiled, all other Info fields are skipped when parsing.
+void kgl::InfoEvidenceHeader::compileFieldIndex() {
+
+  std::vector<std::string> slot_keys(info_subscribed_map_.size());
+  for (auto const& [field_id, subscribed_field] : info_subscribed_map_) {
+
+    slot_keys[subscribed_field.infoSlot()] = field_id;
+
+  }
+
+  info_field_index_ = InfoFieldIndex(slot_keys);
+
+}
+
+
 // All field access is through this function.
 std::optional<const kgl::InfoSubscribedField> kgl::InfoEvidenceHeader::getSubscribedField(const std::string& field_id) const {
 
@@ -222,7 +238,7 @@ kgl::InfoMemoryResource kgl::ManageInfoData::resolveResources( const VCFInfoPars
   for (auto const &[ident, subscribed_info] : evidence_header.getConstMap()) {
 
     // The pre-parsed info field. This is used to determine storage requirements.
-    std::optional<InfoParserToken> token = info_parser.getToken(ident);
+    const std::optional<InfoParserToken>& token = info_parser.getToken(subscribed_info.infoSlot());
 
     // No additional storage required if token not available.
     if (token) {
@@ -251,7 +267,7 @@ kgl::InfoMemoryResource kgl::ManageInfoData::resolveResources( const VCFInfoPars
 // The evidence factory also creates an evidence object for each variant (data only).
 
 // Create an indexed data object from the VCF info field, std::moved in as a string.
-std::shared_ptr<const kgl::DataMemoryBlock> kgl::EvidenceFactory::createVariantEvidence(std::string&& info) {
+std::shared_ptr<const kgl::DataMemoryBlock> kgl::EvidenceFactory::createVariantEvidence(std::string_view info) {
 
   // If no Info fields have been subscribed, then just return std::nullopt
   if (info_evidence_header_->getMap().empty()) {
@@ -260,8 +276,8 @@ std::shared_ptr<const kgl::DataMemoryBlock> kgl::EvidenceFactory::createVariantE
 
   }
 
-  // Parse the VCF info line.
-  VCFInfoParser info_parser(std::move(info));
+  // Parse the subscribed fields of the VCF info line.
+  VCFInfoParser info_parser(info, info_evidence_header_->fieldIndex());
 
   // Use the parsed data to create a compact memory block with a copy of the Info data.
   std::shared_ptr<const DataMemoryBlock> mem_blk_ptr = manage_info_data_.createMemoryBlock(info_parser, info_evidence_header_);
@@ -324,6 +340,8 @@ void kgl::EvidenceFactory::availableInfoFields(const VCFInfoRecordMap& vcf_info_
 
   }
 
+  info_evidence_header_->compileFieldIndex();
+
   // Print out subscribed fields.
   std::string all_available = info_evidence_header_->getMap().size() == all_available_map_.size() ? "(all available)" : "";
   ExecEnv::log().info("Subscribed to {} {} VCF Info fields", info_evidence_header_->getMap().size(), all_available);
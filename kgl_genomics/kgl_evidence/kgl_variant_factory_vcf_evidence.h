@@ -10,6 +10,7 @@
 #include "kgl_variant_factory_vcf_parse_header.h"
 #include "kgl_variant_factory_vcf_parse_info.h"
 #include "kgl_variant_factory_vcf_evidence_data_blk.h"
+#include "kgl_variant_factory_vcf_evidence_vep_column.h"
 
 
 #include <string>
@@ -32,6 +33,7 @@ public:
 
     if (parseHeader(field_description)) {
 
+      field_dictionary_ = std::make_shared<VepFieldDictionary>(sub_fields_headers_);
       ExecEnv::log().info("Info Field: vep; successfully parsed: {} sub field headers", sub_fields_headers_.size());
 
     } else {
@@ -51,11 +53,14 @@ public:
 
   [[nodiscard]] const std::vector<std::string>& subFieldHeaders() const { return sub_fields_headers_; }
   [[nodiscard]] std::optional<size_t> getSubFieldIndex(const std::string& sub_field) const;
+  // The per file dictionary used to encode the vep sub fields at ingest (nullptr if the header was not parsed).
+  [[nodiscard]] const std::shared_ptr<VepFieldDictionary>& fieldDictionary() const { return field_dictionary_; }
 
 private:
 
   std::vector<std::string> sub_fields_headers_;
   std::map<std::string, size_t> index_map_;
+  std::shared_ptr<VepFieldDictionary> field_dictionary_;
 
   constexpr static const char* HEADER_SEARCH_STR_ = "Format: ";
 
@@ -75,9 +80,11 @@ class InfoSubscribedField {
 public:
 
   InfoSubscribedField(VCFInfoRecord vcfInfoRecord,
+                      size_t info_slot,
                       std::shared_ptr<const InfoEvidenceHeader> info_evidence_header,
                       ManageInfoData& manage_info_data)
   : vcfInfoRecord_(std::move(vcfInfoRecord)),
+    info_slot_(info_slot),
     type_(InfoTypeLookup::evidenceType(vcfInfoRecord_)),
     info_evidence_header_(std::move(info_evidence_header)),
     m_data_handle_(requestResourceHandle(manage_info_data)) {
@@ -108,6 +115,8 @@ public:
 
   // Returns the reference VCF header record for the VCF Info field.
   [[nodiscard]] const VCFInfoRecord &infoVCF() const { return vcfInfoRecord_; }
+  // The slot of the field in the compiled InfoFieldIndex, used to access parsed tokens.
+  [[nodiscard]] size_t infoSlot() const { return info_slot_; }
   // Returns one of the following
   // The enums are integer valued and can be used as an index for the std::variant return type of InfoDataVariant.
   // InfoEvidenceExtern::Boolean,
@@ -133,6 +142,7 @@ private:
 
 
   const VCFInfoRecord vcfInfoRecord_;  // The reference VCF Header Record.
+  const size_t info_slot_;  // The field index slot.
   const InfoEvidenceType type_;  // THe inferred subscriber type, external type and internal type.
   std::shared_ptr<const InfoEvidenceHeader> info_evidence_header_; // Ensure the index knows which header it belongs to.
   InfoResourceHandle m_data_handle_;
@@ -162,15 +172,19 @@ public:
   [[nodiscard]] std::optional<const InfoSubscribedField> getSubscribedField(const std::string &field_id) const;
   [[nodiscard]] InfoSubscribedMap &getMap()  { return info_subscribed_map_; }
   [[nodiscard]] const InfoSubscribedMap &getConstMap() const { return info_subscribed_map_; }
+  // The perfect hash of the subscribed field keys, compiled once all fields are subscribed.
+  [[nodiscard]] const InfoFieldIndex &fieldIndex() const { return info_field_index_; }
 
 private:
 
   InfoSubscribedMap info_subscribed_map_;
+  InfoFieldIndex info_field_index_;
 
   // Note that this routine takes a shared_ptr to itself obtained from the info data factory. This is passed onto subscribed field objects.
   [[nodiscard]] bool setupEvidenceHeader( const VCFInfoRecord& vcf_info_record,
                                           std::shared_ptr<const InfoEvidenceHeader> self_ptr,
                                           ManageInfoData& manage_info_data);
+  void compileFieldIndex();
 
 
 };
@@ -225,8 +239,8 @@ public:
   // This also initializes the InfoEvidenceHeader object.
   void availableInfoFields(const VCFInfoRecordMap& vcf_info_map);
   [[nodiscard]] const VCFInfoRecordMap& availableInfoFields() const { return all_available_map_; }
-  // For each input VCFRecord info text field (std::moved for efficiency), create a parsed data object.
-  [[nodiscard]] std::shared_ptr<const DataMemoryBlock> createVariantEvidence(std::string&& info);
+  // For each input VCFRecordView info text field (a view of the record line), create a parsed data object.
+  [[nodiscard]] std::shared_ptr<const DataMemoryBlock> createVariantEvidence(std::string_view info);
   // All subscribed Info fields.
   [[nodiscard]] std::shared_ptr<const InfoEvidenceHeader> getInfoHeader() const { return info_evidence_header_; }
 
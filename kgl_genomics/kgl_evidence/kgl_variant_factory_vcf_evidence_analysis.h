@@ -81,6 +81,8 @@ public:
   static std::vector<double> stringBinToFloat(const std::vector<std::string>& bin_data, size_t expected_bin_size);
 
   static std::optional<std::unique_ptr<const VEPSubFieldEvidence>> getVepSubFields(const Variant& variant);
+  // The vep field parsed at ingest into dictionary encoded columns, nullptr if not available.
+  static const VepRecordColumns* getVepColumns(const Variant& variant);
 
   // There can multiple vep records per variant. Default empty vector retrieves all fields.
   static VepValueMap getVepValues(const Variant& variant, std::vector<std::string> vep_fields = std::vector<std::string>{});
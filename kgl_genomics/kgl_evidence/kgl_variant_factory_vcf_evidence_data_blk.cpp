@@ -25,22 +25,7 @@ kgl::DataMemoryBlock::DataMemoryBlock( std::shared_ptr<const InfoEvidenceHeader>
   mem_count_.arrayCount(memory_resource.arraySize());
 
   // Perform actual memory allocation.
-#ifdef KGL_UNIQUE_PTR
-  char_memory_ = std::make_unique<char[]>(mem_count_.charCount());
-  integer_memory_ = std::make_unique<InfoIntegerType[]>(mem_count_.integerCount());
-  float_memory_ = std::make_unique<InfoFloatType[]>(mem_count_.floatCount()) ;
-  array_memory_ = std::make_unique<InfoArrayIndex[]>(mem_count_.arrayCount());
-  string_memory_ = std::make_unique<std::string_view[]>(mem_count_.stringCount());
-#else
-
-  allocation_strategy_.allocateMemory(mem_count_, MemoryStrategy::SINGLE_MALLOC);
-  char_memory_ = allocation_strategy_.charMemory();
-  integer_memory_ = allocation_strategy_.integerMemory();
-  float_memory_ = allocation_strategy_.floatMemory();
-  array_memory_ = allocation_strategy_.arrayMemory();
-  string_memory_ = allocation_strategy_.stringMemory();
-
-#endif
+  allocateBlock();
 
   // Copy the array blocks.
   // The dynamicAllocation() map ensures that copied array memory blocks will be sorted in ascending identifier order.
@@ -60,7 +45,7 @@ kgl::DataMemoryBlock::DataMemoryBlock( std::shared_ptr<const InfoEvidenceHeader>
   for (auto const& [data_identifier, data_item] : info_evidence_header_->getConstMap()) {
 
     // Lookup the matching data token.
-    std::optional<const InfoParserToken> token = info_parser.getToken(data_identifier);
+    const std::optional<InfoParserToken>& token = info_parser.getToken(data_item.infoSlot());
 
     switch(data_item.getDataHandle().resourceType()) {
 
@@ -78,6 +63,12 @@ kgl::DataMemoryBlock::DataMemoryBlock( std::shared_ptr<const InfoEvidenceHeader>
 
       case DataResourceType::String:
         storeString(data_item.getDataHandle(), token, string_usage);
+        // Parse the vep field once into the column store.
+        if (token and data_item.vepSubFieldHeader()) {
+
+          vep_columns_ = VepRecordColumns::parseVep(token.value().first, *data_item.vepSubFieldHeader().value()->fieldDictionary());
+
+        }
         break;
 
     }
@@ -89,6 +80,151 @@ kgl::DataMemoryBlock::DataMemoryBlock( std::shared_ptr<const InfoEvidenceHeader>
 }
 
 
+kgl::DataMemoryBlock::DataMemoryBlock( std::shared_ptr<const InfoEvidenceHeader> info_evidence_header,
+                                       const DataBlockImage& block_image)
+                                       : info_evidence_header_(std::move(info_evidence_header)),
+                                         mem_count_(block_image.mem_count) {
+
+  if (block_image.char_bytes.size() != mem_count_.charCount() * sizeof(char)
+      or block_image.integer_bytes.size() != mem_count_.integerCount() * sizeof(InfoIntegerType)
+      or block_image.float_bytes.size() != mem_count_.floatCount() * sizeof(InfoFloatType)
+      or block_image.array_index.size() != mem_count_.arrayCount()
+      or block_image.string_index.size() != mem_count_.stringCount()) {
+
+    ExecEnv::log().critical("DataMemoryBlock::DataMemoryBlock; block image sizes do not match the block memory usage");
+
+  }
+
+  allocateBlock();
+
+  if (not block_image.char_bytes.empty()) {
+
+    std::memcpy(&char_memory_[0], block_image.char_bytes.data(), block_image.char_bytes.size());
+
+  }
+  if (not block_image.integer_bytes.empty()) {
+
+    std::memcpy(&integer_memory_[0], block_image.integer_bytes.data(), block_image.integer_bytes.size());
+
+  }
+  if (not block_image.float_bytes.empty()) {
+
+    std::memcpy(&float_memory_[0], block_image.float_bytes.data(), block_image.float_bytes.size());
+
+  }
+  for (size_t index = 0; index < block_image.array_index.size(); ++index) {
+
+    array_memory_[index] = block_image.array_index[index];
+
+  }
+  for (size_t index = 0; index < block_image.string_index.size(); ++index) {
+
+    auto const [char_offset, string_size] = block_image.string_index[index];
+    if (char_offset + string_size > mem_count_.charCount()) {
+
+      ExecEnv::log().critical("DataMemoryBlock::DataMemoryBlock; string offset: {} + size: {} exceeds the char memory size: {}",
+                              char_offset, string_size, mem_count_.charCount());
+
+    }
+    string_memory_[index] = string_size == 0 ? std::string_view() : std::string_view(&char_memory_[char_offset], string_size);
+
+  }
+
+  // The vep column store is not saved, it is rebuilt from the restored vep field.
+  for (auto const& [data_identifier, data_item] : info_evidence_header_->getConstMap()) {
+
+    if (data_item.vepSubFieldHeader() and data_item.getDataHandle().resourceType() == DataResourceType::String) {
+
+      // A missing vep field is restored as empty strings.
+      std::vector<std::string> vep_records = getString(data_item.getDataHandle());
+      if (std::ranges::any_of(vep_records, [](const std::string& vep_record) { return not vep_record.empty(); })) {
+
+        std::string vep_field(vep_records.front());
+        for (size_t index = 1; index < vep_records.size(); ++index) {
+
+          vep_field.push_back(VCFInfoParser::INFO_VECTOR_DELIMITER_);
+          vep_field.append(vep_records[index]);
+
+        }
+
+        vep_columns_ = VepRecordColumns::parseVep(vep_field, *data_item.vepSubFieldHeader().value()->fieldDictionary());
+
+      }
+
+    }
+
+  }
+
+  ++object_count_;
+
+}
+
+
+kgl::DataBlockImage kgl::DataMemoryBlock::blockImage() const {
+
+  DataBlockImage block_image;
+  block_image.mem_count = mem_count_;
+
+  if (mem_count_.charCount() > 0) {
+
+    block_image.char_bytes = std::as_bytes(std::span<const char>(&char_memory_[0], mem_count_.charCount()));
+
+  }
+  if (mem_count_.integerCount() > 0) {
+
+    block_image.integer_bytes = std::as_bytes(std::span<const InfoIntegerType>(&integer_memory_[0], mem_count_.integerCount()));
+
+  }
+  if (mem_count_.floatCount() > 0) {
+
+    block_image.float_bytes = std::as_bytes(std::span<const InfoFloatType>(&float_memory_[0], mem_count_.floatCount()));
+
+  }
+
+  block_image.array_index.reserve(mem_count_.arrayCount());
+  for (size_t index = 0; index < mem_count_.arrayCount(); ++index) {
+
+    block_image.array_index.push_back(array_memory_[index]);
+
+  }
+
+  // String views point into the char memory or are empty.
+  block_image.string_index.reserve(mem_count_.stringCount());
+  for (size_t index = 0; index < mem_count_.stringCount(); ++index) {
+
+    const std::string_view& string_view = string_memory_[index];
+    auto char_offset = string_view.empty() ? 0 : static_cast<uint32_t>(string_view.data() - &char_memory_[0]);
+    block_image.string_index.emplace_back(char_offset, static_cast<uint32_t>(string_view.size()));
+
+  }
+
+  return block_image;
+
+}
+
+
+void kgl::DataMemoryBlock::allocateBlock() {
+
+#ifdef KGL_UNIQUE_PTR
+  char_memory_ = std::make_unique<char[]>(mem_count_.charCount());
+  integer_memory_ = std::make_unique<InfoIntegerType[]>(mem_count_.integerCount());
+  float_memory_ = std::make_unique<InfoFloatType[]>(mem_count_.floatCount()) ;
+  array_memory_ = std::make_unique<InfoArrayIndex[]>(mem_count_.arrayCount());
+  string_memory_ = std::make_unique<std::string_view[]>(mem_count_.stringCount());
+#else
+
+  allocation_strategy_.allocateMemory(mem_count_, MemoryStrategy::SINGLE_MALLOC);
+  char_memory_ = allocation_strategy_.charMemory();
+  integer_memory_ = allocation_strategy_.integerMemory();
+  float_memory_ = allocation_strategy_.floatMemory();
+  array_memory_ = allocation_strategy_.arrayMemory();
+  string_memory_ = allocation_strategy_.stringMemory();
+
+#endif
+
+}
+
+
 kgl::DataMemoryBlock::~DataMemoryBlock() {
 
   --object_count_;
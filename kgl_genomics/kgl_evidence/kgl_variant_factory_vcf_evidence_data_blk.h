@@ -9,6 +9,11 @@
 #include "kgl_variant_factory_vcf_evidence_mem_alloc.h"
 #include "kgl_variant_factory_vcf_evidence_data.h"
 #include "kgl_variant_factory_vcf_evidence_memory.h"
+#include "kgl_variant_factory_vcf_evidence_vep_column.h"
+
+#include <span>
+#include <vector>
+#include <cstddef>
 
 
 namespace kellerberrin::genome {   //  organization level namespace
@@ -32,6 +37,19 @@ namespace kellerberrin::genome {   //  organization level namespace
 // Forward declarations.
 class InfoEvidenceHeader;
 
+// The raw memory of a data block, used to save and restore the block without re-parsing the INFO field.
+// The data bytes are (possibly unaligned) copies of the block memory, string views are stored as {char offset, size}.
+struct DataBlockImage {
+
+  MemDataUsage mem_count;
+  std::span<const std::byte> char_bytes;
+  std::span<const std::byte> integer_bytes;
+  std::span<const std::byte> float_bytes;
+  std::vector<InfoArrayIndex> array_index;
+  std::vector<std::pair<uint32_t, uint32_t>> string_index;
+
+};
+
 // Uncomment to use std::unique_ptr<T[]>
 //#define KGL_UNIQUE_PTR 1
 class DataMemoryBlock {
@@ -41,6 +59,9 @@ public:
   DataMemoryBlock( std::shared_ptr<const InfoEvidenceHeader> info_evidence_header,
                    const InfoMemoryResource& initial_memory_resource,
                    const VCFInfoParser& info_parser);
+  // Restore a block from a saved image, the header must have the same subscribed field layout as the saved block.
+  DataMemoryBlock( std::shared_ptr<const InfoEvidenceHeader> info_evidence_header,
+                   const DataBlockImage& block_image);
   DataMemoryBlock(const DataMemoryBlock &) = delete;
   ~DataMemoryBlock();
 
@@ -53,9 +74,14 @@ public:
   [[nodiscard]] std::vector<std::string> getString(const InfoResourceHandle& handle) const;
 
   [[nodiscard]] const MemDataUsage& getUsageCount() const { return mem_count_; }
+  // The image of the block memory, the data spans are only valid for the lifetime of the block.
+  [[nodiscard]] DataBlockImage blockImage() const;
 
   [[nodiscard]] const std::shared_ptr<const InfoEvidenceHeader>& evidenceHeader() const { return info_evidence_header_; }
 
+  // The vep field parsed at ingest into a dictionary encoded column store, nullptr if the record has no vep data.
+  [[nodiscard]] const VepRecordColumns* vepColumns() const { return vep_columns_.get(); }
+
   [[nodiscard]] static size_t objectCount() { return object_count_; }
 
 private:
@@ -64,6 +90,7 @@ private:
   std::shared_ptr<const InfoEvidenceHeader> info_evidence_header_; // The data header and indexing structure.
   MemDataUsage mem_count_;  // Size count object.
   MemoryAllocationStrategy allocation_strategy_;
+  std::unique_ptr<const VepRecordColumns> vep_columns_;
 
 // Raw memory to efficiently store the info data.
 #ifdef KGL_UNIQUE_PTR
@@ -91,6 +118,8 @@ private:
   void storeString(const InfoResourceHandle& handle, std::optional<const InfoParserToken> token, FixedResourceInstance& string_usage);
   void storeInteger(const InfoResourceHandle& handle, std::optional<const InfoParserToken> token);
   void storeFloat(const InfoResourceHandle& handle, std::optional<const InfoParserToken> token);
+  // Allocate the block memory using mem_count_.
+  void allocateBlock();
 
 
 };
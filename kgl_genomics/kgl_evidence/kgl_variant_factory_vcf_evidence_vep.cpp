@@ -127,6 +127,19 @@ kgl::InfoEvidenceAnalysis::getVepSubFields(const Variant& variant) {
 }
 
 
+const kgl::VepRecordColumns* kgl::InfoEvidenceAnalysis::getVepColumns(const Variant& variant) {
+
+  if (not variant.evidence().infoData()) {
+
+    return nullptr;
+
+  }
+
+  return variant.evidence().infoData().value()->vepColumns();
+
+}
+
+
 kgl::VepValueMap kgl::InfoEvidenceAnalysis::getVepValues(const Variant& variant, std::vector<std::string> vep_field_list) {
 
   return getVepData(variant, getVepIndexes(variant, vep_field_list));
@@ -136,23 +149,22 @@ kgl::VepValueMap kgl::InfoEvidenceAnalysis::getVepValues(const Variant& variant,
 // Empty field list returns all available fields and associated offsets.
 kgl::VepIndexVector kgl::InfoEvidenceAnalysis::getVepIndexes(const Variant& variant, const std::vector<std::string>& vep_field_list) {
 
-  std::optional<std::unique_ptr<const VEPSubFieldEvidence>> vep_fields_opt = InfoEvidenceAnalysis::getVepSubFields(variant);
+  const VepRecordColumns* vep_columns = getVepColumns(variant);
 
-  if (not vep_fields_opt) {
+  if (vep_columns == nullptr) {
 
     return VepIndexVector{};
 
   }
 
-  auto const &vep_fields = *vep_fields_opt.value();
-  auto const &vep_header = *vep_fields.vepHeader();
+  auto const &vep_dictionary = vep_columns->dictionary();
 
   VepIndexVector field_index;
   if (not vep_field_list.empty()) {
 
     for (auto const &field_header : vep_field_list) {
 
-      std::optional<size_t> vep_index_opt = vep_header.getSubFieldIndex(field_header);
+      std::optional<size_t> vep_index_opt = vep_dictionary.columnIndex(field_header);
 
       if (not vep_index_opt) {
 
@@ -169,7 +181,7 @@ kgl::VepIndexVector kgl::InfoEvidenceAnalysis::getVepIndexes(const Variant& vari
   } else {
 
     size_t index{0};
-    for (auto const &vep_field_header : vep_header.subFieldHeaders()) {
+    for (auto const &vep_field_header : vep_dictionary.columnHeaders()) {
 
       field_index.emplace_back(vep_field_header, index);
       ++index;
@@ -190,40 +202,33 @@ kgl::VepValueMap kgl::InfoEvidenceAnalysis::getVepData(const Variant& variant, c
 
   }
 
-  std::optional<std::unique_ptr<const VEPSubFieldEvidence>> vep_fields_opt = InfoEvidenceAnalysis::getVepSubFields(variant);
+  const VepRecordColumns* vep_columns = getVepColumns(variant);
 
-  if (not vep_fields_opt) {
+  if (vep_columns == nullptr) {
 
     return VepValueMap{};
 
   }
 
-  auto const &vep_fields = *vep_fields_opt.value();
-  auto const &vep_header = *vep_fields.vepHeader();
-
-  VepValueMap vep_value_map;
-  for (auto const &vep_field : vep_fields.vepFields()) {
-
-    const std::vector<std::string_view> sub_field_vector = VEPSubFieldEvidence::vepSubFields(vep_field);
-
-    if (sub_field_vector.size() != vep_header.subFieldHeaders().size()) {
+  for (auto const&[field_ident, index] : vep_field_list) {
 
-      ExecEnv::log().error("InfoEvidenceAnalysis::getVepData; Vep Header size: {} not equal vep sub field size: {}, vep field: {}",
-                           vep_header.subFieldHeaders().size(), sub_field_vector.size(), vep_field);
-      for (auto const &sub_field : sub_field_vector) {
-
-        ExecEnv::log().error("InfoEvidenceAnalysis::getVepData; sub field: {}", std::string(sub_field));
-
-      }
+    if (index >= vep_columns->columnCount()) {
 
+      ExecEnv::log().error("InfoEvidenceAnalysis::getVepData; Vep sub field: {}, index: {} exceeds the Vep Header size: {}",
+                           field_ident, index, vep_columns->columnCount());
       return VepValueMap{};
 
     }
 
+  }
+
+  VepValueMap vep_value_map;
+  for (size_t row = 0; row < vep_columns->rowCount(); ++row) {
+
     std::map<std::string, std::string> sub_field_map;
     for (auto const&[field_ident, index] : vep_field_list) {
 
-      sub_field_map[field_ident] = sub_field_vector[index];
+      sub_field_map[field_ident] = vep_columns->value(row, index);
 
     }
 
@@ -276,13 +281,11 @@ void kgl::InfoEvidenceAnalysis::vepSubFieldCount( std::string vep_sub_field,
 
 bool kgl::VepSubFieldValues::getSubFieldValues(const std::shared_ptr<const Variant>& variant_ptr) {
 
-  std::optional<std::unique_ptr<const VEPSubFieldEvidence>> vep_fields_opt = InfoEvidenceAnalysis::getVepSubFields(*variant_ptr);
+  const VepRecordColumns* vep_columns = InfoEvidenceAnalysis::getVepColumns(*variant_ptr);
 
-  if (vep_fields_opt) {
+  if (vep_columns != nullptr) {
 
-    auto const &vep_fields = *vep_fields_opt.value();
-    auto const &vep_header = *vep_fields.vepHeader();
-    std::optional<size_t> vep_index_opt = vep_header.getSubFieldIndex(vep_sub_field_);
+    std::optional<size_t> vep_index_opt = vep_columns->dictionary().columnIndex(vep_sub_field_);
 
     if (not vep_index_opt) {
 
@@ -293,24 +296,9 @@ bool kgl::VepSubFieldValues::getSubFieldValues(const std::shared_ptr<const Varia
 
     size_t vep_index = vep_index_opt.value();
 
-    for (auto const&  vep_field : vep_fields.vepFields()) {
-
-      const std::vector<std::string_view> sub_field_vector = VEPSubFieldEvidence::vepSubFields(vep_field);
-
-      // Check that the header and the field vector are the same size.
-      if (sub_field_vector.size() != vep_header.subFieldHeaders().size()) {
-
-        ExecEnv::log().error("InfoEvidenceAnalysis::vepSubFieldValues; Vep Header size: {} not equal vep sub field size: {}, vep field: {}",
-                             vep_header.subFieldHeaders().size(), sub_field_vector.size(), vep_field);
-        for (auto const& sub_field : sub_field_vector) {
-
-          ExecEnv::log().error("InfoEvidenceAnalysis::vepSubFieldValues; sub field: {}", std::string(sub_field));
-
-        }
-        return false;
-      }
+    for (size_t row = 0; row < vep_columns->rowCount(); ++row) {
 
-      std::string field_value(sub_field_vector[vep_index]);
+      std::string_view field_value = vep_columns->value(row, vep_index);
       if (field_value.empty()) {
 
         continue;
@@ -325,7 +313,7 @@ bool kgl::VepSubFieldValues::getSubFieldValues(const std::shared_ptr<const Varia
 
       } else {
 
-        auto insert_result = field_value_map_.try_emplace(field_value, 1);
+        auto insert_result = field_value_map_.try_emplace(std::string(field_value), 1);
         if (not insert_result.second) {
 
           ExecEnv::log().error("InfoEvidenceAnalysis::vepSubFieldValues, could not insert sub_field value: {}", field_value);
@@ -334,9 +322,9 @@ bool kgl::VepSubFieldValues::getSubFieldValues(const std::shared_ptr<const Varia
 
       }
 
-    } // sub fields
+    } // for all vep rows
 
-  } // for all sub fields
+  } // has vep
 
   return true;
 
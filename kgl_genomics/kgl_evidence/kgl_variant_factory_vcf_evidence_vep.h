@@ -21,7 +21,7 @@ namespace kellerberrin::genome {   //  organization level namespace
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
-using VepFieldValueMap = std::map<std::string, size_t>;
+using VepFieldValueMap = std::map<std::string, size_t, std::less<>>;
 
 class VepSubFieldValues {
 
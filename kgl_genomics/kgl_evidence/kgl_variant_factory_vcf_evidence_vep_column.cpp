@@ -0,0 +1,273 @@
+//
+// Created by kellerberrin on 17/10/23.
+//
+
+#include "kgl_variant_factory_vcf_evidence_vep_column.h"
+#include "kel_exec_env.h"
+#include "kel_tokenizer.h"
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <limits>
+#include <bit>
+
+
+namespace kgl = kellerberrin::genome;
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Dictionary encodes the VEP sub field values.
+
+kgl::VepFieldDictionary::VepFieldDictionary(const std::vector<std::string>& sub_field_headers)
+: column_headers_(sub_field_headers), columns_(sub_field_headers.size()) {
+
+  impact_column_ = columnIndex(IMPACT_FIELD_);
+  if (impact_column_) {
+
+    // The codes of the seeded values are the VepImpact enum values.
+    const std::array<std::string_view, 4> impact_values{"HIGH", "MODERATE", "LOW", "MODIFIER"};
+    for (auto const& impact : impact_values) {
+
+      static_cast<void>(insertValue(columns_[impact_column_.value()], impact));
+
+    }
+
+  }
+
+}
+
+
+uint32_t kgl::VepFieldDictionary::insertValue(ColumnDictionary& column, std::string_view value) {
+
+  auto find_iter = column.code_map.find(value);
+  if (find_iter != column.code_map.end()) {
+
+    return find_iter->second;
+
+  }
+
+  const uint32_t code = column.value_count;
+  auto [segment, offset] = valuePosition(code);
+  if (not column.value_segments[segment]) {
+
+    column.value_segments[segment] = std::make_unique<std::string[]>(static_cast<size_t>(FIRST_SEGMENT_SIZE_) << segment);
+
+  }
+
+  std::string& stored_value = column.value_segments[segment][offset];
+  stored_value = value;
+  column.code_map.emplace(stored_value, code);
+  ++column.value_count;
+
+  return code;
+
+}
+
+
+std::pair<size_t, size_t> kgl::VepFieldDictionary::valuePosition(uint32_t code) {
+
+  // Segment s starts at code FIRST_SEGMENT_SIZE_ * (2^s - 1).
+  const uint64_t segment_code = (static_cast<uint64_t>(code) >> FIRST_SEGMENT_SHIFT_) + 1;
+  const size_t segment = std::bit_width(segment_code) - 1;
+  const size_t offset = code - (static_cast<size_t>(FIRST_SEGMENT_SIZE_) * ((size_t{1} << segment) - 1));
+
+  return { segment, offset };
+
+}
+
+
+void kgl::VepFieldDictionary::encode(std::span<const std::string_view> values, size_t row_count, std::span<uint32_t> codes) {
+
+  constexpr const uint32_t NOT_FOUND{std::numeric_limits<uint32_t>::max()};
+  size_t not_found_count{0};
+
+  {
+    std::shared_lock lock(dictionary_mutex_);
+
+    for (size_t index = 0; index < values.size(); ++index) {
+
+      const auto& code_map = columns_[index / row_count].code_map;
+      auto find_iter = code_map.find(values[index]);
+      if (find_iter != code_map.end()) {
+
+        codes[index] = find_iter->second;
+
+      } else {
+
+        codes[index] = NOT_FOUND;
+        ++not_found_count;
+
+      }
+
+    }
+
+  }
+
+  if (not_found_count == 0) {
+
+    return;
+
+  }
+
+  // Another thread may have added the value since the shared lock was released.
+  std::unique_lock lock(dictionary_mutex_);
+  for (size_t index = 0; index < values.size(); ++index) {
+
+    if (codes[index] == NOT_FOUND) {
+
+      codes[index] = insertValue(columns_[index / row_count], values[index]);
+
+    }
+
+  }
+
+}
+
+
+std::optional<uint32_t> kgl::VepFieldDictionary::findCode(size_t column, std::string_view value) const {
+
+  std::shared_lock lock(dictionary_mutex_);
+
+  const auto& code_map = columns_[column].code_map;
+  auto find_iter = code_map.find(value);
+  if (find_iter == code_map.end()) {
+
+    return std::nullopt;
+
+  }
+
+  return find_iter->second;
+
+}
+
+
+// The value and its segment were stored before the code was returned by encode() or findCode(),
+// concurrent inserts only write to later values and segments.
+std::string_view kgl::VepFieldDictionary::value(size_t column, uint32_t code) const {
+
+  auto [segment, offset] = valuePosition(code);
+  return columns_[column].value_segments[segment][offset];
+
+}
+
+
+size_t kgl::VepFieldDictionary::codeCount(size_t column) const {
+
+  std::shared_lock lock(dictionary_mutex_);
+
+  return columns_[column].value_count;
+
+}
+
+
+std::optional<size_t> kgl::VepFieldDictionary::columnIndex(std::string_view column_header) const {
+
+  auto find_iter = std::ranges::find(column_headers_, column_header);
+  if (find_iter == column_headers_.end()) {
+
+    return std::nullopt;
+
+  }
+
+  return static_cast<size_t>(std::distance(column_headers_.begin(), find_iter));
+
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The per record VEP column store.
+
+std::unique_ptr<const kgl::VepRecordColumns> kgl::VepRecordColumns::parseVep(std::string_view vep_field, VepFieldDictionary& dictionary) {
+
+  const size_t column_count = dictionary.columnCount();
+  if (column_count == 0) {
+
+    return nullptr;
+
+  }
+
+  std::vector<std::string_view> vep_records;
+  FieldTokenizer::tokenize(vep_field, VEP_RECORD_DELIMITER_, vep_records);
+
+  // Tokenize the rows, discarding any rows that do not match the header.
+  std::vector<std::string_view> row_values;
+  row_values.reserve(vep_records.size() * column_count);
+  std::vector<std::string_view> sub_fields;
+  for (auto const& vep_record : vep_records) {
+
+    FieldTokenizer::tokenize(vep_record, VEP_SUB_FIELD_DELIMITER_, sub_fields);
+    if (sub_fields.size() == column_count) {
+
+      row_values.insert(row_values.end(), sub_fields.begin(), sub_fields.end());
+
+    } else {
+
+      // **** Gnomad 3 VEP bug workaround ****
+      // Sub-sub-fields in the 'LoF_xxx' fields are delimited with ',' and are thus parsed as separate VEP records.
+      static std::atomic<bool> gnomad3_vep_warning{false};
+      if (not gnomad3_vep_warning.exchange(true)) {
+
+        ExecEnv::log().warn("VepRecordColumns::parseVep; Gnomad 3 VEP bug, VEP sub-field count: {} not equal to VEP header size: {}, record discarded",
+                            sub_fields.size(), column_count);
+
+      }
+
+    }
+
+  }
+
+  const size_t row_count = row_values.size() / column_count;
+  if (row_count == 0) {
+
+    return nullptr;
+
+  }
+
+  // Transpose to column-major.
+  std::vector<std::string_view> column_values(row_values.size());
+  for (size_t row = 0; row < row_count; ++row) {
+
+    for (size_t column = 0; column < column_count; ++column) {
+
+      column_values[(column * row_count) + row] = row_values[(row * column_count) + column];
+
+    }
+
+  }
+
+  auto codes = std::make_unique<uint32_t[]>(column_values.size());
+  dictionary.encode(column_values, row_count, std::span<uint32_t>(codes.get(), column_values.size()));
+
+  return std::make_unique<const VepRecordColumns>(dictionary, row_count, std::move(codes));
+
+}
+
+
+kgl::VepImpact kgl::VepRecordColumns::impact(size_t row) const {
+
+  auto impact_column = dictionary_.impactColumn();
+  if (not impact_column) {
+
+    return VepImpact::UNKNOWN;
+
+  }
+
+  uint32_t impact_code = code(row, impact_column.value());
+  return impact_code < static_cast<uint32_t>(VepImpact::UNKNOWN) ? static_cast<VepImpact>(impact_code) : VepImpact::UNKNOWN;
+
+}
+
+
+bool kgl::VepRecordColumns::anyImpact(VepImpact impact) const {
+
+  auto impact_column = dictionary_.impactColumn();
+  if (not impact_column) {
+
+    return false;
+
+  }
+
+  return anyRow(impact_column.value(), [impact](uint32_t impact_code) { return impact_code == static_cast<uint32_t>(impact); });
+
+}
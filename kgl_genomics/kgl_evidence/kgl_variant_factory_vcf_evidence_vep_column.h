@@ -0,0 +1,148 @@
+//
+// Created by kellerberrin on 17/10/23.
+//
+
+#ifndef KGL_VARIANT_FACTORY_VCF_EVIDENCE_VEP_COLUMN_H
+#define KGL_VARIANT_FACTORY_VCF_EVIDENCE_VEP_COLUMN_H
+
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <span>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <shared_mutex>
+#include <algorithm>
+#include <cstdint>
+
+
+namespace kellerberrin::genome {   //  organization level namespace
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The VEP 'IMPACT' sub field values. The IMPACT dictionary is seeded in this order so that the dictionary
+// codes of these values are the enum values.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum class VepImpact : uint32_t { HIGH = 0, MODERATE = 1, LOW = 2, MODIFIER = 3, UNKNOWN = 4 };
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Dictionary encodes the values of each VEP sub field (column) to small integer codes, one dictionary per VCF file.
+// Codes are allocated per column in order of first appearance. Encoding is thread safe for the parser threads,
+// a record is encoded under a single shared lock and an exclusive lock is only taken to add new values.
+// Values are stored in fixed segments that are never moved or reallocated when the dictionary grows, so the returned
+// views remain valid for the lifetime of the dictionary and value() decodes a code without taking a lock.
+// A code is only obtained from encode() or findCode(), after its value has been stored.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class VepFieldDictionary {
+
+public:
+
+  explicit VepFieldDictionary(const std::vector<std::string>& sub_field_headers);
+  VepFieldDictionary(const VepFieldDictionary&) = delete;
+  ~VepFieldDictionary() = default;
+
+  VepFieldDictionary& operator=(const VepFieldDictionary&) = delete;
+
+  // The values are column-major, all the rows of column 0 then all the rows of column 1, etc.
+  // The codes are written in the same order.
+  void encode(std::span<const std::string_view> values, size_t row_count, std::span<uint32_t> codes);
+
+  // The code of a value if it has been seen in this column.
+  [[nodiscard]] std::optional<uint32_t> findCode(size_t column, std::string_view value) const;
+  // Lock free, called per row by the variant filters.
+  [[nodiscard]] std::string_view value(size_t column, uint32_t code) const;
+  // The number of distinct values of the column.
+  [[nodiscard]] size_t codeCount(size_t column) const;
+
+  [[nodiscard]] size_t columnCount() const { return columns_.size(); }
+  [[nodiscard]] const std::vector<std::string>& columnHeaders() const { return column_headers_; }
+  [[nodiscard]] std::optional<size_t> columnIndex(std::string_view column_header) const;
+  [[nodiscard]] std::optional<size_t> impactColumn() const { return impact_column_; }
+
+  constexpr static const char* IMPACT_FIELD_{"IMPACT"};
+
+private:
+
+  // Segment s holds FIRST_SEGMENT_SIZE_ << s values, the segments address the full uint32_t code range.
+  constexpr static const uint32_t FIRST_SEGMENT_SHIFT_{4};
+  constexpr static const uint32_t FIRST_SEGMENT_SIZE_{1u << FIRST_SEGMENT_SHIFT_};
+  constexpr static const size_t SEGMENT_COUNT_{32 - FIRST_SEGMENT_SHIFT_};
+
+  struct ColumnDictionary {
+
+    std::unordered_map<std::string_view, uint32_t> code_map;
+    std::array<std::unique_ptr<std::string[]>, SEGMENT_COUNT_> value_segments;
+    uint32_t value_count{0};
+
+  };
+
+  const std::vector<std::string> column_headers_;
+  std::vector<ColumnDictionary> columns_;
+  std::optional<size_t> impact_column_;
+  mutable std::shared_mutex dictionary_mutex_;
+
+  // Called under the exclusive lock.
+  uint32_t insertValue(ColumnDictionary& column, std::string_view value);
+  // The {segment, offset} of a code.
+  [[nodiscard]] static std::pair<size_t, size_t> valuePosition(uint32_t code);
+
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The VEP (CSQ) field of a variant record parsed once at ingest into a dictionary encoded column store.
+// Each ',' delimited VEP record is a row and each '|' delimited sub field is a column, rows that do not match
+// the VEP header size (Gnomad 3 VEP bug) are discarded. The codes are stored column-major so that the rows of a
+// column are contiguous and can be tested as integers, e.g. "does any row have HIGH impact".
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class VepRecordColumns {
+
+public:
+
+  VepRecordColumns(const VepFieldDictionary& dictionary, size_t row_count, std::unique_ptr<uint32_t[]> codes)
+  : dictionary_(dictionary), row_count_(row_count), codes_(std::move(codes)) {}
+  VepRecordColumns(const VepRecordColumns&) = delete;
+  ~VepRecordColumns() = default;
+
+  // Returns nullptr if the VEP field has no valid rows.
+  [[nodiscard]] static std::unique_ptr<const VepRecordColumns> parseVep(std::string_view vep_field, VepFieldDictionary& dictionary);
+
+  [[nodiscard]] size_t rowCount() const { return row_count_; }
+  [[nodiscard]] size_t columnCount() const { return dictionary_.columnCount(); }
+  [[nodiscard]] const VepFieldDictionary& dictionary() const { return dictionary_; }
+
+  [[nodiscard]] uint32_t code(size_t row, size_t column) const { return codes_[(column * row_count_) + row]; }
+  [[nodiscard]] std::span<const uint32_t> column(size_t column) const { return { codes_.get() + (column * row_count_), row_count_ }; }
+  [[nodiscard]] std::string_view value(size_t row, size_t column) const { return dictionary_.value(column, code(row, column)); }
+
+  // The typed IMPACT of a row, UNKNOWN if there is no IMPACT column.
+  [[nodiscard]] VepImpact impact(size_t row) const;
+
+  // Code level predicates.
+  template<typename CodePredicate>
+  [[nodiscard]] bool anyRow(size_t column, CodePredicate predicate) const { return std::ranges::any_of(this->column(column), predicate); }
+  [[nodiscard]] bool anyImpact(VepImpact impact) const;
+
+private:
+
+  const VepFieldDictionary& dictionary_;
+  const size_t row_count_;
+  const std::unique_ptr<uint32_t[]> codes_;
+
+  constexpr static const char VEP_RECORD_DELIMITER_{','};
+  constexpr static const char VEP_SUB_FIELD_DELIMITER_{'|'};
+
+};
+
+
+
+} // namespace
+
+#endif //KGL_VARIANT_FACTORY_VCF_EVIDENCE_VEP_COLUMN_H
@@ -9,6 +9,7 @@
 #include "kgl_pfgenome_aux.h"
 #include "kel_mt_buffer.h"
 #include "kel_exec_env.h"
+#include "kel_tokenizer.h"
 
 
 
@@ -161,6 +162,8 @@ std::shared_ptr<kgl::SquareTextRows> kgl::SquareTextParser::parseFlatFile(const
   StreamMTBuffer file_io;
   std::shared_ptr<SquareTextRows> square_text_ptr(std::make_shared<SquareTextRows>());
   size_t counter = 0;
+  // Reused by each line.
+  std::vector<std::string_view> field_views;
 
   if (not file_io.open(file_name)) {
 
@@ -185,7 +188,8 @@ std::shared_ptr<kgl::SquareTextRows> kgl::SquareTextParser::parseFlatFile(const
 
     }
 
-    std::vector<std::string> row_fields = Utility::charTokenizer(record_str, delimiter);
+    FieldTokenizer::tokenize(record_str, delimiter, field_views);
+    std::vector<std::string> row_fields(field_views.begin(), field_views.end());
     square_text_ptr->getRowVector().push_back(std::move(row_fields));
 
     ++counter;
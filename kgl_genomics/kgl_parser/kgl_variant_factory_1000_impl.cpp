@@ -3,6 +3,7 @@
 //
 
 #include "kgl_variant_factory_1000_impl.h"
+#include "kgl_variant_factory_vcf_parse_gt.h"
 
 
 
@@ -43,7 +44,7 @@ void kgl::Genome1000VCFImpl::readParseVCFImpl(const std::string &vcf_file_name)
 }
 
 // This is multi-threaded code called from the reader defined above.
-void kgl::Genome1000VCFImpl::ProcessVCFRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr) {
+void kgl::Genome1000VCFImpl::ProcessVCFRecord(std::unique_ptr<const VCFRecordView> vcf_record_ptr) {
 
   try {
 
@@ -60,23 +61,25 @@ void kgl::Genome1000VCFImpl::ProcessVCFRecord(std::unique_ptr<const VCFRecord> v
 
 
 // This is multithreaded code called from the reader defined above.
-void kgl::Genome1000VCFImpl::ParseRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr) {
+void kgl::Genome1000VCFImpl::ParseRecord(std::unique_ptr<const VCFRecordView> vcf_record_ptr) {
 
   // Parse the info fields into a map.
-  // For performance reasons the info field is std::moved - don't reference again.
-  auto mutable_info = const_cast<std::string&>(vcf_record_ptr->info);
-  std::shared_ptr<const DataMemoryBlock> info_evidence_ptr = evidence_factory_.createVariantEvidence(std::move(mutable_info));  // Each vcf record.
+  // The info field is a view of the record line and is not copied.
+  std::shared_ptr<const DataMemoryBlock> info_evidence_ptr = evidence_factory_.createVariantEvidence(vcf_record_ptr->info);  // Each vcf record.
 
   // Look at the filter field for "Pass"
-  bool passed_filter = Utility::toupper(vcf_record_ptr->filter) == PASSED_FILTERS_;
+  bool passed_filter = Utility::toupper(std::string(vcf_record_ptr->filter)) == PASSED_FILTERS_;
 
   // Convert VCF contig to genome contig_ref_ptr.
-  std::string contig = contig_alias_map_.lookupAlias(vcf_record_ptr->contig_id);
+  std::string contig = contig_alias_map_.lookupAlias(std::string(vcf_record_ptr->contig_id));
 
-  if (getGenomeNames().size() != vcf_record_ptr->genotypeInfos.size()) {
+  // The genotype columns are tokenised once as views of the record line.
+  const std::vector<std::string_view>& genotype_infos = vcf_record_ptr->genotypeInfos();
+
+  if (getGenomeNames().size() != genotype_infos.size()) {
 
     ExecEnv::log().warn("Genome Name Size: {}, Genotype count: {}",
-                        getGenomeNames().size(), vcf_record_ptr->genotypeInfos.size());
+                        getGenomeNames().size(), genotype_infos.size());
 
   }
 
@@ -91,10 +94,10 @@ void kgl::Genome1000VCFImpl::ParseRecord(std::unique_ptr<const VCFRecord> vcf_re
   // For all genotypes.
 
   std::map<size_t, std::vector<GenomeId_t>> phase_A_map, phase_B_map;
-  for (size_t genotype_count = 0; genotype_count< vcf_record_ptr->genotypeInfos.size(); ++genotype_count)
+  for (size_t genotype_count = 0; genotype_count< genotype_infos.size(); ++genotype_count)
   {
 
-    const std::string& genotype = vcf_record_ptr->genotypeInfos[genotype_count];
+    std::string_view genotype = genotype_infos[genotype_count];
     const std::string& genome = getGenomeNames()[genotype_count];
 
     auto const [A_index, B_index] = alternateIndex(contig, genotype, alt_vector);
@@ -146,123 +149,78 @@ void kgl::Genome1000VCFImpl::ParseRecord(std::unique_ptr<const VCFRecord> vcf_re
 
 
 std::pair<size_t, size_t> kgl::Genome1000VCFImpl::alternateIndex( const std::string& contig,
-                                                                  const std::string& genotype,
+                                                                  std::string_view genotype,
                                                                   const std::vector<std::string>& alt_vector) const {
 
-  // Trim any whitespace.
-  auto trim_genotype = Utility::trimEndWhiteSpace(genotype);
+  // The GT field is decoded up to the first ':' (if it exists).
+  DecodedGenotype decoded = VCFGenotypeDecoder::decode(genotype);
 
-  // Check for info.
-  if (trim_genotype.empty()) {
+  if (not decoded.valid()) {
 
-    ExecEnv::log().warn("Genome1000VCFImpl::alternateIndex, No Phase Vector information");
-    return {REFERENCE_VARIANT_INDEX_, REFERENCE_VARIANT_INDEX_};
+    if (Utility::trimEndWhiteSpaceView(genotype).empty()) {
 
-  }
+      ExecEnv::log().warn("Genome1000VCFImpl::alternateIndex, No Phase Vector information");
 
-  // Size of the GT Block.
-  size_t GT_size{0};
-  auto GT_index = trim_genotype.find(GT_SEPARATOR_);
-  if (GT_index != std::string::npos) {
+    } else {
 
-    GT_size = GT_index;
+      ExecEnv::log().warn("Genome1000VCFImpl::alternateIndex, Problem converting phase indexes to unsigned longs, phase text: {}", genotype);
 
-  } else {
-
-    GT_size = trim_genotype.size();
+    }
+    return {REFERENCE_VARIANT_INDEX_, REFERENCE_VARIANT_INDEX_};
 
   }
 
-
-  // The phenotype size or the first ":" if that exists.
-  std::string_view unphased_view(trim_genotype.c_str(), GT_size);
-  // Look for the "|" phase separator.
-  std::vector<std::string_view> phase_vector = Utility::viewTokenizer(unphased_view, PHASE_MARKER_);
-
   size_t phase_A_alt{REFERENCE_VARIANT_INDEX_};
   size_t phase_B_alt{REFERENCE_VARIANT_INDEX_};
 
+  if (not decoded.diploid()) {
 
-  try {
-
-    if (phase_vector.size() == 1) {
-
-      // If the phase vector size is 1 then we assume that we are processing the X/Y chromosomes of a male_.
-      if (unphased_view != REFERENCE_VARIANT_INDICATOR_ and unphased_view != ALT_REFERENCE_VARIANT_INDICATOR_) {
-
-        switch(contig_alias_map_.lookupType(contig)) {
+    // If the genotype is haploid then we assume that we are processing the X/Y chromosomes of a male_.
+    if (decoded.a_idx != DecodedGenotype::MISSING_ALLELE_) {
 
-          case ChromosomeType::ALLOSOME_X:
-            phase_A_alt = std::stoul(std::string(unphased_view));
-            phase_B_alt = REFERENCE_VARIANT_INDEX_;
-            break;
+      switch(contig_alias_map_.lookupType(contig)) {
 
-          case ChromosomeType::ALLOSOME_Y:
-            phase_A_alt = REFERENCE_VARIANT_INDEX_;
-            phase_B_alt = std::stoul(std::string(unphased_view));
-            break;
-
-          default:
-            ExecEnv::log().warn("Genome1000VCFImpl::alternateIndex, Expected Autosomal Chromosome: {} to have 2 phases", contig);
-            break;
-
-        }
-
-      }
+        case ChromosomeType::ALLOSOME_X:
+          phase_A_alt = DecodedGenotype::referenceIndex(decoded.a_idx);
+          phase_B_alt = REFERENCE_VARIANT_INDEX_;
+          break;
 
-      if (phase_A_alt > alt_vector.size() or phase_B_alt > alt_vector.size()) {
+        case ChromosomeType::ALLOSOME_Y:
+          phase_A_alt = REFERENCE_VARIANT_INDEX_;
+          phase_B_alt = DecodedGenotype::referenceIndex(decoded.a_idx);
+          break;
 
-        ExecEnv::log().warn("Genome1000VCFImpl::alternateIndex, phase A index: {}, phase B index: {}, exceed alternate vector size: {}, genotype: {}",
-                            phase_A_alt, phase_B_alt, phase_vector.size(), genotype);
-        return {REFERENCE_VARIANT_INDEX_, REFERENCE_VARIANT_INDEX_};
+        default:
+          ExecEnv::log().warn("Genome1000VCFImpl::alternateIndex, Expected Autosomal Chromosome: {} to have 2 phases", contig);
+          break;
 
       }
 
-      return {phase_A_alt, phase_B_alt};
-
     }
 
-    // Size of the vector is 2
-    if (phase_vector[0].find(ABSTRACT_ALT_BRACKET_) == std::string::npos) {
-
-      if (phase_vector[0] != REFERENCE_VARIANT_INDICATOR_ and phase_vector[0] != ALT_REFERENCE_VARIANT_INDICATOR_) {
-
-        phase_A_alt = std::stoul(std::string(phase_vector[0]));
-
-      }
+  } else {
 
-    } else {
+    // Symbolic alleles are counted and treated as the reference.
+    if (decoded.a_idx == DecodedGenotype::SYMBOLIC_ALLELE_) {
 
       ++abstract_variant_count_;
 
     }
-
-    if (phase_vector[1].find(ABSTRACT_ALT_BRACKET_) == std::string::npos) {
-
-      if (phase_vector[1] != REFERENCE_VARIANT_INDICATOR_ and phase_vector[0] != ALT_REFERENCE_VARIANT_INDICATOR_) {
-
-        phase_B_alt = std::stoul(std::string(phase_vector[1]));
-
-      }
-
-    } else {
+    if (decoded.b_idx == DecodedGenotype::SYMBOLIC_ALLELE_) {
 
       ++abstract_variant_count_;
 
     }
 
-  }
-  catch(...) {
-
-    ExecEnv::log().warn("Genome1000VCFImpl::alternateIndex, Problem converting phase indexes to unsigned longs, phase text: {}", genotype);
-    return {REFERENCE_VARIANT_INDEX_, REFERENCE_VARIANT_INDEX_};
+    phase_A_alt = DecodedGenotype::referenceIndex(decoded.a_idx);
+    phase_B_alt = DecodedGenotype::referenceIndex(decoded.b_idx);
 
   }
 
   if (phase_A_alt > alt_vector.size() or phase_B_alt > alt_vector.size()) {
 
     ExecEnv::log().warn("Genome1000VCFImpl::alternateIndex, phase A index: {}, phase B index: {}, exceed alternate vector size: {}, genotype: {}",
-                        phase_A_alt, phase_B_alt, phase_vector.size(), genotype);
+                        phase_A_alt, phase_B_alt, alt_vector.size(), genotype);
     return {REFERENCE_VARIANT_INDEX_, REFERENCE_VARIANT_INDEX_};
 
   }
@@ -277,8 +235,8 @@ void kgl::Genome1000VCFImpl::addVariants( const std::map<size_t, std::vector<Gen
                                           ContigOffset_t offset,
                                           bool passed_filters,
                                           const std::shared_ptr<const DataMemoryBlock>& info_evidence_ptr,
-                                          const std::string& reference,
-                                          const std::string& identifier,
+                                          std::string_view reference,
+                                          std::string_view identifier,
                                           const std::vector<std::string>& alt_vector,
                                           size_t vcf_record_count) {
 
@@ -297,8 +255,8 @@ void kgl::Genome1000VCFImpl::addVariants( const std::map<size_t, std::vector<Gen
     std::shared_ptr<const Variant> variant_ptr(std::make_shared<const Variant>( contig,
                                                                                 offset,
                                                                                 phase,
-                                                                                identifier,
-                                                                                DNA5SequenceLinear(StringDNA5(reference)),
+                                                                                std::string(identifier),
+                                                                                DNA5SequenceLinear(StringDNA5(std::string(reference))),
                                                                                 DNA5SequenceLinear(StringDNA5(alt_vector[alt_allele])),
                                                                                 evidence));
 
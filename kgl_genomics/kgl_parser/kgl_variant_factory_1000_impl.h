@@ -30,7 +30,7 @@ public:
                                                            genome_db_ptr_(genome_db_ptr) {}
   ~Genome1000VCFImpl() override = default;
 
-  void ProcessVCFRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr) override;
+  void ProcessVCFRecord(std::unique_ptr<const VCFRecordView> vcf_record_ptr) override;
 
   void processVCFHeader(const VCFHeaderInfo& header_info) override;
 
@@ -42,7 +42,7 @@ private:
   ContigAliasMap contig_alias_map_;
 
   // Processes the record in a try/catch block.
-  void ParseRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr);
+  void ParseRecord(std::unique_ptr<const VCFRecordView> vcf_record_ptr);
 
   // Progress counters.
   mutable size_t abstract_variant_count_{0};
@@ -53,14 +53,9 @@ private:
 
   constexpr static const size_t MINIMUM_GENOTYPE_SIZE_{3};
   constexpr static const size_t REFERENCE_VARIANT_INDEX_{0};
-  constexpr static const char* ALT_REFERENCE_VARIANT_INDICATOR_{"-"};
-  constexpr static const char* REFERENCE_VARIANT_INDICATOR_{"."};
-  constexpr static const char PHASE_MARKER_ {'|'};
   constexpr static const char MULTIPLE_ALT_SEPARATOR_{','};
-  constexpr static const char ABSTRACT_ALT_BRACKET_{'<'};
   constexpr static const char* PASSED_FILTERS_{"PASS"};
   constexpr static const char* NULL_IDENTIFIER_{"."};
-  constexpr static const char GT_SEPARATOR_{':'};
 
   const std::shared_ptr<PopulationDB> diploid_population_ptr_;   // Diploid phased variants.
   const std::shared_ptr<const GenomeReference> genome_db_ptr_; // read access only.
@@ -71,7 +66,7 @@ private:
   bool addThreadSafeVariant(const std::shared_ptr<const Variant>& variant_ptr, const std::vector<GenomeId_t>& genome_vector) const;
 // Calculates alternate indexes for the two phases (.first = A, .second = B).
   std::pair<size_t, size_t> alternateIndex(const std::string& contig,
-                                           const std::string& genotype,
+                                           std::string_view genotype,
                                            const std::vector<std::string>& alt_vector) const;
 // Adds variants to a vector of genomes.
   void addVariants( const std::map<size_t, std::vector<GenomeId_t>>& phase_map,
@@ -80,8 +75,8 @@ private:
                     ContigOffset_t offset,
                     bool passedFilters,
                     const std::shared_ptr<const DataMemoryBlock>& info_evidence_ptr,
-                    const std::string& reference,
-                    const std::string& identifier,
+                    std::string_view reference,
+                    std::string_view identifier,
                     const std::vector<std::string>& alt_vector,
                     size_t vcf_record_count);
 
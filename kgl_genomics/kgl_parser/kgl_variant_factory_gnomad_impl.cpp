@@ -3,6 +3,7 @@
 //
 
 #include "kgl_variant_factory_gnomad_impl.h"
+#include "kgl_variant_factory_vcf_parse_gt.h"
 
 
 
@@ -43,7 +44,7 @@ void kgl::GenomeGnomadVCFImpl::readParseVCFImpl(const std::string &vcf_file_name
 }
 
 // This is multi-threaded code called from the reader defined above.
-void kgl::GenomeGnomadVCFImpl::ProcessVCFRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr) {
+void kgl::GenomeGnomadVCFImpl::ProcessVCFRecord(std::unique_ptr<const VCFRecordView> vcf_record_ptr) {
 
   try {
 
@@ -60,23 +61,25 @@ void kgl::GenomeGnomadVCFImpl::ProcessVCFRecord(std::unique_ptr<const VCFRecord>
 
 
 // This is multithreaded code called from the reader defined above.
-void kgl::GenomeGnomadVCFImpl::ParseRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr) {
+void kgl::GenomeGnomadVCFImpl::ParseRecord(std::unique_ptr<const VCFRecordView> vcf_record_ptr) {
 
   // Parse the info fields into a map.
-  // For performance reasons the info field is std::moved - don't reference again.
-  auto mutable_info = const_cast<std::string&>(vcf_record_ptr->info);
-  std::shared_ptr<const DataMemoryBlock> info_evidence_ptr = evidence_factory_.createVariantEvidence(std::move(mutable_info));  // Each vcf record.
+  // The info field is a view of the record line and is not copied.
+  std::shared_ptr<const DataMemoryBlock> info_evidence_ptr = evidence_factory_.createVariantEvidence(vcf_record_ptr->info);  // Each vcf record.
 
   // Look at the filter field for "Pass"
-  bool passed_filter = Utility::toupper(vcf_record_ptr->filter) == PASSED_FILTERS_;
+  bool passed_filter = Utility::toupper(std::string(vcf_record_ptr->filter)) == PASSED_FILTERS_;
 
   // Convert VCF contig to genome contig_ref_ptr.
-  std::string contig = contig_alias_map_.lookupAlias(vcf_record_ptr->contig_id);
+  std::string contig = contig_alias_map_.lookupAlias(std::string(vcf_record_ptr->contig_id));
 
-  if (getGenomeNames().size() != vcf_record_ptr->genotypeInfos.size()) {
+  // The genotype columns are tokenised once as views of the record line.
+  const std::vector<std::string_view>& genotype_infos = vcf_record_ptr->genotypeInfos();
+
+  if (getGenomeNames().size() != genotype_infos.size()) {
 
     ExecEnv::log().warn("Genome Name Size: {}, Genotype count: {}",
-                        getGenomeNames().size(), vcf_record_ptr->genotypeInfos.size());
+                        getGenomeNames().size(), genotype_infos.size());
 
   }
 
@@ -91,10 +94,10 @@ void kgl::GenomeGnomadVCFImpl::ParseRecord(std::unique_ptr<const VCFRecord> vcf_
   // For all genotypes.
 
   std::map<size_t, std::vector<GenomeId_t>> phase_A_map, phase_B_map;
-  for (size_t genotype_count = 0; genotype_count < vcf_record_ptr->genotypeInfos.size(); ++genotype_count)
+  for (size_t genotype_count = 0; genotype_count < genotype_infos.size(); ++genotype_count)
   {
 
-    const std::string& genotype = vcf_record_ptr->genotypeInfos[genotype_count];
+    std::string_view genotype = genotype_infos[genotype_count];
     const std::string& genome = getGenomeNames()[genotype_count];
 
     auto const [A_index, B_index] = alternateIndex(genotype, alt_vector);
@@ -144,89 +147,26 @@ void kgl::GenomeGnomadVCFImpl::ParseRecord(std::unique_ptr<const VCFRecord> vcf_
 }
 
 
-std::pair<size_t, size_t> kgl::GenomeGnomadVCFImpl::alternateIndex(const std::string& genotype, const std::vector<std::string>& alt_vector) const {
+std::pair<size_t, size_t> kgl::GenomeGnomadVCFImpl::alternateIndex(std::string_view genotype, const std::vector<std::string>& alt_vector) const {
 
-  if (genotype.size() < MINIMUM_GENOTYPE_SIZE_) {
+  // The GT field is decoded up to the first ':' (if it exists).
+  DecodedGenotype decoded = VCFGenotypeDecoder::decode(genotype);
+  if (not decoded.valid() or decoded.a_idx == DecodedGenotype::SYMBOLIC_ALLELE_ or decoded.b_idx == DecodedGenotype::SYMBOLIC_ALLELE_) {
 
-    ExecEnv::log().warn("GenomeGnomadVCFImpl::alternateIndex; Genotype: {} Size: {} < {} characters", genotype, genotype.size(), MINIMUM_GENOTYPE_SIZE_);
+    ExecEnv::log().warn("GenomeGnomadVCFImpl::alternateIndex; Problem converting phase indexes to unsigned longs, genotype: {}", genotype);
     return {REFERENCE_VARIANT_INDEX_, REFERENCE_VARIANT_INDEX_};
 
   }
 
-  // Size of the GT Block.
-  size_t GT_size{0};
-  auto GT_index = genotype.find(GT_SEPARATOR_);
-  if (GT_index != std::string::npos) {
-
-    GT_size = GT_index;
-
-  } else {
-
-    GT_size = genotype.size();
-
-  }
-
-  // The first 3 characters or the first ":" if that exists.
-  std::string_view unphased_view(genotype.c_str(), GT_size);
-  // Look for the "/" phase separator.
-  std::vector<std::string_view> phase_vector = Utility::viewTokenizer(unphased_view, PHASE_MARKER_);
-
-  // Init to Ref allele (which is a no-op).
-  size_t phase_A_alt{REFERENCE_VARIANT_INDEX_};
-  size_t phase_B_alt{REFERENCE_VARIANT_INDEX_};
-
-  if (phase_vector.size() == 2) {
-  // Phase separator found.
-
-    try {
-
-      if (phase_vector[0] != REFERENCE_VARIANT_INDICATOR_) {
-
-        phase_A_alt = std::stoul(std::string(phase_vector[0]));
-
-      }
-
-      if (phase_vector[1] != REFERENCE_VARIANT_INDICATOR_) {
-
-        phase_B_alt = std::stoul(std::string(phase_vector[1]));
-
-      }
-
-    }
-    catch(...) {
-
-      ExecEnv::log().warn("GenomeGnomadVCFImpl::alternateIndex; Problem converting phase indexes to unsigned longs, phase A: {}, phase B: {} genotype: {}",
-                          std::string(phase_vector[0]), std::string(phase_vector[1]), genotype);
-      return {REFERENCE_VARIANT_INDEX_, REFERENCE_VARIANT_INDEX_};
-
-    }
-
-  } else {
-  // Phase separator not found, assume an X or Y chromosome with single Genotype indicator for males.
-
-    try {
-
-      if (unphased_view != REFERENCE_VARIANT_INDICATOR_) {
-
-        phase_A_alt = std::stoul(std::string(unphased_view));
-
-      }
-
-    }
-    catch(...) {
-
-      ExecEnv::log().warn("GenomeGnomadVCFImpl::alternateIndex; Problem converting phase index to unsigned long, phase A: {} (only), genotype: {}",
-                          std::string(unphased_view), genotype);
-      return {REFERENCE_VARIANT_INDEX_, REFERENCE_VARIANT_INDEX_};
-
-    }
-
-  }
+  // Missing ('.') alleles are the reference (a no-op).
+  // A haploid genotype is assumed to be an X or Y chromosome with a single genotype indicator for males.
+  size_t phase_A_alt = DecodedGenotype::referenceIndex(decoded.a_idx);
+  size_t phase_B_alt = decoded.diploid() ? DecodedGenotype::referenceIndex(decoded.b_idx) : REFERENCE_VARIANT_INDEX_;
 
   if (phase_A_alt > alt_vector.size() or phase_B_alt > alt_vector.size()) {
 
     ExecEnv::log().warn("GenomeGnomadVCFImpl::alternateIndex; phase A index: {}, phase B index: {}, exceed alternate vector size: {}, genotype: {}",
-                        phase_A_alt, phase_B_alt, phase_vector.size(), genotype);
+                        phase_A_alt, phase_B_alt, alt_vector.size(), genotype);
     return {REFERENCE_VARIANT_INDEX_, REFERENCE_VARIANT_INDEX_};
 
   }
@@ -241,8 +181,8 @@ void kgl::GenomeGnomadVCFImpl::addVariants( const std::map<size_t, std::vector<G
                                           ContigOffset_t offset,
                                           bool passed_filters,
                                           const std::shared_ptr<const DataMemoryBlock>& info_evidence_ptr,
-                                          const std::string& reference,
-                                          const std::string& identifier,
+                                          std::string_view reference,
+                                          std::string_view identifier,
                                           const std::vector<std::string>& alt_vector,
                                           size_t vcf_record_count) {
 
@@ -261,8 +201,8 @@ void kgl::GenomeGnomadVCFImpl::addVariants( const std::map<size_t, std::vector<G
     std::shared_ptr<const Variant> variant_ptr(std::make_shared<const Variant>( contig,
                                                                                 offset,
                                                                                 phase,
-                                                                                identifier,
-                                                                                DNA5SequenceLinear(StringDNA5(reference)),
+                                                                                std::string(identifier),
+                                                                                DNA5SequenceLinear(StringDNA5(std::string(reference))),
                                                                                 DNA5SequenceLinear(StringDNA5(alt_vector[alt_allele])),
                                                                                 evidence));
 
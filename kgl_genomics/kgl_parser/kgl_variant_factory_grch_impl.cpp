@@ -52,23 +52,22 @@ void kgl::GrchVCFImpl::readParseVCFImpl(const std::string &vcf_file_name) {
 }
 
 
-void kgl::GrchVCFImpl::ProcessVCFRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr) {
+void kgl::GrchVCFImpl::ProcessVCFRecord(std::unique_ptr<const VCFRecordView> vcf_record_ptr) {
 
   // Parse the info fields into a map..
-  // For performance reasons the info field is std::moved - don't reference again.
-  auto mutable_info = const_cast<std::string&>(vcf_record_ptr->info);
-  std::shared_ptr<const DataMemoryBlock> info_evidence_ptr = evidence_factory_.createVariantEvidence(std::move(mutable_info));
+  // The info field is a view of the record line and is not copied.
+  std::shared_ptr<const DataMemoryBlock> info_evidence_ptr = evidence_factory_.createVariantEvidence(vcf_record_ptr->info);
 
   // Look at the filter field for "Pass"
-  bool passed_filter = Utility::toupper(vcf_record_ptr->filter) == PASSED_FILTERS_;
+  bool passed_filter = Utility::toupper(std::string(vcf_record_ptr->filter)) == PASSED_FILTERS_;
 
   // Convert VCF contig to genome contig_ref_ptr.
-  std::string contig = contig_alias_map_.lookupAlias(vcf_record_ptr->contig_id);
+  std::string contig = contig_alias_map_.lookupAlias(std::string(vcf_record_ptr->contig_id));
 
   // Check for multiple alt sequences
   size_t position = vcf_record_ptr->alt.find_first_of(MULIPLE_ALT_SEPARATOR_);  // Check for ',' separators
   // The alt field can be blank (deletion).
-  if (position == std::string::npos or vcf_record_ptr->alt.empty()) {
+  if (position == std::string_view::npos or vcf_record_ptr->alt.empty()) {
 
     // We have no format data and only 1 variant specified.
     // These variables declared to make this obvious.
@@ -87,9 +86,9 @@ void kgl::GrchVCFImpl::ProcessVCFRecord(std::unique_ptr<const VCFRecord> vcf_rec
     std::shared_ptr<const Variant> variant_ptr(std::make_shared<const Variant>( contig,
                                                                                 vcf_record_ptr->offset,
                                                                                 VariantPhase::UNPHASED,
-                                                                                vcf_record_ptr->id,
-                                                                                DNA5SequenceLinear(StringDNA5(vcf_record_ptr->ref)),
-                                                                                DNA5SequenceLinear(StringDNA5(vcf_record_ptr->alt)),
+                                                                                std::string(vcf_record_ptr->id),
+                                                                                DNA5SequenceLinear(StringDNA5(std::string(vcf_record_ptr->ref))),
+                                                                                DNA5SequenceLinear(StringDNA5(std::string(vcf_record_ptr->alt))),
                                                                                 evidence));
 
     if (not addThreadSafeVariant(variant_ptr, genome_db_ptr_->genomeId())) {
@@ -130,8 +129,8 @@ void kgl::GrchVCFImpl::ProcessVCFRecord(std::unique_ptr<const VCFRecord> vcf_rec
       std::shared_ptr<const Variant> variant_ptr(std::make_shared<const Variant>( contig,
                                                                                   vcf_record_ptr->offset,
                                                                                   VariantPhase::UNPHASED,
-                                                                                  vcf_record_ptr->id,
-                                                                                  DNA5SequenceLinear(StringDNA5(vcf_record_ptr->ref)),
+                                                                                  std::string(vcf_record_ptr->id),
+                                                                                  DNA5SequenceLinear(StringDNA5(std::string(vcf_record_ptr->ref))),
                                                                                   DNA5SequenceLinear(StringDNA5(alternate)),
                                                                                   evidence));
 
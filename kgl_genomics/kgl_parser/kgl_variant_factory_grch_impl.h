@@ -35,7 +35,7 @@ public:
 
   ~GrchVCFImpl() override = default;
 
-  void ProcessVCFRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr) override;
+  void ProcessVCFRecord(std::unique_ptr<const VCFRecordView> vcf_record_ptr) override;
 
   void processVCFHeader(const VCFHeaderInfo &header_info) override;
 
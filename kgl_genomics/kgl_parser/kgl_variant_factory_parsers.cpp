@@ -27,7 +27,10 @@ namespace kgl = kellerberrin::genome;
 std::shared_ptr<kgl::DataDB> kgl::ParserSelection::parseData(const std::shared_ptr<const AnalysisResources>& resource_ptr,
                                                              const std::shared_ptr<const BaseFileInfo>& file_info_ptr,
                                                              const VariantEvidenceMap& evidence_map,
-                                                             const ContigAliasMap& contig_alias) {
+                                                             const ContigAliasMap& contig_alias,
+                                                             const PipelineConfig& pipeline_config,
+                                                             const BGZRegionVector& regions,
+                                                             const std::string& snapshot_directory) {
 
   auto file_characteristic = DataDB::findCharacteristic(file_info_ptr->fileType());
 
@@ -45,19 +48,19 @@ std::shared_ptr<kgl::DataDB> kgl::ParserSelection::parseData(const std::shared_p
   switch(parser_type) {
 
     case ParserTypeEnum::DiploidFalciparum:
-      return readVCF<PfVCFImpl>(resource_ptr, file_info_ptr, evidence_map, contig_alias, data_source);
+      return readVCF<PfVCFImpl>(resource_ptr, file_info_ptr, evidence_map, contig_alias, pipeline_config, regions, snapshot_directory, parser_type, data_source);
 
     case ParserTypeEnum::MonoGenomeUnphased:
-      return readVCF<GrchVCFImpl>(resource_ptr, file_info_ptr, evidence_map, contig_alias, data_source);
+      return readVCF<GrchVCFImpl>(resource_ptr, file_info_ptr, evidence_map, contig_alias, pipeline_config, regions, snapshot_directory, parser_type, data_source);
 
     case ParserTypeEnum::MonoDBSNPUnphased:
-      return readVCF<SNPdbVCFImpl>(resource_ptr, file_info_ptr, evidence_map, contig_alias, data_source);
+      return readVCF<SNPdbVCFImpl>(resource_ptr, file_info_ptr, evidence_map, contig_alias, pipeline_config, regions, snapshot_directory, parser_type, data_source);
 
     case ParserTypeEnum::DiploidPhased:
-      return readVCF<Genome1000VCFImpl>(resource_ptr, file_info_ptr, evidence_map, contig_alias, data_source);
+      return readVCF<Genome1000VCFImpl>(resource_ptr, file_info_ptr, evidence_map, contig_alias, pipeline_config, regions, snapshot_directory, parser_type, data_source);
 
     case ParserTypeEnum::DiploidGnomad:
-      return readVCF<GenomeGnomadVCFImpl>(resource_ptr, file_info_ptr, evidence_map, contig_alias, data_source);
+      return readVCF<GenomeGnomadVCFImpl>(resource_ptr, file_info_ptr, evidence_map, contig_alias, pipeline_config, regions, snapshot_directory, parser_type, data_source);
 
     case ParserTypeEnum::MonoJSONdbSNPUnphased:
       return readJSONdbSNP(file_info_ptr, data_source);
@@ -70,7 +73,7 @@ std::shared_ptr<kgl::DataDB> kgl::ParserSelection::parseData(const std::shared_p
 
     default:
       ExecEnv::log().critical("ParserSelection::parseData; Unknown data file: {} specified - unrecoverable", file_info_ptr->fileName());
-      return readVCF<GenomeGnomadVCFImpl>(resource_ptr, file_info_ptr, evidence_map, contig_alias, data_source); // never reached.
+      return readVCF<GenomeGnomadVCFImpl>(resource_ptr, file_info_ptr, evidence_map, contig_alias, pipeline_config, regions, snapshot_directory, parser_type, data_source); // never reached.
 
   }
 
@@ -110,3 +113,68 @@ std::shared_ptr<kgl::DataDB> kgl::ParserSelection::parseData(const std::shared_p
 
 }
 
+
+std::vector<std::string> kgl::ParserSelection::selectSamples(const std::shared_ptr<const AnalysisResources>& resource_ptr,
+                                                             const RuntimeVCFFileInfo& vcf_file_info) {
+
+  const VCFSampleSelection& sample_selection = vcf_file_info.sampleSelection();
+  if (sample_selection.empty()) {
+
+    return {};  // Parse all samples.
+
+  }
+
+  std::set<std::string> selected_samples(sample_selection.samples);
+  if (not sample_selection.populations.empty() or not sample_selection.super_populations.empty()) {
+
+    // Both the genome aux and the genome genealogy (HsGenomeGenealogyData) resources provide sample populations.
+    auto genome_aux_vector = resource_ptr->getResources(ResourceProperties::GENOMEAUX_RESOURCE_ID_);
+    auto genealogy_vector = resource_ptr->getResources(ResourceProperties::GENEALOGY_RESOURCE_ID_);
+    genome_aux_vector.insert(genome_aux_vector.end(), genealogy_vector.begin(), genealogy_vector.end());
+    if (genome_aux_vector.empty()) {
+
+      ExecEnv::log().error("ParserSelection::selectSamples; VCF file ident: {}, sample populations specified but no genome genealogy resource is available",
+                           vcf_file_info.identifier());
+
+    }
+
+    for (auto const& resource : genome_aux_vector) {
+
+      auto genome_aux_ptr = std::dynamic_pointer_cast<const HsGenomeAux>(resource);
+      if (not genome_aux_ptr) {
+
+        ExecEnv::log().critical("ParserSelection::selectSamples; Serious Internal Error, Invalid Genome Aux or Genealogy resource.");
+
+      }
+
+      for (auto const& genome : genome_aux_ptr->getGenomeList()) {
+
+        auto genome_record_opt = genome_aux_ptr->getGenome(genome);
+        if (genome_record_opt
+            and (sample_selection.populations.contains(genome_record_opt->population())
+                 or sample_selection.super_populations.contains(genome_record_opt->superPopulation()))) {
+
+          selected_samples.insert(genome);
+
+        }
+
+      }
+
+    }
+
+  }
+
+  if (selected_samples.empty()) {
+
+    // An empty sample list parses all samples, which is not the requested selection.
+    ExecEnv::log().critical("ParserSelection::selectSamples; VCF file ident: {}, no samples match the sample selection - unrecoverable",
+                            vcf_file_info.identifier());
+
+  }
+
+  ExecEnv::log().info("ParserSelection::selectSamples; VCF file ident: {}, samples selected: {}", vcf_file_info.identifier(), selected_samples.size());
+
+  return {selected_samples.begin(), selected_samples.end()};
+
+}
+
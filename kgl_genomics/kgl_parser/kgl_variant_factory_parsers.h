@@ -7,6 +7,7 @@
 
 #include "kgl_runtime.h"
 #include "kgl_runtime_resource.h"
+#include "kgl_variant_db_snapshot.h"
 
 
 
@@ -31,7 +32,10 @@ public:
   [[nodiscard]] static std::shared_ptr<DataDB> parseData(const std::shared_ptr<const AnalysisResources>& resource_ptr,
                                                          const std::shared_ptr<const BaseFileInfo>& file_info,
                                                          const VariantEvidenceMap& evidence_map,
-                                                         const ContigAliasMap& contig_alias);
+                                                         const ContigAliasMap& contig_alias,
+                                                         const PipelineConfig& pipeline_config = PipelineConfig(),
+                                                         const BGZRegionVector& regions = BGZRegionVector(),
+                                                         const std::string& snapshot_directory = std::string());
 
 private:
 
@@ -42,12 +46,23 @@ private:
   [[nodiscard]] static std::shared_ptr<DataDB> readBioPMID( const std::shared_ptr<const BaseFileInfo>& file_info,
                                                             DataSourceEnum data_source);
 
-  // Read and parse a package specified VCF file.
+  // Resolve the optional VCF sample subset to sample names, population codes are resolved using the genome aux and genealogy resources.
+  // A sample selection that matches no samples is an unrecoverable error.
+  [[nodiscard]] static std::vector<std::string> selectSamples(const std::shared_ptr<const AnalysisResources>& resource_ptr,
+                                                              const RuntimeVCFFileInfo& vcf_file_info);
+
+  // Read and parse a package specified VCF file, only records overlapping the regions are read if regions are specified.
+  // If a snapshot directory is specified, the population is read from a matching snapshot if one exists,
+  // otherwise the VCF is parsed and a snapshot of the parsed population is written.
   template<class VCFParser>
   [[nodiscard]] static std::shared_ptr<DataDB> readVCF(const std::shared_ptr<const AnalysisResources>& resource_ptr,
                                                        const std::shared_ptr<const BaseFileInfo>& file_info,
                                                        const VariantEvidenceMap& evidence_map,
                                                        const ContigAliasMap& contig_alias,
+                                                       const PipelineConfig& pipeline_config,
+                                                       const BGZRegionVector& regions,
+                                                       const std::string& snapshot_directory,
+                                                       ParserTypeEnum parser_type,
                                                        DataSourceEnum data_source) {
 
     // Get the physical file name, VCF file type etc.
@@ -96,14 +111,59 @@ private:
 
     }
 
-    // The variant population and VCF data source.
-    std::shared_ptr<PopulationDB> vcf_population_ptr(std::make_shared<PopulationDB>(vcf_file_info->identifier(), data_source));
+    std::vector<std::string> selected_samples = selectSamples(resource_ptr, *vcf_file_info);
+
+    // The snapshot is keyed by the VCF file, the parser and the INFO, sample and region projections.
+    std::optional<PopulationSnapshotKey> snapshot_key;
+    std::string snapshot_file;
+    if (not snapshot_directory.empty()) {
+
+      snapshot_key = PopulationSnapshot::createKey( vcf_file_info->fileName(),
+                                                    parser_type,
+                                                    data_source,
+                                                    vcf_file_info->identifier(),
+                                                    vcf_file_info->referenceGenome(),
+                                                    evidence_opt.value(),
+                                                    selected_samples,
+                                                    regions);
+      snapshot_file = PopulationSnapshot::snapshotFileName(snapshot_directory, vcf_file_info->fileName());
+
+    }
+
+    std::shared_ptr<PopulationDB> vcf_population_ptr;
+    if (snapshot_key) {
+
+      auto snapshot_opt = PopulationSnapshot::readSnapshot(snapshot_file, snapshot_key.value());
+      if (snapshot_opt) {
+
+        vcf_population_ptr = snapshot_opt.value();
+
+      }
+
+    }
+
+    if (not vcf_population_ptr) {
+
+      // The variant population and VCF data source.
+      vcf_population_ptr = std::make_shared<PopulationDB>(vcf_file_info->identifier(), data_source);
+
+      // Read the VCF with the appropriate parser in a unique block so that that the parser is deleted before validation begins.
+      // This prevents the parser queues stall warning from activating if the population verification is lengthy.
+      {
+        VCFParser reader(vcf_population_ptr, ref_genome, contig_alias, evidence_opt.value());
+        reader.configurePipeline(pipeline_config);
+        reader.selectSamples(selected_samples);
+        reader.selectRegions(regions);
+        reader.readParseVCFImpl(vcf_file_info->fileName());
+      }
+
+      // A snapshot that cannot be written is not an error, the VCF is parsed again on the next run.
+      if (snapshot_key and not PopulationSnapshot::writeSnapshot(snapshot_file, snapshot_key.value(), *vcf_population_ptr)) {
+
+        ExecEnv::log().warn("ParserSelection::readVCF; unable to write population snapshot: {}", snapshot_file);
+
+      }
 
-    // Read the VCF with the appropriate parser in a unique block so that that the parser is deleted before validation begins.
-    // This prevents the parser queues stall warning from activating if the population verification is lengthy.
-    {
-      VCFParser reader(vcf_population_ptr, ref_genome, contig_alias, evidence_opt.value());
-      reader.readParseVCFImpl(vcf_file_info->fileName());
     }
 
     // Validate the parsed VCF population against the specified reference genome.
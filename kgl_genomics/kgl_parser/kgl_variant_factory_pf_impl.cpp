@@ -7,6 +7,9 @@
 #include "kgl_variant_factory_readvcf_impl.h"
 #include "kgl_variant_factory_pf_impl.h"
 #include "kgl_variant_db.h"
+#include "kgl_variant_factory_vcf_parse_gt.h"
+
+#include <charconv>
 
 
 namespace kgl = kellerberrin::genome;
@@ -53,7 +56,7 @@ void kgl::PfVCFImpl::readParseVCFImpl(const std::string &vcf_file_name) {
 }
 
 // This is multithreaded code called from the reader defined above.
-void kgl::PfVCFImpl::ProcessVCFRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr) {
+void kgl::PfVCFImpl::ProcessVCFRecord(std::unique_ptr<const VCFRecordView> vcf_record_ptr) {
 
   try {
 
@@ -70,10 +73,10 @@ void kgl::PfVCFImpl::ProcessVCFRecord(std::unique_ptr<const VCFRecord> vcf_recor
 
 
 // This is multithreaded code called from the reader defined above.
-void kgl::PfVCFImpl::ParseRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr) {
+void kgl::PfVCFImpl::ParseRecord(std::unique_ptr<const VCFRecordView> vcf_record_ptr) {
 
   // Convert VCF contig to genome contig_ref_ptr.
-  std::string genome_contig = contig_alias_map_.lookupAlias(vcf_record_ptr->contig_id);
+  std::string genome_contig = contig_alias_map_.lookupAlias(std::string(vcf_record_ptr->contig_id));
 
   ParseVCFRecord recordParser(genome_contig, *vcf_record_ptr, genome_db_ptr_); //Each vcf record.
   if (not recordParser.parseResult()) {
@@ -85,14 +88,17 @@ void kgl::PfVCFImpl::ParseRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr
 
 
   // Parse the info fields into a map.
-  // For performance reasons the info field is std::moved - don't reference again.
-  auto mutable_info = const_cast<std::string&>(vcf_record_ptr->info);
-  std::shared_ptr<const DataMemoryBlock> info_evidence_ptr = evidence_factory_.createVariantEvidence(std::move(mutable_info));  // Each vcf record.
+  // The info field is a view of the record line and is not copied.
+  std::shared_ptr<const DataMemoryBlock> info_evidence_ptr = evidence_factory_.createVariantEvidence(vcf_record_ptr->info);  // Each vcf record.
+
+  // The genotype columns are tokenised once as views of the record line.
+  const std::vector<std::string_view>& genotype_infos = vcf_record_ptr->genotypeInfos();
+  const std::string variant_identifier(vcf_record_ptr->id);
 
-  if (getGenomeNames().size() != vcf_record_ptr->genotypeInfos.size()) {
+  if (getGenomeNames().size() != genotype_infos.size()) {
 
     ExecEnv::log().warn("PfVCFImpl::ParseRecord; Genome Name Size: {}, Genotype count: {}",
-                        getGenomeNames().size(), vcf_record_ptr->genotypeInfos.size());
+                        getGenomeNames().size(), genotype_infos.size());
 
   }
 
@@ -108,14 +114,17 @@ void kgl::PfVCFImpl::ParseRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr
     return;
   }
 
+  // The format field and allele depth views are reused for each genome.
+  std::vector<std::string_view> genotype_formats;
+  std::vector<std::string_view> ad_vector;
   // For each genome.
-  for (size_t genotype_count = 0;  genotype_count < vcf_record_ptr->genotypeInfos.size(); ++genotype_count)
+  for (size_t genotype_count = 0;  genotype_count < genotype_infos.size(); ++genotype_count)
   {
 
-    const std::string& genotype = vcf_record_ptr->genotypeInfos[genotype_count];
+    std::string_view genotype = genotype_infos[genotype_count];
     const std::string& genome_name = getGenomeNames()[genotype_count];
 
-    std::vector<std::string_view> genotype_formats = Utility::viewTokenizer(genotype, FORMAT_SEPARATOR_);
+    Utility::viewTokenizer(genotype, FORMAT_SEPARATOR_, genotype_formats);
 
     // Require GT format field.
     if (genotype_formats.size() <= GT_offset_opt.value()) {
@@ -126,47 +135,30 @@ void kgl::PfVCFImpl::ParseRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr
 
     }
 
-    std::string GT_format(genotype_formats[GT_offset_opt.value()]);
-    // Assume '/' is the GT field separator.
-    std::vector<std::string> gt_vector = Utility::charTokenizer(GT_format, GT_FIELD_SEPARATOR_CHAR_);
-    if (gt_vector.size() != DIPLOID_) {
-
-      // Assume '|' is the GT field separator.
-      gt_vector = Utility::charTokenizer(GT_format, GT_ALT_FIELD_SEPARATOR_CHAR_);
-
-       if (gt_vector.size() != DIPLOID_) {
-
-         if (GT_format == MISSING_VALUE_) {
+    std::string_view GT_format = genotype_formats[GT_offset_opt.value()];
+    // Only a diploid GT field ('/' or '|' separated) is accepted.
+    DecodedGenotype decoded_GT = VCFGenotypeDecoder::decode(GT_format);
+    if (not decoded_GT.diploid()) {
 
-           ExecEnv::log().warn("PfVCFImpl::ParseRecord; VCF Record: {}, Genome: {}, GT format field: {} is missing for Genotype: {}.",
-                               vcf_record_ptr->line_number, genome_name, GT_format, genotype);
+      if (GT_format == MISSING_VALUE_) {
 
-         } else {
+        ExecEnv::log().warn("PfVCFImpl::ParseRecord; VCF Record: {}, Genome: {}, GT format field: {} is missing for Genotype: {}.",
+                            vcf_record_ptr->line_number, genome_name, GT_format, genotype);
 
-           ExecEnv::log().error("PfVCFImpl::ParseRecord; VCF record: {}, Genome: {}, GT format field: {} is not diploid for Genotype: {}.",
-                                vcf_record_ptr->line_number, genome_name, GT_format, genotype);
+      } else {
 
-         }
-
-        continue;
+        ExecEnv::log().error("PfVCFImpl::ParseRecord; VCF record: {}, Genome: {}, GT format field: {} is not diploid for Genotype: {}.",
+                             vcf_record_ptr->line_number, genome_name, GT_format, genotype);
 
       }
 
-    }
-
-    size_t A_allele{0};
-    if (gt_vector[0].find_first_not_of(DIGITS_) ==  std::string::npos) {
-
-      A_allele = std::stoll(gt_vector[0]);
+      continue;
 
     }
 
-    size_t B_allele{0};
-    if (gt_vector[0].find_first_not_of(DIGITS_) ==  std::string::npos) {
-
-      B_allele = std::stoll(gt_vector[1]);
-
-    }
+    // Missing and symbolic alleles are the reference.
+    size_t A_allele = DecodedGenotype::referenceIndex(decoded_GT.a_idx);
+    size_t B_allele = DecodedGenotype::referenceIndex(decoded_GT.b_idx);
 
     // If there are no alt alleles then skip.
     if (A_allele == 0 and B_allele == 0) {
@@ -248,8 +240,7 @@ void kgl::PfVCFImpl::ParseRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr
     if (AD_offset_opt) {
 
       // Get ad allele depths.
-      std::string AD_text(genotype_formats[AD_offset_opt.value()]);
-      std::vector<std::string> ad_vector = Utility::charTokenizer(AD_text, AD_FIELD_SEPARATOR_CHAR_);
+      Utility::viewTokenizer(genotype_formats[AD_offset_opt.value()], AD_FIELD_SEPARATOR_CHAR_, ad_vector);
 
       // Allele depths should be the number of alleles + the reference
       if (ad_vector.size() != (recordParser.alleles().size() + 1)) {
@@ -263,19 +254,28 @@ void kgl::PfVCFImpl::ParseRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr
       size_t ad_total_count = 0;
       for (auto const& depth_count_text : ad_vector) {
 
-        if (depth_count_text.find_first_not_of(DIGITS_) !=  std::string::npos) {
+        // Converted directly from the record view.
+        size_t ad_count{0};
+        auto const [end_ptr, error_code] = std::from_chars(depth_count_text.data(), depth_count_text.data() + depth_count_text.size(), ad_count);
+        if (error_code != std::errc() or end_ptr != depth_count_text.data() + depth_count_text.size()) {
 
           ExecEnv::log().error("PfVCFImpl::ParseRecord; Expected numeric value AD allele depths, actually:{}", depth_count_text);
-          continue;
+          break;
 
         }
 
-        size_t ad_count = std::stoll(depth_count_text);
         ad_total_count += ad_count;
         ad_count_vector.push_back(ad_count);
 
       }
 
+      // The genome is skipped if any allele depth is invalid.
+      if (ad_count_vector.size() != ad_vector.size()) {
+
+        continue;
+
+      }
+
     } else {
 
       ExecEnv::log().error("PfVCFImpl::ParseRecord; AD format field not found");
@@ -318,7 +318,7 @@ void kgl::PfVCFImpl::ParseRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr
         if (not createAddVariant(genome_name,
                                  recordParser.contigPtr(),
                                  recordParser.offset(),
-                                 vcf_record_ptr->id,
+                                 variant_identifier,
                                  recordParser.reference(),
                                  allele,
                                  evidence)) {
@@ -366,7 +366,7 @@ void kgl::PfVCFImpl::ParseRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr
         if (not createAddVariant(genome_name,
                                  recordParser.contigPtr(),
                                  recordParser.offset(),
-                                 vcf_record_ptr->id,
+                                 variant_identifier,
                                  recordParser.reference(),
                                  allele,
                                  evidence)) {
@@ -31,7 +31,7 @@ public:
                                                    genome_db_ptr_(genome_db_ptr) {}
   ~PfVCFImpl() override = default;
 
-  void ProcessVCFRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr) override;
+  void ProcessVCFRecord(std::unique_ptr<const VCFRecordView> vcf_record_ptr) override;
 
   void processVCFHeader(const VCFHeaderInfo& header_info) override;
 
@@ -43,17 +43,14 @@ private:
   ContigAliasMap contig_alias_map_;
 
   // Processes the record in a try/catch block.
-  void ParseRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr);
+  void ParseRecord(std::unique_ptr<const VCFRecordView> vcf_record_ptr);
 
-  constexpr static const char GT_FIELD_SEPARATOR_CHAR_{'/'};
-  constexpr static const char GT_ALT_FIELD_SEPARATOR_CHAR_{'|'};
   constexpr static const char AD_FIELD_SEPARATOR_CHAR_{','};
   constexpr static const char* DIGITS_{"0123456789"};
   constexpr static const char* FLOAT_DIGITS_{"eE.+-0123456789"};
   constexpr static const char* UPSTREAM_ALLELE_{"*"};
   constexpr static const char FORMAT_SEPARATOR_ = ':';
   constexpr static const char* MISSING_VALUE_{"."};
-  constexpr static const size_t DIPLOID_{2};
 
 
   // Progress counters.
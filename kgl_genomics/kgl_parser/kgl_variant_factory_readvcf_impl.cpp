@@ -8,46 +8,87 @@
 namespace kgl = kellerberrin::genome;
 
 
-void kgl::VCFReaderMT::readHeader(const std::string& file_name) {
+void kgl::VCFReaderMT::readVCFFile(const std::string& vcf_file_name) {
 
-  if (not parseheader_.parseHeader(file_name)) {
+  parseVCFFile(vcf_file_name, region_selection_);
 
-    ExecEnv::log().error("RecordVCFIO::VCFReadHeader, Problem parsing VCF header file: {}", file_name);
+}
 
-  }
 
-  processVCFHeader(parseheader_.getHeaderInfo());
+void kgl::VCFReaderMT::configurePipeline(const PipelineConfig& pipeline_config) {
 
-}
+  for (auto const& [stage_name, stage_config] : pipeline_config.stageMap()) {
 
+    if (stage_name != ParseVCF::DECOMPRESS_STAGE and stage_name != ParseVCF::PARSE_STAGE and stage_name != INGEST_STAGE) {
 
-void kgl::VCFReaderMT::readVCFFile(const std::string& vcf_file_name) {
+      ExecEnv::log().warn("VCFReaderMT::configurePipeline; unknown pipeline stage: {} ignored", stage_name);
+
+    }
 
+  }
 
-  ExecEnv::log().info("Parse Header VCF file: {}", vcf_file_name);
+  pipeline_config_ = pipeline_config;
 
-  readHeader(vcf_file_name);
+}
 
-  ExecEnv::log().info("Begin processing VCF file: {}", vcf_file_name);
 
-  ExecEnv::log().info("Spawning: {} Consumer threads to process the VCF file", parser_threads_.threadCount());
+void kgl::VCFReaderMT::parseVCFFile(const std::string& vcf_file_name, const BGZRegionVector& regions) {
 
-  // Queue the worker thread tasks.
-  std::vector<std::future<void>> thread_futures;
-  for (size_t index = 0; index < parser_threads_.threadCount(); ++index) {
 
-    thread_futures.push_back(parser_threads_.enqueueFuture(&VCFReaderMT::VCFConsumer, this));
+  ExecEnv::log().info("Begin processing VCF file: {}", vcf_file_name);
 
+  auto ingest_stage = pipeline_config_.stageConfig(INGEST_STAGE, { .threads = consumer_threads_
+                                                                 , .batch_size = RECORD_BATCH_SIZE_ });
+  record_batch_size_ = ingest_stage.batch_size;
+  // A new parser is created for each file so that the configured pipeline queue depths are used.
+  vcf_parser_ptr_ = std::make_unique<ParseVCF>(pipeline_config_, ingest_stage.threads);
+  vcf_parser_ptr_->selectSamples(sample_selection_);
+  size_t stage_thread_limit = vcf_parser_ptr_->stageThreadLimit();
+  size_t consumer_count = std::max(ingest_stage.threads, stage_thread_limit);
+  {
+    std::lock_guard<std::mutex> lock(active_mutex_);
+    consumers_released_ = false;
+    active_consumers_.store(std::numeric_limits<size_t>::max(), std::memory_order_release);
   }
 
-  // start reading records asynchronously.
-  if (not vcf_parser_.open(vcf_file_name)) {
+  // The header is parsed from the first lines of the stream and records are then read asynchronously.
+  // The file is opened and decompressed once.
+  bool parser_open = regions.empty() ? vcf_parser_ptr_->open(vcf_file_name) : vcf_parser_ptr_->open(vcf_file_name, regions);
+  if (not parser_open) {
 
     ExecEnv::log().error("VCFReaderMT::readVCFFile; Problem opening VCF file: {}", vcf_file_name);
     return;
 
   }
 
+  // The header is processed before any records are consumed.
+  processVCFHeader(getHeader().getHeaderInfo());
+
+  // If the stages are balanced, then the balancer sets the active threads of each stage.
+  PipelineBalancer balancer;
+  if (stage_thread_limit > 0) {
+
+    vcf_parser_ptr_->addBalancedStages(balancer);
+    balancer.addStage( INGEST_STAGE
+                     , [this]() { return vcf_parser_ptr_->recordOccupancy(); }
+                     , [this](size_t threads) { setActiveConsumers(threads); }
+                     , ingest_stage.threads
+                     , stage_thread_limit);
+    balancer.start(pipeline_config_.balanceInterval());
+
+  }
+
+  ExecEnv::log().info("Spawning: {} Consumer threads to process the VCF file", consumer_count);
+
+  // Queue the worker thread tasks.
+  WorkflowThreads consumer_threads(consumer_count);
+  std::vector<std::future<void>> thread_futures;
+  for (size_t index = 0; index < consumer_threads.threadCount(); ++index) {
+
+    thread_futures.push_back(consumer_threads.enqueueFuture(&VCFReaderMT::VCFConsumer, this, index));
+
+  }
+
   // Wait until processing is complete.
   for (auto const& future : thread_futures) {
 
@@ -55,35 +96,92 @@ void kgl::VCFReaderMT::readVCFFile(const std::string& vcf_file_name) {
 
   }
 
+  balancer.stop();
+
+}
+
+
+void kgl::VCFReaderMT::setActiveConsumers(size_t active_consumers) {
+
+  std::lock_guard<std::mutex> lock(active_mutex_);
+  if (consumers_released_) {
+
+    return;
+
+  }
+  active_consumers_.store(std::max<size_t>(active_consumers, 1), std::memory_order_release);
+  active_consumers_.notify_all();
+
+}
+
+
+void kgl::VCFReaderMT::releaseConsumers() {
+
+  std::lock_guard<std::mutex> lock(active_mutex_);
+  consumers_released_ = true;
+  active_consumers_.store(std::numeric_limits<size_t>::max(), std::memory_order_release);
+  active_consumers_.notify_all();
+
 }
 
 
-void kgl::VCFReaderMT::VCFConsumer() {
+void kgl::VCFReaderMT::VCFConsumer(size_t consumer_index) {
 
+  // Records are dequeued in batches to reduce contention on the record queue.
+  VCFRecordBlock record_batch;
+  record_batch.reserve(record_batch_size_);
   // Loop until EOF.
   size_t final_count = 0;
-  while (true) {
+  bool terminate{false};
+  while (not terminate) {
 
-    // Dequeue the vcf record.
-    std::unique_ptr<const VCFRecord> vcf_record_ptr = vcf_parser_.readVCFRecord();
-    // Terminate on EOF
-    if (vcf_record_ptr->EOFRecord()) {
+    // Consumers above the active limit are parked until the limit is raised or EOF.
+    size_t active_consumers = active_consumers_.load(std::memory_order_acquire);
+    while (consumer_index >= active_consumers) {
 
-      vcf_parser_.enqueueEOF();
-      break;  // Eof encountered, terminate processing.
+      active_consumers_.wait(active_consumers, std::memory_order_acquire);
+      active_consumers = active_consumers_.load(std::memory_order_acquire);
 
     }
 
-    if (vcf_record_ptr->contig_id.empty()) {
+    // Dequeue a batch of vcf records.
+    record_batch.clear();
+    auto wait_start = std::chrono::steady_clock::now();
+    vcf_parser_ptr_->readVCFRecords(record_batch, record_batch_size_);
+    record_wait_.addTime(std::chrono::steady_clock::now() - wait_start);
+    size_t batch_start_count = final_count;
+    // The record latency is timed per batch, the mean is recorded for each record processed.
+    auto batch_start = std::chrono::steady_clock::now();
+    for (auto& vcf_record_ptr : record_batch) {
+
+      // Terminate on EOF
+      if (vcf_record_ptr->EOFRecord()) {
+
+        // The EOF record is re-queued for the other consumers, including any parked consumers.
+        releaseConsumers();
+        vcf_parser_ptr_->enqueueEOF();
+        terminate = true;
+        break;  // Eof encountered, terminate processing.
 
-      ExecEnv::log().error("Empty VCF_record encountered; consumer thread terminates.");
-      break;
+      }
+
+      // The remaining records of the batch are processed before the consumer terminates.
+      if (vcf_record_ptr->contig_id.empty()) {
+
+        ExecEnv::log().error("Empty VCF_record encountered; consumer thread terminates after the current record batch.");
+        terminate = true;
+        continue;
+
+      }
+
+      // Call the consumer object with the dequeued record.
+      ProcessVCFRecord(std::move(vcf_record_ptr));
+      ++final_count;
 
     }
 
-    // Call the consumer object with the dequeued record.
-    ProcessVCFRecord(std::move(vcf_record_ptr));
-    ++final_count;
+    record_latency_.observeBatch(std::chrono::steady_clock::now() - batch_start, final_count - batch_start_count);
+    records_processed_.add(final_count - batch_start_count);
 
   }
 
@@ -91,5 +189,3 @@ void kgl::VCFReaderMT::VCFConsumer() {
 
 
 }
-
-
@@ -10,10 +10,16 @@
 #include <thread>
 #include <fstream>
 #include <functional>
+#include <atomic>
+#include <limits>
+#include <mutex>
 
 #include "kel_exec_env.h"
 #include "kel_queue_mt_safe.h"
 #include "kel_workflow_threads.h"
+#include "kel_metrics.h"
+#include "kel_pipeline_config.h"
+#include "kel_pipeline_balancer.h"
 
 #include "kgl_variant_vcf_impl.h"
 
@@ -22,42 +28,82 @@ namespace kellerberrin::genome {   //  organization::project level namespace
 
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Dequeues VCF Records and passes them to the final parser logic which generates variant objects.
+// The reader registers a MetricSet (type "vcf_reader") with the MetricsRegistry, the records processed,
+// the time consumers waited for parsed records and the record processing latency are exported.
+// The "decompress", "parse" and "ingest" (record consumer) stages are set by an optional PipelineConfig. If the
+// configuration is auto balanced then the active threads of the stages are rebalanced during parsing.
+// If a sample allow-list is set then only the genotypes of the listed samples are parsed and getGenomeNames()
+// returns the selected samples, in header order, matching VCFRecordView::genotypeInfos().
 
 class VCFReaderMT {
 
 public:
 
-  explicit VCFReaderMT(size_t thread_count = DEFAULT_PARSER_THREADS) : parser_threads_(thread_count) {}
+  explicit VCFReaderMT(size_t thread_count = DEFAULT_PARSER_THREADS) : consumer_threads_(thread_count) {}
   virtual ~VCFReaderMT() = default;
 
+  // Set the pipeline stage threads, queue depths and batch sizes used by subsequent file reads.
+  void configurePipeline(const PipelineConfig& pipeline_config);
+
+  // Only parse the genotypes of the listed samples (genomes) for subsequent file reads, all samples if empty.
+  void selectSamples(const std::vector<std::string>& sample_list) { sample_selection_ = sample_list; }
+  // Only parse records overlapping the regions for subsequent file reads, all records if empty.
+  // Regions require a '.bgz' VCF file with a '.tbi' or '.csi' index.
+  void selectRegions(const BGZRegionVector& regions) { region_selection_ = regions; }
+
   // Perform multi-threaded parsing of queued VCF records.
   void readVCFFile(const std::string& vcf_file_name);
 
   // Process each VCF record.
-  virtual void ProcessVCFRecord(std::unique_ptr<const VCFRecord> vcf_record_ptr) = 0;
+  virtual void ProcessVCFRecord(std::unique_ptr<const VCFRecordView> vcf_record_ptr) = 0;
 
   // Process VCF header information.
   virtual void processVCFHeader(const VCFHeaderInfo& header_info) = 0;
 
   // Stored VCF header info.
-  [[nodiscard]] const std::vector<std::string>& getGenomeNames() const { return parseheader_.getGenomes(); }
+  [[nodiscard]] const std::vector<std::string>& getGenomeNames() const { return vcf_parser_ptr_->sampleNames(); }
+  [[nodiscard]] const VCFParseHeader& getHeader() const { return vcf_parser_ptr_->vcfHeader(); }
+  // Access the record parser for diagnostics.
+  [[nodiscard]] const ParseVCF& vcfParser() const { return *vcf_parser_ptr_; }
 
   constexpr static const size_t DEFAULT_PARSER_THREADS{50};
+  // The pipeline stage name of the record consumer threads.
+  constexpr static const char* INGEST_STAGE{"ingest"};
 
 private:
 
-  // VCF record queue.
-  ParseVCF vcf_parser_;
+  // VCF record queue, created for each file read using the pipeline configuration.
+  std::unique_ptr<ParseVCF> vcf_parser_ptr_{std::make_unique<ParseVCF>()};
+  PipelineConfig pipeline_config_;
+  std::vector<std::string> sample_selection_;
+  BGZRegionVector region_selection_;
 
   // Threads to process the VCF record queue.
-  WorkflowThreads parser_threads_;
-
-  // Get genome and contig_ref_ptr information.
-  VCFParseHeader parseheader_;
-
-  void readHeader(const std::string& file_name);
+  size_t consumer_threads_;
+  // VCF records dequeued by each consumer thread per lock of the record queue.
+  constexpr static const size_t RECORD_BATCH_SIZE_{64};
+  size_t record_batch_size_{RECORD_BATCH_SIZE_};
+  // Consumer threads with an index at or above the active limit are parked.
+  std::atomic<size_t> active_consumers_{std::numeric_limits<size_t>::max()};
+  std::mutex active_mutex_;
+  bool consumers_released_{false};
+
+  // Runtime metrics exported by the MetricsRegistry.
+  constexpr static const char* METRICS_TYPE_{"vcf_reader"};
+  constexpr static const char* METRICS_NAME_{"VCFReaderMT"};
+  std::shared_ptr<MetricSet> metrics_ptr_{MetricsRegistry::registerSource(METRICS_TYPE_, METRICS_NAME_)};
+  MetricCounter& records_processed_{metrics_ptr_->counter("records_total")};
+  MetricCounter& record_wait_{metrics_ptr_->counter("record_wait_nanoseconds_total")};
+  MetricHistogram& record_latency_{metrics_ptr_->histogram("record_latency_seconds")};
+
+  // Parse the VCF file, all records if regions is empty.
+  void parseVCFFile(const std::string& vcf_file_name, const BGZRegionVector& regions);
   // Call the template VCF consumer class
-  void VCFConsumer();
+  void VCFConsumer(size_t consumer_index);
+  // Limit the active consumer threads, ignored after the consumers have been released at EOF.
+  void setActiveConsumers(size_t active_consumers);
+  // Unpark all consumer threads so that they read the EOF record.
+  void releaseConsumers();
 
 };
 
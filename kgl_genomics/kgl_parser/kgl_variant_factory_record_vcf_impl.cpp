@@ -14,7 +14,7 @@ namespace kgl = kellerberrin::genome;
 
 
 kgl::ParseVCFRecord::ParseVCFRecord( const std::string& genome_contig,
-                                     const VCFRecord& vcf_record,
+                                     const VCFRecordView& vcf_record,
                                      const std::shared_ptr<const GenomeReference>& genome_db_ptr) {
 
   // Get the format fields for Genetype analysis.
@@ -67,7 +67,7 @@ kgl::ParseVCFRecord::ParseVCFRecord( const std::string& genome_contig,
   quality_ = static_cast<Phred_t>(vcf_record.qual);
 
   // Look at the filter field for "Pass"
-  passed_filter_ = Utility::toupper(vcf_record.filter) == PASSED_FILTERS_;
+  passed_filter_ = Utility::toupper(std::string(vcf_record.filter)) == PASSED_FILTERS_;
 
 }
 
@@ -24,7 +24,7 @@ class ParseVCFRecord {
 public:
 
   ParseVCFRecord(const std::string& genome_contig,
-                 const VCFRecord& vcf_record,
+                 const VCFRecordView& vcf_record,
                  const std::shared_ptr<const GenomeReference>& genome_db_ptr);
   ~ParseVCFRecord() = default;
 
@@ -0,0 +1,180 @@
+//
+// Created by kellerberrin on 17/10/23.
+//
+
+#include "kgl_variant_factory_vcf_parse_gt.h"
+
+#include <array>
+
+
+namespace kgl = kellerberrin::genome;
+
+
+namespace {   // The single char allele lookup table.
+
+constexpr const uint32_t INVALID_CHAR_ALLELE{kgl::DecodedGenotype::SYMBOLIC_ALLELE_ - 1};
+
+constexpr std::array<uint32_t, 256> alleleTable() {
+
+  std::array<uint32_t, 256> allele_table{};
+  allele_table.fill(INVALID_CHAR_ALLELE);
+  for (char digit = '0'; digit <= '9'; ++digit) {
+
+    allele_table[static_cast<unsigned char>(digit)] = static_cast<uint32_t>(digit - '0');
+
+  }
+  allele_table[static_cast<unsigned char>('.')] = kgl::DecodedGenotype::MISSING_ALLELE_;
+  allele_table[static_cast<unsigned char>('-')] = kgl::DecodedGenotype::MISSING_ALLELE_;
+
+  return allele_table;
+
+}
+
+constexpr const std::array<uint32_t, 256> ALLELE_TABLE{alleleTable()};
+
+inline uint32_t charAllele(char allele_char) { return ALLELE_TABLE[static_cast<unsigned char>(allele_char)]; }
+
+}   // end anonymous namespace
+
+
+kgl::DecodedGenotype kgl::VCFGenotypeDecoder::decode(std::string_view genotype) {
+
+  static_assert(INVALID_ALLELE_ == INVALID_CHAR_ALLELE);
+
+  // Diploid fast path "a|b" or "a/b".
+  if (genotype.size() == DIPLOID_SIZE_ or (genotype.size() > DIPLOID_SIZE_ and genotype[DIPLOID_SIZE_] == FORMAT_SEPARATOR_)) {
+
+    uint32_t a_idx = charAllele(genotype[0]);
+    uint32_t b_idx = charAllele(genotype[2]);
+    char separator = genotype[1];
+    if (a_idx != INVALID_ALLELE_ and b_idx != INVALID_ALLELE_ and (separator == PHASED_SEPARATOR_ or separator == UNPHASED_SEPARATOR_)) {
+
+      return { .a_idx = a_idx, .b_idx = b_idx, .phased = (separator == PHASED_SEPARATOR_), .ploidy = 2 };
+
+    }
+
+  } else if (genotype.size() == HAPLOID_SIZE_ or (genotype.size() > HAPLOID_SIZE_ and genotype[HAPLOID_SIZE_] == FORMAT_SEPARATOR_)) {
+
+    // Haploid fast path "a".
+    uint32_t a_idx = charAllele(genotype[0]);
+    if (a_idx != INVALID_ALLELE_) {
+
+      return { .a_idx = a_idx, .b_idx = DecodedGenotype::MISSING_ALLELE_, .phased = false, .ploidy = 1 };
+
+    }
+
+  }
+
+  return decodeGeneral(genotype);
+
+}
+
+
+kgl::DecodedGenotype kgl::VCFGenotypeDecoder::decodeGeneral(std::string_view genotype) {
+
+  // The GT field ends at the first format separator, ignore any surrounding whitespace.
+  genotype = genotype.substr(0, genotype.find(FORMAT_SEPARATOR_));
+  constexpr const std::string_view WHITESPACE{" \t\r\n"};
+  auto begin = genotype.find_first_not_of(WHITESPACE);
+  if (begin == std::string_view::npos) {
+
+    return {};  // Empty, ploidy is zero.
+
+  }
+  genotype = genotype.substr(begin, genotype.find_last_not_of(WHITESPACE) - begin + 1);
+
+  DecodedGenotype decoded;
+  size_t allele_begin{0};
+  for (size_t index = 0; index <= genotype.size(); ++index) {
+
+    bool allele_end = index == genotype.size();
+    if (not allele_end and (genotype[index] == PHASED_SEPARATOR_ or genotype[index] == UNPHASED_SEPARATOR_)) {
+
+      decoded.phased = genotype[index] == PHASED_SEPARATOR_;
+      allele_end = true;
+
+    }
+
+    if (allele_end) {
+
+      uint32_t allele_idx = decodeAllele(genotype.substr(allele_begin, index - allele_begin));
+      if (allele_idx == INVALID_ALLELE_) {
+
+        return {};
+
+      }
+
+      switch (decoded.ploidy) {
+
+        case 0:
+          decoded.a_idx = allele_idx;
+          break;
+
+        case 1:
+          decoded.b_idx = allele_idx;
+          break;
+
+        default:
+          return {};  // Only haploid and diploid genotypes.
+
+      }
+      ++decoded.ploidy;
+      allele_begin = index + 1;
+
+    }
+
+  }
+
+  if (decoded.ploidy == 1) {
+
+    decoded.phased = false;
+
+  }
+
+  return decoded;
+
+}
+
+
+uint32_t kgl::VCFGenotypeDecoder::decodeAllele(std::string_view allele) {
+
+  if (allele.empty()) {
+
+    return INVALID_ALLELE_;
+
+  }
+
+  if (allele.size() == 1) {
+
+    return charAllele(allele[0]);
+
+  }
+
+  if (allele.front() == SYMBOLIC_BEGIN_ and allele.back() == SYMBOLIC_END_) {
+
+    return DecodedGenotype::SYMBOLIC_ALLELE_;
+
+  }
+
+  // Multi-digit allele index.
+  uint64_t allele_idx{0};
+  for (auto allele_char : allele) {
+
+    if (allele_char < '0' or allele_char > '9') {
+
+      return INVALID_ALLELE_;
+
+    }
+
+    allele_idx = (allele_idx * 10) + static_cast<uint64_t>(allele_char - '0');
+    if (allele_idx >= INVALID_ALLELE_) {
+
+      return INVALID_ALLELE_;
+
+    }
+
+  }
+
+  return static_cast<uint32_t>(allele_idx);
+
+}
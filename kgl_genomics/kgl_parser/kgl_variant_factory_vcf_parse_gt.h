@@ -0,0 +1,86 @@
+//
+// Created by kellerberrin on 17/10/23.
+//
+
+#ifndef KGL_VARIANT_FACTORY_VCF_PARSE_GT_H
+#define KGL_VARIANT_FACTORY_VCF_PARSE_GT_H
+
+
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+
+
+namespace kellerberrin::genome {   //  organization level namespace
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The decoded GT (genotype) field of a VCF sample.
+// Allele indexes are 0 for the reference and 1.. for the alternate alleles. A haploid genotype has ploidy 1 and
+// b_idx set to MISSING_ALLELE_. An empty or malformed GT field has ploidy 0.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct DecodedGenotype {
+
+  // The '.' allele (also the '-' allele used in some 1000 Genomes files).
+  constexpr static const uint32_t MISSING_ALLELE_{std::numeric_limits<uint32_t>::max()};
+  // A symbolic '<...>' allele.
+  constexpr static const uint32_t SYMBOLIC_ALLELE_{MISSING_ALLELE_ - 1};
+
+  uint32_t a_idx{MISSING_ALLELE_};
+  uint32_t b_idx{MISSING_ALLELE_};
+  bool phased{false};
+  uint8_t ploidy{0};
+
+  [[nodiscard]] bool valid() const { return ploidy != 0; }
+  [[nodiscard]] bool diploid() const { return ploidy == 2; }
+  // The allele index with missing and symbolic alleles mapped to the reference (0).
+  [[nodiscard]] static uint32_t referenceIndex(uint32_t allele_idx) { return allele_idx >= SYMBOLIC_ALLELE_ ? 0 : allele_idx; }
+
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Decodes the GT field at the start of a sample genotype ("0|1:12,3:..."), the field ends at the first ':'.
+// Single digit haploid and diploid genotypes ("1", "0|0", "0/1", "./.") are decoded by a table lookup, other
+// genotypes (multi-digit or symbolic alleles, whitespace, ploidy > 2) fall back to the general parser.
+// The '|' separator is phased and the '/' separator is unphased.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class VCFGenotypeDecoder {
+
+public:
+
+  VCFGenotypeDecoder() = delete;
+  ~VCFGenotypeDecoder() = delete;
+
+  [[nodiscard]] static DecodedGenotype decode(std::string_view genotype);
+
+private:
+
+  constexpr static const size_t HAPLOID_SIZE_{1};
+  constexpr static const size_t DIPLOID_SIZE_{3};
+  constexpr static const char FORMAT_SEPARATOR_{':'};
+  constexpr static const char PHASED_SEPARATOR_{'|'};
+  constexpr static const char UNPHASED_SEPARATOR_{'/'};
+  constexpr static const char MISSING_CHAR_{'.'};
+  constexpr static const char ALT_MISSING_CHAR_{'-'};
+  constexpr static const char SYMBOLIC_BEGIN_{'<'};
+  constexpr static const char SYMBOLIC_END_{'>'};
+  // Marks chars that are not a single char allele.
+  constexpr static const uint32_t INVALID_ALLELE_{DecodedGenotype::SYMBOLIC_ALLELE_ - 1};
+
+  // Multi-digit and symbolic alleles, surrounding whitespace.
+  [[nodiscard]] static DecodedGenotype decodeGeneral(std::string_view genotype);
+  // Decode a single allele, returns INVALID_ALLELE_ if malformed.
+  [[nodiscard]] static uint32_t decodeAllele(std::string_view allele);
+
+};
+
+
+
+} // namespace
+
+
+#endif //KGL_VARIANT_FACTORY_VCF_PARSE_GT_H
@@ -27,87 +27,102 @@ bool kgl::VCFParseHeader::parseHeader(const std::string& vcf_file_name) {
 
   try {
 
-    long counter = 0;
-    bool found_header = false;
-
     while (true) {
 
       IOLineRecord line_record = vcf_stream_opt.value()->readLine();
       if (line_record.EOFRecord()) break;
 
-      std::string_view record_str_view = line_record.getView();
+      if (parseHeaderLine(line_record.getView())) {
 
-      size_t pos = record_str_view.find_first_of(KEY_SEPARATOR_);
+        break; // #CHROM is the last field in the VCF header so stop processing.
 
-      if (pos != std::string::npos) {
+      }
 
-        std::string key{record_str_view.substr(0, pos)};
-        std::string value{record_str_view.substr(pos, std::string::npos)};
+    }
 
-        pos = value.find_first_of(KEY_SEPARATOR_);
+    logHeader(vcf_file_name);
 
-        if (pos != std::string::npos) {
+  }
+  catch (std::exception const &e) {
 
-          value = value.erase(pos, pos + std::string(KEY_SEPARATOR_).length());
+    ExecEnv::log().critical("VCFParseHeader::parseHeader; VCF file: {}, unexpected I/O exception: {}", vcf_file_name, e.what());
 
-        }
+  }
 
-        pos = key.find_first_of(KEY_PREFIX_);
+  return true;
 
-        if (pos != std::string::npos) {
+}
 
-          key = key.erase(pos, pos + std::string(KEY_PREFIX_).length());
 
-        }
+bool kgl::VCFParseHeader::parseHeaderLine(std::string_view record_str_view) {
 
-        vcf_header_info_.emplace_back(key, value);
+  size_t pos = record_str_view.find_first_of(KEY_SEPARATOR_);
 
-      }
+  if (pos != std::string::npos) {
 
-      std::string line_prefix{record_str_view.substr(0, FIELD_NAME_FRAGMENT_LENGTH_)};
-      if (line_prefix == FIELD_NAME_FRAGMENT_) {
+    std::string key{record_str_view.substr(0, pos)};
+    std::string value{record_str_view.substr(pos, std::string::npos)};
 
-        found_header = true;
-        std::vector<std::string_view> field_vector = Utility::viewTokenizer(record_str_view, RECORD_FIELD_LIST_SEPARATOR_);
-        size_t field_count = 0;
-        for(auto const& field :field_vector) {
+    pos = value.find_first_of(KEY_SEPARATOR_);
 
-          if (field_count >= SKIP_FIELD_NAMES_) {
+    if (pos != std::string::npos) {
 
-            vcf_genomes_.emplace_back(field);
+      value = value.erase(pos, pos + std::string(KEY_SEPARATOR_).length());
 
-          }
+    }
 
-          ++field_count;
+    pos = key.find_first_of(KEY_PREFIX_);
 
-        }
+    if (pos != std::string::npos) {
 
-        break; // #CHROM is the last field in the VCF header so stop processing.
+      key = key.erase(pos, pos + std::string(KEY_PREFIX_).length());
 
-      }
+    }
 
-      ++counter;
+    vcf_header_info_.emplace_back(key, value);
 
-    }
+  }
 
-    if (not found_header) {
+  std::string line_prefix{record_str_view.substr(0, FIELD_NAME_FRAGMENT_LENGTH_)};
+  if (line_prefix == FIELD_NAME_FRAGMENT_) {
 
-      ExecEnv::log().error("VCF Genome Names Not Found");
+    found_header_ = true;
+    std::vector<std::string_view> field_vector = Utility::viewTokenizer(record_str_view, RECORD_FIELD_LIST_SEPARATOR_);
+    size_t field_count = 0;
+    for(auto const& field :field_vector) {
 
-    } else {
+      if (field_count >= SKIP_FIELD_NAMES_) {
 
-      ExecEnv::log().info("{} Genomes in VCF Header {}, Header lines processed: {}", vcf_genomes_.size(), vcf_file_name, counter);
+        vcf_genomes_.emplace_back(field);
+
+      }
+
+      ++field_count;
 
     }
 
+    return true;
+
   }
-  catch (std::exception const &e) {
 
-    ExecEnv::log().critical("VCFParseHeader::parseHeader; VCF file: {}, unexpected I/O exception: {}", vcf_file_name, e.what());
+  ++header_line_count_;
 
-  }
+  return false;
 
-  return true;
+}
+
+
+void kgl::VCFParseHeader::logHeader(const std::string& vcf_file_name) const {
+
+  if (not found_header_) {
+
+    ExecEnv::log().error("VCF Genome Names Not Found");
+
+  } else {
+
+    ExecEnv::log().info("{} Genomes in VCF Header {}, Header lines processed: {}", vcf_genomes_.size(), vcf_file_name, header_line_count_);
+
+  }
 
 }
 
@@ -11,6 +11,7 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <string_view>
 
 
 namespace kellerberrin::genome {   //  organization level namespace
@@ -54,7 +55,15 @@ public:
 
   ~VCFParseHeader() = default;
 
+  // Opens the VCF file and parses the header lines.
   [[nodiscard]] bool parseHeader(const std::string &file_name);
+  // Parse a single header line read from an already open stream.
+  // Returns true when the header is complete ('#CHROM' field names line).
+  [[nodiscard]] bool parseHeaderLine(std::string_view header_line);
+  // Log the number of genomes and header lines found.
+  void logHeader(const std::string& file_name) const;
+
+  [[nodiscard]] bool headerComplete() const { return found_header_; }
 
   [[nodiscard]] const std::vector<std::string> &getGenomes() const { return vcf_genomes_; }
 
@@ -72,6 +81,8 @@ private:
 
   std::vector<std::string> vcf_genomes_;                // Field (genome) names for each VCF record
   VCFHeaderInfo vcf_header_info_;
+  size_t header_line_count_{0};
+  bool found_header_{false};
 
   // Parser constants.
   static constexpr const char *KEY_SEPARATOR_{"="};
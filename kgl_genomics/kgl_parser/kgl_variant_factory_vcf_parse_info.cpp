@@ -6,136 +6,124 @@
 #include "kel_utility.h"
 
 #include <string_view>
+#include <algorithm>
+#include <numeric>
+#include <bit>
 
 namespace kgl = kellerberrin::genome;
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Efficient parser for the info field.
-// Implemented as a simple finite FSM_State parser.
-bool kgl::VCFInfoParser::infoTokenParser() {
-
-  enum class ParserStates { KeyToken, ValueToken} parser_state = ParserStates::KeyToken;
-  size_t info_length = info_view_.length();
-  size_t key_token_count{0};
-  size_t key_token_offset{0};
-  size_t value_token_count{0};
-  size_t value_token_offset{0};
-  size_t value_sub_field_count{0};  // Count the number of sub fields in a value e.g. "9,9,9" = 3.
-  std::string_view key_view;
-  std::string_view value_view;
-  const std::string_view empty_value_view;
+// Compile the perfect hash table of the INFO keys.
 
-  for (size_t index = 0; index < info_length; ++index) {
+kgl::InfoFieldIndex::InfoFieldIndex(const std::vector<std::string>& field_keys) : slot_keys_(field_keys) {
 
-    switch(parser_state) {
+  if (slot_keys_.empty()) {
 
-      case ParserStates::KeyToken:
-        if (info_view_[index] == INFO_VALUE_DELIMITER_) {
+    return;
 
-          key_view = info_view_.substr(key_token_offset, key_token_count);
-          parser_state = ParserStates::ValueToken;
-          value_token_offset = index + 1;
-          value_token_count = 0;
-          value_sub_field_count = 0;
+  }
 
-        } else if (info_view_[index] == INFO_FIELD_DELIMITER_) {
+  // A larger (sparser) table is only tried if no key hash seed can be placed in the smaller table.
+  // A different key hash seed is only required if two keys have identical 64 bit hashes.
+  for (size_t table_scale = 1; table_scale <= MAX_TABLE_SCALE_; table_scale *= 2) {
 
-          key_view = info_view_.substr(key_token_offset, key_token_count);
-          value_sub_field_count = 0;
-          auto result = parsed_token_map_.try_emplace(key_view, InfoParserToken(empty_value_view, value_sub_field_count));
-          if (not result.second) {
+    for (uint64_t hash_seed = 0; hash_seed < MAX_HASH_SEEDS_; ++hash_seed) {
 
-            ExecEnv::log().warn("VCFInfoParser::infoTokenParser, 1. cannot insert <key> : '{}', <value> pair, (duplicate)", std::string(key_view));
-            ExecEnv::log().warn("VCFInfoParser::infoTokenParser, 1. Info : {} ", std::string(info_view_));
+      if (buildTable(hash_seed, table_scale)) {
 
-          }
-          key_token_offset = index + 1;
-          key_token_count = 0;
+        return;
 
-        } else {
+      }
 
-          ++key_token_count;
+    }
 
-        }
-        break;
+  }
 
-      case ParserStates::ValueToken:
-        if (info_view_[index] == INFO_FIELD_DELIMITER_) {
+  ExecEnv::log().warn("InfoFieldIndex::InfoFieldIndex, unable to compile a perfect hash for: {} INFO field keys, using a hash map", slot_keys_.size());
 
-          value_view = info_view_.substr(value_token_offset, value_token_count);
-          ++value_sub_field_count;
-          auto result = parsed_token_map_.try_emplace(key_view, InfoParserToken(value_view, value_sub_field_count));
-          if (not result.second) {
+  bucket_seeds_.clear();
+  table_.clear();
+  for (uint32_t slot = 0; slot < slot_keys_.size(); ++slot) {
 
-            ExecEnv::log().warn("VCFInfoParser::infoTokenParser, 2. cannot insert <key>: '{}', <value> pair, (duplicate)", std::string(key_view));
-            ExecEnv::log().warn("VCFInfoParser::infoTokenParser, 2. Info : {} ", std::string(info_view_));
+    // A duplicate key is found at the first slot.
+    fallback_index_.emplace(slot_keys_[slot], slot);
 
-          }
-          parser_state = ParserStates::KeyToken;
-          key_token_offset = index + 1;
-          key_token_count = 0;
+  }
 
-        } else {
+}
 
-          if (info_view_[index] == INFO_VECTOR_DELIMITER_) {
 
-            ++value_sub_field_count;
+bool kgl::InfoFieldIndex::buildTable(uint64_t hash_seed, size_t table_scale) {
 
-          }
-          ++value_token_count;
+  hash_seed_ = hash_seed;
+  const size_t bucket_count = std::bit_ceil(std::max<size_t>(1, slot_keys_.size() / KEYS_PER_BUCKET_));
+  // Table load factor is less than 0.5
+  const size_t table_size = std::bit_ceil(2 * table_scale * slot_keys_.size());
+  bucket_mask_ = bucket_count - 1;
+  table_mask_ = table_size - 1;
 
-        }
-        break;
+  // Hash the keys into buckets.
+  std::vector<std::vector<uint32_t>> buckets(bucket_count);
+  std::vector<uint64_t> key_hashes(slot_keys_.size());
+  for (uint32_t slot = 0; slot < slot_keys_.size(); ++slot) {
 
-    } // switch
+    key_hashes[slot] = hashKey(slot_keys_[slot], hash_seed_);
+    buckets[key_hashes[slot] & bucket_mask_].push_back(slot);
 
-  } // for loop
+  }
 
-  // Process final token.
-  if (parser_state == ParserStates::ValueToken) {
+  // Place the largest buckets first.
+  std::vector<size_t> bucket_order(bucket_count);
+  std::iota(bucket_order.begin(), bucket_order.end(), 0);
+  std::stable_sort(bucket_order.begin(), bucket_order.end(), [&buckets](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
 
-    // Check value_token_offset + value_token_count equals the length of the info field.
-    // and all characters have been consumed.
-    if (value_token_offset + value_token_count != info_length) {
+  bucket_seeds_.assign(bucket_count, 0);
+  table_.assign(table_size, EMPTY_ENTRY_);
+  std::vector<uint64_t> bucket_entries;
+  for (auto bucket_index : bucket_order) {
 
-      ExecEnv::log().error("VCFInfoParser::infoTokenParser, Final_Parser_State=ValueToken, Final Value Token Offset: {}, Size: {} not equal the Info size : {}",
-                           value_token_offset, value_token_count, info_length);
+    const auto& bucket = buckets[bucket_index];
+    if (bucket.empty()) {
 
-      return false;
+      break;
 
     }
 
-    value_view = info_view_.substr(value_token_offset, value_token_count);
-    ++value_sub_field_count;
-    auto result = parsed_token_map_.try_emplace(key_view, InfoParserToken(value_view, value_sub_field_count));
-    if (not result.second) {
+    bool placed{false};
+    for (uint32_t seed = 0; seed < MAX_DISPLACEMENT_SEEDS_ and not placed; ++seed) {
 
-      ExecEnv::log().warn("VCFInfoParser::infoTokenParser, 3. cannot insert <key> : '{}', <value> pair, (duplicate)", std::string(value_view));
-      ExecEnv::log().warn("VCFInfoParser::infoTokenParser, 3. Info : {} ", std::string(info_view_));
+      bucket_entries.clear();
+      placed = true;
+      for (auto slot : bucket) {
 
-    }
+        uint64_t entry = displace(key_hashes[slot], seed) & table_mask_;
+        if (table_[entry] != EMPTY_ENTRY_ or std::find(bucket_entries.begin(), bucket_entries.end(), entry) != bucket_entries.end()) {
 
-  } else {
+          placed = false;
+          break;
 
-    // Check key_token_offset + key_token_count equals the length of the info field.
-    // and all characters have been consumed.
-    if (key_token_offset + key_token_count != info_length) {
+        }
+        bucket_entries.push_back(entry);
 
-      ExecEnv::log().error("VCFInfoParser::infoTokenParser, Final_Parser_State=KeyToken, Final Key Token Offset: {}, Size: {} not equal the Info size : {}",
-                           key_token_offset, key_token_count, info_length);
+      }
 
-      return false;
+      if (placed) {
+
+        bucket_seeds_[bucket_index] = seed;
+        for (size_t index = 0; index < bucket.size(); ++index) {
+
+          table_[bucket_entries[index]] = bucket[index];
+
+        }
+
+      }
 
     }
 
-    key_view = info_view_.substr(key_token_offset, key_token_count);
-    value_sub_field_count = 0;
-    auto result = parsed_token_map_.try_emplace(key_view, InfoParserToken(empty_value_view, value_sub_field_count));
-    if (not result.second) {
+    if (not placed) {
 
-      ExecEnv::log().warn("VCFInfoParser::infoTokenParser, 4. cannot insert <key> : '{}', <value> pair, (duplicate)", std::string(key_view));
-      ExecEnv::log().warn("VCFInfoParser::infoTokenParser, 4. Info : {} ", std::string(info_view_));
+      return false;
 
     }
 
@@ -146,15 +134,67 @@ bool kgl::VCFInfoParser::infoTokenParser() {
 }
 
 
-// These three functions are parser specific
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Efficient parser for the info field.
+// Each ';' delimited field is split into a key and value, only keys found in the field index are stored.
+void kgl::VCFInfoParser::infoTokenParser() {
+
+  const std::string_view empty_value_view;
+  size_t field_begin{0};
+  while (field_begin <= info_view_.length()) {
+
+    size_t field_end = info_view_.find(INFO_FIELD_DELIMITER_, field_begin);
+    if (field_end == std::string_view::npos) {
+
+      field_end = info_view_.length();
+
+    }
+
+    std::string_view field_view = info_view_.substr(field_begin, field_end - field_begin);
+    field_begin = field_end + 1;
+
+    size_t value_offset = field_view.find(INFO_VALUE_DELIMITER_);
+    std::optional<size_t> slot = field_index_.findSlot(field_view.substr(0, value_offset));
+    if (not slot) {
+
+      continue;  // Not subscribed, skip.
+
+    }
+
+    if (parsed_tokens_[slot.value()]) {
+
+      ExecEnv::log().warn("VCFInfoParser::infoTokenParser, cannot insert <key> : '{}', <value> pair, (duplicate)",
+                          std::string(field_view.substr(0, value_offset)));
+      ExecEnv::log().warn("VCFInfoParser::infoTokenParser, Info : {} ", std::string(info_view_));
+      continue;
+
+    }
+
+    if (value_offset == std::string_view::npos) {
+
+      // A flag field has no value.
+      parsed_tokens_[slot.value()] = InfoParserToken(empty_value_view, 0);
+
+    } else {
+
+      // Count the number of sub fields in a value e.g. "9,9,9" = 3.
+      std::string_view value_view = field_view.substr(value_offset + 1);
+      size_t value_sub_field_count = std::count(value_view.begin(), value_view.end(), INFO_VECTOR_DELIMITER_) + 1;
+      parsed_tokens_[slot.value()] = InfoParserToken(value_view, value_sub_field_count);
+
+    }
+
+  }
+
+}
 
 
-[[nodiscard]] std::optional<kgl::InfoParserToken> kgl::VCFInfoParser::getToken(const std::string& key) const {
+std::optional<kgl::InfoParserToken> kgl::VCFInfoParser::getToken(const std::string& key) const {
 
-  auto key_it = parsed_token_map_.find(key);
-  if (key_it != parsed_token_map_.end()) {
+  std::optional<size_t> slot = field_index_.findSlot(key);
+  if (slot) {
 
-    return key_it->second;
+    return parsed_tokens_[slot.value()];
 
   }
 
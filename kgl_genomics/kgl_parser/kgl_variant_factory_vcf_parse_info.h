@@ -8,9 +8,14 @@
 #include "kel_exec_env.h"
 
 
-#include <map>
+#include <vector>
 #include <string>
+#include <string_view>
 #include <optional>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+#include <limits>
 
 
 namespace kellerberrin::genome {   //  organization level namespace
@@ -40,25 +45,133 @@ using InfoFloatType = float;
 
 
 using InfoParserToken = std::pair<std::string_view, size_t>;      // Tokens are a string_view and a field number (number of ',')
-using InfoParserMap = std::map<std::string_view, InfoParserToken>; // The token parser data structure.
 
 
-class VCFInfoParser {
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// A perfect hash table of INFO field keys compiled once per VCF file from the subscribed header fields.
+// Each key is mapped to a dense slot [0, slotCount()), keys not in the table (unsubscribed fields) are not found.
+// The table is built using hash and displace; keys are hashed to buckets and each bucket (largest first) is
+// assigned a displacement seed that places all its keys in free table entries. A lookup is one hash of the key,
+// two array reads and a single key comparison. If no seed places all the keys, the table is enlarged and the build
+// is retried. If this also fails (duplicate keys), the keys are indexed by an unordered map.
+
+class InfoFieldIndex {
 
 public:
 
-  // std::move the info string into this object for efficiency.
-  explicit VCFInfoParser(std::string&& info) : info_(std::move(info)), info_view_(info_) {
+  InfoFieldIndex() = default;
+  // The slot of each key is its position in the key vector.
+  explicit InfoFieldIndex(const std::vector<std::string>& field_keys);
+  ~InfoFieldIndex() = default;
+
+  [[nodiscard]] std::optional<size_t> findSlot(std::string_view key) const {
 
-    if (not infoTokenParser()) {
+    if (slot_keys_.empty()) {
 
-      ExecEnv::log().error("VCFInfoParser::VCFInfoParser, Token parser had a problem parsing info field");
+      return std::nullopt;
 
     }
 
+    if (not fallback_index_.empty()) {
+
+      auto result = fallback_index_.find(key);
+      if (result == fallback_index_.end()) {
+
+        return std::nullopt;
+
+      }
+
+      return result->second;
+
+    }
+
+    const uint64_t key_hash = hashKey(key, hash_seed_);
+    const uint32_t table_entry = table_[displace(key_hash, bucket_seeds_[key_hash & bucket_mask_]) & table_mask_];
+    if (table_entry == EMPTY_ENTRY_ or slot_keys_[table_entry] != key) {
+
+      return std::nullopt;
+
+    }
+
+    return table_entry;
+
+  }
+
+  [[nodiscard]] size_t slotCount() const { return slot_keys_.size(); }
+  [[nodiscard]] const std::vector<std::string>& slotKeys() const { return slot_keys_; }
+
+private:
+
+  std::vector<std::string> slot_keys_;     // The key of each slot.
+  std::vector<uint32_t> bucket_seeds_;     // The displacement seed of each bucket.
+  std::vector<uint32_t> table_;            // Table entry to slot.
+  uint64_t bucket_mask_{0};
+  uint64_t table_mask_{0};
+  uint64_t hash_seed_{0};
+
+  // Heterogeneous lookup of string_view keys.
+  struct FallbackKeyHash {
+
+    using is_transparent = void;
+    [[nodiscard]] size_t operator()(std::string_view key) const { return std::hash<std::string_view>{}(key); }
+
+  };
+  // Only used if a perfect hash cannot be compiled (e.g. duplicate keys).
+  std::unordered_map<std::string, uint32_t, FallbackKeyHash, std::equal_to<>> fallback_index_;
+
+  constexpr static const uint32_t EMPTY_ENTRY_{std::numeric_limits<uint32_t>::max()};
+  constexpr static const size_t KEYS_PER_BUCKET_{4};
+  constexpr static const uint32_t MAX_DISPLACEMENT_SEEDS_{1 << 16};
+  constexpr static const uint64_t MAX_HASH_SEEDS_{16};
+  constexpr static const size_t MAX_TABLE_SCALE_{8};         // The table is enlarged up to 8 times the minimum size.
+
+  // FNV-1a, INFO keys are short.
+  [[nodiscard]] static uint64_t hashKey(std::string_view key, uint64_t seed) {
+
+    uint64_t hash = 0xcbf29ce484222325ULL ^ seed;
+    for (auto key_char : key) {
+
+      hash ^= static_cast<uint8_t>(key_char);
+      hash *= 0x100000001b3ULL;
+
+    }
+
+    return hash;
+
+  }
+  // Mix the key hash with the bucket displacement seed (splitmix64 finalizer).
+  [[nodiscard]] static uint64_t displace(uint64_t key_hash, uint32_t bucket_seed) {
+
+    uint64_t mix = key_hash + (static_cast<uint64_t>(bucket_seed) + 1) * 0x9e3779b97f4a7c15ULL;
+    mix = (mix ^ (mix >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    mix = (mix ^ (mix >> 27)) * 0x94d049bb133111ebULL;
+    return mix ^ (mix >> 31);
+
+  }
+
+  [[nodiscard]] bool buildTable(uint64_t hash_seed, size_t table_scale);
+
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Only the INFO fields in the field index are stored, all other fields are skipped during the scan.
+
+class VCFInfoParser {
+
+public:
+
+  // The info text is not copied, it must remain valid for the lifetime of the parser (it is a view of the VCF record line).
+  VCFInfoParser(std::string_view info_view, const InfoFieldIndex& field_index)
+  : info_view_(info_view), field_index_(field_index), parsed_tokens_(field_index.slotCount()) {
+
+    infoTokenParser();
+
   }
   ~VCFInfoParser() = default;
 
+  // Lookup by the field index slot.
+  [[nodiscard]] const std::optional<InfoParserToken>& getToken(size_t slot) const { return parsed_tokens_[slot]; }
   [[nodiscard]] std::optional<InfoParserToken> getToken(const std::string& key) const;
 
   [[nodiscard]] static InfoIntegerType convertToInteger(const std::string& value);
@@ -72,15 +185,15 @@ public:
 
 private:
 
-  const std::string info_; // The unparsed 'raw' VCF info record.
-  const std::string_view info_view_;  // This a string_view of the info_ string above
-  InfoParserMap parsed_token_map_;  // The parsed token map.
+  const std::string_view info_view_;  // The unparsed 'raw' VCF info record.
+  const InfoFieldIndex& field_index_;  // The compiled subscribed fields.
+  std::vector<std::optional<InfoParserToken>> parsed_tokens_;  // The parsed tokens indexed by slot.
 
   constexpr static const char INFO_FIELD_DELIMITER_{';'};
   constexpr static const char INFO_VALUE_DELIMITER_{'='};
   constexpr static const char* INFO_VECTOR_MISSING_VALUE_STR_{"."};
 
-  [[nodiscard]] bool infoTokenParser();
+  void infoTokenParser();
 
 };
 
@@ -4,17 +4,37 @@
 
 #include "kel_exec_env.h"
 #include "kel_utility.h"
+#include "kel_tokenizer.h"
 #include "kgl_variant_vcf_impl.h"
+#include "kel_bzip_workflow.h"
 
 #include <string>
 #include <vector>
 #include <memory>
+#include <unordered_set>
 
 // Implementation file classes need to be defined within namespaces.
 namespace kgl = kellerberrin::genome;
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+kgl::ParseVCF::ParseVCF(const PipelineConfig& pipeline_config, size_t consumer_threads)
+  : decompress_stage_(pipeline_config.stageConfig(DECOMPRESS_STAGE, {.threads = DECOMPRESSION_THREADS_}))
+  , parse_stage_(pipeline_config.stageConfig(PARSE_STAGE, { .threads = PARSER_THREADS_
+                                                          , .high_tide = PIPELINE_HIGH_TIDE_
+                                                          , .low_tide = PIPELINE_LOW_TIDE_ }))
+  , vcf_pipeline_(parse_stage_.high_tide, parse_stage_.low_tide, PIPELINE_NAME_) {
+
+  // A balanced stage can grow to all the pipeline threads, less one thread for each of the other 2 stages.
+  if (pipeline_config.autoBalance() and consumer_threads > 0) {
+
+    stage_thread_limit_ = std::max<size_t>(decompress_stage_.threads + parse_stage_.threads + consumer_threads, 3) - 2;
+
+  }
+
+}
+
+
 kgl::ParseVCF::~ParseVCF() {
 
   enqueue_thread_.joinThreads();
@@ -27,6 +47,20 @@ kgl::ParseVCF::~ParseVCF() {
 
 }
 
+bool kgl::ParseVCF::open(const std::string& vcf_file_name) {
+
+  return open(vcf_file_name, stageThreads(decompress_stage_), stageThreads(parse_stage_));
+
+}
+
+
+bool kgl::ParseVCF::open(const std::string& vcf_file_name, const BGZRegionVector& regions) {
+
+  return open(vcf_file_name, regions, stageThreads(decompress_stage_), stageThreads(parse_stage_));
+
+}
+
+
 bool kgl::ParseVCF::open(const std::string& vcf_file_name, size_t decompression_threads, size_t vcf_parse_threads) {
 
   auto stream_opt = BaseStreamIO::getStreamIO(vcf_file_name, decompression_threads);
@@ -38,29 +72,188 @@ bool kgl::ParseVCF::open(const std::string& vcf_file_name, size_t decompression_
 
   }
 
-  stream_ptr_ = std::move(stream_opt.value());
+  activateParser(vcf_file_name, std::move(stream_opt.value()), vcf_parse_threads);
 
-  // The stream is now open, start parsing VCF fields.
-  vcf_pipeline_.activatePipeline(vcf_parse_threads, &kgl::ParseVCF::moveToVcfRecord, this);
+  return true;
+
+}
+
+
+bool kgl::ParseVCF::open( const std::string& vcf_file_name,
+                          const BGZRegionVector& regions,
+                          size_t decompression_threads,
+                          size_t vcf_parse_threads) {
+
+  // Region queries use the '.tbi' or '.csi' index to only decompress the blocks that cover the regions.
+  auto stream_opt = BGZStreamIO::getStreamIO(vcf_file_name, regions, decompression_threads);
+  if (not stream_opt) {
+
+    ExecEnv::log().error("ParseVCF::open; could not open indexed regions for VCF file: {}", vcf_file_name);
+    // Enqueue an eof marker further up the pipeline.
+    enqueueEOF();
+    return false;
+
+  }
 
-  enqueue_thread_.enqueueVoid(&ParseVCF::enqueueLineRecord, this);
+  activateParser(vcf_file_name, std::move(stream_opt.value()), vcf_parse_threads);
 
   return true;
 
 }
 
 
+void kgl::ParseVCF::activateParser( const std::string& vcf_file_name
+                                  , std::unique_ptr<BaseStreamIO> stream_ptr
+                                  , size_t vcf_parse_threads) {
+
+  file_name_ = vcf_file_name;
+  stream_ptr_ = std::move(stream_ptr);
+
+  // The stream is now open, start parsing VCF fields.
+  vcf_pipeline_.activatePipeline(vcf_parse_threads, &kgl::ParseVCF::moveToVcfRecords, this);
+
+  // The header is parsed from the first lines of the same stream, the remaining lines are then enqueued asynchronously.
+  if (readHeader()) {
+
+    enqueue_thread_.enqueueVoid(&ParseVCF::enqueueLineBlock, this);
+
+  }
+
+}
+
+
+// Balanced stages initially have the configured active threads, the remaining stage threads are parked.
+void kgl::ParseVCF::addBalancedStages(PipelineBalancer& balancer) {
+
+  if (stage_thread_limit_ == 0 or not stream_ptr_) {
+
+    return;
+
+  }
+
+  // Only the '.bgz' stream decompresses blocks on multiple threads.
+  auto bgz_stream_ptr = dynamic_cast<BGZStreamIO*>(stream_ptr_.get());
+  if (bgz_stream_ptr != nullptr) {
+
+    balancer.addStage( DECOMPRESS_STAGE
+                     , [bgz_stream_ptr]() { return bgz_stream_ptr->decompressionOccupancy(); }
+                     , [bgz_stream_ptr](size_t threads) { bgz_stream_ptr->setActiveThreads(threads); }
+                     , decompress_stage_.threads
+                     , stageThreads(decompress_stage_));
+
+  }
+
+  balancer.addStage( PARSE_STAGE
+                   , [this]() { return vcf_pipeline_.inputOccupancy(); }
+                   , [this](size_t threads) { vcf_pipeline_.setActiveThreads(threads); }
+                   , parse_stage_.threads
+                   , stageThreads(parse_stage_));
+
+}
+
+
+// Parse the header lines at the start of the stream.
+// The line block holding the end of the header (and usually the first records) is queued for parsing.
+// Returns false if the stream has no records.
+bool kgl::ParseVCF::readHeader() {
+
+  vcf_header_ = VCFParseHeader();
+  while (true) {
+
+    IOLineBlock line_block = stream_ptr_->readBlock();
+
+    // Check for EOF condition.
+    if (line_block.EOFBlock()) {
+
+      vcf_header_.logHeader(file_name_);
+      mapSampleColumns();
+      enqueueEOF();
+      return false;
+
+    }
+
+    bool header_complete{false};
+    for (size_t index = 0; index < line_block.size(); ++index) {
+
+      auto line_view = line_block.lineView(index);
+      if (line_view.empty()) {
+
+        continue;
+
+      }
+
+      // The header ends with the '#CHROM' line or at the first record.
+      if (line_view[0] != HEADER_CHAR_ or vcf_header_.parseHeaderLine(line_view)) {
+
+        header_complete = true;
+        break;
+
+      }
+
+    }
+
+    if (header_complete) {
+
+      vcf_header_.logHeader(file_name_);
+      mapSampleColumns();
+      // Header lines are skipped by the record parser.
+      vcf_pipeline_.push(std::move(line_block));
+      return true;
+
+    }
+
+  }
+
+}
+
+
+void kgl::ParseVCF::mapSampleColumns() {
+
+  sample_columns_.clear();
+  sample_names_.clear();
+  sample_projection_ = not sample_selection_.empty();
+  if (not sample_projection_) {
+
+    return;
+
+  }
+
+  std::unordered_set<std::string> selected_samples(sample_selection_.begin(), sample_selection_.end());
+  auto const& header_genomes = vcf_header_.getGenomes();
+  for (size_t column = 0; column < header_genomes.size(); ++column) {
+
+    if (selected_samples.erase(header_genomes[column]) > 0) {
+
+      sample_columns_.push_back(column);
+      sample_names_.push_back(header_genomes[column]);
+
+    }
+
+  }
+
+  for (auto const& sample : selected_samples) {
+
+    ExecEnv::log().warn("ParseVCF::mapSampleColumns; VCF file: {}, selected sample: {} not found in the header", file_name_, sample);
+
+  }
+
+  ExecEnv::log().info("ParseVCF::mapSampleColumns; VCF file: {}, parsing: {} of: {} samples",
+                      file_name_, sample_columns_.size(), header_genomes.size());
+
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Parse the line record into a VCF record and enqueue the record.
+// Read line blocks and enqueue them for parsing into VCF records.
 
-void kgl::ParseVCF::enqueueLineRecord() {
+void kgl::ParseVCF::enqueueLineBlock() {
 
   while (true) {
 
-    IOLineRecord line_record = stream_ptr_->readLine();
+    IOLineBlock line_block = stream_ptr_->readBlock();
 
     // Check for EOF condition.
-    if (line_record.EOFRecord()) {
+    if (line_block.EOFBlock()) {
 
       // Push the EOF marker onto the pipeline and stop processing.
       enqueueEOF();
@@ -68,13 +261,92 @@ void kgl::ParseVCF::enqueueLineRecord() {
 
     }
 
-    // Peek at the line record.
-    auto line_view = line_record.getView();
+    if (not line_block.empty()) {
+
+      vcf_pipeline_.push(std::move(line_block));
+
+    }
+
+  }
+
+}
+
+
+// Records are returned in file order to multiple consumer threads.
+kgl::VCFRecordPtr kgl::ParseVCF::readVCFRecord() {
+
+  std::lock_guard<std::mutex> lock(record_mutex_);
+  while (record_index_ >= record_block_.size()) {
+
+    record_block_ = vcf_pipeline_.waitAndPop();
+    record_index_ = 0;
+
+  }
+
+  return std::move(record_block_[record_index_++]);
+
+}
+
+
+// A batch of records is returned in file order under a single lock.
+// The pipeline is only waited on if no records have been read, so a batch never delays available records.
+size_t kgl::ParseVCF::readVCFRecords(VCFRecordBlock& record_batch, size_t max_records) {
+
+  std::lock_guard<std::mutex> lock(record_mutex_);
+  size_t read_count{0};
+  while (read_count < max_records) {
+
+    if (record_index_ >= record_block_.size()) {
+
+      if (read_count > 0) {
+
+        break;
+
+      }
+
+      record_block_ = vcf_pipeline_.waitAndPop();
+      record_index_ = 0;
+      continue;
+
+    }
+
+    bool eof_record = record_block_[record_index_]->EOFRecord();
+    record_batch.push_back(std::move(record_block_[record_index_++]));
+    ++read_count;
+    if (eof_record) {
+
+      break;
+
+    }
+
+  }
+
+  return read_count;
+
+}
+
+
+// Parse a block of VCF lines, header and zero length lines are skipped.
+kgl::VCFRecordBlock kgl::ParseVCF::moveToVcfRecords(IOLineBlock line_block) {
+
+  VCFRecordBlock record_block;
+  // Check for EOF.
+  if (line_block.EOFBlock()) {
+
+    record_block.push_back(VCFRecordView::createEOFMarker());
+    return record_block;
+
+  }
+
+  record_block.reserve(line_block.size());
+  for (size_t index = 0; index < line_block.size(); ++index) {
+
+    auto line_view = line_block.lineView(index);
 
     // Check for zero length lines.
     if (line_view.empty()) {
 
-      ExecEnv::log().warn( "File: {}, unexpected zero length line found at line: {}", getFileName(), line_record.lineCount());
+      ExecEnv::log().warn( "File: {}, unexpected zero length line found at line: {}", getFileName(), line_block.lineCount(index));
       continue;
 
     }
@@ -86,27 +358,33 @@ void kgl::ParseVCF::enqueueLineRecord() {
 
     }
 
-    vcf_pipeline_.push(std::move(line_record));
+    auto vcf_record_ptr = parseVcfRecord(line_block.lineCount(index), line_view);
+    if (vcf_record_ptr) {
 
-  }
+      record_block.push_back(std::move(vcf_record_ptr));
 
-}
+    }
 
-// Parse the VCF line into basic VCF fields.
-std::unique_ptr<const kgl::VCFRecord> kgl::ParseVCF::moveToVcfRecord(IOLineRecord line) {
+  }
 
-  // Check for EOF.
-  if (line.EOFRecord()) {
+  return record_block;
 
-    return VCFRecord::createEOFMarker();
+}
 
-  }
 
-  std::unique_ptr<VCFRecord> vcf_record_ptr(std::make_unique<VCFRecord>(std::move(line)));
+// Parse the VCF line into basic VCF fields.
+// The fields are views into the record line, only the mandatory and FORMAT fields are tokenised here.
+// The genotype columns are kept as a single view and are tokenised on demand by the consumer.
+std::unique_ptr<const kgl::VCFRecordView> kgl::ParseVCF::parseVcfRecord(size_t line_count, std::string_view line_view) {
+
+  std::unique_ptr<VCFRecordView> vcf_record_ptr(std::make_unique<VCFRecordView>(line_count, line_view));
+  std::string_view record_view = vcf_record_ptr->lineView();
 
-  std::vector<std::string_view> field_views = Utility::viewTokenizer(vcf_record_ptr->line_record_str, VCF_FIELD_DELIMITER_CHAR_);
+  std::array<std::string_view, FORMAT_FIELD_IDX_ + 1> field_views;
+  size_t field_begin{0};
+  size_t field_count = FieldTokenizer::leadingFields(record_view, VCF_FIELD_DELIMITER_CHAR_, field_views, field_begin);
 
-  if (field_views.size() < MINIMUM_VCF_FIELDS_) {
+  if (field_count < MINIMUM_VCF_FIELDS_) {
 
     ExecEnv::log().error("VCF file: {}, line: {}, record has less than the mandatory field count: {}"
                          , getFileName(), vcf_record_ptr->line_number, MINIMUM_VCF_FIELDS_);
@@ -120,24 +398,15 @@ std::unique_ptr<const kgl::VCFRecord> kgl::ParseVCF::moveToVcfRecord(IOLineRecor
   vcf_record_ptr->offset = std::stoull(std::string(field_views[OFFSET_FIELD_IDX_])) - 1;
 
   // The identifier field. Set field not present "." to the empty string.
-  if (field_views[IDENT_FIELD_IDX_] == FIELD_NOT_PRESENT_) {
-
-    vcf_record_ptr->id = "";
-
-  } else {
+  if (field_views[IDENT_FIELD_IDX_] != FIELD_NOT_PRESENT_) {
 
-    vcf_record_ptr->id = field_views[IDENT_FIELD_IDX_];
-    vcf_record_ptr->id = Utility::trimEndWhiteSpace(vcf_record_ptr->id);
+    vcf_record_ptr->id = Utility::trimEndWhiteSpaceView(field_views[IDENT_FIELD_IDX_]);
 
   }
 
   vcf_record_ptr->ref = field_views[REF_FIELD_IDX_];
   // A deletion variant can be signalled by a missing alt value.
-  if (field_views[ALT_FIELD_IDX_] == FIELD_NOT_PRESENT_) {
-
-    vcf_record_ptr->alt = "";
-
-  } else {
+  if (field_views[ALT_FIELD_IDX_] != FIELD_NOT_PRESENT_) {
 
     vcf_record_ptr->alt = field_views[ALT_FIELD_IDX_];
 
@@ -156,14 +425,14 @@ std::unique_ptr<const kgl::VCFRecord> kgl::ParseVCF::moveToVcfRecord(IOLineRecor
   vcf_record_ptr->filter = field_views[FILTER_FIELD_IDX_];
   vcf_record_ptr->info = field_views[INFO_FIELD_IDX_];
 
-  if (field_views.size() > MINIMUM_VCF_FIELDS_) {
+  if (field_count > MINIMUM_VCF_FIELDS_) {
 
     vcf_record_ptr->format = field_views[FORMAT_FIELD_IDX_];
+    // The remaining genotype columns, empty if the record has no genotypes.
+    vcf_record_ptr->genotype_columns = record_view.substr(field_begin);
+    if (sample_projection_) {
 
-    vcf_record_ptr->genotypeInfos.clear();
-    for (size_t idx = (MINIMUM_VCF_FIELDS_ + 1); idx < field_views.size(); ++idx) {
-
-      vcf_record_ptr->genotypeInfos.emplace_back(field_views[idx]);
+      vcf_record_ptr->projectSamples(sample_columns_);
 
     }
 
@@ -172,4 +441,3 @@ std::unique_ptr<const kgl::VCFRecord> kgl::ParseVCF::moveToVcfRecord(IOLineRecor
   return vcf_record_ptr;
 
 }
-
@@ -8,62 +8,136 @@
 
 #include "kgl_genome_types.h"
 #include "kel_basic_io.h"
+#include "kel_bzip_index.h"
 #include "kgl_variant_vcf_record.h"
 #include "kgl_variant_factory_vcf_parse_header.h"
 
 #include "kel_queue_tidal.h"
 #include "kel_workflow_threads.h"
 #include "kel_workflow_pipeline.h"
+#include "kel_workflow_ordered.h"
+#include "kel_pipeline_config.h"
+#include "kel_pipeline_balancer.h"
 
 #include <memory>
 #include <string>
 #include <vector>
+#include <mutex>
+#include <algorithm>
+#include <array>
 
 namespace kellerberrin::genome {   //  organization::project level namespace
 
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// VCF Record parser object (multi-threaded) - uses multiple threads to parse queued file lines from the IO reader.
-// The line fields are tab delimited and are parsed into a VCFRecord which is then enqueued for further processing.
+// VCF Record parser object (multi-threaded) - uses multiple threads to parse queued line blocks from the IO reader.
+// The line fields are tab delimited and are parsed into a VCFRecordView which is then enqueued for further processing.
+// Lines are queued and parsed as blocks so that pipeline synchronization occurs once per block rather than once per line.
+//
+// The threads and queue depth of the "decompress" and "parse" stages are set by a PipelineConfig. If the configuration
+// is auto balanced then the active threads are rebalanced between the decompress, parse and record consumer stages by
+// a PipelineBalancer (see addBalancedStages()). Each stage is created with the threads of all stages (less one thread
+// for each other stage), of which the configured number are active.
+//
+// An optional sample allow-list (selectSamples()) is mapped to the header genotype columns once when the header is
+// parsed. The parsed records then only tokenise the selected genotype columns, see VCFRecordView::genotypeInfos().
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-using VCFRecordPtr = std::unique_ptr<const VCFRecord>;
+using VCFRecordPtr = std::unique_ptr<const VCFRecordView>;
+using VCFRecordBlock = std::vector<VCFRecordPtr>;
 
 class ParseVCF {
 
-  using VCFPipeline = WorkflowPipeline<IOLineRecord, VCFRecordPtr>;
+  // Record blocks are returned in file order by the reorder buffer of the ordered pipeline.
+  using VCFPipeline = WorkflowOrdered<IOLineBlock, VCFRecordBlock>;
 
 public:
 
-  ParseVCF() = default;
+  ParseVCF() : ParseVCF(PipelineConfig()) {}
+  // The consumer threads reading parsed records are the third balanced stage, zero if the stages are not balanced.
+  explicit ParseVCF(const PipelineConfig& pipeline_config, size_t consumer_threads = 0);
   ~ParseVCF();
 
-  // Begin reading IO records, allocates threads to bgz decompression and parsing the VCF record.
+  // Begin reading IO records, allocates the configured threads to bgz decompression and parsing the VCF record.
+  // The VCF header is parsed from the first lines of the stream before open() returns.
+  bool open(const std::string& vcf_file_name);
   bool open( const std::string& vcf_file_name,
-             size_t decompression_threads = DECOMPRESSION_THREADS_,
-             size_t vcf_parse_threads = PARSER_THREADS_);
+             size_t decompression_threads,
+             size_t vcf_parse_threads);
 
-  // Export parsed VCF records further up the parser chain.
-  [[nodiscard]] VCFRecordPtr readVCFRecord() { return vcf_pipeline_.waitAndPop(); }
+  // Only parse the header and the records overlapping the regions. The file must be '.bgz' with a '.tbi' or '.csi' index.
+  bool open(const std::string& vcf_file_name, const BGZRegionVector& regions);
+  bool open( const std::string& vcf_file_name,
+             const BGZRegionVector& regions,
+             size_t decompression_threads,
+             size_t vcf_parse_threads);
+
+  // Only the genotype columns of the listed samples are parsed, all samples if the list is empty. Call before open().
+  void selectSamples(const std::vector<std::string>& sample_list) { sample_selection_ = sample_list; }
+  // The samples (genomes) of the parsed genotype columns, the header genomes if no samples are selected.
+  [[nodiscard]] const std::vector<std::string>& sampleNames() const { return sample_projection_ ? sample_names_ : vcf_header_.getGenomes(); }
+  [[nodiscard]] bool sampleProjection() const { return sample_projection_; }
+
+  // Add the decompress and parse stages to the balancer after open(), only if the configuration is auto balanced.
+  // The decompress stage is only balanced for '.bgz' files.
+  void addBalancedStages(PipelineBalancer& balancer);
+  // The maximum threads of a balanced stage, zero if the stages are not balanced.
+  [[nodiscard]] size_t stageThreadLimit() const { return stage_thread_limit_; }
+  // The fraction of the parser pipeline holding parsed records waiting for the consumer threads.
+  [[nodiscard]] double recordOccupancy() const { return vcf_pipeline_.outputOccupancy(); }
+
+  // The pipeline stage names used in a PipelineConfig.
+  constexpr static const char* DECOMPRESS_STAGE{"decompress"};
+  constexpr static const char* PARSE_STAGE{"parse"};
+
+  // Export parsed VCF records further up the parser chain. Thread safe.
+  [[nodiscard]] VCFRecordPtr readVCFRecord();
+  // Append up to max_records parsed VCF records to the batch, returns the number of records appended. Thread safe.
+  // Blocks until at least one record is available, the batch ends after an EOF record.
+  size_t readVCFRecords(VCFRecordBlock& record_batch, size_t max_records);
 
   // Push an eof marker onto the queue
-  void enqueueEOF() { vcf_pipeline_.push(IOLineRecord::createEOFMarker()); }
+  void enqueueEOF() { vcf_pipeline_.push(IOLineBlock::createEOFMarker()); }
 
   [[nodiscard]] const std::string& getFileName() const { return file_name_; }
+  // The VCF header parsed by open().
+  [[nodiscard]] const VCFParseHeader& vcfHeader() const { return vcf_header_; }
+  // Access the parser pipeline queues for diagnostics.
+  [[nodiscard]] const VCFPipeline& workFlow() const { return vcf_pipeline_; }
 
 private:
 
   // Stream to read decompressed VCF records.
   std::unique_ptr<BaseStreamIO> stream_ptr_;
   std::string file_name_;
+  // The header parsed from the first lines of the stream.
+  VCFParseHeader vcf_header_;
+  // The sample allow-list and the selected header genotype columns (ascending) and sample names.
+  std::vector<std::string> sample_selection_;
+  bool sample_projection_{false};
+  std::vector<size_t> sample_columns_;
+  std::vector<std::string> sample_names_;
   // VCF queue worker threads
   static constexpr const long DECOMPRESSION_THREADS_{15};         // Threads decompressing bgz records.
   // VCF queue worker threads
   static constexpr const long PARSER_THREADS_{15};         // Threads parsing into vcf_records.
-  // Pipeline to parse the VCF line record into fields.
+  // Each queued line block holds the lines of a decompressed block.
+  static constexpr const size_t PIPELINE_HIGH_TIDE_{200};
+  static constexpr const size_t PIPELINE_LOW_TIDE_{100};
+  // The configured pipeline stages.
+  PipelineStageConfig decompress_stage_;
+  PipelineStageConfig parse_stage_;
+  // If non-zero then the stages are balanced and each stage has this many threads.
+  size_t stage_thread_limit_{0};
+  // Pipeline to parse the VCF line blocks into fields.
+  static constexpr const char* PIPELINE_NAME_{"ParseVCF Parse Pipeline"};
   VCFPipeline vcf_pipeline_;
+  // The block of parsed records currently read by readVCFRecord() and readVCFRecords().
+  VCFRecordBlock record_block_;
+  size_t record_index_{0};
+  std::mutex record_mutex_;
   // Read the decompressed line records and enqueue them in the VCF parser pipeline (1 thread).
   WorkflowThreads enqueue_thread_{1};
 
@@ -71,7 +145,7 @@ private:
   static constexpr const char HEADER_CHAR_{'#'};          // If first char start with '#' then a header record (skip).
   static constexpr const size_t MINIMUM_VCF_FIELDS_{8};   // At least 8 fields, any others are format and genotype fields (header specified).
   static constexpr const char VCF_FIELD_DELIMITER_CHAR_{'\t'};   // VCF Field separator (char).
-  const std::string FIELD_NOT_PRESENT_{"."}; // no field value
+  static constexpr const std::string_view FIELD_NOT_PRESENT_{"."}; // no field value
   // Mandatory Field Offsets.
   static constexpr const size_t CONTIG_FIELD_IDX_{0};
   static constexpr const size_t OFFSET_FIELD_IDX_{1};
@@ -83,8 +157,15 @@ private:
   static constexpr const size_t INFO_FIELD_IDX_{7};
   static constexpr const size_t FORMAT_FIELD_IDX_{8};
 
-  void enqueueLineRecord();
-  std::unique_ptr<const VCFRecord> moveToVcfRecord(IOLineRecord line_record);
+  void activateParser(const std::string& vcf_file_name, std::unique_ptr<BaseStreamIO> stream_ptr, size_t vcf_parse_threads);
+  // The threads created for a stage, more than the configured threads if the stage is balanced.
+  [[nodiscard]] size_t stageThreads(const PipelineStageConfig& stage_config) const { return std::max(stage_config.threads, stage_thread_limit_); }
+  bool readHeader();
+  // Map the sample allow-list to the header genotype columns.
+  void mapSampleColumns();
+  void enqueueLineBlock();
+  VCFRecordBlock moveToVcfRecords(IOLineBlock line_block);
+  std::unique_ptr<const VCFRecordView> parseVcfRecord(size_t line_count, std::string_view line_view);
 
 };
 
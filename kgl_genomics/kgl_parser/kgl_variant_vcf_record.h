@@ -7,7 +7,10 @@
 
 #include "kgl_genome_types.h"
 #include "kel_basic_io.h"
+#include "kel_utility.h"
+#include "kel_tokenizer.h"
 #include <string>
+#include <string_view>
 #include <vector>
 
 
@@ -15,69 +18,135 @@
 namespace kellerberrin::genome {   //  organization::project level namespace
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Basic VCF Record LIne.
+// Basic VCF Record Line.
+// The record owns the line text (a recycled pool buffer) and the parsed fields are views into the line,
+// so that parsing a record does not copy the fields. The genotype columns are only tokenised when
+// genotypeInfos() is first called, the view vector is also recycled. If the parser projects a sample subset then
+// only the selected genotype columns are tokenised, the other columns are skipped.
+// The field views are valid for the lifetime of the record, the record cannot be copied or moved.
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-class VCFRecord {
+class VCFRecordView {
 
 public:
 
-  explicit VCFRecord(IOLineRecord&& line_record) noexcept {
+  // Copy the line text from a line block.
+  VCFRecordView(size_t line_count, std::string_view line_view) : line_number(line_count), line_record_str_(IOLineRecord::linePool().acquire()) {
 
-    auto [line_count, line_str] = line_record.getLineData();
-    line_number = line_count;
-    line_record_str = (std::move(line_str));
+    line_record_str_.assign(line_view);
 
   }
-  ~VCFRecord() = default;
+  ~VCFRecordView() {
 
-  // Cannot copy this object.
-  VCFRecord(const VCFRecord& line_record) = delete;
-  VCFRecord& operator=(const VCFRecord&) = delete;
+    IOLineRecord::linePool().release(std::move(line_record_str_));
+    genotypePool().release(std::move(genotype_views_));
+
+  }
+
+  // Cannot copy or move this object.
+  VCFRecordView(const VCFRecordView&) = delete;
+  VCFRecordView& operator=(const VCFRecordView&) = delete;
 
   // The VCF text record and line count.
-  std::string line_record_str;
+  [[nodiscard]] std::string_view lineView() const { return line_record_str_; }
   size_t line_number{0};
   //
-  // Parsed VCF fields
+  // Parsed VCF fields, views into the line text.
   //
   // Id of the reference sequence.
-  ContigId_t contig_id;
+  std::string_view contig_id;
   // Position on the reference.
   ContigOffset_t offset{INVALID_POS};
   // Textual identifier of the variant.
-  std::string id;
+  std::string_view id;
   // Bases in the reference.
-  std::string ref;
+  std::string_view ref;
   // Bases in the alternatives, COMMA-separated.
-  std::string alt;
+  std::string_view alt;
   // Quality
   double qual{MISSING_QUAL};
   // Value of FILTER field.
-  std::string filter;
+  std::string_view filter;
   // Value of INFO field.
-  std::string info;
+  std::string_view info;
   // Value of FORMAT field.
-  std::string format;
-  // The genotype infos.
-  std::vector<std::string> genotypeInfos;
+  std::string_view format;
+  // The tab delimited genotype columns following the FORMAT field, empty if there are no genotypes.
+  std::string_view genotype_columns;
+
+  // The genotype infos, tokenised from the genotype columns on the first call.
+  // If a sample projection is set then only the selected columns are returned (in column order).
+  // Not thread safe, a record is processed by a single consumer thread.
+  [[nodiscard]] const std::vector<std::string_view>& genotypeInfos() const {
+
+    if (not genotypes_tokenised_) {
+
+      genotype_views_ = genotypePool().acquire();
+      genotype_views_.clear();
+      if (not genotype_columns.empty()) {
+
+        if (sample_columns_ != nullptr) {
+
+          FieldTokenizer::selectFields(genotype_columns, FIELD_DELIMITER_CHAR_, *sample_columns_, genotype_views_);
+
+        } else {
+
+          Utility::viewTokenizer(genotype_columns, FIELD_DELIMITER_CHAR_, genotype_views_);
+
+        }
+
+      }
+      genotypes_tokenised_ = true;
+
+    }
+
+    return genotype_views_;
+
+  }
+
+  // Select the (ascending) genotype column indices returned by genotypeInfos().
+  // The column vector is owned by the parser and must outlive the record.
+  void projectSamples(const std::vector<size_t>& sample_columns) { sample_columns_ = &sample_columns; }
 
   // Constant for invalid position.
   static constexpr const ContigOffset_t INVALID_POS = std::numeric_limits<ContigOffset_t>::max();
   // Undefined quality number.
   static constexpr const double MISSING_QUAL = std::numeric_limits<double>::lowest();
+  // VCF Field separator (char).
+  static constexpr const char FIELD_DELIMITER_CHAR_{'\t'};
 
   [[nodiscard]] bool EOFRecord() const { return EOF_; }
   // Create an EOF marker.
-  [[nodiscard]] static std::unique_ptr<const VCFRecord> createEOFMarker() { return std::unique_ptr<const VCFRecord>(new VCFRecord()); }
+  [[nodiscard]] static std::unique_ptr<const VCFRecordView> createEOFMarker() { return std::unique_ptr<const VCFRecordView>(new VCFRecordView()); }
+
+  // Recycled genotype view vectors.
+  [[nodiscard]] static BufferPool<std::vector<std::string_view>>& genotypePool() {
+
+    // Never destroyed, records may be released during static destruction.
+    static BufferPool<std::vector<std::string_view>>& genotype_pool = *(new BufferPool<std::vector<std::string_view>>(POOL_SLOTS_, GENOTYPE_POOL_MAX_CAPACITY_));
+    return genotype_pool;
+
+  }
 
 private:
 
+  // The owned line text, the field views refer to this buffer.
+  std::string line_record_str_;
+  // Lazily tokenised genotype columns.
+  mutable std::vector<std::string_view> genotype_views_;
+  mutable bool genotypes_tokenised_{false};
+  // The projected genotype columns, all columns if null.
+  const std::vector<size_t>* sample_columns_{nullptr};
+
   // EOF record constructor.
-  VCFRecord() { EOF_ = true; }
+  VCFRecordView() { EOF_ = true; }
   // The record represents an EOF marker if this flag is set.
   bool EOF_{false};
 
+  // Pooled buffers are only retained up to the peak number of records in the parser pipeline.
+  static constexpr const size_t POOL_SLOTS_{32768};
+  static constexpr const size_t GENOTYPE_POOL_MAX_CAPACITY_{1 << 16};
+
 };
 
 
@@ -4,7 +4,7 @@
 
 #include "kgl_variant_factory_vcf_evidence_analysis.h"
 #include "kgl_variant_sort.h"
-#include "kel_workflow_threads.h"
+#include "kel_executor.h"
 
 
 namespace kgl = kellerberrin::genome;
@@ -270,27 +270,28 @@ std::shared_ptr<kgl::VariantGenomeIndexMap> kgl::VariantSort::variantGenomeIndex
   }; // IndexMap object.
 
 
-  // Thread count strategy
-  size_t thread_count = WorkflowThreads::defaultThreads(population_ptr->getMap().size());
-  // Fire-up the threads.
-  WorkflowThreads thread_pool(thread_count);
-
-  using GenomeIndexFuture = std::future<std::shared_ptr<VariantIdIndexMap>>;
-  std::vector<std::pair<std::string, GenomeIndexFuture>> future_vector;
-
+  // Index each genome using the process-wide executor.
+  std::vector<std::pair<std::string, std::shared_ptr<const GenomeDB>>> genome_vector;
   for (auto const&[genome_id, genome_ptr] : population_ptr->getMap()) {
 
-    GenomeIndexFuture future = thread_pool.enqueueFuture(&IndexMap::indexGenome, genome_ptr);
-    future_vector.emplace_back(genome_id, std::move(future));
+    genome_vector.emplace_back(genome_id, genome_ptr);
 
   }
 
+  std::vector<std::shared_ptr<VariantIdIndexMap>> index_vector(genome_vector.size());
+  auto index_lambda = [&genome_vector, &index_vector](size_t index) {
+
+    index_vector[index] = IndexMap::indexGenome(genome_vector[index].second);
+
+  };
+  Executor::parallelFor(0, genome_vector.size(), index_lambda, 1);
+
   std::shared_ptr<VariantGenomeIndexMap> genome_index_map(std::make_shared<VariantGenomeIndexMap>());
-  // Retrieve the thread results into the map above.
-  for (auto &future : future_vector) {
+  // Retrieve the genome indexes into the map above.
+  for (size_t index = 0; index < genome_vector.size(); ++index) {
 
-    auto& [genome_id, genome_future] = future;
-    auto indexed_variant_ptr = genome_future.get();
+    auto const& genome_id = genome_vector[index].first;
+    auto const& indexed_variant_ptr = index_vector[index];
 
     auto [iter, result] = genome_index_map->try_emplace(genome_id, indexed_variant_ptr);
     if (not result) {
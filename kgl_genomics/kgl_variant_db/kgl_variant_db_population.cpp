@@ -4,7 +4,7 @@
 
 #include "kgl_variant_db_population.h"
 #include "kgl_variant_filter_db_variant.h"
-#include "kel_workflow_threads.h"
+#include "kel_executor.h"
 
 
 namespace kgl = kellerberrin::genome;
@@ -97,36 +97,9 @@ bool kgl::PopulationDB::addGenome(const std::shared_ptr<GenomeDB>& genome_ptr) {
 // Multi-thread for speed.
 size_t kgl::PopulationDB::variantCount() const {
 
-  // Check edge condition.
-  if (getMap().empty()) {
-
-    return 0;
-
-  }
-  // Calc how many threads required.
-  size_t thread_count = std::min(getMap().size(), WorkflowThreads::defaultThreads());
-  WorkflowThreads thread_pool(thread_count);
-  // A vector for futures.
-  std::vector<std::future<size_t>> future_vector;
-  // Thread pool work lambda
-  auto count_lambda =  [](const std::shared_ptr<const GenomeDB>& genome_ptr)->size_t { return genome_ptr->variantCount(); };
-  // Queue a thread for each genome.
-  for (auto const& [genome_id, genome_ptr] : getMap()) {
-
-    std::future<size_t> future = thread_pool.enqueueFuture(count_lambda, genome_ptr);
-    future_vector.push_back(std::move(future));
-
-  }
-
-  size_t variant_count{0};
-  // Add the genome variant counts.
-  for (auto& future : future_vector) {
-
-    variant_count += future.get();
-
-  }
-
-  return variant_count;
+  // Add the genome variant counts, each genome is counted by the process-wide executor.
+  auto count_lambda = [](const auto& genome_entry)->size_t { return genome_entry.second->variantCount(); };
+  return Executor::parallelReduce(getMap(), size_t{0}, count_lambda, std::plus<>(), 1);
 
 }
 
@@ -328,25 +301,10 @@ bool kgl::PopulationDB::addVariant( const std::shared_ptr<const Variant>& varian
 // Ensures that all variants are correctly specified.
 std::pair<size_t, size_t> kgl::PopulationDB::validate(const std::shared_ptr<const GenomeReference>& genome_db) const {
 
-  WorkflowThreads thread_pool(WorkflowThreads::defaultThreads());
-  std::vector<std::future<std::pair<size_t, size_t>>> future_vector;
-
-  // Queue a thread for each genome.
-  for (auto const& [genome_id, genome_ptr] : getMap()) {
-
-    // function, object_ptr, arg1
-    std::future<std::pair<size_t, size_t>> future = thread_pool.enqueueFuture(&GenomeDB::validate,
-                                                                              genome_ptr,
-                                                                              genome_db);
-    future_vector.push_back(std::move(future));
+  // Validate each genome using the process-wide executor.
+  auto validate_lambda = [this, &genome_db](const auto& genome_entry)->std::pair<size_t, size_t> {
 
-  }
-
-  // Check the results of the validation.
-  std::pair<size_t, size_t> population_count{0, 0};
-  for (auto& future : future_vector) {
-
-    std::pair<size_t, size_t> genome_count = future.get();
+    std::pair<size_t, size_t> genome_count = genome_entry.second->validate(genome_db);
 
     if (genome_count.first != genome_count.second) {
 
@@ -355,10 +313,17 @@ std::pair<size_t, size_t> kgl::PopulationDB::validate(const std::shared_ptr<cons
 
     }
 
-    population_count.first += genome_count.first;
-    population_count.second += genome_count.second;
+    return genome_count;
 
-  }
+  };
+
+  // Check the results of the validation.
+  auto add_lambda = [](std::pair<size_t, size_t> population_count, std::pair<size_t, size_t> genome_count)->std::pair<size_t, size_t> {
+
+    return {population_count.first + genome_count.first, population_count.second + genome_count.second};
+
+  };
+  std::pair<size_t, size_t> population_count = Executor::parallelReduce(getMap(), std::pair<size_t, size_t>{0, 0}, validate_lambda, add_lambda, 1);
 
   return population_count;
 
@@ -385,50 +350,23 @@ bool kgl::PopulationDB::processAll(const VariantProcessFunc& objFunc)  const {
 
 bool kgl::PopulationDB::processAll_MT(const GenomeProcessFunc& objFunc)  const {
 
-  // Calc how many threads required.
-  size_t thread_count = std::min(getMap().size(), WorkflowThreads::defaultThreads());
-  WorkflowThreads thread_pool(thread_count);
-  // A vector for thread futures.
-  std::vector<std::future<std::pair<bool, GenomeId_t>>> future_vector;
-
-  // Local structure in which to define an appropriate static routine.
-  struct genomeClass {
+  // Process each genome using the process-wide executor.
+  auto genome_lambda = [&objFunc](const auto& genome_entry)->bool {
 
-    // All arguments are passed by value.
-    static std::pair<bool, GenomeId_t> processGenome(std::shared_ptr<const GenomeDB> genome_ptr, GenomeProcessFunc objFunc) {
+    auto const& [genome_id, genome_ptr] = genome_entry;
+    VariantProcessFunc callable = std::bind_front(objFunc, genome_ptr);
+    if (not genome_ptr->processAll(callable)) {
 
-      VariantProcessFunc callable = std::bind_front(objFunc, genome_ptr);
-      bool result = genome_ptr->processAll(callable);
-      GenomeId_t genome = genome_ptr->genomeId();
-      return {result, genome};
+      ExecEnv::log().error("PopulationDB::processAll_MT<Obj>; error with genome: {}", genome_id);
+      return false;
 
     }
 
-  };
-
-  // Queue a thread for each genome.
-  for (const auto& [genome_id, genome_ptr] : getMap()) {
+    return true;
 
-    std::future<std::pair<bool, GenomeId_t>> future = thread_pool.enqueueFuture(&genomeClass::processGenome, genome_ptr, objFunc);
-    future_vector.push_back(std::move(future));
-
-  }
-
-  // Wait for the threads to finish.
-  bool process_result{true};
-  for (auto& future : future_vector) {
-
-    auto [result, genome] = future.get();
-    if (not result) {
-
-      ExecEnv::log().error("PopulationDB::processAll_MT<Obj>; error with genome: {}", genome);
-      process_result = false;
-
-    }
-
-  }
+  };
 
-  return process_result;
+  return Executor::parallelReduce(getMap(), true, genome_lambda, std::logical_and<>(), 1);
 
 }
 
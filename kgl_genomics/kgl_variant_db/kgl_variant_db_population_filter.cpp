@@ -5,7 +5,7 @@
 
 #include "kgl_variant_db_population.h"
 #include "kgl_variant_filter_db_variant.h"
-#include "kel_workflow_threads.h"
+#include "kel_executor.h"
 
 
 namespace kgl = kellerberrin::genome;
@@ -34,40 +34,19 @@ std::unique_ptr<kgl::PopulationDB> kgl::PopulationDB::viewFilter(const BaseFilte
 
   }
 
-  // All other filters are multi-threaded for each genome.
-  // Calc how many threads required.
-  size_t thread_count = WorkflowThreads::defaultThreads(getMap().size());
-  WorkflowThreads thread_pool(thread_count);
-  // A vector for futures.
-  std::vector<std::future<std::shared_ptr<GenomeDB>>> future_vector;
-  // The thread lambda.
-  auto filter_lambda = [](std::shared_ptr<const GenomeDB> genome_ptr,
-                          const BaseFilter& filter)-> std::shared_ptr<GenomeDB> {
+  // All other filters are multi-threaded for each genome using the process-wide executor.
+  auto filter_lambda = [&filtered_population_ptr, &filter](const auto& genome_entry) {
 
-    return genome_ptr->viewFilter(filter);
-
-  };
-
-  // Queue a thread for each genome.
-  for (auto const& [genome_id, genome_ptr] : getMap()) {
-
-    std::future<std::shared_ptr<GenomeDB>> future = thread_pool.enqueueFuture(filter_lambda, genome_ptr, std::ref(filter));
-    future_vector.push_back(std::move(future));
-
-  }
-
-
-  // Add in the filtered genomes.
-  for (auto& future : future_vector) {
-
-    std::shared_ptr<GenomeDB> filtered_genome_ptr = future.get();
+    // Add in the filtered genome.
+    std::shared_ptr<GenomeDB> filtered_genome_ptr = genome_entry.second->viewFilter(filter);
     if (not filtered_population_ptr->addGenome(filtered_genome_ptr)) {
 
       ExecEnv::log().error("PopulationDB::filter; could not add filtered genome to the population");
 
     }
 
-  }
+  };
+  Executor::parallelFor(getMap(), filter_lambda, 1);
 
   return filtered_population_ptr;
 
@@ -103,38 +82,20 @@ std::pair<size_t, size_t> kgl::PopulationDB::selfFilter(const BaseFilter& filter
 
   }
 
-  // All other filters are multi-threaded for each genome.
-  // Calc how many threads required.
-  size_t thread_count = WorkflowThreads::defaultThreads(getMap().size());
-  WorkflowThreads thread_pool(thread_count);
-  // A vector for futures.
-  std::vector<std::future<std::pair<size_t, size_t>>> future_vector;
-  // Required by the thread pool.
-
-  auto filter_lambda = [](std::shared_ptr<GenomeDB> genome_ptr,
-                          const BaseFilter& filter) -> std::pair<size_t, size_t> {
+  // All other filters are multi-threaded for each genome using the process-wide executor.
+  auto filter_lambda = [&filter](const auto& genome_entry) -> std::pair<size_t, size_t> {
 
-    return genome_ptr->selfFilter(filter);
+    return genome_entry.second->selfFilter(filter);
 
   };
 
-  // Queue a thread for each genome.
-  for (auto& [genome_id, genome_ptr] : getMap()) {
+  // Add the genome filter counts.
+  auto add_lambda = [](std::pair<size_t, size_t> filter_counts, std::pair<size_t, size_t> genome_counts) -> std::pair<size_t, size_t> {
 
-    std::future<std::pair<size_t, size_t>> future = thread_pool.enqueueFuture(filter_lambda, genome_ptr, std::ref(filter));
-    future_vector.push_back(std::move(future));
-
-  }
+    return {filter_counts.first + genome_counts.first, filter_counts.second + genome_counts.second};
 
-  // Wait for the threads to finish.
-  std::pair<size_t, size_t> filter_counts{0, 0};
-  for (auto& future : future_vector) {
-
-    auto [original_count, filtered_count] = future.get();
-    filter_counts.first += original_count;
-    filter_counts.second += filtered_count;
-
-  }
+  };
+  std::pair<size_t, size_t> filter_counts = Executor::parallelReduce(getMap(), std::pair<size_t, size_t>{0, 0}, filter_lambda, add_lambda, 1);
 
   return filter_counts;
 
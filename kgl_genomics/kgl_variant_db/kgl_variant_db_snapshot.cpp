@@ -0,0 +1,1183 @@
+//
+// Created by kellerberrin on 17/10/23.
+//
+
+#include "kgl_variant_db_snapshot.h"
+#include "kel_file_io.h"
+#include "kel_utility.h"
+
+#include <array>
+#include <algorithm>
+#include <span>
+#include <fstream>
+#include <filesystem>
+#include <format>
+#include <unordered_map>
+#include <type_traits>
+#include <limits>
+#include <cstring>
+
+
+namespace kel = kellerberrin;
+namespace kgl = kellerberrin::genome;
+namespace fs = std::filesystem;
+
+
+namespace {   // Snapshot serialization.
+
+using SnapshotMarker = std::array<char, 8>;
+constexpr const SnapshotMarker SNAPSHOT_MAGIC{'K', 'G', 'L', 'S', 'N', 'A', 'P', '\0'};
+constexpr const SnapshotMarker SNAPSHOT_END{'K', 'G', 'L', 'E', 'N', 'D', '\0', '\0'};
+// Detects a snapshot written on a machine with a different byte order.
+constexpr const uint32_t BYTE_ORDER_MARK{0x01020304};
+// A variant without an INFO data block.
+constexpr const uint64_t NO_DATA_BLOCK{std::numeric_limits<uint64_t>::max()};
+constexpr const size_t WRITE_BUFFER_SIZE{1024 * 1024};
+
+
+// Checksum of the snapshot payload, processed as 8 byte words. Incremental updates must be a multiple of the word
+// size, only the final update can contain a partial word.
+class PayloadChecksum {
+
+public:
+
+  PayloadChecksum() = default;
+  ~PayloadChecksum() = default;
+
+  void update(std::string_view bytes) {
+
+    size_t position{0};
+    for (; position + sizeof(uint64_t) <= bytes.size(); position += sizeof(uint64_t)) {
+
+      uint64_t word{0};
+      std::memcpy(&word, bytes.data() + position, sizeof(uint64_t));
+      mix(word);
+
+    }
+
+    for (; position < bytes.size(); ++position) {
+
+      mix(static_cast<uint8_t>(bytes[position]));
+
+    }
+
+    byte_count_ += bytes.size();
+
+  }
+
+  [[nodiscard]] uint64_t value() const { return checksum_ ^ byte_count_; }
+
+private:
+
+  constexpr static const uint64_t CHECKSUM_SEED_{0xCBF29CE484222325ULL};
+  constexpr static const uint64_t CHECKSUM_MULTIPLIER_{0x9E3779B97F4A7C15ULL};
+
+  uint64_t checksum_{CHECKSUM_SEED_};
+  uint64_t byte_count_{0};
+
+  void mix(uint64_t word) {
+
+    checksum_ = (checksum_ ^ word) * CHECKSUM_MULTIPLIER_;
+    checksum_ ^= checksum_ >> 32;
+
+  }
+
+};
+
+
+// Native byte order binary writer, all values are written unaligned.
+// The payload is buffered and checksummed, the checksum is appended to the snapshot by finish().
+class SnapshotWriter {
+
+public:
+
+  explicit SnapshotWriter(std::ostream& stream) : stream_(stream) { write_buffer_.reserve(WRITE_BUFFER_SIZE); }
+  ~SnapshotWriter() = default;
+
+  template<typename T> requires std::is_trivially_copyable_v<T>
+  void write(const T& value) { append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+  void writeString(std::string_view text) {
+
+    write<uint64_t>(text.size());
+    append(text.data(), text.size());
+
+  }
+
+  void writeBytes(std::span<const std::byte> bytes) {
+
+    write<uint64_t>(bytes.size());
+    append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+
+  }
+
+  // Flush the payload and append the payload checksum.
+  void finish() {
+
+    flush();
+    const uint64_t checksum = checksum_.value();
+    stream_.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+    stream_.flush();
+
+  }
+
+  [[nodiscard]] bool good() const { return stream_.good(); }
+
+private:
+
+  std::ostream& stream_;
+  std::vector<char> write_buffer_;
+  PayloadChecksum checksum_;
+
+  // The buffer is only flushed when full, so intermediate checksum updates are a multiple of the checksum word size.
+  static_assert(WRITE_BUFFER_SIZE % sizeof(uint64_t) == 0);
+
+  void append(const char* data, size_t size) {
+
+    while (size > 0) {
+
+      const size_t copy_size = std::min(size, WRITE_BUFFER_SIZE - write_buffer_.size());
+      write_buffer_.insert(write_buffer_.end(), data, data + copy_size);
+      data += copy_size;
+      size -= copy_size;
+      if (write_buffer_.size() == WRITE_BUFFER_SIZE) {
+
+        flush();
+
+      }
+
+    }
+
+  }
+
+  void flush() {
+
+    checksum_.update(std::string_view(write_buffer_.data(), write_buffer_.size()));
+    stream_.write(write_buffer_.data(), static_cast<std::streamsize>(write_buffer_.size()));
+    write_buffer_.clear();
+
+  }
+
+};
+
+
+// Reads the memory mapped snapshot. All reads are bounds checked, a failed read marks the snapshot as invalid.
+class SnapshotReader {
+
+public:
+
+  explicit SnapshotReader(std::string_view snapshot_view) : snapshot_view_(snapshot_view) {}
+  ~SnapshotReader() = default;
+
+  template<typename T> requires std::is_trivially_copyable_v<T>
+  [[nodiscard]] bool read(T& value) {
+
+    if (remaining() < sizeof(T)) {
+
+      return false;
+
+    }
+
+    std::memcpy(&value, snapshot_view_.data() + position_, sizeof(T));
+    position_ += sizeof(T);
+    return true;
+
+  }
+
+  [[nodiscard]] bool readString(std::string& text) {
+
+    std::string_view text_view;
+    if (not readView(text_view)) {
+
+      return false;
+
+    }
+
+    text = std::string(text_view);
+    return true;
+
+  }
+
+  // The returned view is valid while the snapshot is mapped.
+  [[nodiscard]] bool readView(std::string_view& text_view) {
+
+    uint64_t size{0};
+    if (not read(size) or remaining() < size) {
+
+      return false;
+
+    }
+
+    text_view = snapshot_view_.substr(position_, size);
+    position_ += size;
+    return true;
+
+  }
+
+  [[nodiscard]] bool readBytes(std::span<const std::byte>& bytes) {
+
+    std::string_view byte_view;
+    if (not readView(byte_view)) {
+
+      return false;
+
+    }
+
+    bytes = std::as_bytes(std::span<const char>(byte_view.data(), byte_view.size()));
+    return true;
+
+  }
+
+  // A count of objects that each occupy at least one byte, guards against allocating a corrupt count.
+  [[nodiscard]] bool readCount(uint64_t& count) { return read(count) and count <= remaining(); }
+
+  [[nodiscard]] size_t remaining() const { return snapshot_view_.size() - position_; }
+
+private:
+
+  std::string_view snapshot_view_;
+  size_t position_{0};
+
+};
+
+
+void writeStringVector(SnapshotWriter& writer, const std::vector<std::string>& text_vector) {
+
+  writer.write<uint64_t>(text_vector.size());
+  for (auto const& text : text_vector) {
+
+    writer.writeString(text);
+
+  }
+
+}
+
+
+bool readStringVector(SnapshotReader& reader, std::vector<std::string>& text_vector) {
+
+  uint64_t text_count{0};
+  if (not reader.readCount(text_count)) {
+
+    return false;
+
+  }
+
+  text_vector.resize(text_count);
+  for (auto& text : text_vector) {
+
+    if (not reader.readString(text)) {
+
+      return false;
+
+    }
+
+  }
+
+  return true;
+
+}
+
+
+void writeKey(SnapshotWriter& writer, const kgl::PopulationSnapshotKey& key) {
+
+  writer.write(key.file_size);
+  writer.write(key.file_time);
+  writer.write(key.file_checksum);
+  writer.write(key.parser_type);
+  writer.write(key.data_source);
+  writer.writeString(key.population_id);
+  writer.writeString(key.reference_genome);
+  writeStringVector(writer, key.info_fields);
+  writeStringVector(writer, key.samples);
+  writeStringVector(writer, key.regions);
+
+}
+
+
+bool readKey(SnapshotReader& reader, kgl::PopulationSnapshotKey& key) {
+
+  return reader.read(key.file_size)
+         and reader.read(key.file_time)
+         and reader.read(key.file_checksum)
+         and reader.read(key.parser_type)
+         and reader.read(key.data_source)
+         and reader.readString(key.population_id)
+         and reader.readString(key.reference_genome)
+         and readStringVector(reader, key.info_fields)
+         and readStringVector(reader, key.samples)
+         and readStringVector(reader, key.regions);
+
+}
+
+
+// The VCF INFO records of the subscribed fields, followed by the resource handle of each subscribed field.
+// The handles are used to verify that the recreated header has the same data block layout.
+void writeInfoHeader(SnapshotWriter& writer, const kgl::InfoEvidenceHeader& info_header) {
+
+  writer.write<uint64_t>(info_header.getConstMap().size());
+  for (auto const& [field_ident, subscribed_field] : info_header.getConstMap()) {
+
+    const kgl::VCFInfoRecord& info_record = subscribed_field.infoVCF();
+    writer.writeString(info_record.ID);
+    writer.writeString(info_record.description);
+    writer.writeString(info_record.type);
+    writer.writeString(info_record.number);
+    writer.writeString(info_record.source);
+    writer.writeString(info_record.version);
+
+  }
+
+  for (auto const& [field_ident, subscribed_field] : info_header.getConstMap()) {
+
+    const kgl::InfoResourceHandle& handle = subscribed_field.getDataHandle();
+    writer.writeString(field_ident);
+    writer.write<uint64_t>(handle.handleId());
+    writer.write<uint64_t>(handle.initialDataOffset());
+    writer.write<uint64_t>(handle.initialDataSize());
+    writer.write(static_cast<uint32_t>(handle.dynamicType()));
+    writer.write(static_cast<uint32_t>(handle.resourceType()));
+
+  }
+
+}
+
+
+std::optional<std::shared_ptr<const kgl::InfoEvidenceHeader>> readInfoHeader(SnapshotReader& reader, const kgl::EvidenceInfoSet& info_fields) {
+
+  uint64_t record_count{0};
+  if (not reader.readCount(record_count)) {
+
+    return std::nullopt;
+
+  }
+
+  kgl::VCFInfoRecordMap info_record_map;
+  for (uint64_t index = 0; index < record_count; ++index) {
+
+    kgl::VCFInfoRecord info_record;
+    if (not reader.readString(info_record.ID)
+        or not reader.readString(info_record.description)
+        or not reader.readString(info_record.type)
+        or not reader.readString(info_record.number)
+        or not reader.readString(info_record.source)
+        or not reader.readString(info_record.version)) {
+
+      return std::nullopt;
+
+    }
+    info_record_map.emplace(info_record.ID, std::move(info_record));
+
+  }
+
+  // Subscribe the saved fields, the subscription order and therefore the data layout is the same as the parsed VCF.
+  kgl::EvidenceFactory evidence_factory(info_fields);
+  evidence_factory.availableInfoFields(info_record_map);
+  std::shared_ptr<const kgl::InfoEvidenceHeader> info_header = evidence_factory.getInfoHeader();
+
+  if (info_header->getConstMap().size() != record_count) {
+
+    return std::nullopt;
+
+  }
+
+  for (auto const& [field_ident, subscribed_field] : info_header->getConstMap()) {
+
+    std::string saved_ident;
+    uint64_t handle_id{0}, data_offset{0}, data_size{0};
+    uint32_t dynamic_type{0}, resource_type{0};
+    if (not reader.readString(saved_ident)
+        or not reader.read(handle_id)
+        or not reader.read(data_offset)
+        or not reader.read(data_size)
+        or not reader.read(dynamic_type)
+        or not reader.read(resource_type)) {
+
+      return std::nullopt;
+
+    }
+
+    const kgl::InfoResourceHandle& handle = subscribed_field.getDataHandle();
+    if (saved_ident != field_ident
+        or handle_id != handle.handleId()
+        or data_offset != handle.initialDataOffset()
+        or data_size != handle.initialDataSize()
+        or dynamic_type != static_cast<uint32_t>(handle.dynamicType())
+        or resource_type != static_cast<uint32_t>(handle.resourceType())) {
+
+      kel::ExecEnv::log().warn("PopulationSnapshot; INFO field: {} data layout differs from the saved layout", field_ident);
+      return std::nullopt;
+
+    }
+
+  }
+
+  return info_header;
+
+}
+
+
+void writeDataBlock(SnapshotWriter& writer, const kgl::DataMemoryBlock& data_block) {
+
+  const kgl::DataBlockImage block_image = data_block.blockImage();
+
+  writer.write(block_image.mem_count.charCount());
+  writer.write(block_image.mem_count.integerCount());
+  writer.write(block_image.mem_count.floatCount());
+  writer.write(block_image.mem_count.arrayCount());
+  writer.write(block_image.mem_count.stringCount());
+
+  writer.writeBytes(block_image.char_bytes);
+  writer.writeBytes(block_image.integer_bytes);
+  writer.writeBytes(block_image.float_bytes);
+
+  for (auto const& array_index : block_image.array_index) {
+
+    writer.write<uint64_t>(array_index.infoVariableIndex());
+    writer.write<uint64_t>(array_index.infoOffset());
+    writer.write<uint64_t>(array_index.infoSize());
+
+  }
+
+  for (auto const& [char_offset, string_size] : block_image.string_index) {
+
+    writer.write(char_offset);
+    writer.write(string_size);
+
+  }
+
+}
+
+
+std::optional<std::shared_ptr<const kgl::DataMemoryBlock>> readDataBlock( SnapshotReader& reader,
+                                                                          const std::shared_ptr<const kgl::InfoEvidenceHeader>& info_header) {
+
+  uint32_t char_count{0}, integer_count{0}, float_count{0}, array_count{0}, string_count{0};
+  if (not reader.read(char_count)
+      or not reader.read(integer_count)
+      or not reader.read(float_count)
+      or not reader.read(array_count)
+      or not reader.read(string_count)) {
+
+    return std::nullopt;
+
+  }
+
+  kgl::DataBlockImage block_image;
+  block_image.mem_count.charCount(char_count);
+  block_image.mem_count.integerCount(integer_count);
+  block_image.mem_count.floatCount(float_count);
+  block_image.mem_count.arrayCount(array_count);
+  block_image.mem_count.stringCount(string_count);
+
+  if (not reader.readBytes(block_image.char_bytes)
+      or not reader.readBytes(block_image.integer_bytes)
+      or not reader.readBytes(block_image.float_bytes)
+      or block_image.char_bytes.size() != char_count
+      or block_image.integer_bytes.size() != integer_count * sizeof(kgl::InfoIntegerType)
+      or block_image.float_bytes.size() != float_count * sizeof(kgl::InfoFloatType)
+      or reader.remaining() < array_count * (3 * sizeof(uint64_t)) + string_count * (2 * sizeof(uint32_t))) {
+
+    return std::nullopt;
+
+  }
+
+  block_image.array_index.reserve(array_count);
+  for (uint32_t index = 0; index < array_count; ++index) {
+
+    uint64_t variable_index{0}, element_offset{0}, element_count{0};
+    if (not reader.read(variable_index) or not reader.read(element_offset) or not reader.read(element_count)) {
+
+      return std::nullopt;
+
+    }
+    block_image.array_index.emplace_back(variable_index, element_offset, element_count);
+
+  }
+
+  block_image.string_index.reserve(string_count);
+  for (uint32_t index = 0; index < string_count; ++index) {
+
+    uint32_t char_offset{0}, string_size{0};
+    if (not reader.read(char_offset) or not reader.read(string_size)
+        or static_cast<uint64_t>(char_offset) + string_size > char_count) {
+
+      return std::nullopt;
+
+    }
+    block_image.string_index.emplace_back(char_offset, string_size);
+
+  }
+
+  return std::make_shared<const kgl::DataMemoryBlock>(info_header, block_image);
+
+}
+
+
+void writeVariant( SnapshotWriter& writer,
+                   const kgl::Variant& variant,
+                   uint32_t contig_index,
+                   uint64_t block_index) {
+
+  writer.write(contig_index);
+  writer.write<uint64_t>(variant.offset());
+  writer.write(static_cast<uint8_t>(variant.phaseId()));
+  writer.writeString(variant.identifier());
+  writer.writeString(variant.reference().getStringView());
+  writer.writeString(variant.alternate().getStringView());
+
+  const kgl::VariantEvidence& evidence = variant.evidence();
+  writer.write<uint64_t>(evidence.vcfRecordCount());
+  writer.write<uint8_t>(evidence.passFilter() ? 1 : 0);
+  writer.write(block_index);
+  writer.write(evidence.altVariantIndex());
+  writer.write(evidence.altVariantCount());
+
+  auto format_data_opt = evidence.formatData();
+  writer.write<uint8_t>(format_data_opt ? 1 : 0);
+  if (format_data_opt) {
+
+    const kgl::FormatData& format_data = *format_data_opt.value();
+    writer.write<uint64_t>(format_data.refCount());
+    writer.write<uint64_t>(format_data.altCount());
+    writer.write<uint64_t>(format_data.DPCount());
+    writer.write(format_data.GQProbWrongVariant());
+    writer.write(format_data.Quality());
+
+  }
+
+}
+
+
+std::optional<std::shared_ptr<const kgl::Variant>> readVariant( SnapshotReader& reader,
+                                                                 kgl::DataSourceEnum data_source,
+                                                                 const std::vector<kgl::ContigId_t>& contig_ids,
+                                                                 const std::vector<std::shared_ptr<const kgl::DataMemoryBlock>>& data_blocks) {
+
+  uint32_t contig_index{0};
+  uint64_t offset{0};
+  uint8_t phase{0};
+  std::string identifier;
+  std::string_view reference;
+  std::string_view alternate;
+  if (not reader.read(contig_index)
+      or not reader.read(offset)
+      or not reader.read(phase)
+      or not reader.readString(identifier)
+      or not reader.readView(reference)
+      or not reader.readView(alternate)
+      or contig_index >= contig_ids.size()) {
+
+    return std::nullopt;
+
+  }
+
+  uint64_t record_count{0};
+  uint8_t pass_filter{0};
+  uint64_t block_index{0};
+  uint32_t alt_index{0}, alt_count{0};
+  uint8_t has_format{0};
+  if (not reader.read(record_count)
+      or not reader.read(pass_filter)
+      or not reader.read(block_index)
+      or not reader.read(alt_index)
+      or not reader.read(alt_count)
+      or not reader.read(has_format)
+      or (block_index != NO_DATA_BLOCK and block_index >= data_blocks.size())) {
+
+    return std::nullopt;
+
+  }
+
+  std::shared_ptr<const kgl::FormatData> format_data;
+  if (has_format != 0) {
+
+    uint64_t ref_count{0}, format_alt_count{0}, DP_count{0};
+    float GQ_value{0.0}, quality{0.0};
+    if (not reader.read(ref_count)
+        or not reader.read(format_alt_count)
+        or not reader.read(DP_count)
+        or not reader.read(GQ_value)
+        or not reader.read(quality)) {
+
+      return std::nullopt;
+
+    }
+    format_data = std::make_shared<const kgl::FormatData>(ref_count, format_alt_count, DP_count, GQ_value, quality);
+
+  }
+
+  std::shared_ptr<const kgl::DataMemoryBlock> data_block = block_index == NO_DATA_BLOCK ? nullptr : data_blocks[block_index];
+  kgl::VariantEvidence evidence(record_count, data_source, pass_filter != 0, data_block, format_data, alt_index, alt_count);
+
+  return std::make_shared<const kgl::Variant>( contig_ids[contig_index],
+                                               offset,
+                                               static_cast<kgl::VariantPhase>(phase),
+                                               std::move(identifier),
+                                               kgl::DNA5SequenceLinear(kgl::StringDNA5(std::string(reference))),
+                                               kgl::DNA5SequenceLinear(kgl::StringDNA5(std::string(alternate))),
+                                               evidence);
+
+}
+
+
+} // end anonymous namespace.
+
+
+std::optional<kgl::PopulationSnapshotKey> kgl::PopulationSnapshot::createKey( const std::string& file_name,
+                                                                              ParserTypeEnum parser_type,
+                                                                              DataSourceEnum data_source,
+                                                                              const std::string& population_id,
+                                                                              const std::string& reference_genome,
+                                                                              const EvidenceInfoSet& info_fields,
+                                                                              const std::vector<std::string>& samples,
+                                                                              const BGZRegionVector& regions) {
+
+  std::error_code error_code;
+  auto file_size = fs::file_size(file_name, error_code);
+  if (error_code) {
+
+    ExecEnv::log().warn("PopulationSnapshot::createKey; cannot read the size of file: {}, error: {}", file_name, error_code.message());
+    return std::nullopt;
+
+  }
+
+  auto file_time = fs::last_write_time(file_name, error_code);
+  if (error_code) {
+
+    ExecEnv::log().warn("PopulationSnapshot::createKey; cannot read the modification time of file: {}, error: {}", file_name, error_code.message());
+    return std::nullopt;
+
+  }
+
+  auto file_checksum = sampledChecksum(file_name, file_size);
+  if (not file_checksum) {
+
+    return std::nullopt;
+
+  }
+
+  PopulationSnapshotKey key;
+  key.file_size = file_size;
+  key.file_time = static_cast<int64_t>(file_time.time_since_epoch().count());
+  key.file_checksum = file_checksum.value();
+  key.parser_type = static_cast<uint32_t>(parser_type);
+  key.data_source = static_cast<uint32_t>(data_source);
+  key.population_id = population_id;
+  key.reference_genome = reference_genome;
+  key.info_fields.assign(info_fields.begin(), info_fields.end());
+  key.samples = samples;
+  for (auto const& region : regions) {
+
+    key.regions.push_back(region.toString());
+
+  }
+
+  return key;
+
+}
+
+
+std::optional<uint64_t> kgl::PopulationSnapshot::sampledChecksum(const std::string& file_name, uint64_t file_size) {
+
+  std::ifstream file(file_name, std::ios::binary);
+  if (not file.good()) {
+
+    ExecEnv::log().warn("PopulationSnapshot::sampledChecksum; cannot open file: {}", file_name);
+    return std::nullopt;
+
+  }
+
+  // FNV-1a over the sampled blocks, small files are checksummed completely.
+  constexpr const uint64_t FNV_OFFSET_BASIS{14695981039346656037ULL};
+  constexpr const uint64_t FNV_PRIME{1099511628211ULL};
+  uint64_t checksum{FNV_OFFSET_BASIS};
+
+  const uint64_t sampled_size = CHECKSUM_SAMPLES_ * CHECKSUM_BLOCK_SIZE_;
+  const size_t sample_count = file_size <= sampled_size ? 1 : CHECKSUM_SAMPLES_;
+  const uint64_t block_size = file_size <= sampled_size ? file_size : CHECKSUM_BLOCK_SIZE_;
+  std::vector<char> block_buffer(block_size);
+  for (size_t sample = 0; sample < sample_count; ++sample) {
+
+    // Evenly spaced, the first block is at the start and the last block at the end of the file.
+    uint64_t block_offset = sample_count == 1 ? 0 : (sample * (file_size - block_size)) / (sample_count - 1);
+    file.seekg(static_cast<std::streamoff>(block_offset));
+    file.read(block_buffer.data(), static_cast<std::streamsize>(block_size));
+    if (not file.good()) {
+
+      ExecEnv::log().warn("PopulationSnapshot::sampledChecksum; error reading file: {}, offset: {}", file_name, block_offset);
+      return std::nullopt;
+
+    }
+
+    for (auto byte : block_buffer) {
+
+      checksum = (checksum ^ static_cast<uint8_t>(byte)) * FNV_PRIME;
+
+    }
+
+  }
+
+  return checksum;
+
+}
+
+
+uint64_t kgl::PopulationSnapshot::payloadChecksum(std::string_view payload) {
+
+  PayloadChecksum payload_checksum;
+  payload_checksum.update(payload);
+  return payload_checksum.value();
+
+}
+
+
+std::string kgl::PopulationSnapshot::snapshotFileName(const std::string& snapshot_directory, const std::string& file_name) {
+
+  // VCF files with the same name in different directories have different snapshot files.
+  std::error_code error_code;
+  std::string absolute_path = fs::absolute(file_name, error_code).string();
+  if (error_code) {
+
+    absolute_path = file_name;
+
+  }
+  std::string snapshot_name = std::format("{}.{:08x}{}",
+                                          fs::path(file_name).filename().string(),
+                                          Utility::hash(absolute_path),
+                                          SNAPSHOT_EXTENSION_);
+
+  return Utility::filePath(snapshot_name, snapshot_directory);
+
+}
+
+
+std::optional<std::shared_ptr<kgl::PopulationDB>> kgl::PopulationSnapshot::readSnapshot( const std::string& snapshot_file,
+                                                                                        const PopulationSnapshotKey& key) {
+
+  std::error_code error_code;
+  if (not fs::exists(snapshot_file, error_code)) {
+
+    return std::nullopt;
+
+  }
+
+  MMapStreamIO snapshot_stream;
+  if (not snapshot_stream.open(snapshot_file)) {
+
+    return std::nullopt;
+
+  }
+
+  // Verify the payload checksum before reading, detects a corrupt snapshot that would otherwise parse.
+  std::string_view snapshot_view = snapshot_stream.mappedView();
+  uint64_t saved_checksum{0};
+  if (snapshot_view.size() < sizeof(saved_checksum)) {
+
+    ExecEnv::log().warn("PopulationSnapshot::readSnapshot; snapshot: {} is truncated, ignored", snapshot_file);
+    return std::nullopt;
+
+  }
+
+  snapshot_view.remove_suffix(sizeof(saved_checksum));
+  std::memcpy(&saved_checksum, snapshot_view.data() + snapshot_view.size(), sizeof(saved_checksum));
+  if (payloadChecksum(snapshot_view) != saved_checksum) {
+
+    ExecEnv::log().warn("PopulationSnapshot::readSnapshot; snapshot: {} checksum mismatch, ignored", snapshot_file);
+    return std::nullopt;
+
+  }
+
+  SnapshotReader reader(snapshot_view);
+
+  SnapshotMarker magic{};
+  uint32_t version{0}, byte_order{0}, integer_size{0}, float_size{0};
+  if (not reader.read(magic)
+      or magic != SNAPSHOT_MAGIC
+      or not reader.read(version)
+      or version != SNAPSHOT_VERSION_
+      or not reader.read(byte_order)
+      or byte_order != BYTE_ORDER_MARK
+      or not reader.read(integer_size)
+      or integer_size != sizeof(InfoIntegerType)
+      or not reader.read(float_size)
+      or float_size != sizeof(InfoFloatType)) {
+
+    ExecEnv::log().info("PopulationSnapshot::readSnapshot; snapshot: {} has an incompatible format, ignored", snapshot_file);
+    return std::nullopt;
+
+  }
+
+  PopulationSnapshotKey saved_key;
+  if (not readKey(reader, saved_key) or saved_key != key) {
+
+    ExecEnv::log().info("PopulationSnapshot::readSnapshot; snapshot: {} does not match the input file or projection, ignored", snapshot_file);
+    return std::nullopt;
+
+  }
+
+  const EvidenceInfoSet info_fields(key.info_fields.begin(), key.info_fields.end());
+  uint8_t has_info_header{0};
+  if (not reader.read(has_info_header)) {
+
+    return std::nullopt;
+
+  }
+
+  std::shared_ptr<const InfoEvidenceHeader> info_header;
+  if (has_info_header != 0) {
+
+    auto info_header_opt = readInfoHeader(reader, info_fields);
+    if (not info_header_opt) {
+
+      ExecEnv::log().warn("PopulationSnapshot::readSnapshot; snapshot: {} INFO header is invalid, ignored", snapshot_file);
+      return std::nullopt;
+
+    }
+    info_header = info_header_opt.value();
+
+  }
+
+  // Contig identifiers.
+  uint64_t contig_count{0};
+  if (not reader.readCount(contig_count)) {
+
+    return std::nullopt;
+
+  }
+
+  std::vector<ContigId_t> contig_ids(contig_count);
+  for (auto& contig_id : contig_ids) {
+
+    if (not reader.readString(contig_id)) {
+
+      return std::nullopt;
+
+    }
+
+  }
+
+  // INFO data blocks.
+  uint64_t block_count{0};
+  if (not reader.readCount(block_count) or (block_count > 0 and not info_header)) {
+
+    return std::nullopt;
+
+  }
+
+  std::vector<std::shared_ptr<const DataMemoryBlock>> data_blocks;
+  data_blocks.reserve(block_count);
+  for (uint64_t index = 0; index < block_count; ++index) {
+
+    auto data_block_opt = readDataBlock(reader, info_header);
+    if (not data_block_opt) {
+
+      ExecEnv::log().warn("PopulationSnapshot::readSnapshot; snapshot: {} data block: {} is invalid, ignored", snapshot_file, index);
+      return std::nullopt;
+
+    }
+    data_blocks.push_back(std::move(data_block_opt.value()));
+
+  }
+
+  // Interned variants.
+  const auto data_source = static_cast<DataSourceEnum>(key.data_source);
+  uint64_t variant_count{0};
+  if (not reader.readCount(variant_count)) {
+
+    return std::nullopt;
+
+  }
+
+  std::vector<std::shared_ptr<const Variant>> variants;
+  variants.reserve(variant_count);
+  for (uint64_t index = 0; index < variant_count; ++index) {
+
+    auto variant_opt = readVariant(reader, data_source, contig_ids, data_blocks);
+    if (not variant_opt) {
+
+      ExecEnv::log().warn("PopulationSnapshot::readSnapshot; snapshot: {} variant: {} is invalid, ignored", snapshot_file, index);
+      return std::nullopt;
+
+    }
+    variants.push_back(std::move(variant_opt.value()));
+
+  }
+  // The data blocks are now held by the variants.
+  data_blocks.clear();
+
+  // Genome/contig/offset structure.
+  std::shared_ptr<PopulationDB> population_ptr(std::make_shared<PopulationDB>(key.population_id, data_source));
+  uint64_t genome_count{0};
+  if (not reader.readCount(genome_count)) {
+
+    return std::nullopt;
+
+  }
+
+  size_t population_variants{0};
+  for (uint64_t genome_index = 0; genome_index < genome_count; ++genome_index) {
+
+    GenomeId_t genome_id;
+    uint64_t genome_contigs{0};
+    if (not reader.readString(genome_id) or not reader.readCount(genome_contigs)) {
+
+      return std::nullopt;
+
+    }
+
+    auto genome_opt = population_ptr->getCreateGenome(genome_id);
+    if (not genome_opt) {
+
+      return std::nullopt;
+
+    }
+
+    for (uint64_t contig = 0; contig < genome_contigs; ++contig) {
+
+      uint32_t contig_index{0};
+      uint64_t offset_count{0};
+      if (not reader.read(contig_index) or contig_index >= contig_ids.size() or not reader.readCount(offset_count)) {
+
+        return std::nullopt;
+
+      }
+
+      auto contig_opt = genome_opt.value()->getCreateContig(contig_ids[contig_index]);
+      if (not contig_opt) {
+
+        return std::nullopt;
+
+      }
+
+      for (uint64_t offset_index = 0; offset_index < offset_count; ++offset_index) {
+
+        uint64_t offset{0};
+        uint64_t offset_variants{0};
+        if (not reader.read(offset) or not reader.readCount(offset_variants)) {
+
+          return std::nullopt;
+
+        }
+
+        for (uint64_t index = 0; index < offset_variants; ++index) {
+
+          uint64_t variant_index{0};
+          if (not reader.read(variant_index)
+              or variant_index >= variants.size()
+              or variants[variant_index]->offset() != offset
+              or not contig_opt.value()->addVariant(variants[variant_index])) {
+
+            ExecEnv::log().warn("PopulationSnapshot::readSnapshot; snapshot: {} genome: {} structure is invalid, ignored", snapshot_file, genome_id);
+            return std::nullopt;
+
+          }
+          ++population_variants;
+
+        }
+
+      }
+
+    }
+
+  }
+
+  SnapshotMarker end_marker{};
+  uint64_t saved_variants{0};
+  if (not reader.read(end_marker)
+      or end_marker != SNAPSHOT_END
+      or not reader.read(saved_variants)
+      or saved_variants != population_variants) {
+
+    ExecEnv::log().warn("PopulationSnapshot::readSnapshot; snapshot: {} is truncated, ignored", snapshot_file);
+    return std::nullopt;
+
+  }
+
+  ExecEnv::log().info("PopulationSnapshot::readSnapshot; read snapshot: {}, genomes: {}, unique variants: {}, population variants: {}",
+                      snapshot_file, population_ptr->getMap().size(), variants.size(), population_variants);
+
+  return population_ptr;
+
+}
+
+
+bool kgl::PopulationSnapshot::writeSnapshot( const std::string& snapshot_file,
+                                             const PopulationSnapshotKey& key,
+                                             const PopulationDB& population) {
+
+  auto info_header_opt = population.getVCFInfoEvidenceHeader();
+
+  // Intern the contigs, data blocks and variants shared between genomes and offsets.
+  std::unordered_map<ContigId_t, uint32_t> contig_index_map;
+  std::vector<ContigId_t> contig_ids;
+  std::unordered_map<const DataMemoryBlock*, uint64_t> block_index_map;
+  std::vector<const DataMemoryBlock*> data_blocks;
+  std::unordered_map<const Variant*, uint64_t> variant_index_map;
+  std::vector<const Variant*> variants;
+  size_t population_variants{0};
+
+  const auto intern_contig = [&](const ContigId_t& contig_id) -> uint32_t {
+
+    auto [iter, inserted] = contig_index_map.try_emplace(contig_id, static_cast<uint32_t>(contig_ids.size()));
+    if (inserted) {
+
+      contig_ids.push_back(contig_id);
+
+    }
+    return iter->second;
+
+  };
+
+  for (auto const& [genome_id, genome_ptr] : population.getMap()) {
+
+    for (auto const& [contig_id, contig_ptr] : genome_ptr->getMap()) {
+
+      intern_contig(contig_id);
+      for (auto const& [offset, offset_ptr] : contig_ptr->getMap()) {
+
+        for (auto const& variant_ptr : offset_ptr->getVariantArray()) {
+
+          ++population_variants;
+          auto [variant_iter, variant_inserted] = variant_index_map.try_emplace(variant_ptr.get(), variants.size());
+          if (not variant_inserted) {
+
+            continue;
+
+          }
+          variants.push_back(variant_ptr.get());
+          intern_contig(variant_ptr->contigId());
+
+          auto info_data_opt = variant_ptr->evidence().infoData();
+          if (info_data_opt) {
+
+            const DataMemoryBlock* data_block = info_data_opt.value().get();
+            // All the data blocks must share the population header (a single parsed VCF).
+            if (not info_header_opt or data_block->evidenceHeader() != info_header_opt.value()) {
+
+              ExecEnv::log().warn("PopulationSnapshot::writeSnapshot; population: {} has more than one INFO header, snapshot not written",
+                                  population.populationId());
+              return false;
+
+            }
+
+            auto [block_iter, block_inserted] = block_index_map.try_emplace(data_block, data_blocks.size());
+            if (block_inserted) {
+
+              data_blocks.push_back(data_block);
+
+            }
+
+          }
+
+        }
+
+      }
+
+    }
+
+  }
+
+  const std::string temporary_file = snapshot_file + TEMPORARY_EXTENSION_;
+  {
+    std::ofstream snapshot_stream(temporary_file, std::ios::binary | std::ios::trunc);
+    if (not snapshot_stream.good()) {
+
+      ExecEnv::log().warn("PopulationSnapshot::writeSnapshot; cannot create snapshot file: {}", temporary_file);
+      return false;
+
+    }
+
+    SnapshotWriter writer(snapshot_stream);
+    writer.write(SNAPSHOT_MAGIC);
+    writer.write(SNAPSHOT_VERSION_);
+    writer.write(BYTE_ORDER_MARK);
+    writer.write(static_cast<uint32_t>(sizeof(InfoIntegerType)));
+    writer.write(static_cast<uint32_t>(sizeof(InfoFloatType)));
+    writeKey(writer, key);
+
+    writer.write<uint8_t>(info_header_opt ? 1 : 0);
+    if (info_header_opt) {
+
+      writeInfoHeader(writer, *info_header_opt.value());
+
+    }
+
+    writer.write<uint64_t>(contig_ids.size());
+    for (auto const& contig_id : contig_ids) {
+
+      writer.writeString(contig_id);
+
+    }
+
+    writer.write<uint64_t>(data_blocks.size());
+    for (auto data_block : data_blocks) {
+
+      writeDataBlock(writer, *data_block);
+
+    }
+
+    writer.write<uint64_t>(variants.size());
+    for (auto variant : variants) {
+
+      auto info_data_opt = variant->evidence().infoData();
+      uint64_t block_index = info_data_opt ? block_index_map[info_data_opt.value().get()] : NO_DATA_BLOCK;
+      writeVariant(writer, *variant, contig_index_map[variant->contigId()], block_index);
+
+    }
+
+    writer.write<uint64_t>(population.getMap().size());
+    for (auto const& [genome_id, genome_ptr] : population.getMap()) {
+
+      writer.writeString(genome_id);
+      writer.write<uint64_t>(genome_ptr->getMap().size());
+      for (auto const& [contig_id, contig_ptr] : genome_ptr->getMap()) {
+
+        writer.write(contig_index_map[contig_id]);
+        writer.write<uint64_t>(contig_ptr->getMap().size());
+        for (auto const& [offset, offset_ptr] : contig_ptr->getMap()) {
+
+          writer.write<uint64_t>(offset);
+          writer.write<uint64_t>(offset_ptr->getVariantArray().size());
+          for (auto const& variant_ptr : offset_ptr->getVariantArray()) {
+
+            writer.write(variant_index_map[variant_ptr.get()]);
+
+          }
+
+        }
+
+      }
+
+    }
+
+    writer.write(SNAPSHOT_END);
+    writer.write<uint64_t>(population_variants);
+    writer.finish();
+    if (not writer.good()) {
+
+      ExecEnv::log().warn("PopulationSnapshot::writeSnapshot; error writing snapshot file: {}", temporary_file);
+      snapshot_stream.close();
+      std::error_code error_code;
+      fs::remove(temporary_file, error_code);
+      return false;
+
+    }
+
+  }
+
+  std::error_code error_code;
+  fs::rename(temporary_file, snapshot_file, error_code);
+  if (error_code) {
+
+    ExecEnv::log().warn("PopulationSnapshot::writeSnapshot; cannot rename: {} to: {}, error: {}", temporary_file, snapshot_file, error_code.message());
+    fs::remove(temporary_file, error_code);
+    return false;
+
+  }
+
+  ExecEnv::log().info("PopulationSnapshot::writeSnapshot; wrote snapshot: {}, genomes: {}, unique variants: {}, population variants: {}",
+                      snapshot_file, population.getMap().size(), variants.size(), population_variants);
+
+  return true;
+
+}
@@ -0,0 +1,112 @@
+//
+// Created by kellerberrin on 17/10/23.
+//
+
+#ifndef KGL_VARIANT_DB_SNAPSHOT_H
+#define KGL_VARIANT_DB_SNAPSHOT_H
+
+
+#include "kgl_variant_db_population.h"
+#include "kel_bzip_index.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <cstdint>
+
+
+namespace kellerberrin::genome {   //  organization::project level namespace
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The key of a population snapshot. A snapshot is only reused if the key of the saved snapshot is identical to the key
+// of the requested population. The input file is identified by its size, modification time and a checksum of sampled
+// file blocks (a full checksum of a multi-hundred GB VCF would take almost as long as parsing it).
+// The INFO projection is the subscribed INFO field set, the sample projection is the selected VCF samples and the
+// region projection is the selected genomic regions.
+// Note that the contig alias configuration is not part of the key, delete the snapshot if the alias file is modified.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct PopulationSnapshotKey {
+
+  uint64_t file_size{0};
+  int64_t file_time{0};
+  uint64_t file_checksum{0};
+  uint32_t parser_type{0};
+  uint32_t data_source{0};
+  std::string population_id;
+  std::string reference_genome;
+  std::vector<std::string> info_fields;
+  std::vector<std::string> samples;
+  std::vector<std::string> regions;
+
+  [[nodiscard]] bool operator==(const PopulationSnapshotKey&) const = default;
+
+};
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// A versioned binary snapshot of a VCF population. The snapshot is written after the VCF has been parsed and is read
+// (memory mapped) instead of re-parsing the VCF on subsequent runs.
+// The snapshot contains the INFO header, the contig identifiers, the evidence (INFO) data blocks, the variants and the
+// genome/contig/offset structure of the population. Variants and data blocks shared between genomes and offsets are
+// interned and saved once, the sharing is recreated when the snapshot is read.
+// The INFO header is recreated from the saved VCF INFO records and the saved data block layout is verified against the
+// recreated header. The snapshot payload is checksummed, any mismatch, version change, corrupt or truncated file
+// rejects the snapshot and the VCF is re-parsed.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class PopulationSnapshot {
+
+public:
+
+  PopulationSnapshot() = delete;
+  ~PopulationSnapshot() = delete;
+
+  // Returns std::nullopt if the input file cannot be read.
+  [[nodiscard]] static std::optional<PopulationSnapshotKey> createKey( const std::string& file_name,
+                                                                       ParserTypeEnum parser_type,
+                                                                       DataSourceEnum data_source,
+                                                                       const std::string& population_id,
+                                                                       const std::string& reference_genome,
+                                                                       const EvidenceInfoSet& info_fields,
+                                                                       const std::vector<std::string>& samples,
+                                                                       const BGZRegionVector& regions);
+
+  // The snapshot file of a VCF file in the snapshot directory, 'file_name.<full path hash>.kglsnap'.
+  [[nodiscard]] static std::string snapshotFileName(const std::string& snapshot_directory, const std::string& file_name);
+
+  // Returns std::nullopt if the snapshot does not exist, was written with a different key, or is invalid.
+  [[nodiscard]] static std::optional<std::shared_ptr<PopulationDB>> readSnapshot( const std::string& snapshot_file,
+                                                                                  const PopulationSnapshotKey& key);
+
+  // The snapshot is written to a temporary file and renamed, a partially written snapshot is never read.
+  [[nodiscard]] static bool writeSnapshot( const std::string& snapshot_file,
+                                           const PopulationSnapshotKey& key,
+                                           const PopulationDB& population);
+
+  // The checksum appended to the snapshot payload (all bytes except the final checksum).
+  [[nodiscard]] static uint64_t payloadChecksum(std::string_view payload);
+
+  // Increment if the snapshot layout, or the layout of any saved object, is modified.
+  constexpr static const uint32_t SNAPSHOT_VERSION_{2};
+
+private:
+
+  constexpr static const char* SNAPSHOT_EXTENSION_{".kglsnap"};
+  constexpr static const char* TEMPORARY_EXTENSION_{".tmp"};
+  // The number of sampled blocks used to checksum the input file.
+  constexpr static const size_t CHECKSUM_SAMPLES_{64};
+  constexpr static const size_t CHECKSUM_BLOCK_SIZE_{65536};
+
+  // Checksum sampled blocks of the file, the first and last blocks are always sampled.
+  [[nodiscard]] static std::optional<uint64_t> sampledChecksum(const std::string& file_name, uint64_t file_size);
+
+};
+
+
+} // end namespace
+
+#endif //KGL_VARIANT_DB_SNAPSHOT_H
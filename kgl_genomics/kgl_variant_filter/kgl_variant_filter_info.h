@@ -116,18 +116,16 @@ private:
 template<bool Missing>
 bool VepSubStringFilter<Missing>::applyFilter(const Variant& variant) const {
 
-  std::optional<std::unique_ptr<const VEPSubFieldEvidence>> vep_fields_opt = InfoEvidenceAnalysis::getVepSubFields(variant);
+  const VepRecordColumns* vep_columns = InfoEvidenceAnalysis::getVepColumns(variant);
 
-  if (vep_fields_opt) {
+  if (vep_columns != nullptr) {
 
-    const VEPSubFieldEvidence& vep_fields = *vep_fields_opt.value();
-
-    std::optional<size_t> vep_index_opt = vep_fields.vepHeader()->getSubFieldIndex(vep_field_name_);
+    std::optional<size_t> vep_index_opt = vep_columns->dictionary().columnIndex(vep_field_name_);
 
     if (not vep_index_opt) {
 
       ExecEnv::log().error("VepSubStringFilter::contains; could not find VEP field: {} in VEP fields", vep_field_name_);
-      for (auto const& sub_field : vep_fields.vepHeader()->subFieldHeaders()) {
+      for (auto const& sub_field : vep_columns->dictionary().columnHeaders()) {
 
         ExecEnv::log().info("VepSubStringFilter::contains; available VEP field: {} in VEP fields", sub_field);
 
@@ -138,19 +136,9 @@ bool VepSubStringFilter<Missing>::applyFilter(const Variant& variant) const {
 
     size_t field_index = vep_index_opt.value();
 
-    for (auto const& vep_field : vep_fields.vepFields()) {
-
-      const std::vector<std::string_view>& sub_fields = VEPSubFieldEvidence::vepSubFields(vep_field);
-
-      if (sub_fields.size() != vep_fields.vepHeader()->subFieldHeaders().size()) {
-
-        ExecEnv::log().error("VepSubStringFilter::contains; VEP sub-field count: {} not equal to VEP header size: {}",
-                             sub_fields.size(),vep_fields.vepHeader()->subFieldHeaders().size());
-        return Missing;
+    for (size_t row = 0; row < vep_columns->rowCount(); ++row) {
 
-      }
-
-      const std::string_view& sub_field = sub_fields[field_index];
+      std::string_view sub_field = vep_columns->value(row, field_index);
 
       if (sub_string_.empty()) {
 
@@ -162,7 +150,7 @@ bool VepSubStringFilter<Missing>::applyFilter(const Variant& variant) const {
 
       }
 
-    } // for all vep fields
+    } // for all vep rows
 
   } // has vep.
 
@@ -171,6 +159,44 @@ bool VepSubStringFilter<Missing>::applyFilter(const Variant& variant) const {
 }
 
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Filter on the Vep 'IMPACT' subfield found in the Gnomad Homosapien data. Will silently return false for all other data.
+// Returns true if any vep record of the variant has one of the specified impacts.
+// The impacts are compared as dictionary codes, the vep text is not examined.
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class VepImpactFilter : public FilterVariants {
+
+public:
+
+  explicit VepImpactFilter(std::vector<VepImpact> impacts) : impacts_(std::move(impacts)) {
+
+    filterName("Vep Info IMPACT Filter");
+
+  }
+  ~VepImpactFilter() override = default;
+
+  [[nodiscard]] bool applyFilter(const Variant& variant) const override {
+
+    const VepRecordColumns* vep_columns = InfoEvidenceAnalysis::getVepColumns(variant);
+    if (vep_columns == nullptr) {
+
+      return false;
+
+    }
+
+    return std::ranges::any_of(impacts_, [vep_columns](VepImpact impact) { return vep_columns->anyImpact(impact); });
+
+  }
+  [[nodiscard]] std::shared_ptr<BaseFilter> clone() const override { return std::make_shared<VepImpactFilter>(*this); }
+
+private:
+
+  const std::vector<VepImpact> impacts_;
+
+};
+
+
 } // Namespace
 
 #endif //KGL_VARIANT_FILTER_INFO_H
@@ -3,7 +3,7 @@
 //
 
 #include "kel_exec_env.h"
-#include "../kel_thread/kel_workflow_threads.h"
+#include "../kel_thread/kel_executor.h"
 #include "kol_SimilarityCache.h"
 
 
@@ -123,30 +123,17 @@ bool kol::TermSimilarityCache::termSimilarityCache(const std::shared_ptr<const T
   // Create a cache matrix
   const size_t term_count = ontology_terms_ptr->size();
   cache_matrix_.reserve(term_count);
-  // Default to HW threads less 1.
-  WorkflowThreads thread_pool(WorkflowThreads::defaultThreads());
-  // Simplify the future vector type definition.
-  using ColumnResult = std::unique_ptr<std::vector<double>>;
-  using FutureResult = std::future<ColumnResult>;
-  std::vector<FutureResult> future_vector;
+  // Calculate the columns using the process-wide executor, each column is written to its own slot.
+  std::vector<std::unique_ptr<std::vector<double>>> column_vector(term_count);
+  auto column_lambda = [&column_vector, &term_similarity_ptr, &ontology_terms_ptr](size_t column) {
 
-  for (size_t column = 0; column < term_count; ++column) {
+    column_vector[column] = calcColumn(column, ontology_terms_ptr->at(column), term_similarity_ptr, ontology_terms_ptr);
 
-    const std::string &column_term = ontology_terms_ptr->at(column);
+  };
+  Executor::parallelFor(0, term_count, column_lambda, 1);
 
-    FutureResult future = thread_pool.enqueueFuture(&TermSimilarityCache::calcColumn,
-                                                    column,
-                                                    column_term,
-                                                    term_similarity_ptr,
-                                                    ontology_terms_ptr);
+  for (auto& row_ptr : column_vector) {
 
-    future_vector.push_back(std::move(future));
-
-  }
-
-  for (auto &future : future_vector) {
-
-    auto row_ptr = future.get();
     cache_matrix_.push_back(std::move(row_ptr));
 
   }
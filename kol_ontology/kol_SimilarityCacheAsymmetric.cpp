@@ -5,7 +5,7 @@
 
 #include "kel_exec_env.h"
 
-#include "../kel_thread/kel_workflow_threads.h"
+#include "../kel_thread/kel_executor.h"
 #include "kol_SimilarityCacheAsymmetric.h"
 
 
@@ -149,29 +149,17 @@ bool kol::SimilarityCacheAsymmetric::termSimilarityCache(const std::vector<std::
   cache_matrix_.reserve(row_count);
   // Create a pointer for the column term vector
   std::shared_ptr<const std::vector<std::string>> column_terms_ptr(std::make_shared<const std::vector<std::string>>(unique_column_terms));
-  // Default to HW threads less 1.
-  WorkflowThreads thread_pool(WorkflowThreads::defaultThreads());
-  // Simplify the future vector type definition.
-  using ColumnResult = std::unique_ptr<std::vector<double>>;
-  using FutureResult = std::future<ColumnResult>;
-  std::vector<FutureResult> future_vector;
+  // Calculate the columns using the process-wide executor, each row is written to its own slot.
+  std::vector<std::unique_ptr<std::vector<double>>> row_vector(row_count);
+  auto row_lambda = [&row_vector, &unique_row_terms, &term_similarity_ptr, &column_terms_ptr](size_t row) {
 
-  for (size_t row = 0; row < row_count; ++row) {
+    row_vector[row] = calcColumn(unique_row_terms[row], term_similarity_ptr, column_terms_ptr);
 
-    const std::string &row_term = unique_row_terms[row];
+  };
+  Executor::parallelFor(0, row_count, row_lambda, 1);
 
-    FutureResult future = thread_pool.enqueueFuture(&SimilarityCacheAsymmetric::calcColumn,
-                                                    row_term,
-                                                    term_similarity_ptr,
-                                                    column_terms_ptr);
+  for (auto& column_ptr : row_vector) {
 
-    future_vector.push_back(std::move(future));
-
-  }
-
-  for (auto &future : future_vector) {
-
-    auto column_ptr = future.get();
     cache_matrix_.push_back(std::move(column_ptr));
 
   }
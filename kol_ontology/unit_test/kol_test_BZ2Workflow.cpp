@@ -0,0 +1,220 @@
+//
+// Created by kellerberrin on 17/10/23.
+//
+
+#include "kel_bz2_workflow.h"
+
+#include <boost/test/unit_test.hpp>
+#include <bzlib.h>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+
+namespace kellerberrin {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Each bzip2 block header contains a bitmap of the bytes used in the block. A 16 bit word for each used range
+// of 16 byte values follows a 16 bit word of the used ranges. The text alphabets below are chosen so that the
+// bitmap words of the byte ranges 0x40, 0x50 and 0x60 spell a magic number, creating a false block boundary in
+// every block header of the compressed file.
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TestBZ2Workflow {
+
+public:
+
+  TestBZ2Workflow() = default;
+  ~TestBZ2Workflow() = default;
+
+  // Bitmap words 0x3141, 0x5926, 0x5359 (block magic).
+  constexpr static const char* BLOCK_MAGIC_ALPHABET_{"BCGIOQSTWZ]^acfgiklo"};
+  // Bitmap words 0x1772, 0x4538, 0x5090 (stream end magic).
+  constexpr static const char* STREAM_END_ALPHABET_{"CEFGIJKNQUWZ[\\achk"};
+
+  constexpr static const uint64_t BLOCK_MAGIC_{0x314159265359};
+  constexpr static const uint64_t STREAM_END_MAGIC_{0x177245385090};
+
+  // Lines of random text, adjacent characters differ so that the bzip2 run length encoding adds no byte values.
+  [[nodiscard]] static std::vector<std::string> textLines(const std::string& alphabet) {
+
+    std::mt19937 generator(TEXT_SEED_);
+    std::uniform_int_distribution<size_t> select(0, alphabet.size() - 1);
+    std::vector<std::string> text_lines;
+    for (size_t line = 0; line < TEXT_LINES_; ++line) {
+
+      std::string text_line;
+      while (text_line.size() < LINE_LENGTH_) {
+
+        char next_char = alphabet[select(generator)];
+        if (text_line.empty() or text_line.back() != next_char) {
+
+          text_line.push_back(next_char);
+
+        }
+
+      }
+      text_lines.push_back(std::move(text_line));
+
+    }
+
+    return text_lines;
+
+  }
+
+  // Compress the lines using the smallest (100k) block size, so the file has multiple blocks.
+  [[nodiscard]] static std::string compressLines(const std::vector<std::string>& text_lines) {
+
+    std::string text;
+    for (auto const& text_line : text_lines) {
+
+      text += text_line;
+      text += '\n';
+
+    }
+
+    std::string compressed(text.size() + (text.size() / 100) + 600, '\0');
+    auto compressed_size = static_cast<unsigned int>(compressed.size());
+    int return_code = ::BZ2_bzBuffToBuffCompress(compressed.data(), &compressed_size, text.data(), static_cast<unsigned int>(text.size()), 1, 0, 0);
+    BOOST_REQUIRE(return_code == BZ_OK);
+    compressed.resize(compressed_size);
+
+    return compressed;
+
+  }
+
+  // The number of (possibly overlapping) occurrences of the magic number at any bit offset.
+  [[nodiscard]] static size_t countMagic(const std::string& compressed, uint64_t magic) {
+
+    size_t magic_count{0};
+    uint64_t shift_register{0};
+    size_t bit_count{0};
+    for (auto byte : compressed) {
+
+      for (size_t bit = 8; bit > 0; --bit) {
+
+        shift_register = (shift_register << 1) | ((static_cast<uint8_t>(byte) >> (bit - 1)) & 1);
+        ++bit_count;
+        if (bit_count >= 48 and (shift_register & 0xFFFFFFFFFFFF) == magic) {
+
+          ++magic_count;
+
+        }
+
+      }
+
+    }
+
+    return magic_count;
+
+  }
+
+  [[nodiscard]] static std::string writeFile(const std::string& compressed, const std::string& file_name) {
+
+    std::string file_path = (std::filesystem::temp_directory_path() / file_name).string();
+    std::ofstream out_file(file_path, std::ios::binary | std::ios::trunc);
+    out_file.write(compressed.data(), static_cast<std::streamsize>(compressed.size()));
+    BOOST_REQUIRE(out_file.good());
+
+    return file_path;
+
+  }
+
+  [[nodiscard]] static std::vector<std::string> readLines(BZ2ParallelStreamIO& bz2_stream) {
+
+    std::vector<std::string> text_lines;
+    while (true) {
+
+      IOLineRecord line_record = bz2_stream.readLine();
+      if (line_record.EOFRecord()) break;
+      text_lines.emplace_back(line_record.getView());
+
+    }
+
+    return text_lines;
+
+  }
+
+private:
+
+  constexpr static const size_t TEXT_LINES_{40000};
+  constexpr static const size_t LINE_LENGTH_{9};
+  constexpr static const uint32_t TEXT_SEED_{1};
+
+};
+
+
+} // namespace
+
+namespace kel = kellerberrin;
+
+
+BOOST_FIXTURE_TEST_SUITE(TestBZ2WorkflowSuite, kel::TestBZ2Workflow)
+
+
+BOOST_AUTO_TEST_CASE(test_false_block_magic)
+{
+
+  auto text_lines = textLines(BLOCK_MAGIC_ALPHABET_);
+  auto compressed = compressLines(text_lines);
+  // Each block has a genuine and a false block magic number.
+  BOOST_REQUIRE(countMagic(compressed, BLOCK_MAGIC_) > countMagic(compressed, STREAM_END_MAGIC_) + 1);
+  auto file_path = writeFile(compressed, "kol_test_false_block_magic.bz2");
+
+  kel::BZ2ParallelStreamIO bz2_stream(4);
+  BOOST_REQUIRE(bz2_stream.open(file_path));
+  BOOST_CHECK(readLines(bz2_stream) == text_lines);
+  BOOST_CHECK(bz2_stream.good());
+  bz2_stream.close();
+  std::filesystem::remove(file_path);
+
+  BOOST_TEST_MESSAGE( "test_false_block_magic ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_false_stream_end_magic)
+{
+
+  auto text_lines = textLines(STREAM_END_ALPHABET_);
+  auto compressed = compressLines(text_lines);
+  // A single stream, any further stream end magic numbers are false.
+  BOOST_REQUIRE(countMagic(compressed, STREAM_END_MAGIC_) > 1);
+  auto file_path = writeFile(compressed, "kol_test_false_stream_end.bz2");
+
+  kel::BZ2ParallelStreamIO bz2_stream(4);
+  BOOST_REQUIRE(bz2_stream.open(file_path));
+  BOOST_CHECK(readLines(bz2_stream) == text_lines);
+  BOOST_CHECK(bz2_stream.good());
+  bz2_stream.close();
+  std::filesystem::remove(file_path);
+
+  BOOST_TEST_MESSAGE( "test_false_stream_end_magic ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_truncated_file)
+{
+
+  auto text_lines = textLines(BLOCK_MAGIC_ALPHABET_);
+  auto compressed = compressLines(text_lines);
+  compressed.resize(compressed.size() / 2);
+  auto file_path = writeFile(compressed, "kol_test_truncated.bz2");
+
+  // The final block cannot be decompressed, the serial decompressor returns the lines before the truncation.
+  kel::BZ2ParallelStreamIO bz2_stream(4);
+  BOOST_REQUIRE(bz2_stream.open(file_path));
+  auto read_lines = readLines(bz2_stream);
+  BOOST_CHECK(read_lines.size() < text_lines.size());
+  BOOST_CHECK(std::equal(read_lines.begin(), read_lines.end(), text_lines.begin()));
+  bz2_stream.close();
+  std::filesystem::remove(file_path);
+
+  BOOST_TEST_MESSAGE( "test_truncated_file ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,273 @@
+//
+// Created by kellerberrin on 17/10/23.
+//
+
+#include "kel_tokenizer.h"
+#include "kel_utility.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <array>
+#include <string>
+#include <vector>
+
+
+namespace kellerberrin {
+
+// The vector kernels are checked against a byte by byte reference tokenizer (the original Utility::viewTokenizer).
+// The test texts have lengths 0 to 80 (beyond two AVX2 blocks) with delimiters at the 16 and 32 byte block
+// boundaries, consecutive delimiters (empty fields) and leading and trailing delimiters.
+class TestFieldTokenizer {
+
+public:
+
+  TestFieldTokenizer() = default;
+  ~TestFieldTokenizer() = default;
+
+  [[nodiscard]] static std::vector<std::string_view> referenceTokenizer(std::string_view text, char delimiter) {
+
+    std::vector<std::string_view> fields;
+    size_t field_begin{0};
+    for (size_t index = 0; index < text.size(); ++index) {
+
+      if (text[index] == delimiter) {
+
+        fields.emplace_back(text.substr(field_begin, index - field_begin));
+        field_begin = index + 1;
+
+      }
+
+    }
+    fields.emplace_back(text.substr(field_begin));
+
+    return fields;
+
+  }
+
+  [[nodiscard]] static std::vector<size_t> referenceOffsets(std::string_view text, char delimiter) {
+
+    std::vector<size_t> offsets;
+    for (size_t index = 0; index < text.size(); ++index) {
+
+      if (text[index] == delimiter) {
+
+        offsets.push_back(index);
+
+      }
+
+    }
+
+    return offsets;
+
+  }
+
+  // The delimiter offsets of a kernel, scanned with the minimum offset buffer so that the scan is resumed.
+  [[nodiscard]] static std::vector<size_t> kernelOffsets(TokenizerKernel kernel, std::string_view text, char delimiter) {
+
+    std::vector<size_t> offsets;
+    std::array<size_t, FieldTokenizer::MINIMUM_OFFSETS_> offset_buffer{};
+    size_t position{0};
+    while (position < text.size()) {
+
+      size_t count = FieldTokenizer::delimiterOffsets(kernel, text, delimiter, position, offset_buffer);
+      offsets.insert(offsets.end(), offset_buffer.begin(), offset_buffer.begin() + static_cast<std::ptrdiff_t>(count));
+
+    }
+
+    return offsets;
+
+  }
+
+  // Fields are compared by position in the text, not only by content.
+  [[nodiscard]] static bool sameFields(const std::vector<std::string_view>& fields, const std::vector<std::string_view>& reference) {
+
+    if (fields.size() != reference.size()) {
+
+      return false;
+
+    }
+
+    for (size_t index = 0; index < fields.size(); ++index) {
+
+      if (fields[index].data() != reference[index].data() or fields[index].size() != reference[index].size()) {
+
+        return false;
+
+      }
+
+    }
+
+    return true;
+
+  }
+
+  // The test texts of each length.
+  [[nodiscard]] static std::vector<std::string> testTexts(char delimiter) {
+
+    std::vector<std::string> texts;
+    for (size_t length = 0; length <= MAX_TEXT_LENGTH_; ++length) {
+
+      // No delimiters.
+      std::string text(length, 'x');
+      for (size_t index = 0; index < length; ++index) {
+
+        text[index] = static_cast<char>('a' + (index % 26));
+
+      }
+      texts.push_back(text);
+
+      // Delimiters at the vector block boundaries.
+      std::string boundary_text = text;
+      for (size_t offset : BOUNDARY_OFFSETS_) {
+
+        if (offset < length) {
+
+          boundary_text[offset] = delimiter;
+
+        }
+
+      }
+      texts.push_back(boundary_text);
+
+      // Each single delimiter position.
+      for (size_t offset = 0; offset < length; ++offset) {
+
+        std::string single_text = text;
+        single_text[offset] = delimiter;
+        texts.push_back(single_text);
+
+      }
+
+      // All delimiters, every field is empty.
+      texts.emplace_back(length, delimiter);
+
+      // Every third char a delimiter, with leading and trailing delimiters.
+      std::string spaced_text = text;
+      for (size_t offset = 0; offset < length; offset += 3) {
+
+        spaced_text[offset] = delimiter;
+
+      }
+      if (length > 0) {
+
+        spaced_text.back() = delimiter;
+
+      }
+      texts.push_back(spaced_text);
+
+    }
+
+    return texts;
+
+  }
+
+  constexpr static const size_t MAX_TEXT_LENGTH_{80};
+  constexpr static const std::array<size_t, 10> BOUNDARY_OFFSETS_{0, 15, 16, 17, 31, 32, 33, 47, 48, 64};
+  constexpr static const std::array<char, 2> DELIMITERS_{'\t', ':'};
+  constexpr static const std::array<TokenizerKernel, 3> KERNELS_{TokenizerKernel::SCALAR, TokenizerKernel::SSE2, TokenizerKernel::AVX2};
+  constexpr static const size_t BUFFER_OFFSETS_{4};   // The text is also tested at unaligned offsets 1 to 3.
+
+};
+
+
+} // namespace
+
+namespace kel = kellerberrin;
+
+
+BOOST_FIXTURE_TEST_SUITE(TestFieldTokenizerSuite, kel::TestFieldTokenizer)
+
+
+BOOST_AUTO_TEST_CASE(test_kernel_tokenize)
+{
+
+  size_t text_count{0};
+  for (char delimiter : DELIMITERS_) {
+
+    for (auto const& test_text : testTexts(delimiter)) {
+
+      for (size_t buffer_offset = 0; buffer_offset < BUFFER_OFFSETS_; ++buffer_offset) {
+
+        // The text starts at an offset within its buffer.
+        const std::string buffer = std::string(buffer_offset, 'z') + test_text;
+        const std::string_view text = std::string_view(buffer).substr(buffer_offset);
+        const auto reference_fields = referenceTokenizer(text, delimiter);
+        const auto reference_offsets = referenceOffsets(text, delimiter);
+
+        for (auto kernel : KERNELS_) {
+
+          std::vector<std::string_view> fields;
+          kel::FieldTokenizer::tokenize(kernel, text, delimiter, fields);
+          BOOST_REQUIRE_MESSAGE(sameFields(fields, reference_fields),
+                                "kernel: " << kel::FieldTokenizer::kernelName(kernel) << ", text: '" << text << "'");
+          BOOST_REQUIRE(kernelOffsets(kernel, text, delimiter) == reference_offsets);
+
+        }
+
+        BOOST_REQUIRE(sameFields(kel::Utility::viewTokenizer(text, delimiter), reference_fields));
+        ++text_count;
+
+      }
+
+    }
+
+  }
+
+  BOOST_TEST_MESSAGE( "test_kernel_tokenize (" << text_count << " texts, active kernel: "
+                      << kel::FieldTokenizer::kernelName(kel::FieldTokenizer::activeKernel()) << ") ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_select_fields)
+{
+
+  for (char delimiter : DELIMITERS_) {
+
+    for (auto const& text : testTexts(delimiter)) {
+
+      const auto reference_fields = referenceTokenizer(text, delimiter);
+      const size_t field_count = reference_fields.size();
+
+      // The first, last, every second, every fifth and an index beyond the last field.
+      std::vector<std::vector<size_t>> index_sets{ {0}, {field_count - 1}, {}, {}, {field_count + 2} };
+      for (size_t index = 0; index < field_count; index += 2) {
+
+        index_sets[2].push_back(index);
+
+      }
+      for (size_t index = 1; index < field_count + 10; index += 5) {
+
+        index_sets[3].push_back(index);
+
+      }
+
+      for (auto const& field_indices : index_sets) {
+
+        std::vector<std::string_view> reference_select;
+        for (size_t index : field_indices) {
+
+          if (index < field_count) {
+
+            reference_select.push_back(reference_fields[index]);
+
+          }
+
+        }
+
+        std::vector<std::string_view> fields;
+        kel::FieldTokenizer::selectFields(text, delimiter, field_indices, fields);
+        BOOST_REQUIRE_MESSAGE(sameFields(fields, reference_select), "text: '" << text << "'");
+
+      }
+
+    }
+
+  }
+
+  BOOST_TEST_MESSAGE( "test_select_fields ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,500 @@
+//
+// Created by kellerberrin on 17/10/23.
+//
+
+#include "kgl_variant_db_snapshot.h"
+#include "kgl_variant_factory_vcf_evidence.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+
+namespace kellerberrin::genome {
+
+// A small population with variants shared between genomes, a homozygous variant and multiple contigs.
+// The variants are created without INFO data, or with INFO data parsed by an EvidenceFactory
+// (integer, float, string, array and vep fields). The INFO data block layout is verified when the snapshot is read.
+class TestPopulationSnapshot {
+
+public:
+
+  TestPopulationSnapshot() {
+
+    std::ofstream input_file(inputFile(), std::ios::trunc);
+    input_file << INPUT_TEXT_;
+
+  }
+  ~TestPopulationSnapshot() {
+
+    std::error_code error_code;
+    std::filesystem::remove(inputFile(), error_code);
+    std::filesystem::remove(snapshotFile(), error_code);
+
+  }
+
+  [[nodiscard]] static std::string inputFile() { return (std::filesystem::temp_directory_path() / INPUT_FILE_).string(); }
+  [[nodiscard]] static std::string snapshotFile() { return PopulationSnapshot::snapshotFileName(std::filesystem::temp_directory_path().string(), inputFile()); }
+
+  [[nodiscard]] static std::shared_ptr<const Variant> createVariant( const ContigId_t& contig,
+                                                                     ContigOffset_t offset,
+                                                                     VariantPhase phase,
+                                                                     const std::string& alternate,
+                                                                     std::shared_ptr<const DataMemoryBlock> info_data = nullptr) {
+
+    VariantEvidence evidence(offset, DataSourceEnum::Genome1000, true, std::move(info_data), nullptr);
+    return std::make_shared<const Variant>( contig,
+                                            offset,
+                                            phase,
+                                            "rs" + std::to_string(offset),
+                                            DNA5SequenceLinear(StringDNA5("A")),
+                                            DNA5SequenceLinear(StringDNA5(alternate)),
+                                            evidence);
+
+  }
+
+  [[nodiscard]] static std::shared_ptr<PopulationDB> createPopulation() {
+
+    auto population_ptr = std::make_shared<PopulationDB>(POPULATION_ID_, DataSourceEnum::Genome1000);
+    BOOST_REQUIRE(population_ptr->addVariant(createVariant("chr1", 100, VariantPhase::DIPLOID_PHASE_A, "C"), {"HG00001", "HG00002"}));
+    BOOST_REQUIRE(population_ptr->addVariant(createVariant("chr1", 100, VariantPhase::DIPLOID_PHASE_B, "G"), {"HG00001"}));
+    BOOST_REQUIRE(population_ptr->addVariant(createVariant("chr1", 250, VariantPhase::DIPLOID_PHASE_A, "T"), {"HG00002", "HG00002"}));
+    BOOST_REQUIRE(population_ptr->addVariant(createVariant("chr2", 75, VariantPhase::DIPLOID_PHASE_B, "CT"), {"HG00001", "HG00003"}));
+
+    return population_ptr;
+
+  }
+
+  // The INFO fields are parsed from the VCF header records below.
+  [[nodiscard]] static std::shared_ptr<PopulationDB> createInfoPopulation() {
+
+    EvidenceFactory evidence_factory(infoFields());
+    VCFInfoRecordMap info_record_map;
+    for (auto const& [field_id, type, number, description] : INFO_RECORDS_) {
+
+      info_record_map.emplace(field_id, VCFInfoRecord{field_id, description, type, number, "", ""});
+
+    }
+    evidence_factory.availableInfoFields(info_record_map);
+
+    auto population_ptr = std::make_shared<PopulationDB>(POPULATION_ID_, DataSourceEnum::Genome1000);
+    ContigOffset_t offset{100};
+    for (auto const& info_text : INFO_TEXT_) {
+
+      auto info_data = evidence_factory.createVariantEvidence(info_text);
+      BOOST_REQUIRE(info_data);
+      BOOST_REQUIRE(population_ptr->addVariant(createVariant("chr1", offset, VariantPhase::DIPLOID_PHASE_A, "C", info_data), {"HG00001", "HG00002"}));
+      BOOST_REQUIRE(population_ptr->addVariant(createVariant("chr1", offset, VariantPhase::DIPLOID_PHASE_B, "T", info_data), {"HG00001"}));
+      offset += 100;
+
+    }
+
+    return population_ptr;
+
+  }
+
+  [[nodiscard]] static EvidenceInfoSet infoFields() {
+
+    EvidenceInfoSet info_fields;
+    for (auto const& info_record : INFO_RECORDS_) {
+
+      info_fields.insert(info_record[0]);
+
+    }
+
+    return info_fields;
+
+  }
+
+  [[nodiscard]] static PopulationSnapshotKey createKey(const std::vector<std::string>& samples, const EvidenceInfoSet& info_fields = EvidenceInfoSet{"AF", "AN"}) {
+
+    auto key_opt = PopulationSnapshot::createKey( inputFile(),
+                                                  ParserTypeEnum::DiploidPhased,
+                                                  DataSourceEnum::Genome1000,
+                                                  POPULATION_ID_,
+                                                  "GRCh38",
+                                                  info_fields,
+                                                  samples,
+                                                  BGZRegionVector{});
+    BOOST_REQUIRE(key_opt.has_value());
+
+    return key_opt.value();
+
+  }
+
+  // Write the snapshot version and re-checksum the payload, only the version check can reject the snapshot.
+  static void setSnapshotVersion(uint32_t version) {
+
+    std::string snapshot_bytes;
+    {
+      std::ifstream snapshot_stream(snapshotFile(), std::ios::binary);
+      snapshot_bytes.assign(std::istreambuf_iterator<char>(snapshot_stream), std::istreambuf_iterator<char>());
+    }
+    BOOST_REQUIRE(snapshot_bytes.size() > VERSION_OFFSET_ + sizeof(version) + sizeof(uint64_t));
+
+    std::memcpy(snapshot_bytes.data() + VERSION_OFFSET_, &version, sizeof(version));
+    const size_t payload_size = snapshot_bytes.size() - sizeof(uint64_t);
+    const uint64_t checksum = PopulationSnapshot::payloadChecksum(std::string_view(snapshot_bytes.data(), payload_size));
+    std::memcpy(snapshot_bytes.data() + payload_size, &checksum, sizeof(checksum));
+
+    std::ofstream snapshot_stream(snapshotFile(), std::ios::binary | std::ios::trunc);
+    snapshot_stream.write(snapshot_bytes.data(), static_cast<std::streamsize>(snapshot_bytes.size()));
+
+  }
+
+  // The populations have the same genomes, contigs and variants at each offset.
+  [[nodiscard]] static bool samePopulation(const PopulationDB& population, const PopulationDB& snapshot_population) {
+
+    if (population.populationId() != snapshot_population.populationId()
+        or population.variantCount() != snapshot_population.variantCount()
+        or population.getMap().size() != snapshot_population.getMap().size()) {
+
+      return false;
+
+    }
+
+    for (auto const& [genome_id, genome_ptr] : population.getMap()) {
+
+      auto snapshot_genome_opt = snapshot_population.getGenome(genome_id);
+      if (not snapshot_genome_opt or snapshot_genome_opt.value()->getMap().size() != genome_ptr->getMap().size()) {
+
+        return false;
+
+      }
+
+      for (auto const& [contig_id, contig_ptr] : genome_ptr->getMap()) {
+
+        auto snapshot_contig = snapshot_genome_opt.value()->getMap().find(contig_id);
+        if (snapshot_contig == snapshot_genome_opt.value()->getMap().end()
+            or snapshot_contig->second->getMap().size() != contig_ptr->getMap().size()) {
+
+          return false;
+
+        }
+
+        for (auto const& [offset, offset_ptr] : contig_ptr->getMap()) {
+
+          auto snapshot_offset = snapshot_contig->second->getMap().find(offset);
+          if (snapshot_offset == snapshot_contig->second->getMap().end()) {
+
+            return false;
+
+          }
+
+          auto const& variant_array = offset_ptr->getVariantArray();
+          auto const& snapshot_array = snapshot_offset->second->getVariantArray();
+          if (variant_array.size() != snapshot_array.size()) {
+
+            return false;
+
+          }
+
+          for (size_t index = 0; index < variant_array.size(); ++index) {
+
+            if (variant_array[index]->HGVS() != snapshot_array[index]->HGVS()
+                or variant_array[index]->phaseId() != snapshot_array[index]->phaseId()
+                or variant_array[index]->identifier() != snapshot_array[index]->identifier()) {
+
+              return false;
+
+            }
+
+          }
+
+        }
+
+      }
+
+    }
+
+    return true;
+
+  }
+
+  // The INFO data and vep columns of the variants are the same, the snapshot variants have the snapshot INFO header.
+  [[nodiscard]] static bool sameInfoData(const Variant& variant, const Variant& snapshot_variant) {
+
+    auto info_data_opt = variant.evidence().infoData();
+    auto snapshot_data_opt = snapshot_variant.evidence().infoData();
+    if (not info_data_opt or not snapshot_data_opt) {
+
+      return info_data_opt.has_value() == snapshot_data_opt.has_value();
+
+    }
+
+    const DataMemoryBlock& info_data = *info_data_opt.value();
+    const DataMemoryBlock& snapshot_data = *snapshot_data_opt.value();
+    if (info_data.evidenceHeader() == snapshot_data.evidenceHeader()
+        or info_data.evidenceHeader()->getConstMap().size() != snapshot_data.evidenceHeader()->getConstMap().size()) {
+
+      return false;
+
+    }
+
+    for (auto const& [field_ident, subscribed_field] : info_data.evidenceHeader()->getConstMap()) {
+
+      auto snapshot_field_opt = snapshot_data.evidenceHeader()->getSubscribedField(field_ident);
+      if (not snapshot_field_opt) {
+
+        return false;
+
+      }
+
+      const InfoResourceHandle& handle = subscribed_field.getDataHandle();
+      const InfoResourceHandle& snapshot_handle = snapshot_field_opt.value().getDataHandle();
+      bool same_data{false};
+      switch (handle.resourceType()) {
+
+        case DataResourceType::Boolean:
+          same_data = info_data.getBoolean(handle) == snapshot_data.getBoolean(snapshot_handle);
+          break;
+
+        case DataResourceType::Integer:
+          same_data = info_data.getInteger(handle) == snapshot_data.getInteger(snapshot_handle);
+          break;
+
+        case DataResourceType::Float:
+          same_data = info_data.getFloat(handle) == snapshot_data.getFloat(snapshot_handle);
+          break;
+
+        case DataResourceType::String:
+          same_data = info_data.getString(handle) == snapshot_data.getString(snapshot_handle);
+          break;
+
+      }
+
+      if (not same_data) {
+
+        return false;
+
+      }
+
+    }
+
+    const VepRecordColumns* vep_columns = info_data.vepColumns();
+    const VepRecordColumns* snapshot_columns = snapshot_data.vepColumns();
+    if (vep_columns == nullptr or snapshot_columns == nullptr) {
+
+      return vep_columns == snapshot_columns;
+
+    }
+
+    if (vep_columns->rowCount() != snapshot_columns->rowCount() or vep_columns->columnCount() != snapshot_columns->columnCount()) {
+
+      return false;
+
+    }
+
+    for (size_t row = 0; row < vep_columns->rowCount(); ++row) {
+
+      if (vep_columns->impact(row) != snapshot_columns->impact(row)) {
+
+        return false;
+
+      }
+
+      for (size_t column = 0; column < vep_columns->columnCount(); ++column) {
+
+        if (vep_columns->value(row, column) != snapshot_columns->value(row, column)) {
+
+          return false;
+
+        }
+
+      }
+
+    }
+
+    return true;
+
+  }
+
+  // Applies a function to each variant of the population and the matching snapshot variant.
+  template<typename F>
+  [[nodiscard]] static bool allVariants(const PopulationDB& population, const PopulationDB& snapshot_population, F&& f) {
+
+    for (auto const& [genome_id, genome_ptr] : population.getMap()) {
+
+      auto snapshot_genome_opt = snapshot_population.getGenome(genome_id);
+      if (not snapshot_genome_opt) {
+
+        return false;
+
+      }
+
+      for (auto const& [contig_id, contig_ptr] : genome_ptr->getMap()) {
+
+        for (auto const& [offset, offset_ptr] : contig_ptr->getMap()) {
+
+          auto const& variant_array = offset_ptr->getVariantArray();
+          auto const& snapshot_array = snapshot_genome_opt.value()->getMap().at(contig_id)->getMap().at(offset)->getVariantArray();
+          for (size_t index = 0; index < variant_array.size(); ++index) {
+
+            if (not f(*variant_array[index], *snapshot_array[index])) {
+
+              return false;
+
+            }
+
+          }
+
+        }
+
+      }
+
+    }
+
+    return true;
+
+  }
+
+  constexpr static const size_t VERSION_OFFSET_{8};    // The version follows the 8 byte magic number.
+  constexpr static const size_t VEP_ROWS_{3};          // The vep rows of the first INFO record.
+
+private:
+
+  constexpr static const char* INPUT_FILE_{"kol_test_snapshot_input.vcf"};
+  constexpr static const char* INPUT_TEXT_{"##fileformat=VCFv4.2\n#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\n"};
+  constexpr static const char* POPULATION_ID_{"SnapshotTest"};
+  // {ID, Type, Number, Description}
+  constexpr static const std::array<std::array<const char*, 4>, 6> INFO_RECORDS_{{
+    {"AC", "Integer", "A", "Allele count"},
+    {"AF", "Float", "A", "Allele frequency"},
+    {"DP", "Integer", "1", "Read depth"},
+    {"DP_HIST", "Integer", ".", "Read depth histogram"},
+    {"FILTER_NOTE", "String", "1", "Filter annotation"},
+    {"vep", "String", ".", "Consequence annotations from Ensembl VEP. Format: Allele|Consequence|IMPACT|SYMBOL"}
+  }};
+  constexpr static const std::array<const char*, 3> INFO_TEXT_{
+    "AC=3;AF=0.125;DP=42;DP_HIST=1,5,12,0,7;FILTER_NOTE=lowqual;"
+    "vep=C|missense_variant|MODERATE|PFK9,C|stop_gained|HIGH|PFK9,C|intron_variant|MODIFIER|",
+    "AC=1;AF=2.5e-05;DP=7;DP_HIST=0;vep=T|synonymous_variant|LOW|AMA1",
+    "AC=12;DP=19;FILTER_NOTE=pass"
+  };
+
+};
+
+
+} // namespace
+
+namespace kgl = kellerberrin::genome;
+
+
+BOOST_FIXTURE_TEST_SUITE(TestPopulationSnapshotSuite, kgl::TestPopulationSnapshot)
+
+
+BOOST_AUTO_TEST_CASE(test_snapshot_round_trip)
+{
+
+  auto population_ptr = createPopulation();
+  auto key = createKey({"HG00001", "HG00002", "HG00003"});
+  BOOST_REQUIRE(kgl::PopulationSnapshot::writeSnapshot(snapshotFile(), key, *population_ptr));
+
+  auto snapshot_opt = kgl::PopulationSnapshot::readSnapshot(snapshotFile(), key);
+  BOOST_REQUIRE(snapshot_opt.has_value());
+  BOOST_CHECK(samePopulation(*population_ptr, *snapshot_opt.value()));
+
+  // Variants shared between genomes are shared in the snapshot population.
+  auto first_genome = snapshot_opt.value()->getGenome("HG00001");
+  auto second_genome = snapshot_opt.value()->getGenome("HG00002");
+  BOOST_REQUIRE(first_genome and second_genome);
+  auto const& first_array = first_genome.value()->getMap().at("chr1")->getMap().at(100)->getVariantArray();
+  auto const& second_array = second_genome.value()->getMap().at("chr1")->getMap().at(100)->getVariantArray();
+  BOOST_CHECK(first_array.front().get() == second_array.front().get());
+
+  // A different sample projection does not match the snapshot.
+  BOOST_CHECK(not kgl::PopulationSnapshot::readSnapshot(snapshotFile(), createKey({"HG00001"})));
+
+  BOOST_TEST_MESSAGE( "test_snapshot_round_trip ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_snapshot_info_round_trip)
+{
+
+  auto population_ptr = createInfoPopulation();
+  auto key = createKey({"HG00001", "HG00002"}, infoFields());
+  BOOST_REQUIRE(kgl::PopulationSnapshot::writeSnapshot(snapshotFile(), key, *population_ptr));
+
+  auto snapshot_opt = kgl::PopulationSnapshot::readSnapshot(snapshotFile(), key);
+  BOOST_REQUIRE(snapshot_opt.has_value());
+  BOOST_CHECK(samePopulation(*population_ptr, *snapshot_opt.value()));
+
+  // The INFO header is recreated with the same subscribed fields.
+  auto snapshot_header_opt = snapshot_opt.value()->getVCFInfoEvidenceHeader();
+  BOOST_REQUIRE(snapshot_header_opt.has_value());
+  BOOST_CHECK(snapshot_header_opt.value()->getConstMap().size() == infoFields().size());
+
+  // The INFO values and the vep columns are restored.
+  BOOST_CHECK(allVariants(*population_ptr, *snapshot_opt.value(), sameInfoData));
+
+  // The values of the first record are restored from the snapshot data block.
+  auto genome_opt = snapshot_opt.value()->getGenome("HG00001");
+  BOOST_REQUIRE(genome_opt);
+  auto const& variant_array = genome_opt.value()->getMap().at("chr1")->getMap().at(100)->getVariantArray();
+  auto info_data_opt = variant_array.front()->evidence().infoData();
+  BOOST_REQUIRE(info_data_opt.has_value());
+  const kgl::DataMemoryBlock& info_data = *info_data_opt.value();
+  auto const& snapshot_header = *snapshot_header_opt.value();
+  BOOST_CHECK(info_data.getInteger(snapshot_header.getSubscribedField("AC").value().getDataHandle()) == std::vector<int64_t>{3});
+  BOOST_CHECK(info_data.getFloat(snapshot_header.getSubscribedField("AF").value().getDataHandle()) == std::vector<double>{0.125});
+  BOOST_CHECK((info_data.getInteger(snapshot_header.getSubscribedField("DP_HIST").value().getDataHandle()) == std::vector<int64_t>{1, 5, 12, 0, 7}));
+  BOOST_CHECK(info_data.getString(snapshot_header.getSubscribedField("FILTER_NOTE").value().getDataHandle()) == std::vector<std::string>{"lowqual"});
+
+  // The vep rows of the first record are rebuilt with their typed impact.
+  const kgl::VepRecordColumns* vep_columns = info_data.vepColumns();
+  BOOST_REQUIRE(vep_columns != nullptr);
+  BOOST_CHECK(vep_columns->rowCount() == VEP_ROWS_);
+  BOOST_CHECK(vep_columns->impact(0) == kgl::VepImpact::MODERATE);
+  BOOST_CHECK(vep_columns->impact(1) == kgl::VepImpact::HIGH);
+  BOOST_CHECK(vep_columns->impact(2) == kgl::VepImpact::MODIFIER);
+
+  // A different INFO field subscription does not match the snapshot.
+  BOOST_CHECK(not kgl::PopulationSnapshot::readSnapshot(snapshotFile(), createKey({"HG00001", "HG00002"})));
+
+  BOOST_TEST_MESSAGE( "test_snapshot_info_round_trip ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_snapshot_version_mismatch)
+{
+
+  auto population_ptr = createPopulation();
+  auto key = createKey({});
+  BOOST_REQUIRE(kgl::PopulationSnapshot::writeSnapshot(snapshotFile(), key, *population_ptr));
+
+  setSnapshotVersion(kgl::PopulationSnapshot::SNAPSHOT_VERSION_ + 1);
+  BOOST_CHECK(not kgl::PopulationSnapshot::readSnapshot(snapshotFile(), key));
+
+  // The re-checksummed snapshot is valid with the current version.
+  setSnapshotVersion(kgl::PopulationSnapshot::SNAPSHOT_VERSION_);
+  BOOST_CHECK(kgl::PopulationSnapshot::readSnapshot(snapshotFile(), key).has_value());
+
+  BOOST_TEST_MESSAGE( "test_snapshot_version_mismatch ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_snapshot_file_name)
+{
+
+  // Files with the same name in different directories have different snapshots.
+  const std::string snapshot_directory{"snapshot"};
+  auto first_name = kgl::PopulationSnapshot::snapshotFileName(snapshot_directory, "/data/first/chr1.vcf.bgz");
+  auto second_name = kgl::PopulationSnapshot::snapshotFileName(snapshot_directory, "/data/second/chr1.vcf.bgz");
+  BOOST_CHECK(first_name != second_name);
+  BOOST_CHECK(first_name == kgl::PopulationSnapshot::snapshotFileName(snapshot_directory, "/data/first/chr1.vcf.bgz"));
+  BOOST_CHECK(std::filesystem::path(first_name).filename().string().starts_with("chr1.vcf.bgz."));
+
+  BOOST_TEST_MESSAGE( "test_snapshot_file_name ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,259 @@
+//
+// Created by kellerberrin on 17/10/23.
+//
+
+#include "kel_queue_ring.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+#include <vector>
+
+
+namespace kellerberrin {
+
+// A move only type that cannot be default constructed, used to check object lifetimes in the ring cells.
+class TestRingObject {
+
+public:
+
+  explicit TestRingObject(size_t value) : value_ptr_(std::make_shared<size_t>(value)) {}
+  TestRingObject(TestRingObject&&) noexcept = default;
+  TestRingObject(const TestRingObject&) = delete;
+  ~TestRingObject() = default;
+
+  [[nodiscard]] size_t value() const { return *value_ptr_; }
+  [[nodiscard]] std::weak_ptr<size_t> reference() const { return value_ptr_; }
+
+private:
+
+  std::shared_ptr<size_t> value_ptr_;
+
+};
+
+
+class TestQueueRing {
+
+public:
+
+  TestQueueRing() = default;
+  ~TestQueueRing() = default;
+
+  // Multiple producers push the values 1 to push_count, consumers pop until a zero stop token.
+  // The count and the sum of the popped values are checked.
+  [[nodiscard]] static bool multiProducerConsumer(size_t producers, size_t consumers, size_t high_tide, size_t low_tide) {
+
+    QueueRing<size_t> ring_queue(high_tide, low_tide);
+    std::atomic<size_t> pop_sum{0};
+    std::atomic<size_t> pop_count{0};
+    const size_t push_count = PUSH_OBJECTS_ / producers;
+
+    std::vector<std::thread> consumer_threads;
+    for (size_t consumer = 0; consumer < consumers; ++consumer) {
+
+      consumer_threads.emplace_back([&ring_queue, &pop_sum, &pop_count]() {
+
+        size_t value_sum{0};
+        size_t value_count{0};
+        while (true) {
+
+          size_t value = ring_queue.waitAndPop();
+          if (value == 0) break;
+          value_sum += value;
+          ++value_count;
+
+        }
+        pop_sum += value_sum;
+        pop_count += value_count;
+
+      });
+
+    }
+
+    std::vector<std::thread> producer_threads;
+    for (size_t producer = 0; producer < producers; ++producer) {
+
+      producer_threads.emplace_back([&ring_queue, push_count]() {
+
+        for (size_t value = 1; value <= push_count; ++value) {
+
+          ring_queue.push(value);
+
+        }
+
+      });
+
+    }
+
+    for (auto& producer_thread : producer_threads) {
+
+      producer_thread.join();
+
+    }
+
+    for (size_t consumer = 0; consumer < consumers; ++consumer) {
+
+      ring_queue.push(0);
+
+    }
+
+    for (auto& consumer_thread : consumer_threads) {
+
+      consumer_thread.join();
+
+    }
+
+    return pop_count == push_count * producers
+           and pop_sum == producers * push_count * (push_count + 1) / 2
+           and ring_queue.empty();
+
+  }
+
+  constexpr static const std::chrono::milliseconds BLOCK_WAIT_{50};
+
+private:
+
+  constexpr static const size_t PUSH_OBJECTS_{200000};
+
+};
+
+
+} // namespace
+
+namespace kel = kellerberrin;
+
+
+BOOST_FIXTURE_TEST_SUITE(TestQueueRingSuite, kel::TestQueueRing)
+
+
+BOOST_AUTO_TEST_CASE(test_mpmc_push_pop)
+{
+
+  // Small tides force producers to block at high tide and consumers to block on an empty queue.
+  BOOST_CHECK(multiProducerConsumer(1, 1, 4, 1));
+  BOOST_CHECK(multiProducerConsumer(4, 4, 8, 2));
+  BOOST_CHECK(multiProducerConsumer(3, 5, 100, 20));
+  BOOST_CHECK(multiProducerConsumer(8, 2, 1, 0));
+  BOOST_CHECK(multiProducerConsumer(2, 7, 1000, 200));
+
+  BOOST_TEST_MESSAGE( "test_mpmc_push_pop ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_single_thread_order)
+{
+
+  kel::QueueRing<size_t> ring_queue(16, 4);
+  // Wrap around the ring several times.
+  for (size_t round = 0; round < 10; ++round) {
+
+    for (size_t value = 0; value < 10; ++value) {
+
+      ring_queue.push(value);
+
+    }
+    for (size_t value = 0; value < 10; ++value) {
+
+      BOOST_REQUIRE(ring_queue.waitAndPop() == value);
+
+    }
+
+  }
+  BOOST_CHECK(ring_queue.empty());
+  BOOST_CHECK(ring_queue.capacity() == 32);
+
+  BOOST_TEST_MESSAGE( "test_single_thread_order ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_tidal_transitions)
+{
+
+  kel::QueueRing<size_t> ring_queue(10, 3);
+  for (size_t value = 0; value < 10; ++value) {
+
+    ring_queue.push(value);
+
+  }
+  BOOST_CHECK(ring_queue.queueTidalState() == kel::QueueTidalState::EBB_TIDE);
+
+  // The producer blocks at high tide.
+  std::atomic<bool> pushed{false};
+  std::thread producer_thread([&ring_queue, &pushed]() { ring_queue.push(99); pushed = true; });
+  std::this_thread::sleep_for(BLOCK_WAIT_);
+  BOOST_CHECK(not pushed);
+
+  // Still blocked above low tide.
+  for (size_t count = 0; count < 6; ++count) {
+
+    (void)ring_queue.waitAndPop();
+
+  }
+  std::this_thread::sleep_for(BLOCK_WAIT_);
+  BOOST_CHECK(not pushed);
+  BOOST_CHECK(ring_queue.queueTidalState() == kel::QueueTidalState::EBB_TIDE);
+
+  // Low tide releases the producer.
+  (void)ring_queue.waitAndPop();
+  producer_thread.join();
+  BOOST_CHECK(pushed);
+  BOOST_CHECK(ring_queue.queueState());
+  BOOST_CHECK(ring_queue.size() == 4);
+
+  // Clearing the queue also releases a blocked producer.
+  for (size_t value = 0; value < 6; ++value) {
+
+    ring_queue.push(value);
+
+  }
+  BOOST_CHECK(not ring_queue.queueState());
+  std::thread clear_thread([&ring_queue]() { ring_queue.push(5); });
+  std::this_thread::sleep_for(BLOCK_WAIT_);
+  ring_queue.clear();
+  clear_thread.join();
+  BOOST_CHECK(ring_queue.size() <= 1);
+  BOOST_CHECK(ring_queue.queueState());
+
+  BOOST_TEST_MESSAGE( "test_tidal_transitions ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_object_lifetime)
+{
+
+  std::weak_ptr<size_t> popped_reference;
+  std::weak_ptr<size_t> queued_reference;
+  {
+
+    kel::QueueRing<kel::TestRingObject> ring_queue(4, 1);
+    kel::TestRingObject first_object(7);
+    popped_reference = first_object.reference();
+    ring_queue.push(std::move(first_object));
+    kel::TestRingObject second_object(8);
+    queued_reference = second_object.reference();
+    ring_queue.push(std::move(second_object));
+
+    {
+
+      kel::TestRingObject popped_object = ring_queue.waitAndPop();
+      BOOST_CHECK(popped_object.value() == 7);
+
+    }
+    // The popped object is not retained by the ring.
+    BOOST_CHECK(popped_reference.expired());
+    BOOST_CHECK(not queued_reference.expired());
+    BOOST_CHECK(ring_queue.size() == 1);
+
+  }
+  // Queued objects are destroyed with the ring.
+  BOOST_CHECK(queued_reference.expired());
+
+  BOOST_TEST_MESSAGE( "test_object_lifetime ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,210 @@
+//
+// Created by kellerberrin on 17/10/23.
+//
+
+#include "kel_workflow_ordered.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace kellerberrin {
+
+// The work function holds sequence zero until the gate is opened, so later objects complete first.
+// Each result is a shared pointer and a weak reference is kept to check that discarded results are destroyed.
+class TestWorkflowOrdered {
+
+public:
+
+  TestWorkflowOrdered() = default;
+  ~TestWorkflowOrdered() = default;
+
+  using ResultType = std::shared_ptr<size_t>;
+  using OrderedPipeline = WorkflowOrdered<size_t, ResultType>;
+
+  [[nodiscard]] ResultType gatedWork(size_t value) {
+
+    if (value == GATED_VALUE_) {
+
+      while (not gate_open_) {
+
+        std::this_thread::yield();
+
+      }
+      // Objects completed before the gated object.
+      completed_before_gate_ = completed_count_.load();
+
+    }
+
+    auto result_ptr = std::make_shared<size_t>(value);
+    {
+      std::lock_guard<std::mutex> lock(result_mutex_);
+      result_references_.push_back(result_ptr);
+    }
+    ++completed_count_;
+
+    return result_ptr;
+
+  }
+
+  // Wait until the objects following the gated object have completed.
+  void waitCompleted(size_t completed) const {
+
+    while (completed_count_ < completed) {
+
+      std::this_thread::yield();
+
+    }
+
+  }
+
+  [[nodiscard]] bool resultsDestroyed() {
+
+    std::lock_guard<std::mutex> lock(result_mutex_);
+    return std::ranges::all_of(result_references_, [](const std::weak_ptr<size_t>& reference) { return reference.expired(); });
+
+  }
+
+  std::atomic<bool> gate_open_{false};
+  std::atomic<size_t> completed_count_{0};
+  std::atomic<size_t> completed_before_gate_{0};
+
+  constexpr static const size_t GATED_VALUE_{0};
+  constexpr static const size_t WORKER_THREADS_{4};
+  constexpr static const size_t HIGH_TIDE_{16};
+  constexpr static const size_t LOW_TIDE_{8};
+  constexpr static const std::chrono::milliseconds GATE_DELAY_{50};
+
+private:
+
+  std::mutex result_mutex_;
+  std::vector<std::weak_ptr<size_t>> result_references_;
+
+};
+
+
+} // namespace
+
+namespace kel = kellerberrin;
+
+
+BOOST_FIXTURE_TEST_SUITE(TestWorkflowOrderedSuite, kel::TestWorkflowOrdered)
+
+
+BOOST_AUTO_TEST_CASE(test_out_of_order_completion)
+{
+
+  OrderedPipeline ordered_pipeline(HIGH_TIDE_, LOW_TIDE_);
+  ordered_pipeline.activatePipeline(WORKER_THREADS_, &kel::TestWorkflowOrdered::gatedWork, this);
+
+  const size_t object_count{10};
+  for (size_t value = 0; value < object_count; ++value) {
+
+    ordered_pipeline.push(value);
+
+  }
+
+  // All objects after the gated first object complete before it.
+  waitCompleted(object_count - 1);
+  gate_open_ = true;
+
+  for (size_t value = 0; value < object_count; ++value) {
+
+    BOOST_REQUIRE(*ordered_pipeline.waitAndPop() == value);
+
+  }
+  BOOST_CHECK(completed_before_gate_ == object_count - 1);
+
+  // Objects completing in order are also dequeued in order.
+  for (size_t value = object_count; value < 1000; ++value) {
+
+    ordered_pipeline.push(value);
+    BOOST_REQUIRE(*ordered_pipeline.waitAndPop() == value);
+
+  }
+
+  BOOST_TEST_MESSAGE( "test_out_of_order_completion ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_clear_with_sequence_gap)
+{
+
+  OrderedPipeline ordered_pipeline(HIGH_TIDE_, LOW_TIDE_);
+  ordered_pipeline.activatePipeline(WORKER_THREADS_, &kel::TestWorkflowOrdered::gatedWork, this);
+
+  const size_t object_count{8};
+  for (size_t value = 0; value < object_count; ++value) {
+
+    ordered_pipeline.push(value);
+
+  }
+  waitCompleted(object_count - 1);
+
+  // The pipeline is cleared while the first object is still being processed, the completed results are discarded.
+  std::thread gate_thread([this]() { std::this_thread::sleep_for(GATE_DELAY_); gate_open_ = true; });
+  ordered_pipeline.clear();
+  gate_thread.join();
+  BOOST_CHECK(completed_count_ == object_count);
+  BOOST_CHECK(resultsDestroyed());
+
+  // The sequence numbers restart after the pipeline is re-activated.
+  ordered_pipeline.activatePipeline(WORKER_THREADS_, &kel::TestWorkflowOrdered::gatedWork, this);
+  // More objects than the pipeline capacity, the producer blocks until the results are dequeued.
+  std::thread producer_thread([&ordered_pipeline]() {
+
+    for (size_t value = 0; value < 100; ++value) {
+
+      ordered_pipeline.push(value);
+
+    }
+
+  });
+  for (size_t value = 0; value < 100; ++value) {
+
+    BOOST_CHECK(*ordered_pipeline.waitAndPop() == value);
+
+  }
+  producer_thread.join();
+
+  BOOST_TEST_MESSAGE( "test_clear_with_sequence_gap ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_CASE(test_destroy_with_sequence_gap)
+{
+
+  const size_t object_count{8};
+  std::thread gate_thread;
+  {
+
+    OrderedPipeline ordered_pipeline(HIGH_TIDE_, LOW_TIDE_);
+    ordered_pipeline.activatePipeline(WORKER_THREADS_, &kel::TestWorkflowOrdered::gatedWork, this);
+    for (size_t value = 0; value < object_count; ++value) {
+
+      ordered_pipeline.push(value);
+
+    }
+    waitCompleted(object_count - 1);
+
+    // Destroyed while the first object is being processed and without dequeueing any results.
+    gate_thread = std::thread([this]() { std::this_thread::sleep_for(GATE_DELAY_); gate_open_ = true; });
+
+  }
+  gate_thread.join();
+
+  BOOST_CHECK(completed_count_ == object_count);
+  BOOST_CHECK(resultsDestroyed());
+
+  BOOST_TEST_MESSAGE( "test_destroy_with_sequence_gap ... OK" );
+
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()